@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include <c10/core/DispatchKeySet.h>
+#include <c10/util/Optional.h>
+
+namespace c10 {
+namespace impl {
+
+/**
+ * A single entry memo of the last dispatch key computed for a
+ * TypedOperatorHandle. Handles to unboxed operators are usually held in a
+ * function-local static (see the generated ATen/Functions.cpp), so this is
+ * effectively a per call site inline cache.
+ *
+ * The cache is keyed on the DispatchKeySet of the arguments after TLS
+ * include/exclude sets have been applied, but before the operator's
+ * fallthrough mask. That is the only part of the dispatch computation that
+ * depends on the operator's registrations, so an entry is valid for the
+ * Dispatcher's registration epoch it was computed in.
+ *
+ * The entry and its epoch are published together under a sequence lock:
+ * a writer makes the sequence odd, stores both and makes it even again, and
+ * a reader only uses what it loaded if the sequence was even and unchanged
+ * around its loads. A writer that finds another one in progress skips its
+ * update, so lookups never block or spin.
+ */
+class DispatchKeyCache final {
+ public:
+  DispatchKeyCache() = default;
+
+  // A copied handle starts out with an empty cache; this keeps copying
+  // handles cheap and avoids sharing entries between call sites.
+  DispatchKeyCache(const DispatchKeyCache&) noexcept {}
+  DispatchKeyCache& operator=(const DispatchKeyCache&) noexcept {
+    // No epoch is 0, so the entry is never used again. A single store can't
+    // be observed half done.
+    epoch_.store(0, std::memory_order_relaxed);
+    return *this;
+  }
+
+  c10::optional<DispatchKey> lookup(DispatchKeySet ks, uint64_t epoch) const {
+    const uint64_t seq = seq_.load(std::memory_order_acquire);
+    const uint64_t cached_epoch = epoch_.load(std::memory_order_relaxed);
+    const uint64_t entry = entry_.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (C10_UNLIKELY(
+            (seq & 1) != 0 || seq_.load(std::memory_order_relaxed) != seq ||
+            cached_epoch != epoch ||
+            (entry & kKeySetMask) != ks.raw_repr())) {
+      return c10::nullopt;
+    }
+    return static_cast<DispatchKey>(entry >> kDispatchKeyShift);
+  }
+
+  // `epoch` must have been read before computing `k`, so that a registration
+  // racing with the computation leaves the entry stale.
+  void update(DispatchKeySet ks, DispatchKey k, uint64_t epoch) const {
+    uint64_t seq = seq_.load(std::memory_order_relaxed);
+    if ((seq & 1) != 0 ||
+        !seq_.compare_exchange_strong(
+            seq, seq + 1, std::memory_order_relaxed)) {
+      return;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    entry_.store(
+        ks.raw_repr() | (static_cast<uint64_t>(k) << kDispatchKeyShift),
+        std::memory_order_relaxed);
+    epoch_.store(epoch, std::memory_order_relaxed);
+    seq_.store(seq + 2, std::memory_order_release);
+  }
+
+ private:
+  static constexpr int kDispatchKeyShift = 56;
+  static constexpr uint64_t kKeySetMask = (1ULL << kDispatchKeyShift) - 1;
+  static_assert(
+      static_cast<uint8_t>(DispatchKey::NumDispatchKeys) <= kDispatchKeyShift,
+      "DispatchKeyCache packs a DispatchKeySet into the low 56 bits of a word");
+
+  // Odd while an update is in progress.
+  mutable std::atomic<uint64_t> seq_{0};
+  mutable std::atomic<uint64_t> entry_{0};
+  // Registration epochs start at 1, so a fresh cache is always stale.
+  mutable std::atomic<uint64_t> epoch_{0};
+};
+
+} // namespace impl
+} // namespace c10
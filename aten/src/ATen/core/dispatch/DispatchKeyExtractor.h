@@ -50,6 +50,13 @@ static inline DispatchKey dispatchTypeId(
   return (((ks | local.included_ | always_included) - local.excluded_) & key_mask).highestPriorityTypeId();
 }
 
+// The part of dispatchTypeId() that only depends on the arguments and TLS,
+// but not on the operator being called.
+static inline DispatchKeySet dispatchKeySetWithTLS(DispatchKeySet ks) {
+  c10::impl::LocalDispatchKeySet local = c10::impl::tls_local_dispatch_key_set();
+  return (ks | local.included_ | always_included) - local.excluded_;
+}
+
 }
 
 namespace detail {
@@ -143,6 +150,19 @@ public:
     return dispatchKeySetToDispatchKey_(eligibleKeys, ks);
   }
 
+  // getDispatchKeyUnboxed(DispatchKeySet::FULL, args...) split in two: the
+  // key set of the arguments with TLS applied, which does not depend on this
+  // operator's registrations, and the dispatch key it maps to, which does.
+  // Dispatcher::call memoizes the latter (see DispatchKeyCache).
+  template<class... Args>
+  DispatchKeySet getDispatchKeySetUnboxed(const Args&... args) const {
+    return impl::dispatchKeySetWithTLS(detail::multi_dispatch_key_set(args...));
+  }
+  DispatchKey getDispatchKeyForKeySet(DispatchKeySet ks) const {
+    // Keys that are fallthrough should be skipped
+    return (ks & nonFallthroughKeys_).highestPriorityTypeId();
+  }
+
   void setOperatorHasFallthroughForKey(DispatchKey k, bool has_fallthrough);
 
   std::string dumpState() const;
@@ -138,6 +138,7 @@ RegistrationHandleRAII Dispatcher::registerDef(FunctionSchema schema, std::strin
                                                     " Each overload's schema should only be registered with a single call to def().",
                                                     " Duplicate registration: ", debug, ". Original registration: ", op.operatorIterator_->op.debug());
   op.operatorIterator_->op.registerSchema(std::move(schema), std::move(debug));
+  bumpRegistrationEpoch_();
   listeners_->callOnOperatorRegistered(op);
 
   // NB: do not increment the counts until AFTER error checking
@@ -167,6 +168,7 @@ void Dispatcher::deregisterDef_(const OperatorHandle& op, const OperatorName& op
     // invariant
     listeners_->callOnOperatorDeregistered(op);
     op.operatorIterator_->op.deregisterSchema();
+    bumpRegistrationEpoch_();
   }
 
   cleanup(op, op_name);
@@ -192,6 +194,7 @@ RegistrationHandleRAII Dispatcher::registerImpl(
     std::move(inferred_function_schema),
     std::move(debug)
   );
+  bumpRegistrationEpoch_();
 
   ++op.operatorIterator_->def_and_impl_count;
 
@@ -204,6 +207,7 @@ void Dispatcher::deregisterImpl_(const OperatorHandle& op, const OperatorName& o
   std::lock_guard<std::mutex> lock(mutex_);
 
   op.operatorIterator_->op.deregisterKernel_(*this, dispatch_key, handle);
+  bumpRegistrationEpoch_();
 
   TORCH_INTERNAL_ASSERT(op.operator_name() == op_name);
 
@@ -256,6 +260,7 @@ RegistrationHandleRAII Dispatcher::registerFallback(DispatchKey dispatchKey, Ker
   for (auto& op : operators_) {
     op.op.updateFallback(*this, dispatchKey);
   }
+  bumpRegistrationEpoch_();
 
   return RegistrationHandleRAII([this, dispatchKey] {
     deregisterFallback_(dispatchKey);
@@ -270,6 +275,7 @@ void Dispatcher::deregisterFallback_(DispatchKey dispatchKey) {
   for (auto& op : operators_) {
     op.op.updateFallback(*this, dispatchKey);
   }
+  bumpRegistrationEpoch_();
 }
 
 
@@ -3,6 +3,7 @@
 #include <ATen/SequenceNumber.h>
 #include <ATen/core/boxing/KernelFunction.h>
 #include <ATen/core/boxing/impl/boxing.h>
+#include <ATen/core/dispatch/DispatchKeyCache.h>
 #include <ATen/core/dispatch/OperatorEntry.h>
 #include <ATen/core/dispatch/CppSignature.h>
 #include <ATen/core/dispatch/RegistrationHandleRAII.h>
@@ -236,9 +237,21 @@ public:
    */
   std::vector<OperatorHandle> findDanglingImpls() const;
 
+  /**
+   * Incremented whenever a registration may have changed the kernel an
+   * operator call dispatches to. Used to invalidate DispatchKeyCache entries.
+   */
+  uint64_t registrationEpoch() const {
+    return registrationEpoch_.load(std::memory_order_acquire);
+  }
+
 private:
   Dispatcher();
 
+  void bumpRegistrationEpoch_() {
+    registrationEpoch_.fetch_add(1, std::memory_order_acq_rel);
+  }
+
   OperatorHandle findOrRegisterSchema_(FunctionSchema&& schema);
   OperatorHandle findOrRegisterName_(const OperatorName& op_name);
 
@@ -263,6 +276,7 @@ private:
 
   std::unique_ptr<detail::RegistrationListenerList> listeners_;
   std::mutex mutex_;
+  std::atomic<uint64_t> registrationEpoch_{1};
 };
 
 /**
@@ -362,6 +376,9 @@ private:
   explicit TypedOperatorHandle(std::list<Dispatcher::OperatorDef>::iterator operatorIterator)
   : OperatorHandle(std::move(operatorIterator)) {}
   friend class OperatorHandle;
+  friend class Dispatcher;
+
+  impl::DispatchKeyCache dispatchKeyCache_;
 };
 
 namespace detail {
@@ -417,11 +434,17 @@ inline Return Dispatcher::callWithDispatchKey(const TypedOperatorHandle<Return(A
 template<class Return, class... Args>
 inline Return Dispatcher::call(const TypedOperatorHandle<Return(Args...)>& op, Args... args) const {
   detail::unused_arg_(args...);  // workaround for a false-positive warning about unused parameters in gcc 5
-  auto dispatchKey = op.operatorIterator_->op.dispatchKeyExtractor()
-    .template getDispatchKeyUnboxed<Args...>(
-      DispatchKeySet::FULL,
-      args...
-    );
+  const auto& extractor = op.operatorIterator_->op.dispatchKeyExtractor();
+  auto ks = extractor.template getDispatchKeySetUnboxed<Args...>(args...);
+  auto epoch = registrationEpoch();
+  auto cached = op.dispatchKeyCache_.lookup(ks, epoch);
+  DispatchKey dispatchKey;
+  if (C10_LIKELY(cached.has_value())) {
+    dispatchKey = *cached;
+  } else {
+    dispatchKey = extractor.getDispatchKeyForKeySet(ks);
+    op.dispatchKeyCache_.update(ks, dispatchKey, epoch);
+  }
   return callWithDispatchKey<Return, Args...>(op, dispatchKey, args...);
 }
 
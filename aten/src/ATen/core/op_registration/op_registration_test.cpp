@@ -14,7 +14,9 @@
 #include <ATen/core/op_registration/op_registration.h>
 #include <torch/library.h>
 #include <ATen/core/Tensor.h>
+#include <atomic>
 #include <functional>
+#include <thread>
 
 #include <ATen/core/LegacyTypeDispatch.h>
 
@@ -1945,6 +1947,84 @@ TEST(NewOperatorRegistrationTest, testDelayedListener) {
   EXPECT_EQ(initial_num_deregisters + 1, listener_ptr->num_deregisters_);
 }
 
+TEST(NewOperatorRegistrationTest, typedHandleFollowsRegistrations) {
+  bool cpu_called = false;
+  bool xla_called = false;
+  auto m = MAKE_TORCH_LIBRARY(test);
+  m.def("fn(Tensor x) -> Tensor");
+  m.impl("fn", c10::DispatchKey::CPU, [&](const Tensor& x) { cpu_called = true; return x; });
+  m.impl("fn", c10::DispatchKey::XLA, CppFunction::makeFallthrough());
+
+  auto op = Dispatcher::singleton().findSchema({"test::fn", ""});
+  ASSERT_TRUE(op.has_value());
+  // Keep a single typed handle around, like a call site would, so that every
+  // call below goes through the same dispatch key cache.
+  auto typed_op = op->typed<Tensor(const Tensor&)>();
+  auto tensor = dummyTensor(c10::DispatchKeySet({c10::DispatchKey::CPU, c10::DispatchKey::XLA}));
+
+  // XLA is fallthrough, calls CPU kernel
+  typed_op.call(tensor);
+  ASSERT_TRUE(cpu_called);
+  cpu_called = false;
+  typed_op.call(tensor);
+  ASSERT_TRUE(cpu_called);
+
+  {
+    auto m_xla = MAKE_TORCH_LIBRARY_IMPL(test, XLA);
+    m_xla.impl("fn", [&](const Tensor& x) { xla_called = true; return x; });
+    cpu_called = false;
+    typed_op.call(tensor);
+    ASSERT_TRUE(xla_called);
+    ASSERT_FALSE(cpu_called);
+  }
+
+  // the XLA kernel is gone again, calls CPU kernel
+  xla_called = false;
+  typed_op.call(tensor);
+  ASSERT_TRUE(cpu_called);
+  ASSERT_FALSE(xla_called);
+}
+
+TEST(NewOperatorRegistrationTest, dispatchKeyCacheEntriesMatchTheirEpoch) {
+  c10::impl::DispatchKeyCache cache;
+  const c10::DispatchKeySet key_sets[] = {
+      c10::DispatchKeySet(DispatchKey::CPU),
+      c10::DispatchKeySet(DispatchKey::CUDA)};
+  // A different key for every key set and epoch, so that a lookup pairing an
+  // entry with the epoch of another update returns the wrong key.
+  auto key_for = [](size_t s, uint64_t epoch) {
+    return static_cast<DispatchKey>(1 + s + 2 * epoch);
+  };
+
+  cache.update(key_sets[0], key_for(0, 1), 1);
+  EXPECT_EQ(cache.lookup(key_sets[0], 1), key_for(0, 1));
+  EXPECT_FALSE(cache.lookup(key_sets[0], 2).has_value());
+  EXPECT_FALSE(cache.lookup(key_sets[1], 1).has_value());
+
+  std::atomic<bool> mismatch{false};
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t] {
+      for (size_t i = 0; i < 100000; ++i) {
+        const size_t s = (i + t) % 2;
+        const uint64_t epoch = 1 + (i / 3 + t) % 2;
+        if (t % 2 == 0) {
+          cache.update(key_sets[s], key_for(s, epoch), epoch);
+        } else {
+          auto k = cache.lookup(key_sets[s], epoch);
+          if (k.has_value() && *k != key_for(s, epoch)) {
+            mismatch = true;
+          }
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_FALSE(mismatch);
+}
+
 TEST(NewOperatorRegistrationTest, testImplNoDefGetsCaught) {
   auto danglingImpls = Dispatcher::singleton().findDanglingImpls();
   std::string error_str = "Discovered operators that have been registered through the dispatcher"
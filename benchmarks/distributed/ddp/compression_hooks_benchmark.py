@@ -0,0 +1,164 @@
+#!/usr/bin/env python3
+#
+# Measure DDP step time and bytes on the wire of the built-in gradient
+# compression communication hooks on CPU with the Gloo backend. The
+# "pipelined" configuration runs without a hook, with buckets split into
+# chunks of --bucket-chunk-kb that are reduced as soon as they are full.
+#
+# Run one copy per worker, e.g. on each of two hosts:
+#
+#   python compression_hooks_benchmark.py --master-addr host0 \
+#       --world-size 2 --rank <rank>
+#
+# Bytes on the wire are measured as the delta of the transmitted bytes of all
+# non-loopback interfaces in /proc/net/dev, so they include framing and any
+# other traffic on the host. The payload bytes a worker sends per step are
+# estimated as well. When all workers run on one host, only the estimate is
+# meaningful.
+#
+
+import argparse
+import os
+import time
+
+import torch
+import torch.distributed as dist
+import torch.nn as nn
+
+HOOKS = {
+    "none": None,
+    "pipelined": None,
+    "allreduce": dist.BuiltinCommHookType.ALLREDUCE,
+    "fp16": dist.BuiltinCommHookType.FP16_COMPRESS,
+    "int8": dist.BuiltinCommHookType.INT8_ROWWISE_QUANTIZE,
+    "topk": dist.BuiltinCommHookType.TOPK_SPARSIFY,
+    "powersgd": dist.BuiltinCommHookType.POWER_SGD,
+}
+
+
+def tx_bytes():
+    total = 0
+    with open("/proc/net/dev") as f:
+        for line in f.readlines()[2:]:
+            iface, stats = line.split(":", 1)
+            if iface.strip() == "lo":
+                continue
+            total += int(stats.split()[8])
+    return total
+
+
+def estimated_payload_bytes(hook, model, world_size):
+    # Bytes a worker sends per step, assuming a ring allreduce sends
+    # 2 * (W - 1) / W of its input and an allgather (W - 1) times its input.
+    ring = 2.0 * (world_size - 1) / world_size
+    gather = world_size - 1
+    total = 0.0
+    for p in model.parameters():
+        n = p.numel()
+        if hook in ("none", "pipelined", "allreduce"):
+            total += ring * 4 * n
+        elif hook == "fp16":
+            total += ring * 2 * n
+        elif hook == "int8":
+            rows = (n + 511) // 512
+            total += gather * (n + 8 * rows)
+        elif hook == "topk":
+            total += gather * 8 * max(1, int(0.01 * n + 0.999))
+        elif hook == "powersgd":
+            if p.dim() <= 1:
+                total += ring * 4 * n
+            else:
+                rows, cols = p.shape[0], n // p.shape[0]
+                rank = min(rows, cols, 1)
+                total += ring * 4 * rank * (rows + cols)
+    return total
+
+
+def create_model(width, depth):
+    layers = []
+    for _ in range(depth):
+        layers += [nn.Linear(width, width), nn.ReLU()]
+    layers.append(nn.Linear(width, 10))
+    return nn.Sequential(*layers)
+
+
+def run(args, hook):
+    torch.manual_seed(0)
+    model = create_model(args.width, args.depth)
+    ddp = nn.parallel.DistributedDataParallel(
+        model, bucket_cap_mb=args.bucket_cap_mb)
+    if HOOKS[hook] is not None:
+        ddp._register_builtin_comm_hook(HOOKS[hook])
+    if hook == "pipelined":
+        ddp._set_bucket_chunk_size(args.bucket_chunk_kb * 1024)
+    optimizer = torch.optim.SGD(ddp.parameters(), lr=0.01)
+    criterion = nn.CrossEntropyLoss()
+    inputs = torch.randn(args.batch_size, args.width)
+    target = torch.randint(0, 10, (args.batch_size,))
+
+    # PowerSGD runs plain allreduce for its first 10 iterations.
+    for _ in range(max(args.warmup, 11)):
+        optimizer.zero_grad()
+        criterion(ddp(inputs), target).backward()
+        optimizer.step()
+
+    dist.barrier()
+    tx_start = tx_bytes()
+    times = []
+    for _ in range(args.iterations):
+        start = time.perf_counter()
+        optimizer.zero_grad()
+        criterion(ddp(inputs), target).backward()
+        optimizer.step()
+        times.append(time.perf_counter() - start)
+    tx_end = tx_bytes()
+    dist.barrier()
+
+    times.sort()
+    return {
+        "p50_ms": 1000 * times[len(times) // 2],
+        "p90_ms": 1000 * times[int(len(times) * 0.9)],
+        "wire_mb_per_step": (tx_end - tx_start) / args.iterations / 1e6,
+        "payload_mb_per_step":
+            estimated_payload_bytes(hook, model, dist.get_world_size()) / 1e6,
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="DDP gradient compression hook benchmark")
+    parser.add_argument("--master-addr", default="localhost")
+    parser.add_argument("--master-port", default="29500")
+    parser.add_argument("--world-size", type=int, default=int(os.environ.get("WORLD_SIZE", 1)))
+    parser.add_argument("--rank", type=int, default=int(os.environ.get("RANK", 0)))
+    parser.add_argument("--width", type=int, default=2048)
+    parser.add_argument("--depth", type=int, default=8)
+    parser.add_argument("--batch-size", type=int, default=64)
+    parser.add_argument("--bucket-cap-mb", type=int, default=25)
+    parser.add_argument("--bucket-chunk-kb", type=int, default=1024)
+    parser.add_argument("--warmup", type=int, default=5)
+    parser.add_argument("--iterations", type=int, default=50)
+    parser.add_argument("--hooks", default=",".join(HOOKS.keys()))
+    args = parser.parse_args()
+
+    os.environ["MASTER_ADDR"] = args.master_addr
+    os.environ["MASTER_PORT"] = args.master_port
+    dist.init_process_group(
+        "gloo", rank=args.rank, world_size=args.world_size)
+
+    if args.rank == 0:
+        print("{:>10} {:>10} {:>10} {:>14} {:>14}".format(
+            "hook", "p50 (ms)", "p90 (ms)", "wire MB/step", "payload MB/step"))
+    for hook in args.hooks.split(","):
+        result = run(args, hook)
+        if args.rank == 0:
+            print("{:>10} {:>10.2f} {:>10.2f} {:>14.2f} {:>14.2f}".format(
+                hook,
+                result["p50_ms"],
+                result["p90_ms"],
+                result["wire_mb_per_step"],
+                result["payload_mb_per_step"]))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+#
+# Measure the throughput of distributed backward passes of many trainers
+# against a single parameter server, using the ProcessGroup RPC agent on one
+# host. Every trainer runs the forward pass of a model whose parameters live on
+# the parameter server, and then runs the distributed backward pass, which
+# sends the gradients back to the parameter server to be accumulated in the
+# autograd context of the trainer.
+#
+#   python dist_autograd_benchmark.py --num-trainers 8
+#
+
+import argparse
+import os
+import time
+
+import torch
+import torch.distributed.autograd as dist_autograd
+import torch.distributed.rpc as rpc
+import torch.multiprocessing as mp
+
+PS_NAME = "ps"
+
+
+class ParameterServer(object):
+    def __init__(self, num_params, param_size):
+        self.params = [
+            torch.randn(param_size, requires_grad=True)
+            for _ in range(num_params)
+        ]
+
+    def forward(self, inputs):
+        return sum((p * inputs).sum() for p in self.params)
+
+
+_ps = None
+
+
+def create_ps(num_params, param_size):
+    global _ps
+    _ps = ParameterServer(num_params, param_size)
+
+
+def ps_forward(inputs):
+    return _ps.forward(inputs)
+
+
+def run_trainer(args):
+    inputs = torch.randn(args.param_size)
+
+    def step():
+        with dist_autograd.context() as context_id:
+            loss = rpc.rpc_sync(PS_NAME, ps_forward, args=(inputs,))
+            dist_autograd.backward(context_id, [loss])
+
+    for _ in range(args.warmup):
+        step()
+    start = time.perf_counter()
+    for _ in range(args.iterations):
+        step()
+    return time.perf_counter() - start
+
+
+def run_worker(rank, args):
+    os.environ["MASTER_ADDR"] = "localhost"
+    os.environ["MASTER_PORT"] = args.master_port
+    world_size = args.num_trainers + 1
+    options = rpc.ProcessGroupRpcBackendOptions(
+        num_send_recv_threads=args.num_threads)
+    if rank == 0:
+        rpc.init_rpc(
+            PS_NAME,
+            rank=rank,
+            world_size=world_size,
+            backend=rpc.BackendType.PROCESS_GROUP,
+            rpc_backend_options=options)
+        create_ps(args.num_params, args.param_size)
+        futs = [
+            rpc.rpc_async("trainer{}".format(i), run_trainer, args=(args,))
+            for i in range(1, world_size)
+        ]
+        elapsed = max(fut.wait() for fut in futs)
+        passes = args.num_trainers * args.iterations
+        print("{} trainers, {} params of {} elements".format(
+            args.num_trainers, args.num_params, args.param_size))
+        print("{:.1f} backward passes/s".format(passes / elapsed))
+    else:
+        rpc.init_rpc(
+            "trainer{}".format(rank),
+            rank=rank,
+            world_size=world_size,
+            backend=rpc.BackendType.PROCESS_GROUP,
+            rpc_backend_options=options)
+    rpc.shutdown()
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Distributed autograd throughput benchmark")
+    parser.add_argument("--master-port", default="29500")
+    parser.add_argument("--num-trainers", type=int, default=8)
+    parser.add_argument("--num-threads", type=int, default=16)
+    parser.add_argument("--num-params", type=int, default=64)
+    parser.add_argument("--param-size", type=int, default=1024)
+    parser.add_argument("--warmup", type=int, default=10)
+    parser.add_argument("--iterations", type=int, default=200)
+    args = parser.parse_args()
+
+    mp.spawn(run_worker, args=(args,), nprocs=args.num_trainers + 1, join=True)
+
+
+if __name__ == "__main__":
+    main()
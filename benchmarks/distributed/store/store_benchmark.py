@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+#
+# Stress TCPStore with many local clients, spread over processes and threads,
+# and measure:
+#
+#   rendezvous  every client publishes a key, checks in on a counter, waits for
+#               all others and reads the keys of all clients
+#   barrier     every client checks in on a counter and waits for it to reach
+#               the number of clients, with _wait_counter or by polling add
+#   set/get     throughput of set followed by get of a per-client key
+#
+# For example, with 4096 clients:
+#
+#   python store_benchmark.py --processes 32 --threads 128
+#
+
+import argparse
+import multiprocessing
+import threading
+import time
+from datetime import timedelta
+
+import torch.distributed as dist
+
+
+def barrier_wait(store, key, target, poll):
+    if poll:
+        while store.add(key, 0) < target:
+            time.sleep(0.01)
+    else:
+        store._wait_counter(key, target, timedelta(seconds=300))
+
+
+def client(args, port, index, num_clients, results):
+    store = dist.TCPStore(
+        "127.0.0.1", port, num_clients + 1, False, timedelta(seconds=300))
+    times = {}
+
+    # Rendezvous
+    start = time.perf_counter()
+    store.set("rdzv/{}".format(index), "addr:{}".format(index))
+    store.add("rdzv/count", 1)
+    barrier_wait(store, "rdzv/count", num_clients, poll=False)
+    peers = store.multi_get(
+        ["rdzv/{}".format(i) for i in range(num_clients)])
+    assert peers[index] == "addr:{}".format(index).encode()
+    times["rendezvous"] = time.perf_counter() - start
+
+    # Barriers
+    for mode in ("wait_counter", "poll"):
+        start = time.perf_counter()
+        for i in range(args.barriers):
+            key = "barrier/{}/{}".format(mode, i)
+            store.add(key, 1)
+            barrier_wait(store, key, num_clients, poll=(mode == "poll"))
+        times["barrier_" + mode] = (
+            time.perf_counter() - start) / args.barriers
+
+    # Set/get throughput
+    key = "kv/{}".format(index)
+    start = time.perf_counter()
+    for i in range(args.ops):
+        store.set(key, str(i))
+        store.get(key)
+    times["set_get"] = time.perf_counter() - start
+
+    results.append(times)
+
+
+def process(args, port, first_index, num_clients, queue):
+    results = []
+    threads = [
+        threading.Thread(
+            target=client,
+            args=(args, port, first_index + i, num_clients, results))
+        for i in range(args.threads)
+    ]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    queue.put(results)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="TCPStore stress benchmark")
+    parser.add_argument("--port", type=int, default=29501)
+    parser.add_argument("--processes", type=int, default=8)
+    parser.add_argument("--threads", type=int, default=64)
+    parser.add_argument("--barriers", type=int, default=10)
+    parser.add_argument("--ops", type=int, default=100)
+    args = parser.parse_args()
+
+    num_clients = args.processes * args.threads
+    # The server store blocks until all clients have connected.
+    stores = []
+    server_thread = threading.Thread(target=lambda: stores.append(dist.TCPStore(
+        "127.0.0.1", args.port, num_clients + 1, True, timedelta(seconds=300))))
+    server_thread.start()
+
+    ctx = multiprocessing.get_context("spawn")
+    queue = ctx.Queue()
+    processes = [
+        ctx.Process(
+            target=process,
+            args=(args, args.port, p * args.threads, num_clients, queue))
+        for p in range(args.processes)
+    ]
+    for p in processes:
+        p.start()
+    results = []
+    for _ in processes:
+        results += queue.get()
+    for p in processes:
+        p.join()
+    server_thread.join()
+
+    print("{} clients in {} processes".format(num_clients, args.processes))
+    print("{:>24} {:>12} {:>12}".format("", "p50 (ms)", "max (ms)"))
+    for name in ("rendezvous", "barrier_wait_counter", "barrier_poll"):
+        values = sorted(r[name] for r in results)
+        print("{:>24} {:>12.2f} {:>12.2f}".format(
+            name, 1000 * values[len(values) // 2], 1000 * values[-1]))
+    total_ops = 2 * args.ops * num_clients
+    slowest = max(r["set_get"] for r in results)
+    print("{:>24} {:>12.0f} ops/s".format("set/get", total_ops / slowest))
+
+
+if __name__ == "__main__":
+    main()
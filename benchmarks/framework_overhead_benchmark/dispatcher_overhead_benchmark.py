@@ -0,0 +1,53 @@
+import argparse
+
+from torch.utils.benchmark import Timer
+
+""" Dispatcher overhead benchmark script.
+Measures the time per op call (in ns) of going through c10::Dispatcher for
+ops on tiny tensors, where kernel time is negligible and the cost is dominated
+by computing the dispatch key and looking up the kernel.
+Calls are made from C++ (via torch.utils.benchmark's C++ timer) so no Python
+overhead is included.
+Example run:
+python dispatcher_overhead_benchmark.py
+python dispatcher_overhead_benchmark.py --ops add,view --requires_grad
+"""
+
+# Each entry is the C++ statement that is timed. `x` and `y` are tensors
+# created in the setup.
+OPS = {
+    "add": "at::add(x, y);",
+    "mul_": "x.mul_(1);",
+    "view": "x.view({-1});",
+    "empty": "at::empty({0});",
+    "typed_call": "op.call(x, y, 1);",
+}
+
+# x is not a leaf so that in-place ops are allowed when it requires grad
+SETUP = """
+auto x = at::ones({1}, at::TensorOptions().requires_grad({requires_grad})) * 1;
+auto y = at::ones({1});
+static auto op = c10::Dispatcher::singleton()
+    .findSchemaOrThrow("aten::add", "Tensor")
+    .typed<at::Tensor(const at::Tensor&, const at::Tensor&, at::Scalar)>();
+"""
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--ops", default=",".join(OPS.keys()), type=str)
+    parser.add_argument("--requires_grad", default=False, action="store_true")
+    parser.add_argument("--min_run_time", default=1.0, type=float)
+    args = parser.parse_args()
+
+    setup = SETUP.replace("{requires_grad}", "true" if args.requires_grad else "false")
+
+    print("===================================")
+    for name in args.ops.split(","):
+        timer = Timer(stmt=OPS[name], setup=setup, language="c++")
+        m = timer.blocked_autorange(min_run_time=args.min_run_time)
+        print("{}, requires_grad={}, ns per op call: {:.1f}".format(
+            name, args.requires_grad, m.median * 1e9))
+    print("===================================")
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,125 @@
+import torch
+
+import time
+from argparse import ArgumentParser
+from collections import defaultdict
+from typing import Callable, List, Tuple
+
+from utils import to_markdown_table, TimingResultType
+
+# Graphs of tiny ops, so that the time spent in backward is dominated by the
+# overhead of the autograd engine for every node. Every getter takes the number
+# of nodes and returns the loss and the leaf to differentiate it with respect
+# to.
+GraphType = Tuple[torch.Tensor, torch.Tensor]
+
+
+def get_chain(num_nodes: int) -> GraphType:
+    # A single chain of nodes, each consumed by the next one.
+    x = torch.ones(1, requires_grad=True)
+    y = x
+    for _ in range(num_nodes):
+        y = y * 1.0
+    return y.sum(), x
+
+
+def get_wide(num_nodes: int) -> GraphType:
+    # Many branches reading the same leaf, summed at once.
+    x = torch.ones(1, requires_grad=True)
+    return torch.stack([x * 1.0 for _ in range(num_nodes)]).sum(), x
+
+
+def get_tree(num_nodes: int) -> GraphType:
+    # A binary tree of additions, where nodes have two consumers.
+    x = torch.ones(1, requires_grad=True)
+    level = [x * 1.0 for _ in range(num_nodes // 2)]
+    while len(level) > 1:
+        level = [a + b for a, b in zip(level[::2], level[1::2])] + level[len(level) // 2 * 2:]
+    return level[0].sum(), x
+
+
+class Reenter(torch.autograd.Function):
+    # Runs a short chain backward from within its own backward.
+    @staticmethod
+    def forward(ctx, x):
+        with torch.enable_grad():
+            ctx.x = x.detach().requires_grad_()
+            ctx.out = ctx.x * 1.0
+        return x.clone()
+
+    @staticmethod
+    def backward(ctx, grad):
+        with torch.enable_grad():
+            ctx.out.sum().backward()
+        return grad
+
+
+def get_reentrant(num_nodes: int) -> GraphType:
+    # A chain of nodes, each running a reentrant backward of two nodes.
+    x = torch.ones(1, requires_grad=True)
+    y = x
+    for _ in range(num_nodes // 4):
+        y = Reenter.apply(y * 1.0)
+    return y.sum(), x
+
+
+GRAPHS = {
+    "chain": get_chain,
+    "wide": get_wide,
+    "tree": get_tree,
+    "reentrant": get_reentrant,
+}
+
+
+def run_graph(graph_getter: Callable[[int], GraphType], num_nodes: int, num_iters: int,
+              num_cpu_worker_threads: int) -> List[float]:
+    engine = torch.autograd.Variable._execution_engine
+    engine.set_num_cpu_worker_threads(num_cpu_worker_threads)
+
+    # Warmup
+    loss, x = graph_getter(num_nodes)
+    torch.autograd.grad(loss, x)
+
+    elapsed = []
+    for _ in range(num_iters):
+        loss, x = graph_getter(num_nodes)
+        start = time.perf_counter()
+        torch.autograd.grad(loss, x)
+        # Per node, in microseconds
+        elapsed.append((time.perf_counter() - start) / num_nodes * 1e6)
+
+    engine.set_num_cpu_worker_threads(0)
+    return elapsed
+
+
+def main():
+    parser = ArgumentParser("Script to benchmark the per-node overhead of the autograd engine.")
+    parser.add_argument("--output", type=str, default="", help="Text file where to write the output")
+    parser.add_argument("--num-iters", type=int, default=20)
+    parser.add_argument("--num-nodes", type=int, default=10000)
+    parser.add_argument("--graph-filter", type=str, default="", help="Only run the graphs in this filter")
+    parser.add_argument("--num-cpu-worker-threads", type=int, default=0,
+                        help="Number of CPU worker threads of the autograd engine")
+    args = parser.parse_args()
+
+    results: TimingResultType = defaultdict(defaultdict)
+    # Intra-op parallelism would only add noise with ops this small
+    torch.set_num_threads(1)
+
+    for name, graph_getter in GRAPHS.items():
+        if args.graph_filter and name not in args.graph_filter:
+            continue
+        runtimes = run_graph(graph_getter, args.num_nodes, args.num_iters, args.num_cpu_worker_threads)
+
+        runtimes = torch.tensor(runtimes)
+        mean, var = runtimes.mean(), runtimes.var()
+        results[name]["backward"] = (mean.item(), var.item())
+        print("Results for graph {}: {}us per node (var: {})".format(name, mean, var))
+
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(to_markdown_table(results, header=("graph", "task", "mean (us per node)", "var")))
+
+
+if __name__ == "__main__":
+    main()
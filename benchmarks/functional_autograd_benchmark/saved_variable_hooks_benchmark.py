@@ -0,0 +1,91 @@
+import torch
+from torch import nn
+
+import tempfile
+import time
+from argparse import ArgumentParser
+from collections import defaultdict
+from contextlib import contextmanager
+from typing import Callable, ContextManager, Dict, Iterator, List, Tuple
+
+from utils import to_markdown_table, TimingResultType
+
+
+def get_mlp(width: int, depth: int) -> nn.Module:
+    # The reference MLP, whose ReLUs and dropouts save masks and activations.
+    layers: List[nn.Module] = []
+    for _ in range(depth):
+        layers += [nn.Linear(width, width), nn.ReLU(), nn.Dropout(0.1)]
+    return nn.Sequential(*layers)
+
+
+@contextmanager
+def no_hooks() -> Iterator[None]:
+    yield
+
+
+def get_modes(directory: str) -> Dict[str, Callable[[], ContextManager]]:
+    return {
+        "none": no_hooks,
+        "bool": lambda: torch.autograd.compress_saved_tensors("none"),
+        "bf16": lambda: torch.autograd.compress_saved_tensors("bf16"),
+        "int8": lambda: torch.autograd.compress_saved_tensors("int8"),
+        "file": lambda: torch.autograd.spill_saved_tensors(directory),
+    }
+
+
+def run_mode(model: nn.Module, inp: torch.Tensor, hooks_getter: Callable[[], ContextManager],
+             num_iters: int) -> Tuple[List[float], int, int]:
+    # Returns the time of the steps, in milliseconds, and the bytes packed by
+    # the hooks in a step, before and after packing.
+    elapsed = []
+    original_bytes = packed_bytes = 0
+    for i in range(num_iters + 1):
+        model.zero_grad()
+        start = time.perf_counter()
+        with hooks_getter() as hooks:
+            loss = model(inp).sum()
+        loss.backward()
+        # The first iteration is warmup
+        if i > 0:
+            elapsed.append((time.perf_counter() - start) * 1e3)
+        if hooks is not None:
+            original_bytes, packed_bytes = hooks.original_bytes, hooks.packed_bytes
+    return elapsed, original_bytes, packed_bytes
+
+
+def main():
+    parser = ArgumentParser("Script to benchmark the packing of the tensors saved for backward.")
+    parser.add_argument("--output", type=str, default="", help="Text file where to write the output")
+    parser.add_argument("--num-iters", type=int, default=10)
+    parser.add_argument("--batch-size", type=int, default=256)
+    parser.add_argument("--width", type=int, default=1024)
+    parser.add_argument("--depth", type=int, default=8)
+    parser.add_argument("--directory", type=str, default="",
+                        help="Directory of the files of the 'file' mode, a temporary directory by default")
+    parser.add_argument("--mode-filter", type=str, default="", help="Only run the modes in this filter")
+    args = parser.parse_args()
+
+    results: TimingResultType = defaultdict(defaultdict)
+    model = get_mlp(args.width, args.depth)
+    inp = torch.randn(args.batch_size, args.width)
+
+    with tempfile.TemporaryDirectory(dir=args.directory or None) as directory:
+        for name, hooks_getter in get_modes(directory).items():
+            if args.mode_filter and name not in args.mode_filter:
+                continue
+            runtimes, original_bytes, packed_bytes = run_mode(model, inp, hooks_getter, args.num_iters)
+
+            runtimes = torch.tensor(runtimes)
+            mean, var = runtimes.mean(), runtimes.var()
+            results[name]["step"] = (mean.item(), var.item())
+            print("Results for mode {}: {}ms per step (var: {}), {} saved bytes packed to {}".format(
+                name, mean, var, original_bytes, packed_bytes))
+
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(to_markdown_table(results, header=("mode", "task", "mean (ms per step)", "var")))
+
+
+if __name__ == "__main__":
+    main()
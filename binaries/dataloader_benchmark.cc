@@ -0,0 +1,130 @@
+#include <torch/data/detail/queue.h>
+#include <torch/torch.h>
+
+#include "c10/util/Flags.h"
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+C10_DEFINE_int(epochs, 5, "Number of epochs to load");
+C10_DEFINE_int(examples, 20000, "Number of examples of the dataset");
+C10_DEFINE_int(example_size, 3 * 64 * 64, "Number of floats of an example");
+C10_DEFINE_int(batch_size, 64, "Batch size");
+C10_DEFINE_int(workers, 4, "Number of worker threads of the DataLoader");
+C10_DEFINE_int(max_jobs, 8, "Number of batches prefetched by the DataLoader");
+C10_DEFINE_bool(pin_memory, false, "Stack the batches into pinned memory");
+C10_DEFINE_int(queue_values, 1000000, "Number of values pushed in queues");
+
+namespace {
+
+// Copies an example out of the dataset tensor, like a dataset decoding its
+// examples would allocate them.
+struct CopyDataset : torch::data::datasets::Dataset<CopyDataset> {
+  explicit CopyDataset(torch::Tensor data) : data_(std::move(data)) {}
+
+  torch::data::Example<> get(size_t index) override {
+    return {data_[index].clone(), torch::zeros({1}, torch::kInt64)};
+  }
+
+  torch::optional<size_t> size() const override {
+    return data_.size(0);
+  }
+
+  torch::Tensor data_;
+};
+
+template <typename Collation>
+float runDataLoaderBench(const torch::Tensor& data, Collation collation) {
+  typedef std::chrono::high_resolution_clock clock;
+  typedef std::chrono::microseconds us;
+  auto data_loader = torch::data::make_data_loader(
+      CopyDataset(data).map(std::move(collation)),
+      torch::data::DataLoaderOptions()
+          .batch_size(FLAGS_batch_size)
+          .workers(FLAGS_workers)
+          .max_jobs(FLAGS_max_jobs));
+  std::chrono::time_point<clock> start_time = clock::now();
+  for (auto epoch = 0; epoch < FLAGS_epochs; ++epoch) {
+    for (auto& batch : *data_loader) {
+      // Touches the batch like a training step copying it would
+      batch.data.sum();
+    }
+  }
+  auto duration = static_cast<float>(
+      std::chrono::duration_cast<us>(clock::now() - start_time).count());
+  return duration;
+}
+
+// Pushes values from `FLAGS_workers` threads and pops them from the main
+// thread, like worker threads pass batches to the main thread.
+template <typename Queue>
+float runQueueBench(Queue& queue) {
+  typedef std::chrono::high_resolution_clock clock;
+  typedef std::chrono::microseconds us;
+  const auto values_per_thread = FLAGS_queue_values / FLAGS_workers;
+  std::chrono::time_point<clock> start_time = clock::now();
+  std::vector<std::thread> threads;
+  for (auto w = 0; w < FLAGS_workers; ++w) {
+    threads.emplace_back([&queue, values_per_thread] {
+      for (auto i = 0; i < values_per_thread; ++i) {
+        queue.push(i);
+      }
+    });
+  }
+  int64_t sum = 0;
+  for (auto i = 0; i < values_per_thread * FLAGS_workers; ++i) {
+    sum += queue.pop();
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  auto duration = static_cast<float>(
+      std::chrono::duration_cast<us>(clock::now() - start_time).count());
+  TORCH_CHECK(sum > 0);
+  return duration;
+}
+
+void runBenchmark(const torch::Tensor& data) {
+  using namespace torch::data;
+  float duration = runDataLoaderBench(data, transforms::Stack<Example<>>());
+  std::cout << "DataLoader with Stack (" << FLAGS_epochs
+            << " epochs): " << duration << " us." << std::endl;
+  duration = runDataLoaderBench(
+      data,
+      transforms::BufferedStack<Example<>>(
+          FLAGS_max_jobs + 2, FLAGS_pin_memory));
+  std::cout << "DataLoader with BufferedStack (" << FLAGS_epochs
+            << " epochs): " << duration << " us." << std::endl;
+
+  torch::data::detail::Queue<int64_t> queue;
+  duration = runQueueBench(queue);
+  std::cout << "Queue (" << FLAGS_queue_values << " values): " << duration
+            << " us." << std::endl;
+  // Never full, like the queues of the DataLoader which hold all the jobs in
+  // flight
+  torch::data::detail::LockFreeQueue<int64_t> lock_free_queue(
+      FLAGS_queue_values);
+  duration = runQueueBench(lock_free_queue);
+  std::cout << "LockFreeQueue (" << FLAGS_queue_values
+            << " values): " << duration << " us." << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  if (!c10::ParseCommandLineFlags(&argc, &argv)) {
+    std::cout << "Failed to parse command line flags" << std::endl;
+    return -1;
+  }
+
+  auto data = torch::randn({FLAGS_examples, FLAGS_example_size});
+
+  std::cout << "Warm up" << std::endl;
+  runBenchmark(data);
+
+  std::cout << "Running" << std::endl;
+  runBenchmark(data);
+  return 0;
+}
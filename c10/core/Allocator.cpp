@@ -34,17 +34,30 @@ at::Allocator* GetAllocator(const at::DeviceType& t) {
   return alloc;
 }
 
+// Memory usage is reported to both the profiler, if it profiles memory, and
+// the memory profiler, which can run alongside it.
+static constexpr DebugInfoKind kMemoryReportingKinds[] = {
+    DebugInfoKind::PROFILER_STATE,
+    DebugInfoKind::MEMORY_PROFILER_STATE};
+
 bool memoryProfilingEnabled() {
-  auto* reporter_ptr = static_cast<MemoryReportingInfoBase*>(
-      ThreadLocalDebugInfo::get(DebugInfoKind::PROFILER_STATE));
-  return reporter_ptr && reporter_ptr->memoryProfilingEnabled();
+  for (auto kind : kMemoryReportingKinds) {
+    auto* reporter_ptr =
+        static_cast<MemoryReportingInfoBase*>(ThreadLocalDebugInfo::get(kind));
+    if (reporter_ptr && reporter_ptr->memoryProfilingEnabled()) {
+      return true;
+    }
+  }
+  return false;
 }
 
 void reportMemoryUsageToProfiler(void* ptr, int64_t alloc_size, Device device) {
-  auto* reporter_ptr = static_cast<MemoryReportingInfoBase*>(
-      ThreadLocalDebugInfo::get(DebugInfoKind::PROFILER_STATE));
-  if (reporter_ptr) {
-    reporter_ptr->reportMemoryUsage(ptr, alloc_size, device);
+  for (auto kind : kMemoryReportingKinds) {
+    auto* reporter_ptr =
+        static_cast<MemoryReportingInfoBase*>(ThreadLocalDebugInfo::get(kind));
+    if (reporter_ptr) {
+      reporter_ptr->reportMemoryUsage(ptr, alloc_size, device);
+    }
   }
 }
 
@@ -100,6 +100,9 @@ class TORCH_API PyTorchStreamReader final {
   // return dataptr, size
   std::tuple<at::DataPtr, size_t> getRecord(const std::string& name);
   size_t getRecordOffset(const std::string& name);
+  // CRC-32 of the uncompressed record, as stored in the zip directory. It is
+  // checked against the data when the record is read.
+  uint32_t getRecordCRC32(const std::string& name);
   bool hasRecord(const std::string& name);
   std::vector<std::string> getAllRecords();
 
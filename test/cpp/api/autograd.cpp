@@ -2,7 +2,9 @@
 
 #include <torch/torch.h>
 
+#include <torch/csrc/autograd/engine.h>
 #include <torch/csrc/autograd/functions/basic_ops.h>
+#include <torch/csrc/autograd/saved_variable_hooks.h>
 
 #include <test/cpp/api/support.h>
 
@@ -794,6 +796,225 @@ TEST(CustomAutogradTest, BackwardWithNonLeafInputs) {
   ASSERT_THROWS_WITH(w.backward(torch::ones({5, 5}), false, false, {z}), "is not a leaf Tensor");
 }
 
+// Enables the CPU worker threads of the engine for the lifetime of the guard
+struct CpuWorkerThreadsGuard {
+  explicit CpuWorkerThreadsGuard(int num_threads) {
+    Engine::get_default_engine().set_num_cpu_worker_threads(num_threads);
+  }
+  ~CpuWorkerThreadsGuard() {
+    Engine::get_default_engine().set_num_cpu_worker_threads(0);
+  }
+};
+
+TEST(CustomAutogradTest, ParallelCpuBackward) {
+  // Towers reading the same input, whose gradients are accumulated in an
+  // order-sensitive way given their magnitudes.
+  auto x = torch::randn({64, 64}, torch::requires_grad());
+  std::vector<Variable> weights;
+  for (int i = 0; i < 8; i++) {
+    weights.push_back(torch::randn({64, 64}) * std::pow(10.0, i - 4));
+  }
+  auto run_backward = [&] {
+    x.mutable_grad().reset();
+    Variable loss = torch::zeros({});
+    for (const auto& w : weights) {
+      auto y = x;
+      for (int j = 0; j < 4; j++) {
+        y = torch::tanh(y.mm(w));
+      }
+      loss = loss + y.sum();
+    }
+    loss.backward();
+    return x.grad().clone();
+  };
+
+  auto expected = run_backward();
+  CpuWorkerThreadsGuard guard(4);
+  ASSERT_EQ(Engine::get_default_engine().num_cpu_worker_threads(), 4);
+  auto grad = run_backward();
+  ASSERT_TRUE(torch::allclose(grad, expected));
+  for (int i = 0; i < 5; i++) {
+    ASSERT_TRUE(torch::equal(run_backward(), grad));
+  }
+}
+
+TEST(CustomAutogradTest, ParallelCpuBackwardReentrant) {
+  struct Reenter : public Function<Reenter> {
+    static Variable forward(AutogradContext *ctx, Variable input) {
+      {
+        at::AutoGradMode enable_grad(true);
+        auto x = make_variable(input.tensor_data(), true);
+        ctx->saved_data["x"] = x;
+        ctx->saved_data["output_var"] = x * 2;
+      }
+      return input.clone();
+    }
+
+    static variable_list backward(AutogradContext *ctx, variable_list grad_output) {
+      {
+        at::AutoGradMode enable_grad(true);
+        ctx->saved_data["output_var"].toTensor().sum().backward();
+      }
+      return {ctx->saved_data["x"].toTensor().grad() * grad_output[0]};
+    }
+  };
+
+  struct Fail : public Function<Fail> {
+    static Variable forward(AutogradContext *ctx, Variable input) {
+      return input.clone();
+    }
+
+    static variable_list backward(AutogradContext *ctx, variable_list grad_output) {
+      throw std::runtime_error("Simulate error in backward");
+    }
+  };
+
+  CpuWorkerThreadsGuard guard(4);
+  auto x = torch::randn({4, 4}, torch::requires_grad());
+  Variable loss = torch::zeros({});
+  for (int i = 0; i < 8; i++) {
+    loss = loss + Reenter::apply(x * (i + 1)).sum();
+  }
+  loss.backward();
+  ASSERT_VARIABLE_EQ(x.grad(), torch::full({4, 4}, 72.0));
+
+  // Errors don't leave the worker threads waiting on the finished backward
+  auto y = torch::randn({4, 4}, torch::requires_grad());
+  loss = Fail::apply(y).sum() + Reenter::apply(y).sum();
+  ASSERT_THROWS_WITH(loss.backward(), "Simulate error in backward");
+  x.mutable_grad().reset();
+  (x * 3).sum().backward();
+  ASSERT_VARIABLE_EQ(x.grad(), torch::full({4, 4}, 3.0));
+}
+
+TEST(CustomAutogradTest, SavedVariableHooks) {
+  // Packs a copy of the data, and counts the variables packed and unpacked
+  struct CountingHooks : public SavedVariableHooks {
+    struct Packed : public PackedVariable {
+      Packed(at::Tensor data, int* num_unpacked)
+          : data_(std::move(data)), num_unpacked_(num_unpacked) {}
+      at::Tensor unpack() const override {
+        ++*num_unpacked_;
+        return data_;
+      }
+      at::Tensor data_;
+      int* num_unpacked_;
+    };
+
+    std::unique_ptr<PackedVariable> pack(const at::Tensor& data) override {
+      ++num_packed;
+      return std::make_unique<Packed>(data.clone(), &num_unpacked);
+    }
+
+    int num_packed = 0;
+    int num_unpacked = 0;
+  };
+
+  auto hooks = std::make_shared<CountingHooks>();
+  auto x = torch::randn({5, 5}, torch::requires_grad());
+  Variable loss;
+  {
+    SavedVariableHooksGuard guard(hooks);
+    ASSERT_EQ(SavedVariableHooks::get_current(), hooks);
+    // The leaf x is saved as is, y is packed
+    auto y = x * 2;
+    loss = (x * y).sum();
+    {
+      SavedVariableHooksGuard no_hooks(nullptr);
+      ASSERT_FALSE(SavedVariableHooks::get_current());
+      loss = loss + (y * 3).sum();
+    }
+  }
+  ASSERT_FALSE(SavedVariableHooks::get_current());
+  ASSERT_EQ(hooks->num_packed, 1);
+  loss.backward();
+  ASSERT_EQ(hooks->num_unpacked, 1);
+  ASSERT_VARIABLE_EQ(x.grad(), x * 4 + 6);
+}
+
+// A small MLP with masks, and the gradient of its input
+Variable mlp_input_grad(const Variable& x, const std::vector<Variable>& w) {
+  auto y = x;
+  for (const auto& weight : w) {
+    y = torch::relu(y.mm(weight));
+    y = y.masked_fill(y > 1, 1);
+  }
+  return torch::autograd::grad({y.sum()}, {x})[0];
+}
+
+TEST(CustomAutogradTest, CompressSavedVariableHooks) {
+  using FloatCompression = CompressSavedVariableHooks::FloatCompression;
+  auto x = torch::randn({64, 64}, torch::requires_grad());
+  std::vector<Variable> w;
+  for (int i = 0; i < 3; i++) {
+    w.push_back(torch::randn({64, 64}, torch::requires_grad()) / 8);
+  }
+  auto expected = mlp_input_grad(x, w);
+
+  // Only masks, packed losslessly
+  auto bool_hooks =
+      std::make_shared<CompressSavedVariableHooks>(FloatCompression::None);
+  {
+    SavedVariableHooksGuard guard(bool_hooks);
+    ASSERT_TRUE(torch::equal(mlp_input_grad(x, w), expected));
+  }
+  ASSERT_EQ(bool_hooks->stats().num_packed, 3);
+  ASSERT_EQ(bool_hooks->stats().original_bytes, 3 * 64 * 64);
+  ASSERT_EQ(bool_hooks->stats().packed_bytes, 3 * 64 * 64 / 8);
+
+  for (auto compression :
+       {FloatCompression::BFloat16, FloatCompression::Int8}) {
+    auto hooks = std::make_shared<CompressSavedVariableHooks>(compression);
+    SavedVariableHooksGuard guard(hooks);
+    // Only an approximation, e.g. relu masks values rounded to 0
+    auto error = (mlp_input_grad(x, w) - expected).norm().item<double>();
+    ASSERT_LT(error, 0.25 * expected.norm().item<double>());
+    ASSERT_GT(hooks->stats().num_packed, 3);
+    ASSERT_LT(
+        hooks->stats().packed_bytes * 2, hooks->stats().original_bytes);
+  }
+
+  // Tensors too small are saved as is
+  auto hooks = std::make_shared<CompressSavedVariableHooks>(
+      FloatCompression::BFloat16, true, 64 * 64 + 1);
+  {
+    SavedVariableHooksGuard guard(hooks);
+    ASSERT_TRUE(torch::equal(mlp_input_grad(x, w), expected));
+  }
+  ASSERT_EQ(hooks->stats().num_packed, 0);
+
+  // Empty tensors are saved as is, whatever min_numel is
+  auto int8_hooks = std::make_shared<CompressSavedVariableHooks>(
+      FloatCompression::Int8, true, 0);
+  ASSERT_FALSE(int8_hooks->pack(torch::empty({0, 4})));
+}
+
+TEST(CustomAutogradTest, FileSavedVariableHooks) {
+  auto x = torch::randn({64, 64}, torch::requires_grad());
+  std::vector<Variable> w;
+  for (int i = 0; i < 3; i++) {
+    w.push_back(torch::randn({64, 64}, torch::requires_grad()) / 8);
+  }
+  auto expected = mlp_input_grad(x, w);
+
+  auto hooks = std::make_shared<FileSavedVariableHooks>("/tmp", 1024);
+  {
+    SavedVariableHooksGuard guard(hooks);
+    ASSERT_TRUE(torch::equal(mlp_input_grad(x, w), expected));
+  }
+  ASSERT_GT(hooks->stats().num_packed, 0);
+  ASSERT_EQ(hooks->stats().original_bytes, hooks->stats().packed_bytes);
+
+  // Quantized and sparse tensors are saved as is
+  auto dense = torch::randn({64, 64});
+  ASSERT_FALSE(hooks->pack(
+      at::quantize_per_tensor(dense, 0.1, 0, torch::kQUInt8)));
+  ASSERT_FALSE(hooks->pack(dense.to_sparse()));
+
+  ASSERT_THROWS_WITH(
+      FileSavedVariableHooks("", 1024), "The directory can't be empty");
+}
+
 // TODO add these tests if needed
 // test_once_differentiable
 // test_sparse_backward
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 
+#include <torch/data/detail/queue.h>
 #include <torch/torch.h>
 
 #include <test/cpp/api/support.h>
@@ -7,8 +8,12 @@
 #include <c10/util/ArrayRef.h>
 #include <c10/util/tempfile.h>
 
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <algorithm>
 #include <chrono>
+#include <fstream>
 #include <future>
 #include <iostream>
 #include <iterator>
@@ -450,6 +455,181 @@ TEST(DataTest, TensorDatasetConstructsFromInitializerListOfTensors) {
       torch::tensor({0, 0, 1, 0, 0}, torch::kFloat32).allclose(dataset.get(2)));
 }
 
+TEST(DataTest, ColumnarDatasetReadsWhatColumnarWriterWrote) {
+  using datasets::ColumnarColumn;
+  auto tempfile = c10::make_tempfile();
+  auto images = torch::rand({10, 2, 3});
+  auto labels = torch::arange(10);
+  std::vector<torch::Tensor> tokens;
+  {
+    datasets::ColumnarWriter writer(
+        tempfile.name,
+        {ColumnarColumn("image", torch::kFloat32, {2, 3}),
+         ColumnarColumn("label", torch::kInt64),
+         ColumnarColumn(
+             "tokens", torch::kInt32, {}, /*variable_length=*/true)});
+    for (int64_t i = 0; i < 10; ++i) {
+      tokens.push_back(torch::randint(100, {i % 4}, torch::kInt32));
+      // Non-contiguous tensors are written contiguously
+      writer.write(
+          {images[i].t().contiguous().t(), labels[i], tokens.back()});
+    }
+    writer.finish();
+  }
+
+  datasets::ColumnarDataset dataset(tempfile.name);
+  ASSERT_EQ(dataset.size().value(), 10);
+  ASSERT_EQ(dataset.columns().size(), 3);
+  ASSERT_EQ(dataset.columns()[0].name, "image");
+  ASSERT_EQ(dataset.columns()[0].shape, std::vector<int64_t>({2, 3}));
+  ASSERT_TRUE(dataset.columns()[2].variable_length);
+  for (size_t i = 0; i < 10; ++i) {
+    auto example = dataset.get(i);
+    ASSERT_EQ(example.size(), 3);
+    ASSERT_TRUE(example[0].equal(images[i]));
+    ASSERT_TRUE(example[1].equal(labels[i]));
+    ASSERT_TRUE(example[2].equal(tokens[i]));
+  }
+  ASSERT_TRUE(dataset.column_data(0).equal(images));
+  ASSERT_TRUE(dataset.column_data(2).equal(torch::cat(tokens)));
+
+  // The examples are copies, which can be written to
+  auto copied = dataset.get(0);
+  ASSERT_FALSE(copied[0].storage().is_alias_of(dataset.get(9)[0].storage()));
+  copied[0].div_(255);
+  ASSERT_TRUE(dataset.get(0)[0].equal(images[0]));
+  ASSERT_THROWS_WITH(dataset.get(10), "out of range");
+
+  // Unless the dataset is zero-copy: views of the same mapping of the file
+  datasets::ColumnarDataset zero_copy(tempfile.name, {}, /*zero_copy=*/true);
+  auto first = zero_copy.get(0);
+  auto last = zero_copy.get(9);
+  ASSERT_TRUE(first[0].equal(images[0]));
+  ASSERT_TRUE(first[0].storage().is_alias_of(last[0].storage()));
+  ASSERT_TRUE(first[0].storage().is_alias_of(last[2].storage()));
+
+  // Selected columns are returned in the requested order
+  datasets::ColumnarDataset selected(tempfile.name, {"tokens", "label"});
+  auto example = selected.get(3);
+  ASSERT_EQ(example.size(), 2);
+  ASSERT_TRUE(example[0].equal(tokens[3]));
+  ASSERT_TRUE(example[1].equal(labels[3]));
+  ASSERT_THROWS_WITH(
+      datasets::ColumnarDataset(tempfile.name, {"text"}),
+      "No column named text");
+}
+
+TEST(DataTest, ColumnarWriterChecksTheExamples) {
+  auto tempfile = c10::make_tempfile();
+  datasets::ColumnarWriter writer(
+      tempfile.name,
+      {datasets::ColumnarColumn("image", torch::kFloat32, {2, 3})});
+  ASSERT_THROWS_WITH(
+      writer.write({torch::rand({2, 3}), torch::rand({2, 3})}),
+      "Expected an example of 1 tensors");
+  ASSERT_THROWS_WITH(
+      writer.write({torch::rand({3, 2})}),
+      "Expected a tensor of shape [2, 3] for the column image");
+  ASSERT_THROWS_WITH(
+      writer.write({torch::zeros({2, 3}, torch::kInt64)}),
+      "Expected a CPU tensor of type Float");
+  writer.finish();
+  ASSERT_THROWS_WITH(
+      writer.write({torch::rand({2, 3})}), "Cannot write to a finished");
+
+  datasets::ColumnarDataset dataset(tempfile.name);
+  ASSERT_EQ(dataset.size().value(), 0);
+
+  // The temporary files are removed if opening one of them fails
+  auto failing = c10::make_tempfile();
+  const auto blocked = failing.name + ".column1.data.tmp";
+  ASSERT_EQ(mkdir(blocked.c_str(), 0700), 0);
+  ASSERT_THROWS_WITH(
+      datasets::ColumnarWriter(
+          failing.name,
+          {datasets::ColumnarColumn("a", torch::kFloat32),
+           datasets::ColumnarColumn("b", torch::kFloat32)}),
+      "Error opening the temporary file");
+  ASSERT_FALSE(std::ifstream(failing.name + ".column0.data.tmp"));
+  rmdir(blocked.c_str());
+
+  auto not_columnar = c10::make_tempfile();
+  std::ofstream(not_columnar.name) << "not a columnar dataset";
+  ASSERT_THROWS_WITH(
+      datasets::ColumnarDataset(not_columnar.name),
+      "is not a columnar dataset file");
+}
+
+TEST(DataTest, ColumnarDatasetChecksTheShapesOfTheColumns) {
+  auto tempfile = c10::make_tempfile();
+  {
+    datasets::ColumnarWriter writer(
+        tempfile.name,
+        {datasets::ColumnarColumn("image", torch::kFloat32, {2, 3})});
+    writer.write({torch::rand({2, 3})});
+    writer.finish();
+  }
+  // The first dimension of the shape follows the magic, the version, the
+  // number of columns and of examples, the name, its length and the type.
+  const auto write_first_dim = [&](int64_t dim) {
+    std::fstream file(
+        tempfile.name, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(8 + 4 + 4 + 8 + 4 + 5 + 1 + 1 + 4);
+    file.write(reinterpret_cast<const char*>(&dim), sizeof(dim));
+  };
+
+  write_first_dim(-1);
+  ASSERT_THROWS_WITH(
+      datasets::ColumnarDataset(tempfile.name), "has an invalid shape");
+  // numel times the size of a float overflows to 0
+  write_first_dim(int64_t(1) << 61);
+  ASSERT_THROWS_WITH(
+      datasets::ColumnarDataset(tempfile.name), "out of the bounds");
+  write_first_dim(2);
+  ASSERT_EQ(datasets::ColumnarDataset(tempfile.name).size().value(), 1);
+}
+
+TEST(DataLoaderTest, StacksTheColumnsOfAColumnarDataset) {
+  auto tempfile = c10::make_tempfile();
+  auto images = torch::rand({10, 2, 3});
+  auto labels = torch::arange(10);
+  {
+    datasets::ColumnarWriter writer(
+        tempfile.name,
+        {datasets::ColumnarColumn("image", torch::kFloat32, {2, 3}),
+         datasets::ColumnarColumn("label", torch::kInt64),
+         datasets::ColumnarColumn(
+             "tokens", torch::kInt32, {}, /*variable_length=*/true)});
+    for (int64_t i = 0; i < 10; ++i) {
+      writer.write(
+          {images[i], labels[i], torch::zeros({i % 4}, torch::kInt32)});
+    }
+    writer.finish();
+  }
+
+  auto data_loader =
+      torch::data::make_data_loader<torch::data::samplers::SequentialSampler>(
+          datasets::ColumnarDataset(tempfile.name, {"label", "image"})
+              .map(transforms::Stack<std::vector<torch::Tensor>>()),
+          DataLoaderOptions().batch_size(4).workers(2));
+  int64_t start = 0;
+  for (auto& batch : *data_loader) {
+    ASSERT_EQ(batch.size(), 2);
+    const auto length = std::min<int64_t>(4, 10 - start);
+    ASSERT_TRUE(batch[0].equal(labels.narrow(0, start, length)));
+    ASSERT_TRUE(batch[1].equal(images.narrow(0, start, length)));
+    start += length;
+  }
+  ASSERT_EQ(start, 10);
+
+  // Variable-length columns can't be stacked
+  auto stack = transforms::Stack<std::vector<torch::Tensor>>();
+  datasets::ColumnarDataset tokens(tempfile.name, {"tokens"});
+  ASSERT_THROWS_WITH(
+      stack.apply_batch({tokens.get(1), tokens.get(2)}),
+      "stack expects each tensor to be equal size");
+}
+
 TEST(DataTest, StackTransformWorksForExample) {
   struct D : public datasets::Dataset<D> {
     Example<> get(size_t index) override {
@@ -485,6 +665,58 @@ TEST(DataTest, StackTransformWorksForTensorExample) {
   ASSERT_TRUE(second.data.allclose(torch::eye(4).slice(/*dim=*/0, 2, 4)));
 }
 
+TEST(DataTest, BufferedStackTransformWorksForExample) {
+  auto tensor = torch::arange(8, torch::kFloat32).view({4, 2});
+  auto d = datasets::TensorDataset(tensor).map(
+      transforms::Lambda<TensorExample, Example<>>([](TensorExample e) {
+        return Example<>{e.data, 1 + e.data};
+      }));
+  auto stacked = d.map(transforms::BufferedStack<Example<>>(2));
+
+  Example<> batch = stacked.get_batch({0, 1});
+  ASSERT_TRUE(batch.data.allclose(tensor.slice(/*dim=*/0, 0, 2)));
+  ASSERT_TRUE(batch.target.allclose(1 + tensor.slice(/*dim=*/0, 0, 2)));
+
+  Example<> second = stacked.get_batch({2, 3});
+  ASSERT_TRUE(second.data.allclose(tensor.slice(/*dim=*/0, 2, 4)));
+  ASSERT_TRUE(second.target.allclose(1 + tensor.slice(/*dim=*/0, 2, 4)));
+  // Both batches are alive, so they are in different buffers
+  ASSERT_TRUE(batch.data.allclose(tensor.slice(/*dim=*/0, 0, 2)));
+}
+
+TEST(DataTest, BufferedStackTransformReusesBuffers) {
+  auto tensor = torch::arange(16, torch::kFloat32).view({8, 2});
+  transforms::BufferedStack<TensorExample> stack(/*num_buffers=*/2);
+  auto d = datasets::TensorDataset(tensor).map(stack);
+
+  // Batches destroyed before the next one is stacked reuse the buffers
+  for (size_t i = 0; i < 4; ++i) {
+    TensorExample batch = d.get_batch({2 * i, 2 * i + 1});
+    ASSERT_TRUE(
+        batch.data.allclose(tensor.slice(/*dim=*/0, 2 * i, 2 * i + 2)));
+  }
+  ASSERT_EQ(stack.num_allocations(), 2);
+
+  // A smaller batch is stacked into the first rows of a buffer
+  {
+    TensorExample last = d.get_batch({7});
+    ASSERT_EQ(last.data.size(0), 1);
+    ASSERT_TRUE(last.data.allclose(tensor.slice(/*dim=*/0, 7, 8)));
+    ASSERT_EQ(stack.num_allocations(), 2);
+  }
+
+  // Batches kept alive use the buffers, then new tensors
+  std::vector<TensorExample> batches;
+  for (size_t i = 0; i < 3; ++i) {
+    batches.push_back(d.get_batch({2 * i, 2 * i + 1}));
+  }
+  ASSERT_EQ(stack.num_allocations(), 3);
+  for (size_t i = 0; i < 3; ++i) {
+    ASSERT_TRUE(batches[i].data.allclose(
+        tensor.slice(/*dim=*/0, 2 * i, 2 * i + 2)));
+  }
+}
+
 // Template classes cannot be nested in functions.
 template <typename Target>
 struct T : transforms::TensorTransform<Target> {
@@ -688,6 +920,90 @@ TEST(DataTest, QueueClearEmptiesTheQueue) {
   ASSERT_THROWS_WITH(queue.pop(1 * kMillisecond), "Timeout");
 }
 
+TEST(DataTest, LockFreeQueuePushAndPopFromSameThread) {
+  torch::data::detail::LockFreeQueue<int> queue(4);
+  queue.push(1);
+  queue.push(2);
+  ASSERT_EQ(queue.pop(), 1);
+  ASSERT_EQ(queue.pop(), 2);
+}
+
+TEST(DataTest, LockFreeQueuePopWithTimeoutThrowsUponTimeout) {
+  torch::data::detail::LockFreeQueue<int> queue(4);
+  ASSERT_THROWS_WITH(
+      queue.pop(10 * kMillisecond),
+      "Timeout in DataLoader queue while waiting for next batch "
+      "(timeout was 10 ms)");
+}
+
+TEST(DataTest, LockFreeQueuePushAndPopFromDifferentThreads) {
+  using torch::data::detail::LockFreeQueue;
+
+  // Attempt to pop (and block), then push.
+  {
+    LockFreeQueue<int> queue(4);
+    std::thread thread([&queue] {
+      std::this_thread::sleep_for(20 * kMillisecond);
+      queue.push(123);
+    });
+    ASSERT_EQ(queue.pop(), 123);
+    thread.join();
+  }
+
+  // Attempt to push into a full queue (and block), then pop.
+  {
+    LockFreeQueue<int> queue(2);
+    ASSERT_EQ(queue.capacity(), 2);
+    queue.push(1);
+    queue.push(2);
+    std::thread thread([&queue] { queue.push(3); });
+    std::this_thread::sleep_for(20 * kMillisecond);
+    ASSERT_EQ(queue.pop(), 1);
+    thread.join();
+    ASSERT_EQ(queue.pop(), 2);
+    ASSERT_EQ(queue.pop(), 3);
+  }
+}
+
+TEST(DataTest, LockFreeQueueWorksWithManyProducersAndConsumers) {
+  constexpr int kNumThreads = 4;
+  constexpr int kNumValues = 10000;
+  torch::data::detail::LockFreeQueue<int> queue(8);
+  std::vector<std::thread> producers;
+  std::vector<std::future<int64_t>> sums;
+  for (int t = 0; t < kNumThreads; ++t) {
+    producers.emplace_back([&queue] {
+      for (int v = 1; v <= kNumValues; ++v) {
+        queue.push(v);
+      }
+    });
+    sums.push_back(std::async(std::launch::async, [&queue] {
+      int64_t sum = 0;
+      for (int v = 0; v < kNumValues; ++v) {
+        sum += queue.pop();
+      }
+      return sum;
+    }));
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  int64_t sum = 0;
+  for (auto& thread_sum : sums) {
+    sum += thread_sum.get();
+  }
+  ASSERT_EQ(sum, int64_t(kNumThreads) * kNumValues * (kNumValues + 1) / 2);
+}
+
+TEST(DataTest, LockFreeQueueClearEmptiesTheQueue) {
+  torch::data::detail::LockFreeQueue<int> queue(4);
+  queue.push(1);
+  queue.push(2);
+  queue.push(3);
+  ASSERT_EQ(queue.clear(), 3);
+  ASSERT_THROWS_WITH(queue.pop(1 * kMillisecond), "Timeout");
+}
+
 TEST(DataTest, DataShuttleCanPushAndPopJob) {
   torch::data::detail::DataShuttle<int, int> shuttle;
   shuttle.push_job(1);
@@ -1284,6 +1600,35 @@ TEST(DataLoaderTest, RespectsTimeout) {
   ASSERT_LT(duration.count(), 1);
 }
 
+TEST(DataLoaderTest, WorksWithBufferedStackAndWorkerThreads) {
+  const int64_t kNumExamples = 100;
+  auto tensor = torch::arange(kNumExamples * 3).view({kNumExamples, 3});
+  const auto options = DataLoaderOptions().batch_size(8).workers(2);
+  // The prefetched batches, and the one being used
+  const size_t num_buffers = 2 * options.workers() + 2;
+  transforms::BufferedStack<TensorExample> stack(num_buffers);
+  auto data_loader = torch::data::make_data_loader(
+      datasets::TensorDataset(tensor).map(stack), options);
+
+  for (size_t epoch = 0; epoch < 2; ++epoch) {
+    std::vector<int64_t> rows;
+    for (auto& batch : *data_loader) {
+      ASSERT_LE(batch.data.size(0), 8);
+      for (int64_t i = 0; i < batch.data.size(0); ++i) {
+        auto row = batch.data[i];
+        auto first = row[0].item<int64_t>();
+        ASSERT_TRUE(row.equal(torch::arange(first, first + 3)));
+        rows.push_back(first / 3);
+      }
+    }
+    std::sort(rows.begin(), rows.end());
+    std::vector<int64_t> expected(kNumExamples);
+    std::iota(expected.begin(), expected.end(), 0);
+    ASSERT_EQ(rows, expected);
+  }
+  ASSERT_LE(stack.num_allocations(), num_buffers);
+}
+
 // stackoverflow.com/questions/24465533/implementing-boostbarrier-in-c11
 struct Barrier {
   explicit Barrier(size_t target) : counter_(target) {}
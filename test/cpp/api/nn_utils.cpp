@@ -615,3 +615,148 @@ TEST_F(NNUtilsTest, PadSequence) {
     ASSERT_TRUE(padded.allclose(expected.transpose(0, 1)));
   }
 }
+
+TEST_F(NNUtilsTest, Checkpoint) {
+  auto linear = Linear(8, 8);
+  auto dropout = Dropout(0.5);
+  auto x = torch::randn({4, 8}, torch::requires_grad());
+  auto function = [&](const torch::Tensor& input) {
+    return dropout(torch::relu(linear(input))).sum(1);
+  };
+  auto run_backward = [&](bool checkpoint) {
+    linear->zero_grad();
+    x.mutable_grad().reset();
+    torch::manual_seed(0);
+    auto output = checkpoint ? utils::checkpoint(function, x) : function(x);
+    output.sum().backward();
+    return std::make_pair(x.grad().clone(), linear->weight.grad().clone());
+  };
+
+  auto expected = run_backward(false);
+  auto grads = run_backward(true);
+  // The recompute of the dropout draws the same mask
+  ASSERT_TRUE(grads.first.allclose(expected.first));
+  ASSERT_TRUE(grads.second.allclose(expected.second));
+
+  {
+    torch::NoGradGuard no_grad;
+    ASSERT_FALSE(utils::checkpoint(function, x).requires_grad());
+  }
+}
+
+// A Sequential of blocks of three modules, the middle one saving a mask
+Sequential make_checkpoint_model() {
+  Sequential model;
+  for (int i = 0; i < 4; i++) {
+    model->push_back(Linear(16, 16));
+    model->push_back(ReLU());
+    model->push_back(Dropout(0.2));
+  }
+  return model;
+}
+
+TEST_F(NNUtilsTest, CheckpointSequential) {
+  auto model = make_checkpoint_model();
+  auto x = torch::randn({8, 16});
+  auto run_backward = [&](std::function<torch::Tensor()> forward) {
+    model->zero_grad();
+    torch::manual_seed(0);
+    forward().sum().backward();
+    std::vector<torch::Tensor> grads;
+    for (const auto& parameter : model->parameters()) {
+      grads.push_back(parameter.grad().clone());
+    }
+    return grads;
+  };
+  auto check_grads = [](
+      const std::vector<torch::Tensor>& grads,
+      const std::vector<torch::Tensor>& expected) {
+    ASSERT_EQ(grads.size(), expected.size());
+    for (size_t i = 0; i < grads.size(); i++) {
+      ASSERT_TRUE(grads[i].allclose(expected[i]));
+    }
+  };
+
+  auto expected = run_backward([&] { return model->forward(x); });
+  // The input doesn't require grad, the first module still gets gradients
+  check_grads(
+      run_backward([&] { return utils::checkpoint_sequential(model, 3, x); }),
+      expected);
+
+  utils::CheckpointPlan plan;
+  plan.segments = {{0, 2}, {5, 9}, {11, 12}};
+  check_grads(
+      run_backward(
+          [&] { return utils::checkpoint_sequential(model, plan, x); }),
+      expected);
+
+  plan.segments = {{5, 9}, {0, 2}};
+  ASSERT_THROWS_WITH(
+      utils::checkpoint_sequential(model, plan, x),
+      "Invalid checkpoint segment [0, 2)");
+  ASSERT_THROWS_WITH(
+      utils::checkpoint_sequential(model, 13, x),
+      "The number of segments must be between 1 and the number of modules");
+}
+
+TEST_F(NNUtilsTest, PlanCheckpoint) {
+  // Eight modules saving 100 bytes each, and outputting 10 bytes
+  std::vector<utils::SequentialModuleProfile> profiles(8);
+  for (auto& profile : profiles) {
+    profile.saved_bytes = 100;
+    profile.output_bytes = 10;
+    profile.forward_seconds = 1;
+  }
+
+  auto plan = utils::plan_checkpoint(profiles, 10, 800);
+  ASSERT_TRUE(plan.segments.empty());
+  ASSERT_EQ(plan.estimated_bytes, 800);
+  ASSERT_EQ(plan.recompute_seconds, 0);
+
+  plan = utils::plan_checkpoint(profiles, 10, 400);
+  ASSERT_FALSE(plan.segments.empty());
+  ASSERT_LE(plan.estimated_bytes, 400);
+  ASSERT_GT(plan.recompute_seconds, 0);
+  ASSERT_LT(plan.recompute_seconds, 8);
+  size_t next = 0;
+  double recompute_seconds = 0;
+  for (const auto& segment : plan.segments) {
+    ASSERT_GE(segment.first, next);
+    ASSERT_LT(segment.first, segment.second);
+    recompute_seconds += segment.second - segment.first;
+    next = segment.second;
+  }
+  ASSERT_LE(next, profiles.size());
+  ASSERT_EQ(plan.recompute_seconds, recompute_seconds);
+
+  {
+    torch::test::WarningCapture warnings;
+    plan = utils::plan_checkpoint(profiles, 10, 1);
+    ASSERT_EQ(
+        torch::test::count_substr_occurrences(
+            warnings.str(), "No checkpoint plan fits"),
+        1);
+  }
+  ASSERT_GT(plan.estimated_bytes, 1);
+  ASSERT_LT(plan.estimated_bytes, 400);
+
+  // A plan for an actual model, which gives the same gradients
+  auto model = make_checkpoint_model();
+  auto x = torch::randn({8, 16});
+  auto measured = utils::profile_sequential(model, x);
+  ASSERT_EQ(measured.size(), model->size());
+  int64_t total_bytes = 0;
+  for (const auto& profile : measured) {
+    ASSERT_EQ(profile.output_bytes, 8 * 16 * 4);
+    total_bytes += profile.saved_bytes;
+  }
+  ASSERT_GT(total_bytes, 0);
+  plan = utils::plan_checkpoint(model, x, total_bytes * 3 / 4);
+  ASSERT_FALSE(plan.segments.empty());
+  ASSERT_LE(plan.estimated_bytes, total_bytes * 3 / 4);
+  torch::manual_seed(0);
+  utils::checkpoint_sequential(model, plan, x).sum().backward();
+  for (const auto& parameter : model->parameters()) {
+    ASSERT_TRUE(parameter.grad().defined());
+  }
+}
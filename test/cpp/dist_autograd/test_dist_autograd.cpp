@@ -104,6 +104,36 @@ TEST_F(DistAutogradTest, TestInitializedContextCleanupSendFunction) {
   ASSERT_EQ(0, engine.numBackwardPasses());
 }
 
+TEST_F(DistAutogradTest, TestAccumulateGradsAcrossShards) {
+  autogradContainer_->newContext();
+  auto context = autogradContainer_->currentContext();
+
+  // Enough variables to spread their gradients over all shards.
+  auto options = at::TensorOptions().requires_grad(true);
+  std::vector<torch::Tensor> params;
+  auto loss = torch::zeros({1});
+  for (int i = 0; i < 64; i++) {
+    params.push_back(torch::ones({1}, options));
+    loss = loss + params.back() * i;
+  }
+
+  DistEngine::getInstance().execute(
+      context->contextId(), {loss}, /* retainGraph */ false);
+
+  auto grads = context->getGradients();
+  ASSERT_EQ(params.size(), grads.size());
+  for (size_t i = 0; i < params.size(); i++) {
+    ASSERT_TRUE(grads.at(params[i]).equal(torch::full({1}, (float)i)));
+  }
+
+  context->runGradCallbackForVariable(params[3], [](torch::Tensor& grad) {
+    grad = grad * 2;
+    return true;
+  });
+  ASSERT_TRUE(
+      context->getGradients().at(params[3]).equal(torch::full({1}, 6.0f)));
+}
+
 } // namespace autograd
 } // namespace distributed
 } // namespace torch
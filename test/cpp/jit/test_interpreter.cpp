@@ -2,6 +2,7 @@
 
 #include <ATen/Parallel.h>
 #include "test/cpp/jit/test_utils.h"
+#include "torch/csrc/jit/runtime/instruction.h"
 #include "torch/jit.h"
 #include "torch/script.h"
 #include "torch/torch.h"
@@ -178,5 +179,54 @@ TEST(InterpreterTest, runAsyncBasicTest) {
   interp.runAsync(stack)->wait();
   ASSERT_TRUE(asyncCounter > 0);
 }
+
+TEST(InterpreterTest, Superinstructions) {
+  auto graph = std::make_shared<Graph>();
+  parseIR(
+      R"IR(
+graph(%a : Tensor,
+      %b : Tensor):
+  %alpha : int = prim::Constant[value=1]()
+  %c : Tensor = aten::add(%a, %b, %alpha)
+  %d : Tensor = aten::mul(%c, %c)
+  %e : Tensor = aten::relu(%d)
+  %f : Tensor = aten::sub(%e, %c, %alpha)
+  return (%f)
+  )IR",
+      &*graph);
+  auto a = at::randn({2, 3});
+  auto b = at::randn({2, 3});
+
+  auto runWithSuperinstructions = [&](bool enabled) {
+    bool prev = FLAGS_torch_jit_enable_superinstructions;
+    FLAGS_torch_jit_enable_superinstructions = enabled;
+    Code code(graph, "");
+    FLAGS_torch_jit_enable_superinstructions = prev;
+
+    bool fused = false;
+    for (const Instruction& inst : code.instructions()) {
+      fused |= unfusedOpCode(inst.op) != inst.op;
+    }
+    EXPECT_EQ(fused, enabled);
+
+    // fused instructions keep the source annotation of the node they run
+    std::stringstream dump;
+    dump << code;
+    std::string line;
+    while (std::getline(dump, line)) {
+      if (line.find("OP_STORE") != std::string::npos) {
+        EXPECT_NE(line.find(" # "), std::string::npos) << line;
+      }
+    }
+
+    InterpreterState interp(code);
+    return run(interp, {a, b})[0];
+  };
+
+  auto expected = runWithSuperinstructions(false);
+  ASSERT_TRUE(exactlyEqual(runWithSuperinstructions(true), expected));
+  ASSERT_TRUE(exactlyEqual(expected, at::relu((a + b) * (a + b)) - (a + b)));
+}
+
 } // namespace jit
 } // namespace torch
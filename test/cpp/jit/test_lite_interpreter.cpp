@@ -2,8 +2,11 @@
 
 #include <c10/core/TensorOptions.h>
 #include <torch/csrc/autograd/generated/variable_factories.h>
+#include <caffe2/serialize/inline_container.h>
 #include <torch/csrc/jit/api/module.h>
+#include <torch/csrc/jit/mobile/function.h>
 #include <torch/csrc/jit/mobile/import.h>
+#include <torch/csrc/jit/mobile/interpreter.h>
 #include <torch/csrc/jit/mobile/module.h>
 #include <torch/csrc/jit/serialization/export.h>
 #include <torch/csrc/jit/serialization/import.h>
@@ -289,6 +292,114 @@ TEST(LiteInterpreterTest, WrongMethodName) {
   ASSERT_THROWS_WITH(bc.get_method("forward")(inputs), "is not defined");
 }
 
+TEST(LiteInterpreterTest, AppendOperators) {
+  mobile::Function function(c10::QualifiedName("test.forward"));
+  auto unsupported = function.append_operators(
+      {c10::OperatorName("aten::add", "Tensor"),
+       c10::OperatorName("aten::this_op_does_not_exist", ""),
+       c10::OperatorName("aten::mul", "Tensor")},
+      caffe2::serialize::kProducedBytecodeVersion);
+  ASSERT_EQ(unsupported.size(), 1);
+  EXPECT_EQ(unsupported[0].name, "aten::this_op_does_not_exist");
+  ASSERT_EQ(function.get_code()->operators_.size(), 2);
+
+  // Operators are interned across functions, resolving them again must give
+  // working operators as well.
+  mobile::Function other(c10::QualifiedName("test.other"));
+  ASSERT_TRUE(other
+                  .append_operators(
+                      {c10::OperatorName("aten::add", "Tensor")},
+                      caffe2::serialize::kProducedBytecodeVersion)
+                  .empty());
+  Stack stack{torch::ones({2}), torch::ones({2}), 1};
+  other.get_code()->operators_[0](stack);
+  ASSERT_EQ(stack.size(), 1);
+  ASSERT_TRUE(stack[0].toTensor().equal(2 * torch::ones({2})));
+}
+
+TEST(LiteInterpreterTest, MemoryPlanning) {
+  Module m("m");
+  m.define(R"(
+    def forward(self, x, y):
+      a = x + y
+      b = a * y
+      c = b - x
+      d = c * y
+      return d + x
+  )");
+  std::stringstream ss;
+  m._save_for_mobile(ss);
+  mobile::Module bc = _load_for_mobile(ss);
+
+  bool prev = FLAGS_torch_jit_mobile_memory_planning;
+  FLAGS_torch_jit_mobile_memory_planning = true;
+  // The first run keeps the activations, later runs write them into the
+  // arena. Changing shapes and dtypes exercises re-planning and the fallback
+  // to the functional ops.
+  std::vector<std::vector<IValue>> all_inputs = {
+      {torch::rand({2, 3}), torch::rand({2, 3})},
+      {torch::rand({2, 3}), torch::rand({2, 3})},
+      {torch::rand({8, 5}), torch::rand({8, 5})},
+      {torch::ones({4}, at::kLong), torch::ones({4}, at::kLong)},
+      {torch::rand({2, 3}), torch::rand({2, 3})}};
+  for (const auto& inputs : all_inputs) {
+    auto ref = m.forward(inputs).toTensor();
+    auto res = bc.forward(inputs).toTensor();
+    ASSERT_EQ(res.scalar_type(), ref.scalar_type());
+    ASSERT_TRUE(res.equal(ref));
+  }
+  // A failed run leaves the planner of the next run working.
+  ASSERT_ANY_THROW(bc.forward({torch::rand({2, 3}), torch::rand({4})}));
+  for (int i = 0; i < 2; ++i) {
+    auto inputs = all_inputs.back();
+    auto ref = m.forward(inputs).toTensor();
+    ASSERT_TRUE(bc.forward(inputs).toTensor().equal(ref));
+  }
+  FLAGS_torch_jit_mobile_memory_planning = prev;
+
+  auto code = bc.get_method("forward").function().get_code();
+  ASSERT_TRUE(code->memory_plan_);
+  // a, b, c and d are managed, the returned tensor is not.
+  EXPECT_EQ(code->memory_plan_->managed().size(), 4);
+}
+
+TEST(LiteInterpreterTest, AppendOperatorsAfterDeregistration) {
+  const c10::OperatorName name("_test::mobile_op", "");
+  auto resolve = [&](mobile::Function& function) {
+    return function
+        .append_operators({name}, caffe2::serialize::kProducedBytecodeVersion)
+        .empty();
+  };
+  auto call = [](mobile::Function& function) {
+    Stack stack{torch::ones({2})};
+    function.get_code()->operators_[0](stack);
+    return stack[0].toTensor();
+  };
+
+  {
+    auto ops = torch::RegisterOperators().op(
+        "_test::mobile_op(Tensor a) -> Tensor",
+        torch::RegisterOperators::options().catchAllKernel(
+            [](at::Tensor a) { return a + 1; }));
+    mobile::Function function(c10::QualifiedName("test.first"));
+    ASSERT_TRUE(resolve(function));
+    ASSERT_TRUE(call(function).equal(2 * torch::ones({2})));
+  }
+
+  // The operator is gone, it must not be resolved from the cache.
+  mobile::Function missing(c10::QualifiedName("test.missing"));
+  ASSERT_FALSE(resolve(missing));
+
+  // Registered again with another kernel, the new kernel is resolved.
+  auto ops = torch::RegisterOperators().op(
+      "_test::mobile_op(Tensor a) -> Tensor",
+      torch::RegisterOperators::options().catchAllKernel(
+          [](at::Tensor a) { return a + 2; }));
+  mobile::Function function(c10::QualifiedName("test.second"));
+  ASSERT_TRUE(resolve(function));
+  ASSERT_TRUE(call(function).equal(3 * torch::ones({2})));
+}
+
 TEST(LiteInterpreterTest, SetState) {
   Module m("m");
   m.register_parameter("foo", torch::ones({}), false);
@@ -55,20 +55,31 @@
 
 #include <c10/util/Exception.h>
 #include <c10/util/ThreadLocalDebugInfo.h>
+#include <c10/util/tempfile.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <fstream>
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <numeric>
 #include <set>
 #include <stdexcept>
 #include <string>
 #include <tuple>
+#include <thread>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+#ifdef __linux__
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
 using namespace torch::autograd::profiler;
 
 namespace torch {
@@ -2301,6 +2312,314 @@ TEST(ProfilerDisableInCallbackTest, Basic) {
   torch::autograd::profiler::disableProfilerLegacy(std::move(opts));
 }
 
+TEST(ProfilerThreadEventListsTest, Basic) {
+  // More ranges than fit in a chunk of an event list, recorded by several
+  // threads at once
+  constexpr int kNumThreads = 4;
+  constexpr int kNumRanges = 1500;
+  enableProfilerLegacy(ProfilerConfig(ProfilerState::CPU, false, false));
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; i++) {
+    threads.emplace_back(wrapPropagateTLSState<void>([] {
+      for (int j = 0; j < kNumRanges; j++) {
+        RECORD_USER_SCOPE("thread_range");
+      }
+    }));
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  {
+    RECORD_USER_SCOPE("sleep_range");
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  // A range ending on another thread than the one it started on
+  auto async_range =
+      std::make_unique<at::RecordFunction>(at::RecordScope::USER_SCOPE);
+  ASSERT_TRUE(async_range->isActive());
+  async_range->before("async_range");
+  std::thread(wrapPropagateTLSState<void>([&async_range] {
+    async_range->end();
+  })).join();
+  auto event_lists = disableProfilerLegacy();
+
+  int num_thread_ranges = 0;
+  std::unordered_map<at::RecordFunctionHandle, const LegacyEvent*> pushes;
+  std::unordered_map<std::string, double> durations;
+  for (const auto& events : event_lists) {
+    double last_push_us = 0;
+    for (const auto& event : events) {
+      if (event.kindStr() == "push") {
+        // Events are recorded in order, and timed consistently
+        ASSERT_GE(event.cpuUs(), last_push_us);
+        last_push_us = event.cpuUs();
+        pushes[event.handle()] = &event;
+        num_thread_ranges += strcmp(event.name(), "thread_range") == 0;
+      } else if (event.kindStr() == "pop") {
+        auto it = pushes.find(event.handle());
+        ASSERT_NE(it, pushes.end());
+        durations[it->second->name()] = it->second->cpuElapsedUs(event);
+      }
+    }
+  }
+  ASSERT_EQ(num_thread_ranges, kNumThreads * kNumRanges);
+  ASSERT_EQ(durations.count("async_range"), 1);
+  ASSERT_GE(durations.at("async_range"), 0);
+  ASSERT_GE(durations.at("sleep_range"), 9000);
+  ASSERT_LT(durations.at("sleep_range"), 1000000);
+}
+
+#ifdef __linux__
+// The number of perf_event_open file descriptors of the process.
+static int numPerfEventFds() {
+  int num_fds = 0;
+  DIR* dir = opendir("/proc/self/fd");
+  if (!dir) {
+    return 0;
+  }
+  while (auto* entry = readdir(dir)) {
+    const auto path = std::string("/proc/self/fd/") + entry->d_name;
+    char target[64];
+    const auto len = readlink(path.c_str(), target, sizeof(target) - 1);
+    if (len > 0 && std::string(target, len) == "anon_inode:[perf_event]") {
+      ++num_fds;
+    }
+  }
+  closedir(dir);
+  return num_fds;
+}
+#endif
+
+TEST(ProfilerPerfCountersTest, Basic) {
+  ASSERT_ANY_THROW(checkPerfEvents({"not_a_perf_event"}));
+  const std::vector<std::string> perf_events = {"task_clock"};
+#ifdef __linux__
+  const int num_fds = numPerfEventFds();
+#endif
+  try {
+    checkPerfEvents(perf_events);
+  } catch (const c10::Error&) {
+    // perf_event_open isn't available, e.g. not on Linux or in a sandbox
+    return;
+  }
+  enableProfilerLegacy(ProfilerConfig(
+      ProfilerState::CPU, false, false, false, false, perf_events));
+  {
+    RECORD_USER_SCOPE("busy_range");
+    auto start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - start <
+           std::chrono::milliseconds(10)) {
+    }
+  }
+  auto event_lists = disableProfilerLegacy();
+#ifdef __linux__
+  // Disabling the profiler closes the counters it opened
+  ASSERT_EQ(numPerfEventFds(), num_fds);
+#endif
+
+  const LegacyEvent* push = nullptr;
+  const LegacyEvent* pop = nullptr;
+  for (const auto& events : event_lists) {
+    for (const auto& event : events) {
+      if (strcmp(event.name(), "busy_range") != 0) {
+        continue;
+      }
+      if (event.kindStr() == "push") {
+        push = &event;
+      } else if (event.kindStr() == "pop") {
+        pop = &event;
+      }
+    }
+  }
+  ASSERT_NE(push, nullptr);
+  ASSERT_NE(pop, nullptr);
+  ASSERT_EQ(push->perfCounters().size(), 1);
+  ASSERT_EQ(pop->perfCounters().size(), 1);
+  // The task clock counts the nanoseconds the thread ran for
+  const auto task_clock_ns = pop->perfCounters()[0] - push->perfCounters()[0];
+  ASSERT_GE(task_clock_ns, 5000000);
+  ASSERT_LT(task_clock_ns, 1000000000);
+}
+
+TEST(SamplingProfilerTest, Basic) {
+  constexpr int kNumThreads = 2;
+  constexpr int kNumIters = 100;
+  std::vector<SampledOpStats> flushed;
+  SamplingProfilerConfig config;
+  config.sampling_prob = 1.0;
+  config.record_shapes = true;
+  config.flush_interval = std::chrono::milliseconds(0);
+  config.callback = [&flushed](const std::vector<SampledOpStats>& stats) {
+    flushed.insert(flushed.end(), stats.begin(), stats.end());
+  };
+  enableSamplingProfiler(std::move(config));
+  ASSERT_TRUE(samplingProfilerEnabled());
+  ASSERT_ANY_THROW(enableSamplingProfiler(SamplingProfilerConfig()));
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; i++) {
+    threads.emplace_back([] {
+      auto t = torch::ones({2, 3});
+      auto u = torch::ones({2, 3});
+      for (int j = 0; j < kNumIters; j++) {
+        t = t.add(u);
+        RECORD_USER_SCOPE("sampled_range");
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  using Shapes = std::vector<std::vector<int64_t>>;
+  auto find_op = [](const std::vector<SampledOpStats>& stats,
+                    const std::string& name,
+                    const Shapes& shapes) {
+    auto it = std::find_if(
+        stats.begin(), stats.end(), [&](const SampledOpStats& op) {
+          return op.name == name && op.shapes == shapes;
+        });
+    return it != stats.end() ? &*it : nullptr;
+  };
+
+  auto stats = flushSamplingProfiler();
+  ASSERT_EQ(stats.size(), flushed.size());
+  // Aggregated across threads, per input shapes
+  auto add = find_op(stats, "aten::add", Shapes{{2, 3}, {2, 3}, {}});
+  ASSERT_TRUE(add);
+  ASSERT_EQ(add->num_samples, kNumThreads * kNumIters);
+  ASSERT_EQ(add->estimated_calls, kNumThreads * kNumIters);
+  ASSERT_EQ(
+      std::accumulate(add->histogram.begin(), add->histogram.end(), 0),
+      add->num_samples);
+  ASSERT_GT(add->total_ns, 0);
+  ASSERT_GT(add->percentileNs(0.5), 0);
+  ASSERT_LE(add->percentileNs(0.5), add->percentileNs(0.99));
+  auto range = find_op(stats, "sampled_range", Shapes{});
+  ASSERT_TRUE(range);
+  ASSERT_EQ(range->num_samples, kNumThreads * kNumIters);
+
+  // Only the samples since the previous flush are reported
+  ASSERT_TRUE(flushSamplingProfiler().empty());
+  torch::ones({1}).add(torch::ones({1}));
+  flushed.clear();
+  disableSamplingProfiler();
+  ASSERT_FALSE(samplingProfilerEnabled());
+  add = find_op(flushed, "aten::add", Shapes{{1}, {1}, {}});
+  ASSERT_TRUE(add);
+  ASSERT_EQ(add->num_samples, 1);
+  ASSERT_FALSE(find_op(flushed, "aten::add", Shapes{{2, 3}, {2, 3}, {}}));
+}
+
+TEST(SamplingProfilerTest, EnableAndDisableWhileRunningOps) {
+  std::atomic<bool> done{false};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 2; i++) {
+    threads.emplace_back([&done] {
+      auto t = torch::ones({2, 3});
+      while (!done.load()) {
+        t = t.add(1).sub(1);
+      }
+    });
+  }
+  for (int i = 0; i < 20; i++) {
+    SamplingProfilerConfig config;
+    config.sampling_prob = 1.0;
+    config.record_shapes = i % 2 == 0;
+    config.flush_interval = std::chrono::milliseconds(i % 3);
+    enableSamplingProfiler(std::move(config));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    flushSamplingProfiler();
+    disableSamplingProfiler();
+  }
+  done = true;
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_FALSE(samplingProfilerEnabled());
+}
+
+TEST(MemoryProfilerTest, Basic) {
+  constexpr int64_t kNumel = 1024;
+  constexpr int64_t kBytes = kNumel * sizeof(float);
+  enableMemoryProfiler();
+  ASSERT_TRUE(memoryProfilerEnabled());
+  ASSERT_ANY_THROW(enableMemoryProfiler());
+  auto a = torch::ones({kNumel});
+  auto b = a.mul(a);
+  {
+    RECORD_USER_SCOPE("user_scope");
+    auto c = a.add(a);
+  }
+  b.reset();
+  auto profile = disableMemoryProfiler();
+  ASSERT_FALSE(memoryProfilerEnabled());
+
+  // Allocations are attributed to the outermost op, and their frees to the
+  // same op
+  std::unordered_map<std::string, OpMemoryStats> op_stats;
+  for (const auto& op : profile.opStats()) {
+    op_stats[op.name] = op;
+  }
+  ASSERT_EQ(op_stats.count("aten::empty"), 0);
+  ASSERT_GE(op_stats.at("aten::ones").allocated_bytes, kBytes);
+  ASSERT_GE(op_stats.at("aten::ones").live_bytes, kBytes);
+  ASSERT_GE(op_stats.at("aten::mul").allocated_bytes, kBytes);
+  ASSERT_EQ(op_stats.at("aten::mul").live_bytes, 0);
+  ASSERT_GE(op_stats.at("aten::add").allocated_bytes, kBytes);
+  ASSERT_EQ(op_stats.at("aten::add").live_bytes, 0);
+
+  std::unordered_map<int64_t, const MemoryEvent*> live;
+  int64_t total_allocated = 0;
+  for (const auto& event : profile.events()) {
+    ASSERT_TRUE(event.device.is_cpu());
+    if (event.allocation_id < 0) {
+      continue;
+    }
+    if (event.bytes > 0) {
+      live[event.allocation_id] = &event;
+    } else {
+      auto& allocation = live.at(event.allocation_id);
+      ASSERT_EQ(event.bytes, -allocation->bytes);
+      ASSERT_EQ(event.op_name, allocation->op_name);
+      ASSERT_LE(allocation->time_ns, event.time_ns);
+      live.erase(event.allocation_id);
+    }
+    total_allocated += event.bytes;
+    ASSERT_EQ(event.total_allocated, total_allocated);
+  }
+
+  // a, b and c are live at the peak
+  auto peaks = profile.peaks();
+  ASSERT_EQ(peaks.size(), 1);
+  ASSERT_GE(peaks[0].bytes, 3 * kBytes);
+  int64_t peak_bytes = 0;
+  std::unordered_set<std::string> peak_ops;
+  for (const auto& op : peaks[0].bytes_per_op) {
+    peak_bytes += op.second;
+    peak_ops.insert(op.first);
+  }
+  ASSERT_EQ(peak_bytes, peaks[0].bytes);
+  ASSERT_EQ(
+      peak_ops,
+      (std::unordered_set<std::string>{
+          "aten::ones", "aten::mul", "aten::add"}));
+  auto report = profile.peakReport();
+  ASSERT_NE(report.find("Peak memory on cpu"), std::string::npos);
+  ASSERT_NE(report.find("aten::add"), std::string::npos);
+
+  auto timeline = c10::make_tempfile();
+  profile.exportTimeline(timeline.name);
+  std::ifstream timeline_file(timeline.name);
+  std::string line;
+  std::getline(timeline_file, line);
+  ASSERT_EQ(line, "{\"traceEvents\": [");
+  std::getline(timeline_file, line);
+  ASSERT_NE(
+      line.find("\"name\": \"cpu memory\", \"ph\": \"C\""),
+      std::string::npos);
+}
+
 TEST(IValueKWargsTest, Basic) {
   const auto text = R"(
     def foo(a : int, b : int, c : int = 4):
@@ -6,6 +6,7 @@
 #include <torch/csrc/jit/serialization/export.h>
 #include <torch/csrc/jit/serialization/import.h>
 #include <torch/csrc/jit/serialization/import_source.h>
+#include <torch/csrc/jit/serialization/storage_cache.h>
 #include <torch/torch.h>
 
 #include "caffe2/serialize/istream_adapter.h"
@@ -120,6 +121,56 @@ TEST(SerializationTest, TypeTags) {
   }
 }
 
+TEST(SerializationTest, ShareLoadedStorages) {
+  Module m("m");
+  m.register_parameter("shared", torch::rand({4, 4}), false);
+  m.register_parameter("distinct", torch::rand({4, 4}), false);
+  m.register_parameter(
+      "trainable", torch::rand({4, 4}, torch::requires_grad()), false);
+  m.eval();
+  std::stringstream ss1;
+  m.save(ss1);
+  m.attr("distinct").toTensor().add_(1);
+  std::stringstream ss2;
+  m.save(ss2);
+
+  auto data = [](const Module& module, const std::string& name) {
+    return module.attr(name).toTensor().data_ptr();
+  };
+
+  {
+    ShareLoadedStoragesGuard guard;
+    ss1.seekg(0);
+    auto m1 = torch::jit::load(ss1);
+    ss2.seekg(0);
+    auto m2 = torch::jit::load(ss2);
+    EXPECT_EQ(data(m1, "shared"), data(m2, "shared"));
+    EXPECT_NE(data(m1, "distinct"), data(m2, "distinct"));
+    ASSERT_TRUE(m2.attr("distinct")
+                    .toTensor()
+                    .equal(m.attr("distinct").toTensor()));
+
+    // Tensors that may be written to get their own copy.
+    EXPECT_NE(data(m1, "trainable"), data(m2, "trainable"));
+    m1.attr("trainable").toTensor().detach().add_(1);
+    ASSERT_TRUE(m2.attr("trainable")
+                    .toTensor()
+                    .equal(m.attr("trainable").toTensor()));
+    m.train();
+    std::stringstream ss3;
+    m.save(ss3);
+    m.eval();
+    auto m_train = torch::jit::load(ss3);
+    EXPECT_NE(data(m1, "shared"), data(m_train, "shared"));
+
+    // Without sharing, loading copies the data as before.
+    ShareLoadedStoragesGuard no_sharing(false);
+    ss1.seekg(0);
+    auto m3 = torch::jit::load(ss1);
+    EXPECT_NE(data(m1, "shared"), data(m3, "shared"));
+  }
+}
+
 TEST(SerializationTest, TestJitStream_CUDA) {
   torch::jit::Module model;
   std::vector<torch::jit::IValue> inputs;
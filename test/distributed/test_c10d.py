@@ -894,6 +894,36 @@ class ProcessGroupGlooTest(MultiProcessTestCase):
     def test_allreduce_basics_cuda(self):
         self._test_allreduce_basics(lambda t: t.clone().cuda())
 
+    def test_hierarchical_allreduce_basics(self):
+        store = c10d.FileStore(self.file_name, self.world_size)
+        opts = self.opts()
+        opts.hierarchical_allreduce = True
+        # Pretend that every pair of ranks shares a host.
+        opts.host_id = "host%d" % (self.rank // 2)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, opts)
+
+        for (op, input, output) in simple_reduce_tests(self.rank, self.world_size):
+            opts = c10d.AllreduceOptions()
+            opts.reduceOp = op
+            tensor = input.clone()
+            pg.allreduce([tensor], opts).wait()
+            self.assertEqualIgnoreType(output, tensor)
+
+        # Concurrent work on all devices and worker threads.
+        inputs = [torch.tensor([i + self.rank]) for i in range(100)]
+        work_handles = [pg.allreduce(inputs[i]) for i in range(len(inputs))]
+        for i, work_handle in enumerate(work_handles):
+            work_handle.wait()
+            self.assertEqualIgnoreType(
+                torch.tensor(
+                    [
+                        (i * self.world_size)
+                        + (self.world_size * (self.world_size - 1) / 2)
+                    ]
+                ),
+                inputs[i],
+            )
+
     def _test_allreduce_stress(self, inputs):
         store = c10d.FileStore(self.file_name, self.world_size)
         pg = c10d.ProcessGroupGloo(
@@ -1030,9 +1060,11 @@ class ProcessGroupGlooTest(MultiProcessTestCase):
                 opts.reduceOp = op
                 pg.allreduce([t3], opts)
 
-    def _test_sparse_allreduce_basics(self, fn):
+    def _test_sparse_allreduce_basics(self, fn, sharded=False):
         store = c10d.FileStore(self.file_name, self.world_size)
-        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+        opts = self.opts()
+        opts.sharded_sparse_allreduce = sharded
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, opts)
 
         for num_inputs_per_rank in [1, 2]:
             tests = simple_sparse_reduce_tests(
@@ -1048,6 +1080,28 @@ class ProcessGroupGlooTest(MultiProcessTestCase):
     def test_sparse_allreduce_basics(self):
         self._test_sparse_allreduce_basics(lambda t: t)
 
+    def test_sparse_allreduce_sharded(self):
+        self._test_sparse_allreduce_basics(lambda t: t, sharded=True)
+
+    def test_sparse_allreduce_sharded_uneven_rows(self):
+        store = c10d.FileStore(self.file_name, self.world_size)
+        opts = self.opts()
+        opts.sharded_sparse_allreduce = True
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, opts)
+        rows = 7
+        indices = torch.tensor([[self.rank, rows - 1, 0, self.rank]])
+        values = torch.ones(4, 3)
+        tensor = torch.sparse_coo_tensor(indices, values, (rows, 3))
+        pg.allreduce([tensor]).wait()
+        expected = torch.zeros(rows, 3)
+        for rank in range(self.world_size):
+            expected[rank] += 2
+        expected[rows - 1] += self.world_size
+        expected[0] += self.world_size
+        # The result is coalesced without coalescing it again.
+        self.assertTrue(tensor.is_coalesced())
+        self.assertEqual(tensor.to_dense(), expected)
+
     @skip_if_not_multigpu
     def test_sparse_allreduce_basics_cuda(self):
         self._test_sparse_allreduce_basics(lambda t: t.clone().cuda())
@@ -1699,6 +1753,80 @@ class ProcessGroupGlooTest(MultiProcessTestCase):
             del pg
 
 
+
+@unittest.skipIf(
+    getattr(c10d, "ProcessGroupShm", None) is None,
+    "The shared memory backend is not available",
+)
+class ProcessGroupShmTest(MultiProcessTestCase):
+    def setUp(self):
+        super(ProcessGroupShmTest, self).setUp()
+        self._fork_processes()
+
+    def _create_process_group(self):
+        store = c10d.FileStore(self.file_name, self.world_size)
+        opts = c10d.ProcessGroupShm.Options()
+        opts.timeout = timedelta(seconds=5)
+        # A small buffer, so that the tensors below are processed in chunks.
+        opts.buffer_size = 256
+        return c10d.ProcessGroupShm(store, self.rank, self.world_size, opts)
+
+    def test_allreduce(self):
+        pg = self._create_process_group()
+        tensor = torch.arange(1000, dtype=torch.float) * (self.rank + 1)
+        pg.allreduce(tensor).wait()
+        expected = torch.arange(1000, dtype=torch.float) * sum(
+            range(1, self.world_size + 1)
+        )
+        self.assertEqual(expected, tensor)
+
+        opts = c10d.AllreduceOptions()
+        opts.reduceOp = c10d.ReduceOp.MAX
+        # Non-contiguous input
+        tensor = torch.full((100, 3), self.rank, dtype=torch.long).t()
+        pg.allreduce([tensor], opts).wait()
+        self.assertEqual(
+            torch.full((3, 100), self.world_size - 1, dtype=torch.long), tensor
+        )
+
+    def test_reduce(self):
+        pg = self._create_process_group()
+        input = torch.arange(500, dtype=torch.float) * (self.rank + 1)
+        for root in range(self.world_size):
+            opts = c10d.ReduceOptions()
+            opts.rootRank = root
+            tensor = input.clone()
+            pg.reduce([tensor], opts).wait()
+            if self.rank == root:
+                expected = torch.arange(500, dtype=torch.float) * sum(
+                    range(1, self.world_size + 1)
+                )
+                self.assertEqual(expected, tensor)
+            else:
+                # The inputs of the other ranks are left unmodified.
+                self.assertEqual(input, tensor)
+
+    def test_broadcast(self):
+        pg = self._create_process_group()
+        for root in range(self.world_size):
+            opts = c10d.BroadcastOptions()
+            opts.rootRank = root
+            opts.rootTensor = 0
+            tensor = torch.full((500,), self.rank, dtype=torch.double)
+            pg.broadcast([tensor], opts).wait()
+            self.assertEqual(torch.full((500,), root, dtype=torch.double), tensor)
+
+    def test_allgather(self):
+        pg = self._create_process_group()
+        input = torch.full((300,), self.rank, dtype=torch.int)
+        outputs = [
+            [torch.empty(300, dtype=torch.int) for _ in range(self.world_size)]
+        ]
+        pg.allgather(outputs, [input]).wait()
+        for rank, output in enumerate(outputs[0]):
+            self.assertEqual(torch.full((300,), rank, dtype=torch.int), output)
+
+
 class ProcessGroupNCCLNoGPUTest(TestCase):
     MAIN_PROCESS_RANK = 0
 
@@ -2175,6 +2303,7 @@ class DistributedDataParallelTest(MultiProcessTestCase):
         device_ids,
         global_batch_size,
         gradient_as_bucket_view=False,
+        bucket_chunk_bytes=0,
     ):
         model = Net()
         ddp_model = DistributedDataParallel(
@@ -2184,6 +2313,8 @@ class DistributedDataParallelTest(MultiProcessTestCase):
             bucket_cap_mb=0.001,
             gradient_as_bucket_view=gradient_as_bucket_view,
         )
+        if bucket_chunk_bytes > 0:
+            ddp_model._set_bucket_chunk_size(bucket_chunk_bytes)
 
         model.to(devices[0])
 
@@ -2229,6 +2360,7 @@ class DistributedDataParallelTest(MultiProcessTestCase):
         device_ids,
         multi_device=False,
         gradient_as_bucket_view=False,
+        bucket_chunk_bytes=0,
     ):
         """
         Note: we pass down `device_ids` all the way to DistributedDataParallel
@@ -2255,6 +2387,7 @@ class DistributedDataParallelTest(MultiProcessTestCase):
                 device_ids,
                 global_batch_size,
                 gradient_as_bucket_view,
+                bucket_chunk_bytes,
             )
 
         def step_model(model, input, target):
@@ -2299,7 +2432,12 @@ class DistributedDataParallelTest(MultiProcessTestCase):
             input = input[torch.randperm(global_batch_size)]
 
     def _test_gloo_backend(
-        self, devices, device_ids, multi_device=False, gradient_as_bucket_view=False
+        self,
+        devices,
+        device_ids,
+        multi_device=False,
+        gradient_as_bucket_view=False,
+        bucket_chunk_bytes=0,
     ):
         store = c10d.FileStore(self.file_name, self.world_size)
         options = c10d.ProcessGroupGloo.Options()
@@ -2308,7 +2446,12 @@ class DistributedDataParallelTest(MultiProcessTestCase):
             store, self.rank, self.world_size, options
         )
         self._test_ddp_with_process_group(
-            process_group, devices, device_ids, multi_device, gradient_as_bucket_view
+            process_group,
+            devices,
+            device_ids,
+            multi_device,
+            gradient_as_bucket_view,
+            bucket_chunk_bytes,
         )
 
     @requires_gloo()
@@ -2319,6 +2462,20 @@ class DistributedDataParallelTest(MultiProcessTestCase):
     def test_gloo_backend_cpu_module_grad_is_view(self):
         self._test_gloo_backend([torch.device("cpu")], [], gradient_as_bucket_view=True)
 
+    @requires_gloo()
+    def test_gloo_backend_cpu_module_pipelined_buckets(self):
+        # Every variable is a chunk of its own.
+        self._test_gloo_backend([torch.device("cpu")], [], bucket_chunk_bytes=1)
+
+    @requires_gloo()
+    def test_gloo_backend_cpu_module_pipelined_buckets_grad_is_view(self):
+        self._test_gloo_backend(
+            [torch.device("cpu")],
+            [],
+            gradient_as_bucket_view=True,
+            bucket_chunk_bytes=1,
+        )
+
     @requires_gloo()
     @skip_if_not_multigpu
     def test_gloo_backend_1gpu_module_device_ids_integer_list(self):
@@ -3624,6 +3781,82 @@ class DistributedDataParallelTest(MultiProcessTestCase):
         # without the comm_hook, result would be 0.25 * torch.ones(2, 2).
         self._run_and_verify_hook(cpu_model, 8, 2 * torch.ones(2, 2))
 
+    @requires_gloo()
+    def test_builtin_ddp_comm_hooks_cpu(self):
+        """
+        This unit test verifies whether built-in C++ DDP communication hooks
+        give the same result as no hook on CPU with Gloo. The gradients are
+        identical on all ranks and constant, so int8 rowwise quantization is
+        lossless, and PowerSGD runs plain allreduce in the first iterations.
+        """
+        store = c10d.FileStore(self.file_name, self.world_size)
+        process_group = c10d.ProcessGroupGloo(store, self.rank, self.world_size)
+
+        for comm_hook_type in [
+            dist.BuiltinCommHookType.ALLREDUCE,
+            dist.BuiltinCommHookType.FP16_COMPRESS,
+            dist.BuiltinCommHookType.INT8_ROWWISE_QUANTIZE,
+            dist.BuiltinCommHookType.POWER_SGD,
+        ]:
+            cpu_model = DistributedDataParallel(
+                ModuleForDdpCommHook().cpu(), process_group=process_group
+            )
+            cpu_model._register_builtin_comm_hook(comm_hook_type)
+            self._run_and_verify_hook(cpu_model, 8, 0.25 * torch.ones(2, 2))
+
+        # Top-k sparsification sends only the single largest entry (k = 1).
+        cpu_model = DistributedDataParallel(
+            ModuleForDdpCommHook().cpu(), process_group=process_group
+        )
+        cpu_model._register_builtin_comm_hook(
+            dist.BuiltinCommHookType.TOPK_SPARSIFY
+        )
+        cpu_model(8, self.rank).mean().backward()
+        grad = next(cpu_model.parameters()).grad
+        self.assertEqual(int((grad != 0).sum()), 1)
+        self.assertEqual(grad.sum().item(), 0.25)
+
+    @requires_gloo()
+    def test_builtin_power_sgd_comm_hook_cpu(self):
+        """
+        This unit test verifies that the built-in C++ PowerSGD hook gives the
+        same gradients as a plain allreduce over several iterations, once it
+        compresses them. With a rank as large as the smaller dimension of the
+        weight, the low-rank approximation is exact.
+        """
+        store = c10d.FileStore(self.file_name, self.world_size)
+        process_group = c10d.ProcessGroupGloo(store, self.rank, self.world_size)
+
+        def make_model():
+            torch.manual_seed(0)
+            return DistributedDataParallel(
+                nn.Linear(4, 3), process_group=process_group
+            )
+
+        ddp_model = make_model()
+        power_sgd_model = make_model()
+        options = dist.PowerSGDOptions()
+        options.matrix_approximation_rank = 3
+        options.start_powerSGD_iter = 1
+        power_sgd_model._register_builtin_comm_hook(
+            dist.BuiltinCommHookType.POWER_SGD, options
+        )
+
+        # The first iteration runs plain allreduce, the others compress.
+        for i in range(4):
+            torch.manual_seed(self.rank * 10 + i)
+            input = torch.randn(5, 4)
+            for model in [ddp_model, power_sgd_model]:
+                model.zero_grad()
+                model(input).pow(2).sum().backward()
+            for p, q in zip(ddp_model.parameters(), power_sgd_model.parameters()):
+                self.assertEqual(p.grad, q.grad, atol=1e-4, rtol=1e-4)
+
+        with self.assertRaisesRegex(ValueError, "cannot be used"):
+            make_model()._register_builtin_comm_hook(
+                dist.BuiltinCommHookType.TOPK_SPARSIFY, options
+            )
+
     def _gpu_model_with_ddp_comm_hook(
         self, process_group, hook=None, gradient_as_bucket_view=False, state=None
     ):
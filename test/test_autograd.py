@@ -3,6 +3,7 @@ import gc
 import sys
 import io
 import math
+import os
 import tempfile
 import time
 import threading
@@ -1530,6 +1531,86 @@ class TestAutograd(TestCase):
             has_deprecated = reduce(lambda x, y: x or y, has_deprecated)
             self.assertTrue(has_deprecated)
 
+    def _saved_tensors_input_grad(self, x):
+        # sin saves y, and the multiplication saves the boolean mask
+        y = x * 2
+        return torch.autograd.grad((y.sin() * (y > 0)).sum(), x)[0]
+
+    def test_compress_saved_tensors(self):
+        x = torch.randn(64, 64, requires_grad=True)
+        expected = self._saved_tensors_input_grad(x)
+
+        # Only the mask, packed losslessly
+        with torch.autograd.compress_saved_tensors("none") as hooks:
+            self.assertEqual(self._saved_tensors_input_grad(x), expected,
+                             atol=0, rtol=0)
+        self.assertEqual(hooks.num_packed, 1)
+        self.assertEqual(hooks.original_bytes, 64 * 64)
+        self.assertEqual(hooks.packed_bytes, 64 * 64 // 8)
+
+        for float_compression in ("bf16", "int8"):
+            with torch.autograd.compress_saved_tensors(float_compression) as hooks:
+                grad = self._saved_tensors_input_grad(x)
+            self.assertEqual(grad, expected, atol=0.1, rtol=0)
+            self.assertEqual(hooks.num_packed, 2)
+            self.assertLess(hooks.packed_bytes * 2, hooks.original_bytes)
+
+        # Tensors too small are saved as is
+        with torch.autograd.compress_saved_tensors(min_numel=64 * 64 + 1) as hooks:
+            self.assertEqual(self._saved_tensors_input_grad(x), expected,
+                             atol=0, rtol=0)
+        self.assertEqual(hooks.num_packed, 0)
+
+        with self.assertRaisesRegex(RuntimeError, "float_compression must be"):
+            torch.autograd.compress_saved_tensors("fp8")
+
+    def test_saved_tensors_hooks_nesting(self):
+        x = torch.randn(64, 64, requires_grad=True)
+        expected = self._saved_tensors_input_grad(x)
+
+        with torch.autograd.compress_saved_tensors("bf16") as outer:
+            with torch.autograd.compress_saved_tensors("none", pack_bool=False) as inner:
+                y = x * 2
+                inner_loss = (y.sin() * (y > 0)).sum()
+            y = x * 2
+            outer_loss = (y.sin() * (y > 0)).sum()
+        self.assertEqual(inner.num_packed, 0)
+        self.assertEqual(outer.num_packed, 2)
+
+        # Backward runs after the hooks are gone, and no hooks are left set
+        self.assertEqual(torch.autograd.grad(inner_loss, x)[0], expected,
+                         atol=0, rtol=0)
+        self.assertEqual(torch.autograd.grad(outer_loss, x)[0], expected,
+                         atol=0.1, rtol=0)
+        self.assertEqual(self._saved_tensors_input_grad(x), expected,
+                         atol=0, rtol=0)
+        self.assertEqual(outer.num_packed, 2)
+
+    @unittest.skipIf(IS_WINDOWS, "Mapped files can't be unlinked on Windows")
+    def test_spill_saved_tensors(self):
+        x = torch.randn(64, 64, requires_grad=True)
+        expected = self._saved_tensors_input_grad(x)
+
+        with tempfile.TemporaryDirectory() as directory:
+            with torch.autograd.spill_saved_tensors(directory, min_bytes=1024) as hooks:
+                y = x * 2
+                loss = (y.sin() * (y > 0)).sum()
+                with torch.autograd.compress_saved_tensors("bf16") as inner:
+                    torch.autograd.grad(x.mul(2).sin().sum(), x)
+            self.assertEqual(inner.num_packed, 1)
+            self.assertEqual(hooks.num_packed, 2)
+            self.assertEqual(hooks.original_bytes, hooks.packed_bytes)
+            # The files are removed as soon as they are mapped
+            self.assertEqual(os.listdir(directory), [])
+            self.assertEqual(torch.autograd.grad(loss, x)[0], expected,
+                             atol=0, rtol=0)
+
+            # Smaller tensors are saved in memory
+            with torch.autograd.spill_saved_tensors(directory, min_bytes=64 * 64 * 4 + 1) as hooks:
+                self.assertEqual(self._saved_tensors_input_grad(x), expected,
+                                 atol=0, rtol=0)
+            self.assertEqual(hooks.num_packed, 0)
+
     def test_requires_grad(self):
         x = torch.randn(5, 5)
         y = torch.randn(5, 5)
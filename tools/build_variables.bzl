@@ -83,6 +83,9 @@ jit_core_sources = [
 core_sources_common = [
     "torch/csrc/autograd/profiler_legacy.cpp",
     "torch/csrc/autograd/profiler_kineto.cpp",
+    "torch/csrc/autograd/profiler_memory.cpp",
+    "torch/csrc/autograd/profiler_perf.cpp",
+    "torch/csrc/autograd/profiler_sampling.cpp",
     "torch/csrc/autograd/profiler_utils.cpp",
     "torch/csrc/autograd/autograd_meta.cpp",
     "torch/csrc/autograd/forward_grad.cpp",
@@ -116,6 +119,7 @@ core_trainer_sources = [
     "torch/csrc/autograd/input_buffer.cpp",
     "torch/csrc/autograd/record_function_ops.cpp",
     "torch/csrc/autograd/saved_variable.cpp",
+    "torch/csrc/autograd/saved_variable_hooks.cpp",
     "torch/csrc/autograd/variable.cpp",
     "torch/csrc/jit/frontend/name_mangler.cpp",
     "torch/csrc/jit/ir/type_hashing.cpp",
@@ -237,6 +241,7 @@ core_sources_full_mobile = [
     "torch/csrc/jit/serialization/pickle.cpp",
     "torch/csrc/jit/serialization/python_print.cpp",
     "torch/csrc/jit/serialization/source_range_serialization.cpp",
+    "torch/csrc/jit/serialization/storage_cache.cpp",
     "torch/csrc/jit/tensorexpr/bounds_inference.cpp",
     "torch/csrc/jit/tensorexpr/bounds_overlap.cpp",
     "torch/csrc/jit/tensorexpr/mem_dependency_checker.cpp",
@@ -341,6 +346,7 @@ libtorch_extra_sources = libtorch_core_jit_sources + [
     "torch/csrc/jit/mobile/import.cpp",
     "torch/csrc/jit/mobile/import_data.cpp",
     "torch/csrc/jit/mobile/interpreter.cpp",
+    "torch/csrc/jit/mobile/memory_planner.cpp",
     "torch/csrc/jit/mobile/module.cpp",
     "torch/csrc/jit/mobile/observer.cpp",
     "torch/csrc/jit/mobile/optim/sgd.cpp",
@@ -418,6 +424,7 @@ libtorch_cuda_sources = libtorch_cuda_core_sources + [
 
 torch_cpp_srcs = [
     "torch/csrc/api/src/cuda.cpp",  # this just forwards stuff, no real CUDA
+    "torch/csrc/api/src/data/datasets/columnar.cpp",
     "torch/csrc/api/src/data/datasets/mnist.cpp",
     "torch/csrc/api/src/data/samplers/distributed.cpp",
     "torch/csrc/api/src/data/samplers/random.cpp",
@@ -462,6 +469,7 @@ torch_cpp_srcs = [
     "torch/csrc/api/src/nn/options/rnn.cpp",
     "torch/csrc/api/src/nn/options/vision.cpp",
     "torch/csrc/api/src/nn/options/transformer.cpp",
+    "torch/csrc/api/src/nn/utils/checkpoint.cpp",
     "torch/csrc/api/src/optim/adagrad.cpp",
     "torch/csrc/api/src/optim/adam.cpp",
     "torch/csrc/api/src/optim/adamw.cpp",
@@ -1,4 +1,4 @@
-from typing import List, Set
+from typing import List, Optional, Set, Tuple
 from enum import Enum
 
 # Defined in tools/autograd/init.cpp
@@ -26,7 +26,8 @@ class ProfilerConfig:
         report_input_shapes: bool,
         profile_memory: bool,
         with_stack: bool,
-        with_flops: bool
+        with_flops: bool,
+        perf_events: List[str] = ...
     ) -> None: ...
     ...
 
@@ -46,6 +47,7 @@ class ProfilerEvent:
     def shapes(self) -> List[List[int]]: ...
     def thread_id(self) -> int: ...
     def flops(self) -> float: ...
+    def perf_counters(self) -> List[int]: ...
     ...
 
 class KinetoEvent:
@@ -53,6 +55,7 @@ class KinetoEvent:
     def device_index(self) -> int: ...
     def start_us(self) -> int: ...
     def duration_us(self) -> int: ...
+    def perf_counters(self) -> List[int]: ...
     ...
 
 class ProfilerResult:
@@ -65,8 +68,74 @@ def _prepare_profiler(config: ProfilerConfig, activities: Set[ProfilerActivity])
 def _disable_profiler() -> ProfilerResult: ...
 def _profiler_enabled() -> bool: ...
 def kineto_available() -> bool: ...
+def _supported_perf_events() -> List[str]: ...
 def _enable_record_function(enable: bool) -> None: ...
 def _set_empty_test_observer(is_global: bool, sampling_prob: float) -> None: ...
 
 def _enable_profiler_legacy(config: ProfilerConfig) -> None: ...
 def _disable_profiler_legacy() -> List[List[ProfilerEvent]]: ...
+
+class _SampledOpStats:
+    name: str
+    shapes: List[List[int]]
+    num_samples: int
+    estimated_calls: float
+    total_ns: int
+    histogram: List[int]
+    def percentile_ns(self, fraction: float) -> int: ...
+
+def _enable_sampling_profiler(
+    sampling_prob: float = ...,
+    record_shapes: bool = ...,
+    flush_interval_ms: int = ...,
+    output_file: str = ...,
+) -> None: ...
+def _disable_sampling_profiler() -> None: ...
+def _flush_sampling_profiler() -> List[_SampledOpStats]: ...
+def _sampling_profiler_enabled() -> bool: ...
+
+class _MemoryEvent:
+    time_ns: int
+    bytes: int
+    device: str
+    thread_id: int
+    allocation_id: int
+    op_name: str
+    stack: List[str]
+    total_allocated: int
+
+class _MemoryPeak:
+    device: str
+    time_ns: int
+    bytes: int
+    bytes_per_op: List[Tuple[str, int]]
+
+class _OpMemoryStats:
+    name: str
+    num_allocations: int
+    allocated_bytes: int
+    live_bytes: int
+
+class _MemoryProfile:
+    def events(self) -> List[_MemoryEvent]: ...
+    def peaks(self) -> List[_MemoryPeak]: ...
+    def op_stats(self) -> List[_OpMemoryStats]: ...
+    def peak_report(self, top_k: int = ...) -> str: ...
+    def export_timeline(self, path: str) -> None: ...
+
+def _enable_memory_profiler(with_stack: bool = ...) -> None: ...
+def _disable_memory_profiler() -> _MemoryProfile: ...
+def _memory_profiler_enabled() -> bool: ...
+
+class _SavedVariableHooks:
+    ...
+
+class _CompressSavedVariableHooks(_SavedVariableHooks):
+    def __init__(self, float_compression: str, pack_bool: bool, min_numel: int) -> None: ...
+    def stats(self) -> Tuple[int, int, int]: ...
+
+class _FileSavedVariableHooks(_SavedVariableHooks):
+    def __init__(self, directory: str, min_bytes: int) -> None: ...
+    def stats(self) -> Tuple[int, int, int]: ...
+
+def _set_saved_variable_hooks(hooks: Optional[_SavedVariableHooks]) -> Optional[_SavedVariableHooks]: ...
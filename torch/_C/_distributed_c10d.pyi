@@ -11,9 +11,37 @@ _DEFAULT_NO_TIMEOUT: timedelta
 class BuiltinCommHookType(Enum):
     ALLREDUCE = ...
     FP16_COMPRESS = ...
+    INT8_ROWWISE_QUANTIZE = ...
+    TOPK_SPARSIFY = ...
+    POWER_SGD = ...
 
 def _register_comm_hook(reducer: Reducer, state: Any, comm_hook: Any): ...
+class Int8RowwiseQuantizeOptions:
+    row_size: int
+    use_error_feedback: bool
+    def __init__(self): ...
+
+class TopKSparsifyOptions:
+    ratio: float
+    use_error_feedback: bool
+    def __init__(self): ...
+
+class PowerSGDOptions:
+    matrix_approximation_rank: int
+    start_powerSGD_iter: int
+    use_error_feedback: bool
+    warm_start: bool
+    random_seed: int
+    def __init__(self): ...
+
+@overload
 def _register_builtin_comm_hook(reducer: Reducer, comm_hook_type: BuiltinCommHookType): ...
+@overload
+def _register_builtin_comm_hook(reducer: Reducer, options: Int8RowwiseQuantizeOptions): ...
+@overload
+def _register_builtin_comm_hook(reducer: Reducer, options: TopKSparsifyOptions): ...
+@overload
+def _register_builtin_comm_hook(reducer: Reducer, options: PowerSGDOptions): ...
 
 def _get_ddp_logging_data(reducer: Reducer): ...
 def _set_construction_logging_data(
@@ -17,6 +17,7 @@ from .function import Function, NestedIOFunction
 from .gradcheck import gradcheck, gradgradcheck
 from .grad_mode import no_grad, enable_grad, set_grad_enabled
 from .anomaly_mode import detect_anomaly, set_detect_anomaly
+from .saved_variable_hooks import compress_saved_tensors, spill_saved_tensors
 from ..overrides import has_torch_function, handle_torch_function
 from . import functional
 from . import forward_ad
@@ -221,7 +221,7 @@ class EventList(list):
                     '"dur": %s, '
                     '"tid": %s, '
                     '"pid": "CPU functions", '
-                    '"args": {}}, '
+                    '"args": {%s}}, '
                     % (
                         evt.trace_name,
                         evt.time_range.start,
@@ -229,6 +229,10 @@ class EventList(list):
                         evt.thread
                         if not evt.is_remote
                         else f'" node_id:{evt.node_id}, thread_id:{evt.thread} "',
+                        ", ".join(
+                            '"%s": %s' % (name, count)
+                            for name, count in evt.perf_counters.items()
+                        ),
                     )
                 )
                 for k in evt.kernels:
@@ -378,6 +382,13 @@ class profile(object):
         use_cpu (default True) - whether to profile CPU events; setting to False requires
             use_kineto=True and can be used to lower the overhead for GPU-only profiling
 
+        perf_events (list of str, optional): names of the hardware and software
+            performance counters to read at the start and the end of every op, e.g.
+            ``["cycles", "instructions", "cache_misses"]``. Only supported on Linux,
+            see ``torch.autograd._supported_perf_events()`` for the available counters.
+            The counts of every event are reported in ``perf_counters`` and in the
+            args of the exported Chrome trace, default: ``None``
+
     .. warning:
         Enabling memory profiling or source attribution incurs additional profiler
         overhead
@@ -420,7 +431,8 @@ class profile(object):
             profile_memory=False,
             with_stack=False,
             use_kineto=False,
-            use_cpu=True):
+            use_cpu=True,
+            perf_events=None):
         self.enabled: bool = enabled
         if not self.enabled:
             return
@@ -433,6 +445,7 @@ class profile(object):
         self.profile_memory = profile_memory
         self.with_stack = with_stack
         self.use_cpu = use_cpu
+        self.perf_events = list(perf_events) if perf_events else []
         self.kineto_results = None
         if not self.use_cpu:
             assert use_kineto, \
@@ -469,7 +482,8 @@ class profile(object):
             self.record_shapes,
             self.profile_memory,
             self.with_stack,
-            self.with_flops)
+            self.with_flops,
+            self.perf_events)
 
     def __enter__(self):
         if not self.enabled:
@@ -498,10 +512,12 @@ class profile(object):
             return
         if self.kineto_activities:
             self.kineto_results = torch.autograd._disable_profiler()
-            parsed_results = parse_kineto_results(self.kineto_results)
+            parsed_results = parse_kineto_results(
+                self.kineto_results, perf_events=self.perf_events)
         else:
             records = torch.autograd._disable_profiler_legacy()
-            parsed_results = parse_legacy_records(records)
+            parsed_results = parse_legacy_records(
+                records, perf_events=self.perf_events)
         self.function_events = EventList(
             parsed_results,
             use_cuda=self.use_cuda,
@@ -847,7 +863,7 @@ class FunctionEvent(FormattedTimesMixin):
             self, id, name, thread, start_us, end_us, fwd_thread=None, input_shapes=None,
             stack=None, scope=0, cpu_memory_usage=0, cuda_memory_usage=0, is_async=False,
             is_remote=False, sequence_nr=-1, node_id=-1, device_type=DeviceType.CPU, device_index=0,
-            is_legacy=False, flops=None, trace_name=None):
+            is_legacy=False, flops=None, trace_name=None, perf_counters=None):
         self.id: int = id
         self.node_id: int = node_id
         self.name: str = name
@@ -871,6 +887,8 @@ class FunctionEvent(FormattedTimesMixin):
         self.device_index: int = device_index
         self.is_legacy: bool = is_legacy
         self.flops: Optional[float] = flops
+        # counts of the performance counters requested with perf_events, by name
+        self.perf_counters: Dict[str, int] = perf_counters if perf_counters is not None else {}
 
     def append_kernel(self, name, device, start, end):
         assert self.device_type == DeviceType.CPU
@@ -1014,6 +1032,7 @@ class FunctionEventAvg(FormattedTimesMixin):
         self.device_type: DeviceType = DeviceType.CPU
         self.is_legacy: bool = False
         self.flops: float = 0.0
+        self.perf_counters: Dict[str, int] = {}
 
     def add(self, other):
         if self.key is None:
@@ -1047,6 +1066,8 @@ class FunctionEventAvg(FormattedTimesMixin):
             self.flops = other.flops
         elif other.flops is not None:
             self.flops += other.flops
+        for name, count in other.perf_counters.items():
+            self.perf_counters[name] = self.perf_counters.get(name, 0) + count
         return self
 
     def __iadd__(self, other):
@@ -1115,7 +1136,7 @@ def rewrite_name(name, with_wildcard=False):
     return name
 
 # Parsing of kineto profiler events
-def parse_kineto_results(result):
+def parse_kineto_results(result, perf_events=None):
     # result.events() has most of the events - PyTorch op-level and device-level events
     # result.legacy_events() has events not yet ported to kineto
     # (e.g. start/stop marks, tensor memory allocator events)
@@ -1152,6 +1173,9 @@ def parse_kineto_results(result):
                     cpu_memory_usage += mem_record.cpu_memory_usage()
                     cuda_memory_usage += mem_record.cuda_memory_usage()
         is_async = kineto_event.start_thread_id() != kineto_event.end_thread_id()
+        perf_counters = None
+        if perf_events and len(kineto_event.perf_counters()) == len(perf_events):
+            perf_counters = dict(zip(perf_events, kineto_event.perf_counters()))
         fe = FunctionEvent(
             id=kineto_event.correlation_id(),
             name=rewrite_name(name=kineto_event.name(), with_wildcard=True),
@@ -1169,6 +1193,7 @@ def parse_kineto_results(result):
             sequence_nr=kineto_event.sequence_nr(),
             device_type=kineto_event.device_type(),
             device_index=kineto_event.device_index(),
+            perf_counters=perf_counters,
         )
         function_events.append(fe)
         if kineto_event.device_type() == DeviceType.CUDA:
@@ -1193,7 +1218,7 @@ def parse_kineto_results(result):
     return function_events
 
 # Parsing of legacy profiler events
-def parse_legacy_records(thread_records):
+def parse_legacy_records(thread_records, perf_events=None):
     def get_record_key(record):
         """
         Returns a tuple to be used by parse_legacy_records for correlating start and
@@ -1279,6 +1304,16 @@ def parse_legacy_records(thread_records):
                 is_async = start.thread_id() != record.thread_id()
                 is_remote_event = record.is_remote()
                 start_flops = start.flops()
+                # counters are per thread, so async ranges have no deltas
+                perf_counters = None
+                if perf_events and not is_async:
+                    start_counters = start.perf_counters()
+                    end_counters = record.perf_counters()
+                    if len(start_counters) == len(end_counters) == len(perf_events):
+                        perf_counters = {
+                            name: last - first
+                            for name, first, last in zip(perf_events, start_counters, end_counters)
+                        }
 
                 fe = FunctionEvent(
                     id=record.handle(),
@@ -1300,6 +1335,7 @@ def parse_legacy_records(thread_records):
                     device_type=DeviceType.CPU,
                     is_legacy=True,
                     flops=start_flops,
+                    perf_counters=perf_counters,
                 )
                 # note: async events have only cpu total time
                 if not is_async and start.has_cuda():
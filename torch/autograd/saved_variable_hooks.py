@@ -0,0 +1,102 @@
+import torch
+
+from typing import Any, Optional
+
+
+class _saved_variable_hooks(object):
+    def __init__(self, hooks: torch._C._autograd._SavedVariableHooks) -> None:
+        self.hooks = hooks
+        self.prev: Optional[torch._C._autograd._SavedVariableHooks] = None
+
+    def __enter__(self) -> '_saved_variable_hooks':
+        self.prev = torch._C._autograd._set_saved_variable_hooks(self.hooks)
+        return self
+
+    def __exit__(self, *args: Any) -> None:
+        torch._C._autograd._set_saved_variable_hooks(self.prev)
+        self.prev = None
+
+    @property
+    def num_packed(self) -> int:
+        r"""Number of tensors packed so far."""
+        return self.hooks.stats()[0]
+
+    @property
+    def original_bytes(self) -> int:
+        r"""Bytes of the tensors packed so far, before packing."""
+        return self.hooks.stats()[1]
+
+    @property
+    def packed_bytes(self) -> int:
+        r"""Bytes of the tensors packed so far, after packing."""
+        return self.hooks.stats()[2]
+
+
+class compress_saved_tensors(_saved_variable_hooks):
+    r"""Context-manager that compresses the tensors saved for backward by the
+    operations run within it, until backward uses them.
+
+    Floating point tensors are converted to bfloat16 (``"bf16"``) or quantized
+    to 8 bits over the range of their values (``"int8"``), so the gradients
+    computed from them are only approximations. Boolean tensors, e.g. the masks
+    of dropout, are packed losslessly to a bit per element. Leaves requiring
+    grad, such as parameters, and tensors of less than :attr:`min_numel`
+    elements or that are not contiguous are saved as is.
+
+    Memory is only saved for the tensors nothing else refers to, e.g. the
+    output of an operation consumed by the next one is still kept alive by
+    the forward pass until that operation returns.
+
+    The setting is thread local, and the number of bytes packed can be read
+    from the context manager.
+
+    Args:
+        float_compression (str): ``"bf16"``, ``"int8"`` or ``"none"`` to only
+            pack boolean tensors.
+        pack_bool (bool): whether to pack boolean tensors to bits.
+        min_numel (int): number of elements below which tensors are saved
+            as is.
+
+    Example::
+
+        >>> with torch.autograd.compress_saved_tensors("bf16") as hooks:
+        ...     loss = model(input).sum()
+        >>> print(hooks.original_bytes, hooks.packed_bytes)
+        >>> loss.backward()
+    """
+
+    def __init__(self, float_compression: str = "bf16", pack_bool: bool = True,
+                 min_numel: int = 1024) -> None:
+        super().__init__(torch._C._autograd._CompressSavedVariableHooks(
+            float_compression, pack_bool, min_numel))
+
+
+class spill_saved_tensors(_saved_variable_hooks):
+    r"""Context-manager that moves the CPU tensors saved for backward by the
+    operations run within it to files mapped in memory, so that the operating
+    system can write them out and release their memory until backward reads
+    them back.
+
+    The files are created in :attr:`directory` and removed right away, and
+    their space is released once the graph is. Only contiguous tensors of at
+    least :attr:`min_bytes` bytes are moved, besides leaves requiring grad
+    such as parameters. The gradients are computed from the same values.
+
+    The setting is thread local, and the number of bytes moved can be read
+    from the context manager.
+
+    Args:
+        directory (str): directory where to create the files, preferably on a
+            fast local disk.
+        min_bytes (int): size in bytes below which tensors are saved in
+            memory.
+
+    Example::
+
+        >>> with torch.autograd.spill_saved_tensors("/mnt/scratch"):
+        ...     loss = model(input).sum()
+        >>> loss.backward()
+    """
+
+    def __init__(self, directory: str, min_bytes: int = 1024 * 1024) -> None:
+        super().__init__(torch._C._autograd._FileSavedVariableHooks(directory, min_bytes))
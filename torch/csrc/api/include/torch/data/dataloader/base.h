@@ -13,6 +13,7 @@
 
 #include <c10/util/Exception.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <exception>
 #include <memory>
@@ -37,6 +38,8 @@ class DataLoaderBase {
       std::unique_ptr<Dataset> main_thread_dataset = nullptr)
       : options_(std::move(options)),
         main_thread_dataset_(std::move(main_thread_dataset)),
+        // Large enough for all the jobs in flight, and the quit messages
+        shuttle_(std::max(options_.max_jobs, options_.workers)),
         sequencer_(new_sequencer()) {}
 
   virtual ~DataLoaderBase() {
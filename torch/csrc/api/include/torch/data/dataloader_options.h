@@ -22,7 +22,8 @@ struct DataLoaderOptions {
   /// synchronously perform the data loading.
   TORCH_ARG(size_t, workers) = 0;
 
-  /// The maximum number of jobs to enqueue for fetching by worker threads.
+  /// The maximum number of jobs to enqueue for fetching by worker threads,
+  /// i.e. how many batches are prefetched ahead of the one being consumed.
   /// Defaults to two times the number of worker threads.
   TORCH_ARG(optional<size_t>, max_jobs);
 
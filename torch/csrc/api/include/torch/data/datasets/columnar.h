@@ -0,0 +1,142 @@
+#pragma once
+
+#include <torch/data/datasets/base.h>
+#include <torch/types.h>
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace datasets {
+
+/// A column of a columnar dataset file, see `ColumnarDataset`.
+struct ColumnarColumn {
+  ColumnarColumn() = default;
+  ColumnarColumn(
+      std::string name,
+      ScalarType dtype,
+      std::vector<int64_t> shape = {},
+      bool variable_length = false)
+      : name(std::move(name)),
+        dtype(dtype),
+        shape(std::move(shape)),
+        variable_length(variable_length) {}
+
+  std::string name;
+  ScalarType dtype = ScalarType::Float;
+  /// The shape of the tensor of every example for fixed-width columns. For
+  /// variable-length columns, the shape of every element of the tensors,
+  /// which have a first dimension of any length.
+  std::vector<int64_t> shape;
+  bool variable_length = false;
+};
+
+/// A dataset read from a columnar binary file, written by `ColumnarWriter`,
+/// without loading or parsing the examples.
+///
+/// The file is memory-mapped, so that only the pages of the examples read are
+/// loaded from disk, and datasets larger than the memory can be read at
+/// random. `get()` returns copies of the examples, unless the dataset is
+/// constructed with `zero_copy`, in which case it returns views of the
+/// mapping, like `column_data()` does. The mapping is read-only: writing to
+/// such a view, e.g. with an in-place op, crashes the process, so they must
+/// be copied first, e.g. by `transforms::Stack`.
+///
+/// The data of every column is stored contiguously, example after example,
+/// so that an example of a fixed-width column is found at `index` times the
+/// size of an example. The examples of a variable-length column are found
+/// through an array of offsets instead. The file is laid out as follows, with
+/// little-endian integers:
+///
+///   char[8] magic "TORCHCOL", uint32 version, uint32 number of columns,
+///   uint64 number of examples, then for every column:
+///     uint32 length of the name, the name, uint8 1 if variable-length or 0,
+///     int8 scalar type, uint32 number of dimensions of the shape, int64
+///     dimensions, uint64 offset of the data, uint64 offset of the offsets
+///     (variable-length only, 0 otherwise)
+///   then the data of every column, and the offsets of every variable-length
+///   column: the number of examples plus one uint64, the first element of
+///   every example and the total number of elements.
+///
+/// The offsets are from the start of the file, aligned to 64 bytes.
+class TORCH_API ColumnarDataset
+    : public Dataset<ColumnarDataset, std::vector<Tensor>> {
+ public:
+  /// Maps the columnar file at `path`. If `columns` is not empty, only the
+  /// columns of these names are returned by `get()`, in this order. If
+  /// `zero_copy` is true, `get()` returns read-only views of the mapping.
+  explicit ColumnarDataset(
+      const std::string& path,
+      const std::vector<std::string>& columns = {},
+      bool zero_copy = false);
+
+  /// Returns the tensors of the columns of the example at `index`.
+  std::vector<Tensor> get(size_t index) override;
+
+  /// Returns the number of examples in the dataset.
+  optional<size_t> size() const override;
+
+  /// Returns the columns returned by `get()`.
+  const std::vector<ColumnarColumn>& columns() const noexcept;
+
+  /// Returns a read-only view of the data of the `column`-th column returned
+  /// by `get()`, for all the examples at once: of shape `{size(), shape...}`
+  /// for fixed-width columns, and of shape `{total length, shape...}` for
+  /// variable-length columns.
+  const Tensor& column_data(size_t column) const;
+
+ private:
+  std::vector<ColumnarColumn> columns_;
+  std::vector<Tensor> data_;
+  /// The offsets of the variable-length columns, undefined for the others.
+  std::vector<Tensor> offsets_;
+  size_t size_ = 0;
+  bool zero_copy_ = false;
+};
+
+/// Writes a columnar file read by `ColumnarDataset`, one example at a time.
+///
+/// The data of every column is first written to a temporary file next to
+/// `path`, so that examples are never held in memory. `finish()` then writes
+/// the file at `path` and removes the temporary files.
+class TORCH_API ColumnarWriter {
+ public:
+  ColumnarWriter(std::string path, std::vector<ColumnarColumn> columns);
+  ColumnarWriter(const ColumnarWriter&) = delete;
+  ColumnarWriter& operator=(const ColumnarWriter&) = delete;
+
+  /// Removes the temporary files if `finish()` wasn't called.
+  ~ColumnarWriter();
+
+  /// Appends an example, made of one CPU tensor per column, in the order of
+  /// the columns.
+  void write(const std::vector<Tensor>& example);
+
+  /// Writes the file. No examples can be written afterwards.
+  void finish();
+
+ private:
+  std::string column_path(size_t column, const char* suffix) const;
+  void remove_column_files();
+
+  std::string path_;
+  std::vector<ColumnarColumn> columns_;
+  std::vector<std::unique_ptr<std::ofstream>> data_files_;
+  /// The offsets of the variable-length columns, null for the others.
+  std::vector<std::unique_ptr<std::ofstream>> offset_files_;
+  /// The number of elements of every variable-length column written so far.
+  std::vector<uint64_t> lengths_;
+  uint64_t size_ = 0;
+  bool finished_ = false;
+};
+} // namespace datasets
+} // namespace data
+} // namespace torch
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <torch/types.h>
+
+#include <c10/util/Exception.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace detail {
+
+/// A fixed ring of preallocated batch buffers that tensors are stacked into,
+/// so that collating a batch doesn't allocate memory once the buffers are
+/// allocated.
+///
+/// A buffer is free again once the batch stacked into it is destroyed, i.e.
+/// once the ring holds the only reference to its storage. Worker threads claim
+/// free buffers with an atomic flag, without locking. If every buffer is still
+/// in use, e.g. because the batches are kept around, a new tensor is allocated
+/// for the batch instead, which is counted by `num_allocations()`.
+class BatchBufferRing {
+ public:
+  /// Creates a ring of `num_buffers` buffers, allocated on the first batches.
+  /// If `pin_memory` is true, the buffers of CPU tensors are allocated in
+  /// pinned memory, which requires CUDA.
+  BatchBufferRing(size_t num_buffers, bool pin_memory)
+      : num_buffers_(num_buffers), pin_memory_(pin_memory) {
+    TORCH_CHECK(num_buffers > 0, "BatchBufferRing needs at least one buffer");
+    buffers_.reset(new Buffer[num_buffers]);
+  }
+
+  /// Stacks `tensors` along a new first dimension, like `torch::stack()`,
+  /// into the next free buffer of the ring.
+  Tensor stack(const std::vector<Tensor>& tensors) {
+    TORCH_CHECK(!tensors.empty(), "Cannot stack an empty batch");
+    const auto& first = tensors.front();
+    std::vector<int64_t> sizes;
+    sizes.reserve(first.dim() + 1);
+    sizes.push_back(static_cast<int64_t>(tensors.size()));
+    sizes.insert(sizes.end(), first.sizes().begin(), first.sizes().end());
+    const auto options = first.options().pinned_memory(
+        pin_memory_ && first.device().is_cpu());
+
+    for (size_t i = 0; i < num_buffers_; ++i) {
+      auto& buffer = buffers_
+          [next_buffer_.fetch_add(1, std::memory_order_relaxed) % num_buffers_];
+      bool busy = false;
+      if (!buffer.busy.compare_exchange_strong(
+              busy, true, std::memory_order_acquire)) {
+        continue;
+      }
+      // A batch stacked into the buffer earlier is still alive.
+      if (buffer.tensor.defined() && buffer.tensor.storage().use_count() > 1) {
+        buffer.busy.store(false, std::memory_order_release);
+        continue;
+      }
+      if (!fits(buffer.tensor, sizes, options)) {
+        buffer.tensor = torch::empty(sizes, options);
+        num_allocations_.fetch_add(1, std::memory_order_relaxed);
+      }
+      auto batch = buffer.tensor.narrow(0, 0, sizes[0]);
+      torch::stack_out(batch, tensors);
+      buffer.busy.store(false, std::memory_order_release);
+      return batch;
+    }
+
+    num_allocations_.fetch_add(1, std::memory_order_relaxed);
+    auto batch = torch::empty(sizes, options);
+    torch::stack_out(batch, tensors);
+    return batch;
+  }
+
+  /// Returns the number of tensors allocated for the batches so far, whether
+  /// as buffers of the ring or because every buffer was in use.
+  size_t num_allocations() const noexcept {
+    return num_allocations_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Buffer {
+    /// Whether a worker thread is stacking into the buffer.
+    std::atomic<bool> busy{false};
+    Tensor tensor;
+  };
+
+  /// Whether a batch of `sizes` can be stacked into the first rows of
+  /// `tensor`.
+  static bool fits(
+      const Tensor& tensor,
+      const std::vector<int64_t>& sizes,
+      const TensorOptions& options) {
+    if (!tensor.defined() ||
+        tensor.dim() != static_cast<int64_t>(sizes.size()) ||
+        tensor.dtype() != options.dtype() ||
+        tensor.device() != options.device() || tensor.size(0) < sizes[0]) {
+      return false;
+    }
+    for (size_t d = 1; d < sizes.size(); ++d) {
+      if (tensor.size(d) != sizes[d]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  const size_t num_buffers_;
+  const bool pin_memory_;
+  std::unique_ptr<Buffer[]> buffers_;
+  std::atomic<size_t> next_buffer_{0};
+  std::atomic<size_t> num_allocations_{0};
+};
+} // namespace detail
+} // namespace data
+} // namespace torch
@@ -1,12 +1,13 @@
 #pragma once
 
-#include <torch/data/detail/queue.h>
+#include <torch/data/detail/lock_free_queue.h>
 #include <torch/types.h>
 
 #include <c10/util/Exception.h>
 #include <c10/util/Optional.h>
 
 #include <chrono>
+#include <cstddef>
 #include <utility>
 
 namespace torch {
@@ -22,9 +23,19 @@ namespace detail {
 /// dequeues a result is the count of in-flight jobs decremented. When the main
 /// thread attempts to dequeue a job but no jobs are in-flight, that means the
 /// epoch is complete and `pop_result` returns an empty optional.
+///
+/// The jobs and the results are passed through `LockFreeQueue`s, so that
+/// worker threads and the main thread only contend on a lock when one of them
+/// has to wait for the other. The queues must be large enough to hold all the
+/// jobs in flight, or `push_job()` blocks until a worker thread pops a job.
 template <typename Job, typename Result>
 class DataShuttle {
  public:
+  /// Creates a `DataShuttle` whose queues hold at most `capacity` jobs and
+  /// results each.
+  explicit DataShuttle(size_t capacity = kDefaultCapacity)
+      : new_jobs_(capacity), results_(capacity) {}
+
   /// Pushes a new job. Called by the main thread.
   void push_job(Job job) {
     new_jobs_.push(std::move(job));
@@ -73,13 +84,15 @@ class DataShuttle {
   }
 
  private:
+  static constexpr size_t kDefaultCapacity = 64;
+
   /// The queue for jobs that are not yet in flight.
-  Queue<Job> new_jobs_;
+  LockFreeQueue<Job> new_jobs_;
   /// The number of in-flight jobs.
   /// NOTE: Not atomic because only manipulated by the main thread.
   size_t in_flight_jobs_ = 0;
   /// The queue for results of finished jobs.
-  Queue<Result> results_;
+  LockFreeQueue<Result> results_;
 };
 
 } // namespace detail
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <torch/types.h>
+
+#include <c10/util/Exception.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace torch {
+namespace data {
+namespace detail {
+
+/// A bounded, blocking MPMC queue whose `push` and `pop` are lock-free as long
+/// as the queue is neither full nor empty.
+///
+/// The values are stored in a fixed ring of cells, each with a sequence number
+/// telling whether it is ready to be written or read at a given position, as
+/// in Dmitry Vyukov's bounded MPMC queue. Producers and consumers claim
+/// positions with a compare-and-swap, so the queue is never locked when
+/// batches are prefetched ahead of the main thread. Only threads that find the
+/// queue empty (or full) lock a mutex, to sleep on a condition variable until
+/// a value (or a free cell) is available.
+///
+/// Like `Queue`, this data structure is written specifically for use with the
+/// `DataLoader`. `T` must be default constructible and move assignable.
+template <typename T>
+class LockFreeQueue {
+ public:
+  /// Creates a queue holding at most `capacity` values, rounded up to a power
+  /// of two.
+  explicit LockFreeQueue(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) {
+      size *= 2;
+    }
+    mask_ = size - 1;
+    cells_.reset(new Cell[size]);
+    for (size_t i = 0; i < size; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  LockFreeQueue(const LockFreeQueue&) = delete;
+  LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
+  /// Pushes a new value to the back of the `LockFreeQueue`, blocking while the
+  /// queue is full, and wakes up one thread waiting inside `pop()`, if any.
+  void push(T value) {
+    if (!try_push(value)) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      waiting_pushers_.fetch_add(1);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      not_full_.wait(lock, [this, &value] { return this->try_push(value); });
+      waiting_pushers_.fetch_sub(1);
+    }
+    notify(waiting_poppers_, not_empty_);
+  }
+
+  /// Blocks until at least one element is ready to be popped from the front of
+  /// the queue. An optional `timeout` in seconds can be used to limit the time
+  /// spent waiting for an element. If the wait times out, an exception is
+  /// raised.
+  T pop(optional<std::chrono::milliseconds> timeout = nullopt) {
+    T value;
+    if (!try_pop(value)) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      waiting_poppers_.fetch_add(1);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      auto ready = [this, &value] { return this->try_pop(value); };
+      bool popped = true;
+      if (timeout) {
+        popped = not_empty_.wait_for(lock, *timeout, ready);
+      } else {
+        not_empty_.wait(lock, ready);
+      }
+      waiting_poppers_.fetch_sub(1);
+      if (!popped) {
+        // clang-format off
+        AT_ERROR(
+            "Timeout in DataLoader queue while waiting for next batch"
+            " (timeout was ", timeout->count(), " ms)");
+        // clang-format on
+      }
+    }
+    notify(waiting_pushers_, not_full_);
+    return value;
+  }
+
+  /// Empties the queue and returns the number of elements that were popped.
+  /// Only the threads blocked inside `push()` are notified about this event,
+  /// as it is assumed to be used to drain the queue during shutdown of a
+  /// `DataLoader`.
+  size_t clear() {
+    size_t size = 0;
+    T value;
+    while (try_pop(value)) {
+      ++size;
+    }
+    value = T();
+    if (size > 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      not_full_.notify_all();
+    }
+    return size;
+  }
+
+  /// Returns the maximum number of elements in the queue.
+  size_t capacity() const noexcept {
+    return mask_ + 1;
+  }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  /// Pushes `value` if the queue isn't full, without blocking.
+  bool try_push(T& value) {
+    size_t position = push_position_.load(std::memory_order_relaxed);
+    while (true) {
+      Cell& cell = cells_[position & mask_];
+      const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<intptr_t>(sequence) -
+          static_cast<intptr_t>(position);
+      if (diff == 0) {
+        if (push_position_.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          cell.value = std::move(value);
+          cell.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        // The cell still holds the value pushed one lap earlier.
+        return false;
+      } else {
+        position = push_position_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /// Pops into `value` if the queue isn't empty, without blocking.
+  bool try_pop(T& value) {
+    size_t position = pop_position_.load(std::memory_order_relaxed);
+    while (true) {
+      Cell& cell = cells_[position & mask_];
+      const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<intptr_t>(sequence) -
+          static_cast<intptr_t>(position + 1);
+      if (diff == 0) {
+        if (pop_position_.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          value = std::move(cell.value);
+          cell.value = T();
+          cell.sequence.store(position + mask_ + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        // Nothing was pushed at this position yet.
+        return false;
+      } else {
+        position = pop_position_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /// Wakes up one of the threads waiting on `condition`. The fence pairs with
+  /// the one of the waiting thread: either the waiting thread sees the cell
+  /// just pushed (or popped) when retrying, or this thread sees it waiting.
+  /// Locking the mutex ensures that it is blocked on `condition` by then.
+  void notify(
+      const std::atomic<size_t>& waiting,
+      std::condition_variable& condition) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting.load(std::memory_order_relaxed) > 0) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+      }
+      condition.notify_one();
+    }
+  }
+
+  /// Pads the positions to their own cache line, so that the producers and
+  /// consumers don't invalidate each other's caches when claiming cells.
+  static constexpr size_t kCacheLineSize = 64;
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t mask_;
+  char pad0_[kCacheLineSize];
+  std::atomic<size_t> push_position_{0};
+  char pad1_[kCacheLineSize - sizeof(std::atomic<size_t>)];
+  std::atomic<size_t> pop_position_{0};
+  char pad2_[kCacheLineSize - sizeof(std::atomic<size_t>)];
+
+  std::mutex mutex_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+  std::atomic<size_t> waiting_poppers_{0};
+  std::atomic<size_t> waiting_pushers_{0};
+};
+} // namespace detail
+} // namespace data
+} // namespace torch
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <torch/data/transforms/base.h>
+#include <torch/data/transforms/buffered_stack.h>
 #include <torch/data/transforms/collate.h>
 #include <torch/data/transforms/lambda.h>
 #include <torch/data/transforms/stack.h>
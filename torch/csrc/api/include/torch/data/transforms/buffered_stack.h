@@ -0,0 +1,109 @@
+#pragma once
+
+#include <torch/data/detail/batch_buffer_ring.h>
+#include <torch/data/example.h>
+#include <torch/data/transforms/collate.h>
+#include <torch/types.h>
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace transforms {
+
+template <typename T = Example<>>
+struct BufferedStack;
+
+/// A `Collation` for `Example<Tensor, Tensor>` types that stacks all data
+/// tensors into one tensor, and all target (label) tensors into one tensor,
+/// like `Stack`, but into a ring of preallocated buffers rather than into new
+/// tensors. The worker threads of a `DataLoader` then collate the batches
+/// without allocating memory, and with `pin_memory` the batches are ready to
+/// be copied to the GPU asynchronously.
+///
+/// The buffer of a batch is reused once the batch is destroyed, so
+/// `num_buffers` should be at least the number of batches prefetched by the
+/// `DataLoader` (its `max_jobs`) plus the number of batches kept alive at once,
+/// beyond which batches are allocated as usual. Copies of the transform,
+/// e.g. in the datasets of the worker threads, share the same buffers.
+///
+/// NOTE: A batch copied to the GPU with `non_blocking=true` must be kept alive
+/// until the copy is done, or the next batches may overwrite it while it is
+/// being copied.
+///
+/// \rst
+/// .. code-block:: cpp
+///   using namespace torch::data;
+///
+///   auto dataset = datasets::MNIST("path/to/mnist")
+///     .map(transforms::BufferedStack<>(
+///         /*num_buffers=*/8, /*pin_memory=*/true));
+/// \endrst
+template <>
+struct BufferedStack<Example<>> : public Collation<Example<>> {
+  explicit BufferedStack(size_t num_buffers, bool pin_memory = false)
+      : data_buffers_(std::make_shared<detail::BatchBufferRing>(
+            num_buffers,
+            pin_memory)),
+        target_buffers_(std::make_shared<detail::BatchBufferRing>(
+            num_buffers,
+            pin_memory)) {}
+
+  Example<> apply_batch(std::vector<Example<>> examples) override {
+    std::vector<torch::Tensor> data, targets;
+    data.reserve(examples.size());
+    targets.reserve(examples.size());
+    for (auto& example : examples) {
+      data.push_back(std::move(example.data));
+      targets.push_back(std::move(example.target));
+    }
+    return {data_buffers_->stack(data), target_buffers_->stack(targets)};
+  }
+
+  /// Returns the number of data and target tensors allocated so far, see
+  /// `detail::BatchBufferRing::num_allocations()`.
+  size_t num_allocations() const noexcept {
+    return data_buffers_->num_allocations() +
+        target_buffers_->num_allocations();
+  }
+
+ private:
+  std::shared_ptr<detail::BatchBufferRing> data_buffers_;
+  std::shared_ptr<detail::BatchBufferRing> target_buffers_;
+};
+
+/// A `Collation` for `Example<Tensor, NoTarget>` types that stacks all data
+/// tensors into one tensor, into a ring of preallocated buffers. See
+/// `BufferedStack<Example<>>`.
+template <>
+struct BufferedStack<TensorExample>
+    : public Collation<Example<Tensor, example::NoTarget>> {
+  explicit BufferedStack(size_t num_buffers, bool pin_memory = false)
+      : data_buffers_(std::make_shared<detail::BatchBufferRing>(
+            num_buffers,
+            pin_memory)) {}
+
+  TensorExample apply_batch(std::vector<TensorExample> examples) override {
+    std::vector<torch::Tensor> data;
+    data.reserve(examples.size());
+    for (auto& example : examples) {
+      data.push_back(std::move(example.data));
+    }
+    return data_buffers_->stack(data);
+  }
+
+  /// Returns the number of data tensors allocated so far, see
+  /// `detail::BatchBufferRing::num_allocations()`.
+  size_t num_allocations() const noexcept {
+    return data_buffers_->num_allocations();
+  }
+
+ private:
+  std::shared_ptr<detail::BatchBufferRing> data_buffers_;
+};
+} // namespace transforms
+} // namespace data
+} // namespace torch
@@ -44,6 +44,39 @@ struct Stack<TensorExample>
     return torch::stack(data);
   }
 };
+
+/// A `Collation` for examples made of a vector of tensors, such as those of a
+/// `ColumnarDataset`, that stacks the `i`-th tensors of all examples into the
+/// `i`-th tensor of the batch. The tensors of the same position must have the
+/// same shape in all examples.
+template <>
+struct Stack<std::vector<Tensor>> : public Collation<std::vector<Tensor>> {
+  std::vector<Tensor> apply_batch(
+      std::vector<std::vector<Tensor>> examples) override {
+    if (examples.empty()) {
+      return {};
+    }
+    const auto num_tensors = examples.front().size();
+    std::vector<Tensor> batch;
+    batch.reserve(num_tensors);
+    std::vector<Tensor> tensors;
+    tensors.reserve(examples.size());
+    for (size_t i = 0; i < num_tensors; ++i) {
+      tensors.clear();
+      for (auto& example : examples) {
+        TORCH_CHECK(
+            example.size() == num_tensors,
+            "Expected examples of ",
+            num_tensors,
+            " tensors, but got one of ",
+            example.size());
+        tensors.push_back(std::move(example[i]));
+      }
+      batch.push_back(torch::stack(tensors));
+    }
+    return batch;
+  }
+};
 } // namespace transforms
 } // namespace data
 } // namespace torch
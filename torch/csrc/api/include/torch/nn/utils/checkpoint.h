@@ -0,0 +1,130 @@
+#pragma once
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+#include <torch/nn/modules/container/sequential.h>
+#include <torch/types.h>
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace nn {
+namespace utils {
+
+/// Checkpoints `function`: runs it on `input` without saving anything for
+/// backward but `input`, and runs it again in backward to compute its
+/// gradients. This trades the memory of the activations of `function` for
+/// a second forward pass. The parameters used by `function` get their
+/// gradients accumulated when backward recomputes it.
+///
+/// If `preserve_rng_state` is true, the state of the random number generator
+/// of the device of `input` is restored before `function` is recomputed, so
+/// that random operations like dropout give the same results.
+///
+/// The gradients of the parameters used by `function` are only computed if
+/// `input` requires grad. See `checkpoint_sequential()` for a way around it.
+///
+/// Example:
+/// @code
+/// auto output = torch::nn::utils::checkpoint(
+///     [&](const torch::Tensor& x) { return block->forward(x); }, input);
+/// @endcode
+TORCH_API Tensor checkpoint(
+    std::function<Tensor(const Tensor&)> function,
+    const Tensor& input,
+    bool preserve_rng_state = true);
+
+/// The memory and time taken by the forward of a module of a `Sequential`,
+/// as measured by `profile_sequential()`.
+struct TORCH_API SequentialModuleProfile {
+  /// The bytes of the tensors the module saves for backward, besides its
+  /// parameters and the tensors already saved by the previous modules.
+  int64_t saved_bytes = 0;
+  /// The bytes of the output of the module.
+  int64_t output_bytes = 0;
+  /// The time taken by the forward of the module.
+  double forward_seconds = 0;
+};
+
+/// Runs the forward of every module of `sequential` on `input` with grad
+/// enabled, and measures the memory it saves for backward and its time. Note
+/// that this runs the modules as in training, e.g. updates the running stats
+/// of batch norm modules.
+TORCH_API std::vector<SequentialModuleProfile> profile_sequential(
+    const Sequential& sequential,
+    const Tensor& input);
+
+/// The modules of a `Sequential` to checkpoint, as ranges of consecutive
+/// modules, and the estimated cost of checkpointing them.
+struct TORCH_API CheckpointPlan {
+  /// The `[begin, end)` ranges of modules checkpointed together, in order.
+  std::vector<std::pair<size_t, size_t>> segments;
+  /// The estimated peak bytes of the tensors saved for backward, including
+  /// the activations backward recomputes.
+  int64_t estimated_bytes = 0;
+  /// The estimated time spent recomputing the forward of the segments.
+  double recompute_seconds = 0;
+};
+
+/// Picks the segments of modules to checkpoint so that the tensors saved for
+/// backward take at most `memory_budget` bytes, given the profile of the
+/// modules and the bytes of the input of the first one, while recomputing as
+/// little as possible.
+///
+/// The modules are split into a number of segments of about the same
+/// activation bytes, from one segment to one per module, and the segments
+/// saving the most memory per second of recompute are checkpointed first,
+/// until the budget is met, and those it is met without are then dropped.
+/// The plan meeting the budget with the least recompute across the numbers
+/// of segments is returned. If no plan meets the budget, a warning is issued
+/// and the plan taking the least memory is returned. No module is
+/// checkpointed if all fit in the budget.
+TORCH_API CheckpointPlan plan_checkpoint(
+    const std::vector<SequentialModuleProfile>& profiles,
+    int64_t input_bytes,
+    int64_t memory_budget);
+
+/// Profiles `sequential` on the sample `input`, see `profile_sequential()`,
+/// and picks the segments of modules to checkpoint to fit the tensors saved
+/// for backward in `memory_budget` bytes, see `plan_checkpoint()`.
+///
+/// Example:
+/// @code
+/// auto plan = torch::nn::utils::plan_checkpoint(model, sample, 1 << 30);
+/// for (auto& batch : *data_loader) {
+///   auto output = torch::nn::utils::checkpoint_sequential(
+///       model, plan, batch.data);
+///   ...
+/// }
+/// @endcode
+TORCH_API CheckpointPlan plan_checkpoint(
+    const Sequential& sequential,
+    const Tensor& input,
+    int64_t memory_budget);
+
+/// Runs `sequential` on `input`, checkpointing the segments of modules of
+/// `plan`, see `checkpoint()`.
+///
+/// If the input of a segment doesn't require grad, e.g. for the segment
+/// starting at the first module, the segment is checkpointed on a copy of its
+/// input requiring grad, so that the gradients of its parameters are still
+/// computed. Segments whose input isn't floating point are not checkpointed.
+TORCH_API Tensor checkpoint_sequential(
+    const Sequential& sequential,
+    const CheckpointPlan& plan,
+    const Tensor& input,
+    bool preserve_rng_state = true);
+
+/// Runs `sequential` on `input`, split in `segments` segments of about the
+/// same number of modules, all of which but the last are checkpointed.
+TORCH_API Tensor checkpoint_sequential(
+    const Sequential& sequential,
+    int64_t segments,
+    const Tensor& input,
+    bool preserve_rng_state = true);
+
+} // namespace utils
+} // namespace nn
+} // namespace torch
@@ -0,0 +1,528 @@
+#include <torch/data/datasets/columnar.h>
+
+#include <torch/types.h>
+
+#include <TH/THAllocator.h>
+#include <c10/util/Exception.h>
+
+#if defined(HAVE_MMAP)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace datasets {
+namespace {
+constexpr char kMagic[8] = {'T', 'O', 'R', 'C', 'H', 'C', 'O', 'L'};
+constexpr uint32_t kVersion = 1;
+constexpr uint64_t kAlignment = 64;
+
+bool check_is_little_endian() {
+  const uint32_t word = 1;
+  return reinterpret_cast<const uint8_t*>(&word)[0] == 1;
+}
+
+void check_little_endian() {
+  static const bool is_little_endian = check_is_little_endian();
+  TORCH_CHECK(
+      is_little_endian,
+      "Columnar datasets are only supported on little-endian machines");
+}
+
+uint64_t align(uint64_t offset) {
+  return (offset + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+#if defined(HAVE_MMAP)
+struct ReadOnlyMapping {
+  void* base;
+  size_t size;
+};
+
+void delete_read_only_mapping(void* context) {
+  auto* mapping = static_cast<ReadOnlyMapping*>(context);
+  munmap(mapping->base, mapping->size);
+  delete mapping;
+}
+#endif
+
+/// Maps the whole file at `path` read-only. The mapping shares the pages of
+/// the page cache, so no memory or swap is reserved for it and files larger
+/// than both can be mapped.
+DataPtr map_file_read_only(const std::string& path, size_t* nbytes) {
+#if defined(HAVE_MMAP)
+  const int fd = open(path.c_str(), O_RDONLY);
+  TORCH_CHECK(
+      fd != -1,
+      "Error opening the columnar dataset file ",
+      path,
+      ": ",
+      std::strerror(errno));
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) == -1) {
+    const auto error = errno;
+    close(fd);
+    TORCH_CHECK(
+        false,
+        "Error reading the size of the columnar dataset file ",
+        path,
+        ": ",
+        std::strerror(error));
+  }
+  *nbytes = file_stat.st_size;
+  if (*nbytes == 0) {
+    // Can't be mapped, and fails as a truncated header
+    close(fd);
+    return DataPtr(nullptr, Device(DeviceType::CPU));
+  }
+  void* base = mmap(nullptr, *nbytes, PROT_READ, MAP_SHARED, fd, 0);
+  const auto error = errno;
+  close(fd);
+  TORCH_CHECK(
+      base != MAP_FAILED,
+      "Error mapping the columnar dataset file ",
+      path,
+      ": ",
+      std::strerror(error));
+  return DataPtr(
+      base,
+      new ReadOnlyMapping{base, *nbytes},
+      &delete_read_only_mapping,
+      Device(DeviceType::CPU));
+#else
+  // A copy-on-write mapping of the file opened read-only
+  return THMapAllocator::makeDataPtr(path.c_str(), 0, 0, nbytes);
+#endif
+}
+
+/// Reads the header of a columnar file out of its mapping, checking that
+/// nothing is read past its end.
+class HeaderReader {
+ public:
+  HeaderReader(const char* data, size_t size, const std::string& path)
+      : data_(data), size_(size), path_(path) {}
+
+  template <typename T>
+  T read() {
+    T value;
+    std::memcpy(&value, read_bytes(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  std::string read_string(size_t length) {
+    return std::string(read_bytes(length), length);
+  }
+
+ private:
+  const char* read_bytes(size_t length) {
+    TORCH_CHECK(
+        length <= size_ - offset_,
+        "Unexpected end of the header of the columnar dataset file ",
+        path_);
+    const char* bytes = data_ + offset_;
+    offset_ += length;
+    return bytes;
+  }
+
+  const char* data_;
+  size_t size_;
+  size_t offset_ = 0;
+  const std::string& path_;
+};
+
+/// Returns a tensor of `sizes` viewing the bytes of `storage` at `offset`.
+Tensor view_storage(
+    const Storage& storage,
+    uint64_t offset,
+    ScalarType dtype,
+    IntArrayRef sizes,
+    const std::string& path) {
+  // The sizes are read from the file, so they are checked for overflows.
+  const uint64_t itemsize = elementSize(dtype);
+  for (const auto size : sizes) {
+    TORCH_CHECK(
+        size >= 0,
+        "A column of the columnar dataset file ",
+        path,
+        " has an invalid shape ",
+        sizes);
+  }
+  uint64_t nbytes = 0;
+  if (std::find(sizes.begin(), sizes.end(), 0) == sizes.end()) {
+    nbytes = itemsize;
+    for (const auto size : sizes) {
+      TORCH_CHECK(
+          nbytes <= std::numeric_limits<uint64_t>::max() / size,
+          "A column of the columnar dataset file ",
+          path,
+          " is out of the bounds of the file");
+      nbytes *= size;
+    }
+  }
+  TORCH_CHECK(
+      offset % itemsize == 0 && offset <= storage.nbytes() &&
+          nbytes <= storage.nbytes() - offset,
+      "A column of the columnar dataset file ",
+      path,
+      " is out of the bounds of the file");
+  return torch::empty({0}, torch::dtype(dtype))
+      .set_(storage, offset / itemsize, sizes);
+}
+
+void write_bytes(std::ofstream& stream, const void* data, size_t size) {
+  stream.write(static_cast<const char*>(data), size);
+}
+
+template <typename T>
+void write_value(std::ofstream& stream, T value) {
+  write_bytes(stream, &value, sizeof(T));
+}
+
+void pad_to(std::ofstream& stream, uint64_t offset) {
+  const auto position = static_cast<uint64_t>(stream.tellp());
+  TORCH_INTERNAL_ASSERT(position <= offset && offset - position < kAlignment);
+  static const char kZeros[kAlignment] = {};
+  write_bytes(stream, kZeros, offset - position);
+}
+
+void append_file(std::ofstream& stream, const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  TORCH_CHECK(file, "Error opening the temporary file ", path);
+  std::vector<char> buffer(1 << 20);
+  while (file.read(buffer.data(), buffer.size()) || file.gcount() > 0) {
+    write_bytes(stream, buffer.data(), file.gcount());
+  }
+}
+} // namespace
+
+ColumnarDataset::ColumnarDataset(
+    const std::string& path,
+    const std::vector<std::string>& columns,
+    bool zero_copy)
+    : zero_copy_(zero_copy) {
+  check_little_endian();
+  // A read-only mapping of the whole file, shared by all the tensors
+  size_t nbytes = 0;
+  auto data_ptr = map_file_read_only(path, &nbytes);
+  Storage storage(
+      Storage::use_byte_size_t(),
+      nbytes,
+      std::move(data_ptr),
+      /*allocator=*/nullptr,
+      /*resizable=*/false);
+
+  HeaderReader header(static_cast<const char*>(storage.data()), nbytes, path);
+  TORCH_CHECK(
+      header.read_string(sizeof(kMagic)) ==
+          std::string(kMagic, sizeof(kMagic)),
+      path,
+      " is not a columnar dataset file");
+  const auto version = header.read<uint32_t>();
+  TORCH_CHECK(
+      version == kVersion,
+      "Unsupported version ",
+      version,
+      " of the columnar dataset file ",
+      path);
+  const auto num_columns = header.read<uint32_t>();
+  size_ = header.read<uint64_t>();
+
+  std::vector<ColumnarColumn> all_columns;
+  std::vector<Tensor> all_data, all_offsets;
+  for (uint32_t c = 0; c < num_columns; ++c) {
+    ColumnarColumn column;
+    column.name = header.read_string(header.read<uint32_t>());
+    column.variable_length = header.read<uint8_t>() != 0;
+    const auto dtype = header.read<int8_t>();
+    TORCH_CHECK(
+        dtype >= 0 && dtype < static_cast<int8_t>(ScalarType::Undefined),
+        "Invalid type of the column ",
+        column.name,
+        " of the columnar dataset file ",
+        path);
+    column.dtype = static_cast<ScalarType>(dtype);
+    const auto ndim = header.read<uint32_t>();
+    for (uint32_t d = 0; d < ndim; ++d) {
+      column.shape.push_back(header.read<int64_t>());
+    }
+    const auto data_offset = header.read<uint64_t>();
+    const auto offsets_offset = header.read<uint64_t>();
+
+    std::vector<int64_t> sizes;
+    Tensor offsets;
+    if (column.variable_length) {
+      offsets = view_storage(
+          storage,
+          offsets_offset,
+          ScalarType::Long,
+          {static_cast<int64_t>(size_) + 1},
+          path);
+      sizes.push_back(offsets.data_ptr<int64_t>()[size_]);
+    } else {
+      sizes.push_back(static_cast<int64_t>(size_));
+    }
+    sizes.insert(sizes.end(), column.shape.begin(), column.shape.end());
+    all_data.push_back(
+        view_storage(storage, data_offset, column.dtype, sizes, path));
+    all_offsets.push_back(std::move(offsets));
+    all_columns.push_back(std::move(column));
+  }
+
+  if (columns.empty()) {
+    columns_ = std::move(all_columns);
+    data_ = std::move(all_data);
+    offsets_ = std::move(all_offsets);
+    return;
+  }
+  for (const auto& name : columns) {
+    auto it = std::find_if(
+        all_columns.begin(),
+        all_columns.end(),
+        [&name](const ColumnarColumn& column) { return column.name == name; });
+    TORCH_CHECK(
+        it != all_columns.end(),
+        "No column named ",
+        name,
+        " in the columnar dataset file ",
+        path);
+    const auto c = it - all_columns.begin();
+    columns_.push_back(*it);
+    data_.push_back(all_data[c]);
+    offsets_.push_back(all_offsets[c]);
+  }
+}
+
+std::vector<Tensor> ColumnarDataset::get(size_t index) {
+  TORCH_CHECK(
+      index < size_,
+      "Index ",
+      index,
+      " is out of range for a columnar dataset of size ",
+      size_);
+  std::vector<Tensor> example;
+  example.reserve(columns_.size());
+  for (size_t c = 0; c < columns_.size(); ++c) {
+    Tensor tensor;
+    if (columns_[c].variable_length) {
+      const auto* offsets = offsets_[c].data_ptr<int64_t>();
+      tensor = data_[c].narrow(
+          0, offsets[index], offsets[index + 1] - offsets[index]);
+    } else {
+      tensor = data_[c][index];
+    }
+    example.push_back(zero_copy_ ? std::move(tensor) : tensor.clone());
+  }
+  return example;
+}
+
+optional<size_t> ColumnarDataset::size() const {
+  return size_;
+}
+
+const std::vector<ColumnarColumn>& ColumnarDataset::columns() const noexcept {
+  return columns_;
+}
+
+const Tensor& ColumnarDataset::column_data(size_t column) const {
+  return data_.at(column);
+}
+
+ColumnarWriter::ColumnarWriter(
+    std::string path,
+    std::vector<ColumnarColumn> columns)
+    : path_(std::move(path)),
+      columns_(std::move(columns)),
+      lengths_(columns_.size(), 0) {
+  check_little_endian();
+  try {
+    for (size_t c = 0; c < columns_.size(); ++c) {
+      data_files_.push_back(std::make_unique<std::ofstream>(
+          column_path(c, "data"), std::ios::binary));
+      TORCH_CHECK(
+          *data_files_.back(),
+          "Error opening the temporary file ",
+          column_path(c, "data"));
+      if (columns_[c].variable_length) {
+        offset_files_.push_back(std::make_unique<std::ofstream>(
+            column_path(c, "offsets"), std::ios::binary));
+        TORCH_CHECK(
+            *offset_files_.back(),
+            "Error opening the temporary file ",
+            column_path(c, "offsets"));
+        write_value<uint64_t>(*offset_files_.back(), 0);
+      } else {
+        offset_files_.emplace_back();
+      }
+    }
+  } catch (...) {
+    // The destructor doesn't run if the constructor throws.
+    remove_column_files();
+    throw;
+  }
+}
+
+ColumnarWriter::~ColumnarWriter() {
+  if (!finished_) {
+    remove_column_files();
+  }
+}
+
+void ColumnarWriter::write(const std::vector<Tensor>& example) {
+  TORCH_CHECK(!finished_, "Cannot write to a finished ColumnarWriter");
+  TORCH_CHECK(
+      example.size() == columns_.size(),
+      "Expected an example of ",
+      columns_.size(),
+      " tensors, one per column, but got ",
+      example.size());
+  for (size_t c = 0; c < columns_.size(); ++c) {
+    const auto& column = columns_[c];
+    const auto& tensor = example[c];
+    TORCH_CHECK(
+        tensor.device().is_cpu() && tensor.scalar_type() == column.dtype,
+        "Expected a CPU tensor of type ",
+        column.dtype,
+        " for the column ",
+        column.name,
+        " but got ",
+        tensor.toString());
+    auto sizes = tensor.sizes();
+    if (column.variable_length) {
+      TORCH_CHECK(
+          tensor.dim() > 0,
+          "Expected a tensor of at least one dimension for the column ",
+          column.name);
+      sizes = sizes.slice(1);
+    }
+    TORCH_CHECK(
+        sizes == IntArrayRef(column.shape),
+        "Expected a tensor of shape ",
+        IntArrayRef(column.shape),
+        column.variable_length ? " after its first dimension" : "",
+        " for the column ",
+        column.name,
+        " but got ",
+        tensor.sizes());
+  }
+
+  for (size_t c = 0; c < columns_.size(); ++c) {
+    const auto tensor = example[c].contiguous();
+    write_bytes(*data_files_[c], tensor.data_ptr(), tensor.nbytes());
+    TORCH_CHECK(*data_files_[c], "Error writing ", column_path(c, "data"));
+    if (columns_[c].variable_length) {
+      lengths_[c] += tensor.size(0);
+      write_value(*offset_files_[c], lengths_[c]);
+    }
+  }
+  ++size_;
+}
+
+void ColumnarWriter::finish() {
+  TORCH_CHECK(!finished_, "ColumnarWriter::finish() was already called");
+  for (size_t c = 0; c < columns_.size(); ++c) {
+    data_files_[c]->close();
+    if (offset_files_[c]) {
+      offset_files_[c]->close();
+    }
+  }
+
+  // The header, then the data and the offsets of the columns, at aligned
+  // offsets.
+  uint64_t header_size = sizeof(kMagic) + sizeof(kVersion) +
+      sizeof(uint32_t) + sizeof(uint64_t);
+  for (const auto& column : columns_) {
+    header_size += sizeof(uint32_t) + column.name.size() + sizeof(uint8_t) +
+        sizeof(int8_t) + sizeof(uint32_t) +
+        column.shape.size() * sizeof(int64_t) + 2 * sizeof(uint64_t);
+  }
+  std::vector<uint64_t> data_offsets, offsets_offsets;
+  uint64_t offset = header_size;
+  for (size_t c = 0; c < columns_.size(); ++c) {
+    offset = align(offset);
+    data_offsets.push_back(offset);
+    const auto& column = columns_[c];
+    uint64_t numel = column.variable_length ? lengths_[c] : size_;
+    for (const auto dim : column.shape) {
+      numel *= dim;
+    }
+    offset += numel * elementSize(column.dtype);
+  }
+  for (size_t c = 0; c < columns_.size(); ++c) {
+    if (columns_[c].variable_length) {
+      offset = align(offset);
+      offsets_offsets.push_back(offset);
+      offset += (size_ + 1) * sizeof(uint64_t);
+    } else {
+      offsets_offsets.push_back(0);
+    }
+  }
+
+  std::ofstream file(path_, std::ios::binary);
+  TORCH_CHECK(file, "Error opening the columnar dataset file ", path_);
+  write_bytes(file, kMagic, sizeof(kMagic));
+  write_value(file, kVersion);
+  write_value(file, static_cast<uint32_t>(columns_.size()));
+  write_value(file, size_);
+  for (size_t c = 0; c < columns_.size(); ++c) {
+    const auto& column = columns_[c];
+    write_value(file, static_cast<uint32_t>(column.name.size()));
+    write_bytes(file, column.name.data(), column.name.size());
+    write_value(file, static_cast<uint8_t>(column.variable_length));
+    write_value(file, static_cast<int8_t>(column.dtype));
+    write_value(file, static_cast<uint32_t>(column.shape.size()));
+    for (const auto dim : column.shape) {
+      write_value(file, dim);
+    }
+    write_value(file, data_offsets[c]);
+    write_value(file, offsets_offsets[c]);
+  }
+  for (size_t c = 0; c < columns_.size(); ++c) {
+    pad_to(file, data_offsets[c]);
+    append_file(file, column_path(c, "data"));
+  }
+  for (size_t c = 0; c < columns_.size(); ++c) {
+    if (columns_[c].variable_length) {
+      pad_to(file, offsets_offsets[c]);
+      append_file(file, column_path(c, "offsets"));
+    }
+  }
+  TORCH_CHECK(
+      file && static_cast<uint64_t>(file.tellp()) == offset,
+      "Error writing the columnar dataset file ",
+      path_);
+  remove_column_files();
+  finished_ = true;
+}
+
+std::string ColumnarWriter::column_path(size_t column, const char* suffix)
+    const {
+  return c10::str(path_, ".column", column, ".", suffix, ".tmp");
+}
+
+void ColumnarWriter::remove_column_files() {
+  // Only the files opened so far if the constructor failed.
+  for (size_t c = 0; c < data_files_.size(); ++c) {
+    data_files_[c]->close();
+    std::remove(column_path(c, "data").c_str());
+    if (c < offset_files_.size() && offset_files_[c]) {
+      offset_files_[c]->close();
+      std::remove(column_path(c, "offsets").c_str());
+    }
+  }
+}
+} // namespace datasets
+} // namespace data
+} // namespace torch
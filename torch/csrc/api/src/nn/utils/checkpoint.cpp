@@ -0,0 +1,411 @@
+#include <torch/nn/utils/checkpoint.h>
+
+#include <torch/csrc/autograd/autograd.h>
+#include <torch/csrc/autograd/custom_function.h>
+#include <torch/csrc/autograd/saved_variable_hooks.h>
+
+#include <ATen/Context.h>
+#include <c10/util/Exception.h>
+#include <c10/util/Optional.h>
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <numeric>
+#include <unordered_set>
+
+using namespace torch::autograd;
+
+namespace torch {
+namespace nn {
+namespace utils {
+namespace {
+
+// The state of the default random number generator of a device.
+struct RngState {
+  explicit RngState(Device device)
+      : generator(at::globalContext().defaultGenerator(device)) {
+    // See Note [Acquire lock when using random generators]
+    std::lock_guard<std::mutex> lock(generator.mutex());
+    state = generator.get_state();
+  }
+
+  void restore() {
+    std::lock_guard<std::mutex> lock(generator.mutex());
+    generator.set_state(state);
+  }
+
+  at::Generator generator;
+  Tensor state;
+};
+
+// Sets the states of the random number generators to the given ones for its
+// lifetime.
+struct RngStateGuard {
+  explicit RngStateGuard(std::vector<RngState>& states) {
+    for (auto& state : states) {
+      prev_states_.emplace_back(state.generator.device());
+      state.restore();
+    }
+  }
+
+  ~RngStateGuard() {
+    for (auto& state : prev_states_) {
+      state.restore();
+    }
+  }
+
+ private:
+  std::vector<RngState> prev_states_;
+};
+
+// What backward needs to recompute a checkpointed function.
+struct CheckpointState : public torch::CustomClassHolder {
+  std::function<Tensor(const Tensor&)> function;
+  std::vector<RngState> rng_states;
+};
+
+struct CheckpointFunction : public Function<CheckpointFunction> {
+  static Variable forward(
+      AutogradContext* ctx,
+      c10::intrusive_ptr<CheckpointState> state,
+      const Variable& input) {
+    auto output = state->function(input);
+    ctx->save_for_backward({input});
+    ctx->saved_data["state"] = IValue::make_capsule(std::move(state));
+    return output;
+  }
+
+  static variable_list backward(
+      AutogradContext* ctx,
+      variable_list grad_output) {
+    auto capsule = ctx->saved_data["state"].toCapsule();
+    auto& state = static_cast<CheckpointState&>(*capsule);
+    const auto saved = ctx->get_saved_variables();
+    auto input = saved[0].detach().requires_grad_(saved[0].requires_grad());
+
+    Variable output;
+    {
+      RngStateGuard rng_guard(state.rng_states);
+      at::AutoGradMode enable_grad(true);
+      output = state.function(input);
+    }
+    TORCH_CHECK(
+        output.requires_grad(),
+        "The output of the checkpointed function doesn't require grad");
+    torch::autograd::backward({output}, {grad_output[0]});
+    return {Variable(), input.grad()};
+  }
+};
+
+// Counts the bytes of the tensors saved for backward, once per storage.
+struct SavedBytesCounter : public SavedVariableHooks {
+  std::unique_ptr<PackedVariable> pack(const at::Tensor& data) override {
+    if (!data.has_storage()) {
+      bytes += data.numel() * data.element_size();
+    } else if (storages.insert(data.storage().unsafeGetStorageImpl()).second) {
+      bytes += data.storage().nbytes();
+    }
+    return nullptr;
+  }
+
+  std::unordered_set<const c10::StorageImpl*> storages;
+  int64_t bytes = 0;
+};
+
+int64_t nbytes(const Tensor& tensor) {
+  return tensor.numel() * tensor.element_size();
+}
+
+Tensor forward_modules(
+    const std::shared_ptr<SequentialImpl>& sequential,
+    size_t begin,
+    size_t end,
+    Tensor input) {
+  for (auto module = sequential->begin() + begin;
+       module != sequential->begin() + end;
+       ++module) {
+    input = module->forward(input);
+  }
+  return input;
+}
+
+// Estimates the peak bytes of the tensors saved for backward and the time of
+// the recompute when checkpointing `segments`. The peak is either at the end
+// of forward, or when backward recomputes a segment, once the tensors saved
+// by the following modules are released.
+CheckpointPlan make_plan(
+    const std::vector<SequentialModuleProfile>& profiles,
+    int64_t input_bytes,
+    std::vector<std::pair<size_t, size_t>> segments) {
+  std::sort(segments.begin(), segments.end());
+  CheckpointPlan plan;
+  int64_t saved_bytes = 0;
+  int64_t peak_bytes = 0;
+  size_t module = 0;
+  auto segment = segments.begin();
+  while (module < profiles.size()) {
+    if (segment == segments.end() || module < segment->first) {
+      saved_bytes += profiles[module].saved_bytes;
+      module++;
+      continue;
+    }
+    const auto segment_input_bytes =
+        module == 0 ? input_bytes : profiles[module - 1].output_bytes;
+    int64_t segment_bytes = 0;
+    for (; module < segment->second; module++) {
+      segment_bytes += profiles[module].saved_bytes;
+      plan.recompute_seconds += profiles[module].forward_seconds;
+    }
+    saved_bytes += segment_input_bytes;
+    peak_bytes = std::max(peak_bytes, saved_bytes + segment_bytes);
+    ++segment;
+  }
+  plan.estimated_bytes = std::max(peak_bytes, saved_bytes);
+  plan.segments = std::move(segments);
+  return plan;
+}
+
+// Splits the modules in `num_segments` segments of about the same saved bytes.
+std::vector<std::pair<size_t, size_t>> split_modules(
+    const std::vector<SequentialModuleProfile>& profiles,
+    size_t num_segments) {
+  // Modules saving nothing still weigh a little, to be spread evenly.
+  auto weight = [](const SequentialModuleProfile& profile) {
+    return static_cast<double>(profile.saved_bytes) + 1;
+  };
+  double total = 0;
+  for (const auto& profile : profiles) {
+    total += weight(profile);
+  }
+  std::vector<std::pair<size_t, size_t>> segments;
+  size_t begin = 0;
+  double cumulative = 0;
+  for (size_t i = 0; i < profiles.size(); i++) {
+    cumulative += weight(profiles[i]);
+    const auto remaining_modules = profiles.size() - i - 1;
+    const auto remaining_segments = num_segments - segments.size() - 1;
+    if (remaining_segments == 0) {
+      continue;
+    }
+    if (cumulative * num_segments >= total * (segments.size() + 1) ||
+        remaining_modules == remaining_segments) {
+      segments.emplace_back(begin, i + 1);
+      begin = i + 1;
+    }
+  }
+  segments.emplace_back(begin, profiles.size());
+  return segments;
+}
+
+} // namespace
+
+Tensor checkpoint(
+    std::function<Tensor(const Tensor&)> function,
+    const Tensor& input,
+    bool preserve_rng_state) {
+  if (!GradMode::is_enabled()) {
+    return function(input);
+  }
+  auto state = c10::make_intrusive<CheckpointState>();
+  state->function = std::move(function);
+  if (preserve_rng_state) {
+    state->rng_states.emplace_back(Device(kCPU));
+    if (input.is_cuda()) {
+      state->rng_states.emplace_back(input.device());
+    }
+  }
+  return CheckpointFunction::apply(std::move(state), input);
+}
+
+std::vector<SequentialModuleProfile> profile_sequential(
+    const Sequential& sequential,
+    const Tensor& input) {
+  const auto& impl = sequential.ptr();
+  TORCH_CHECK(!impl->is_empty(), "Cannot profile an empty Sequential");
+  auto counter = std::make_shared<SavedBytesCounter>();
+  // Parameters saved as is don't go through the hooks, but their views like
+  // the transposed weight of linear modules do.
+  for (const auto& parameter : impl->parameters()) {
+    if (parameter.has_storage()) {
+      counter->storages.insert(parameter.storage().unsafeGetStorageImpl());
+    }
+  }
+  SavedVariableHooksGuard hooks_guard(counter);
+  at::AutoGradMode enable_grad(true);
+
+  std::vector<SequentialModuleProfile> profiles;
+  profiles.reserve(impl->size());
+  // The outputs keep the graph, and so the counted storages, alive.
+  auto output = input;
+  for (auto& module : *impl) {
+    SequentialModuleProfile profile;
+    const auto bytes_before = counter->bytes;
+    const auto start = std::chrono::steady_clock::now();
+    output = module.forward(output);
+    profile.forward_seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    profile.saved_bytes = counter->bytes - bytes_before;
+    profile.output_bytes = nbytes(output);
+    profiles.push_back(profile);
+  }
+  return profiles;
+}
+
+CheckpointPlan plan_checkpoint(
+    const std::vector<SequentialModuleProfile>& profiles,
+    int64_t input_bytes,
+    int64_t memory_budget) {
+  TORCH_CHECK(!profiles.empty(), "Cannot plan the checkpoint of no modules");
+  const auto no_checkpoint = make_plan(profiles, input_bytes, {});
+  if (no_checkpoint.estimated_bytes <= memory_budget) {
+    return no_checkpoint;
+  }
+
+  c10::optional<CheckpointPlan> best;
+  auto smallest = no_checkpoint;
+  for (size_t num_segments = 1; num_segments <= profiles.size();
+       num_segments++) {
+    const auto segments = split_modules(profiles, num_segments);
+    // The bytes each segment saves when checkpointed, per second of
+    // recompute.
+    std::vector<double> ratios;
+    for (const auto& segment : segments) {
+      double seconds = 0;
+      int64_t saved_bytes = 0;
+      for (auto module = segment.first; module < segment.second; module++) {
+        seconds += profiles[module].forward_seconds;
+        saved_bytes += profiles[module].saved_bytes;
+      }
+      const auto segment_input_bytes = segment.first == 0
+          ? input_bytes
+          : profiles[segment.first - 1].output_bytes;
+      ratios.push_back(
+          (saved_bytes - segment_input_bytes) / std::max(seconds, 1e-9));
+    }
+    std::vector<size_t> order(segments.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      return ratios[a] > ratios[b];
+    });
+
+    std::vector<std::pair<size_t, size_t>> selected;
+    auto plan = no_checkpoint;
+    for (const auto index : order) {
+      if (ratios[index] <= 0) {
+        break;
+      }
+      selected.push_back(segments[index]);
+      plan = make_plan(profiles, input_bytes, selected);
+      if (plan.estimated_bytes <= memory_budget) {
+        break;
+      }
+    }
+    // Drop the segments the budget is met without, least worthwhile first.
+    for (size_t i = selected.size(); i-- > 0 &&
+         plan.estimated_bytes <= memory_budget;) {
+      auto without = selected;
+      without.erase(without.begin() + i);
+      auto candidate = make_plan(profiles, input_bytes, without);
+      if (candidate.estimated_bytes <= memory_budget) {
+        selected = std::move(without);
+        plan = std::move(candidate);
+      }
+    }
+
+    if (plan.estimated_bytes < smallest.estimated_bytes) {
+      smallest = plan;
+    }
+    if (plan.estimated_bytes <= memory_budget &&
+        (!best || plan.recompute_seconds < best->recompute_seconds)) {
+      best = std::move(plan);
+    }
+  }
+  if (best) {
+    return *best;
+  }
+  TORCH_WARN(
+      "No checkpoint plan fits the tensors saved for backward in ",
+      memory_budget,
+      " bytes, using the one taking the least memory, estimated to ",
+      smallest.estimated_bytes,
+      " bytes");
+  return smallest;
+}
+
+CheckpointPlan plan_checkpoint(
+    const Sequential& sequential,
+    const Tensor& input,
+    int64_t memory_budget) {
+  return plan_checkpoint(
+      profile_sequential(sequential, input), nbytes(input), memory_budget);
+}
+
+Tensor checkpoint_sequential(
+    const Sequential& sequential,
+    const CheckpointPlan& plan,
+    const Tensor& input,
+    bool preserve_rng_state) {
+  const auto& impl = sequential.ptr();
+  TORCH_CHECK(
+      !impl->is_empty(),
+      "Cannot call checkpoint_sequential() on an empty Sequential");
+  auto output = input;
+  size_t next = 0;
+  for (const auto& segment : plan.segments) {
+    TORCH_CHECK(
+        segment.first >= next && segment.first < segment.second &&
+            segment.second <= impl->size(),
+        "Invalid checkpoint segment [",
+        segment.first,
+        ", ",
+        segment.second,
+        ") for a Sequential of ",
+        impl->size(),
+        " modules");
+    output = forward_modules(impl, next, segment.first, std::move(output));
+    if (GradMode::is_enabled() && !output.requires_grad()) {
+      // The gradients of the parameters of the segment are only computed by
+      // the recompute if its input requires grad.
+      if (!output.is_floating_point()) {
+        output = forward_modules(
+            impl, segment.first, segment.second, std::move(output));
+        next = segment.second;
+        continue;
+      }
+      output = output.detach().requires_grad_();
+    }
+    output = checkpoint(
+        [impl, segment](const Tensor& x) {
+          return forward_modules(impl, segment.first, segment.second, x);
+        },
+        output,
+        preserve_rng_state);
+    next = segment.second;
+  }
+  return forward_modules(impl, next, impl->size(), std::move(output));
+}
+
+Tensor checkpoint_sequential(
+    const Sequential& sequential,
+    int64_t segments,
+    const Tensor& input,
+    bool preserve_rng_state) {
+  const auto size = static_cast<int64_t>(sequential->size());
+  TORCH_CHECK(
+      segments > 0 && segments <= size,
+      "The number of segments must be between 1 and the number of modules (",
+      size,
+      "), got ",
+      segments);
+  const auto segment_size = size / segments;
+  CheckpointPlan plan;
+  for (int64_t i = 0; i < segments - 1; i++) {
+    plan.segments.emplace_back(i * segment_size, (i + 1) * segment_size);
+  }
+  return checkpoint_sequential(sequential, plan, input, preserve_rng_state);
+}
+
+} // namespace utils
+} // namespace nn
+} // namespace torch
@@ -72,6 +72,11 @@ static thread_local bool checkpoint_valid = true;
 // Number of nested reentrant backwards calls currently on this thread
 static thread_local int current_depth = 0;
 
+// Whether this thread is a CPU worker thread, popping tasks from the
+// cpu_ready_queue_ of GraphTasks it doesn't own.
+// See Note [Parallel CPU backward]
+static thread_local bool in_cpu_worker_thread = false;
+
 // For all device threads (i.e. CUDA, XLA), total_depth represents the total nested
 //   reentrant backwards depths over all device threads.
 // For CPU devices, it is the total depth associated with the original backward call.
@@ -97,6 +102,10 @@ static thread_local std::shared_ptr<GraphTask> current_graph_task = nullptr;
 // see Note [Reentrant backwards] for more details.
 static thread_local std::shared_ptr<ReadyQueue> local_ready_queue = nullptr;
 
+// The task this thread executes next, bypassing local_ready_queue.
+// See Note [Next local task]
+static thread_local c10::optional<NodeTask> next_local_task;
+
 // Note [Reentrant backwards]
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~
 // To understand the reentrant backwards problem, we have to notice two
@@ -156,6 +165,52 @@ static thread_local std::shared_ptr<ReadyQueue> local_ready_queue = nullptr;
 // the leaf streams with the default streams is sufficient to implement
 // the historic behavior.
 
+// Note [Parallel CPU backward]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// By default, the CPU tasks of a backward call are all executed by the thread
+// that called it, one at a time. When Engine::set_num_cpu_worker_threads() is
+// given a positive number, that many threads of a pool shared by all backward
+// calls also pop tasks from the cpu_ready_queue_ of the GraphTask, so that
+// independent branches of the graph (e.g. the towers of a multi-tower model)
+// run concurrently.
+//
+// The bookkeeping in evaluate_function() is already done under the mutex of
+// the GraphTask, but with several threads the order in which the producers of
+// a gradient finish is not deterministic, and neither would be the result of
+// summing their outputs. The gradients are therefore only recorded in the
+// InputBuffer as they arrive, and summed once all of them are there, in
+// decreasing order of the sequence number of their producer, which is the
+// order in which a single thread would usually have run them.
+//
+// The owning thread still drives the GraphTask and exits thread_main once it
+// completes, whether or not any worker thread picked it up. Once the future of
+// the GraphTask is completed, the thread noticing it pushes a dummy task for
+// the owning thread and each worker thread, which may be sleeping on pop().
+// Reentrant backward calls made by any of these threads get a ready queue of
+// their own instead of sharing cpu_ready_queue_ with the other threads, which
+// could otherwise take over the tasks the calling thread is waiting on.
+
+// Note [Next local task]
+// ~~~~~~~~~~~~~~~~~~~~~~
+// Most nodes of a backward graph have a single consumer, so that executing one
+// typically makes a single task ready, which is pushed to the ready queue of
+// the thread that executed it, only to be popped right back. With small ops,
+// locking the queue, maintaining its heap and notifying its condition
+// variable for every node is a noticeable part of the time spent in backward.
+//
+// When evaluate_function() makes tasks ready for the queue the thread is
+// working on while that queue is empty, the task this queue would have
+// returned first is instead kept in next_local_task, which thread_main()
+// executes before popping from the queue again. As the queue was empty,
+// keeping the task aside doesn't change the order in which tasks are
+// executed, besides tasks concurrently pushed by other threads. When the
+// queue isn't empty, tasks go through it as usual so that they are executed
+// by priority. The size of the queue is read without locking it, which is
+// fine as long as the check only decides whether to keep a task aside.
+//
+// The task kept aside is counted in outstanding_tasks_ like any queued task,
+// and is pushed to the queue if thread_main() exits before executing it.
+
 int NodeTask::getReentrantDepth() const {
   std::shared_ptr<GraphTask> graph_task = base_.lock();
   if (graph_task) {
@@ -178,6 +233,7 @@ auto ReadyQueue::push(NodeTask item, bool incrementOutstandingTasks) -> void {
       ++graph_task->outstanding_tasks_;
     }
     heap_.push(std::move(item));
+    ++size_;
   }
   not_empty_.notify_one();
 }
@@ -186,14 +242,13 @@ auto ReadyQueue::pushShutdownTask() -> void {
   {
     std::lock_guard<std::mutex> lock(mutex_);
     heap_.push(NodeTask({}, nullptr, InputBuffer(0), true));
+    ++size_;
   }
   not_empty_.notify_one();
 }
 
 size_t ReadyQueue::size() const {
-  // Lock mutex for accesses to heap_
-  std::unique_lock<std::mutex> lock(mutex_);
-  return heap_.size();
+  return size_.load();
 }
 
 auto ReadyQueue::pop() -> NodeTask {
@@ -202,16 +257,46 @@ auto ReadyQueue::pop() -> NodeTask {
   not_empty_.wait(lock, [this]{ return !heap_.empty(); });
   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
   auto task = std::move(const_cast<NodeTask&>(heap_.top())); heap_.pop();
+  --size_;
   return task;
 }
 
 bool ReadyQueue::empty() const {
-  // Lock mutex for accesses to heap_
-  std::unique_lock<std::mutex> lock(mutex_);
-  return heap_.empty();
+  return size_.load() == 0;
+}
+
+// Pushes a task made ready by evaluate_function() to the given queue, or keeps
+// it aside for this thread to execute next. See Note [Next local task]
+static void push_ready_task(
+    const std::shared_ptr<ReadyQueue>& queue,
+    NodeTask task) {
+  if (queue != local_ready_queue) {
+    queue->push(std::move(task));
+    return;
+  }
+  if (next_local_task) {
+    if (!ReadyQueue::CompareNodeTaskTime()(*next_local_task, task)) {
+      queue->push(std::move(task));
+      return;
+    }
+    // The new task comes first, the one kept aside goes to the queue.
+    std::swap(*next_local_task, task);
+    queue->push(std::move(task), /* incrementOutstandingTasks */ false);
+  } else if (queue->empty()) {
+    next_local_task = std::move(task);
+  } else {
+    queue->push(std::move(task));
+    return;
+  }
+  std::shared_ptr<GraphTask> graph_task = next_local_task->base_.lock();
+  TORCH_INTERNAL_ASSERT(graph_task, "GraphTask is no longer valid!");
+  ++graph_task->outstanding_tasks_;
 }
 
-Engine::Engine() : max_recursion_depth_(MAX_DEPTH), non_reentrant_device_thread_count_(0) {}
+Engine::Engine()
+    : max_recursion_depth_(MAX_DEPTH),
+      num_cpu_worker_threads_(0),
+      non_reentrant_device_thread_count_(0) {}
 
 // Send shutdown tasks to all device_ready_queues_ if no backward tasks are running
 // Even though readyQueue should be empty, shutdown tasks have the highest priority
@@ -353,7 +438,10 @@ auto Engine::thread_main(const std::shared_ptr<GraphTask>& graph_task) -> void {
       // Scope this block of execution since NodeTask is not needed after this
       // block and can be deallocated (release any references to grad tensors
       // as part of inputs_).
-      NodeTask task = local_ready_queue->pop();
+      // See Note [Next local task]
+      NodeTask task = next_local_task ? std::move(*next_local_task)
+                                      : local_ready_queue->pop();
+      next_local_task.reset();
       // This will only work if the worker is running a non backward task
       // TODO Needs to be fixed this to work in all cases
       if (task.isShutdownTask_) {
@@ -399,13 +487,38 @@ auto Engine::thread_main(const std::shared_ptr<GraphTask>& graph_task) -> void {
       // before it gets to the task, but it's a no-op anyway.
       //
       // NB: This is not necessary if the current thread is the owning thread.
-      if (worker_device != base_owner) {
+      // CPU worker threads have the device of the owning thread, and might
+      // even complete a GraphTask that doesn't use them when they linger on
+      // its ready queue, see Note [Parallel CPU backward].
+      if (worker_device != base_owner || in_cpu_worker_thread) {
         // Synchronize outstanding_tasks_ with queue mutex
         std::atomic_thread_fence(std::memory_order_release);
         ready_queue_by_index(local_graph_task->cpu_ready_queue_, base_owner)
             ->push(NodeTask(local_graph_task, nullptr, InputBuffer(0)));
       }
     }
+
+    // The future is also completed on errors, before all tasks are done. In
+    // both cases the threads sharing cpu_ready_queue_ must exit thread_main.
+    // See Note [Parallel CPU backward]
+    if (local_graph_task->use_cpu_workers_ &&
+        local_graph_task->future_result_->completed() &&
+        !local_graph_task->cpu_workers_woken_.exchange(true)) {
+      // One dummy task for the owning thread and each worker thread.
+      const auto num_threads = local_graph_task->num_cpu_workers_.load() + 1;
+      for (int i = 0; i < num_threads; i++) {
+        local_graph_task->cpu_ready_queue_->push(
+            NodeTask(local_graph_task, nullptr, InputBuffer(0)));
+      }
+    }
+  }
+
+  // The GraphTask might have failed before the task kept aside was executed.
+  // See Note [Next local task]
+  if (next_local_task) {
+    local_ready_queue->push(
+        std::move(*next_local_task), /* incrementOutstandingTasks */ false);
+    next_local_task.reset();
   }
 }
 
@@ -438,6 +551,35 @@ void Engine::reentrant_thread_init() {
   }
 }
 
+// CPU worker threads execute the CPU tasks of the GraphTasks they pick up until
+// these complete. See Note [Parallel CPU backward]
+void Engine::cpu_worker_thread_init() {
+  at::init_num_threads();
+  in_cpu_worker_thread = true;
+  auto pool_shared = cpu_worker_pool_shared_;
+  while (true) {
+    std::unique_lock<std::mutex> lk(pool_shared->mutex_);
+    pool_shared->work_.wait(
+        lk, [&pool_shared] { return !pool_shared->graphtasks_queue_.empty(); });
+    auto task = pool_shared->graphtasks_queue_.front();
+    pool_shared->graphtasks_queue_.pop();
+    lk.unlock();
+    std::shared_ptr<GraphTask> graph_task;
+    if (!(graph_task = task.lock())) {
+      continue;
+    }
+    set_device(CPU_DEVICE);
+    local_ready_queue = graph_task->cpu_ready_queue_;
+    total_depth = graph_task->reentrant_depth_;
+    // Registered before thread_main checks whether the GraphTask is completed,
+    // so that the thread completing it pushes a dummy task for this thread.
+    ++graph_task->num_cpu_workers_;
+    thread_main(graph_task);
+    --graph_task->num_cpu_workers_;
+    local_ready_queue = nullptr;
+  }
+}
+
 void Engine::thread_on_exception(
     std::shared_ptr<GraphTask> graph_task,
     const std::shared_ptr<Node>& fn,
@@ -786,15 +928,25 @@ void Engine::evaluate_function(
 
       // Accumulates into buffer
       const auto opt_next_stream = next.function->stream(c10::DeviceType::CUDA);
-      input_buffer.add(next.input_nr,
-                       std::move(output),
-                       opt_parent_stream,
-                       opt_next_stream);
+      if (graph_task->use_cpu_workers_) {
+        // See Note [Parallel CPU backward]
+        input_buffer.add_deferred(next.input_nr,
+                                  std::move(output),
+                                  fn.sequence_nr(),
+                                  opt_parent_stream,
+                                  opt_next_stream);
+      } else {
+        input_buffer.add(next.input_nr,
+                         std::move(output),
+                         opt_parent_stream,
+                         opt_next_stream);
+      }
 
       if (is_ready) {
+        input_buffer.accumulate_deferred();
         auto queue = ready_queue(cpu_ready_queue, input_buffer.device());
-        queue->push(
-            NodeTask(graph_task, next.function, std::move(input_buffer)));
+        push_ready_task(
+            queue, NodeTask(graph_task, next.function, std::move(input_buffer)));
       } else {
         not_ready.emplace(next.function.get(), std::move(input_buffer));
       }
@@ -804,14 +956,24 @@ void Engine::evaluate_function(
 
       // Accumulates into buffer
       const auto opt_next_stream = next.function->stream(c10::DeviceType::CUDA);
-      input_buffer.add(next.input_nr,
-                       std::move(output),
-                       opt_parent_stream,
-                       opt_next_stream);
+      if (graph_task->use_cpu_workers_) {
+        // See Note [Parallel CPU backward]
+        input_buffer.add_deferred(next.input_nr,
+                                  std::move(output),
+                                  fn.sequence_nr(),
+                                  opt_parent_stream,
+                                  opt_next_stream);
+      } else {
+        input_buffer.add(next.input_nr,
+                         std::move(output),
+                         opt_parent_stream,
+                         opt_next_stream);
+      }
       if (is_ready) {
+        input_buffer.accumulate_deferred();
         auto queue = ready_queue(cpu_ready_queue, input_buffer.device());
-        queue->push(
-            NodeTask(graph_task, next.function, std::move(input_buffer)));
+        push_ready_task(
+            queue, NodeTask(graph_task, next.function, std::move(input_buffer)));
         not_ready.erase(not_ready_it);
       }
     }
@@ -857,6 +1019,16 @@ auto Engine::execute(const edge_list& roots,
   init_local_ready_queue();
   bool not_reentrant_backward_call = worker_device == NO_DEVICE;
 
+  // A reentrant backward call made by a CPU thread of a GraphTask using CPU
+  // worker threads doesn't share their ready queue.
+  // See Note [Parallel CPU backward]
+  std::shared_ptr<ReadyQueue> shared_ready_queue;
+  if (worker_device == CPU_DEVICE && current_graph_task &&
+      current_graph_task->use_cpu_workers_) {
+    shared_ready_queue = std::move(local_ready_queue);
+    local_ready_queue = std::make_shared<ReadyQueue>();
+  }
+
   auto graph_task = std::make_shared<GraphTask>(
       /* keep_graph */ keep_graph,
       /* create_graph */ create_graph,
@@ -896,6 +1068,9 @@ auto Engine::execute(const edge_list& roots,
   // in dist_engine.cpp).
   auto& fut = graph_task->future_result_;
   fut->wait();
+  if (shared_ready_queue) {
+    local_ready_queue = std::move(shared_ready_queue);
+  }
   return fut->value().toTensorVector();
 }
 
@@ -928,6 +1103,10 @@ std::shared_ptr<at::ivalue::Future> Engine::execute_with_graph_task(
     // set the graph_task owner to the current device
     graph_task->owner_ = worker_device;
 
+    // See Note [Parallel CPU backward]
+    const auto num_cpu_workers = num_cpu_worker_threads_.load();
+    graph_task->use_cpu_workers_ = num_cpu_workers > 0;
+
     // Now that all the non-thread safe fields of the graph_task have been populated,
     // we can enqueue it.
     queue->push(NodeTask(graph_task, std::move(graph_root), std::move(input_buffer)));
@@ -935,6 +1114,9 @@ std::shared_ptr<at::ivalue::Future> Engine::execute_with_graph_task(
     // The owning thread start to drive the engine execution for any CPU task that
     // was just pushed or will be added later from other worker threads
     lock.unlock();
+    if (graph_task->use_cpu_workers_) {
+      add_cpu_worker_tasks(graph_task, num_cpu_workers);
+    }
     thread_main(graph_task);
     TORCH_INTERNAL_ASSERT(graph_task->future_result_->completed());
     // reset the worker_device after the completion of the graph_task, this is so
@@ -1013,6 +1195,18 @@ bool Engine::is_checkpoint_valid() {
   return checkpoint_valid;
 }
 
+void Engine::set_num_cpu_worker_threads(int num_threads) {
+  TORCH_CHECK(
+      num_threads >= 0,
+      "The number of CPU worker threads must be non-negative, got ",
+      num_threads);
+  num_cpu_worker_threads_.store(num_threads);
+}
+
+int Engine::num_cpu_worker_threads() const {
+  return num_cpu_worker_threads_.load();
+}
+
 void Engine::init_local_ready_queue(std::shared_ptr<ReadyQueue> ready_queue) {
   if (ready_queue) {
     // if ready_queue provided in the caller, use the caller's ready_queue to initialize local_ready_queue
@@ -1078,6 +1272,7 @@ auto Engine::start_device_threads() -> void {
   }
 
   thread_pool_shared_ = std::make_shared<ThreadPoolShared>();
+  cpu_worker_pool_shared_ = std::make_shared<CpuWorkerPoolShared>();
 
   for (int i = 0; i < num_devices; ++i) {
     std::thread t(&Engine::thread_init, this, i, device_ready_queues_[i], true);
@@ -1110,6 +1305,24 @@ void Engine::add_thread_pool_task(const std::weak_ptr<GraphTask>& graph_task) {
   thread_pool_shared_->work_.notify_one();
 }
 
+void Engine::add_cpu_worker_tasks(
+    const std::shared_ptr<GraphTask>& graph_task,
+    int num_threads) {
+  std::unique_lock<std::mutex> lck(cpu_worker_pool_shared_->mutex_);
+  // Threads are only started as needed, and never stopped (see
+  // thread_pool_shared_)
+  for (; cpu_worker_pool_shared_->num_threads_ < num_threads;
+       ++cpu_worker_pool_shared_->num_threads_) {
+    std::thread t(&Engine::cpu_worker_thread_init, this);
+    t.detach();
+  }
+  for (int i = 0; i < num_threads; i++) {
+    cpu_worker_pool_shared_->graphtasks_queue_.push(graph_task);
+  }
+  lck.unlock();
+  cpu_worker_pool_shared_->work_.notify_all();
+}
+
 void GraphTask::init_to_execute(Node& graph_root, const edge_list& outputs, bool accumulate_grad) {
   exec_info_[&graph_root].needed_ = true;
   int output_idx = 0;
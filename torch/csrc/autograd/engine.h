@@ -149,6 +149,16 @@ struct GraphTask: std::enable_shared_from_this<GraphTask> {
   // and but next NodeTask should be run on CPU.
   std::shared_ptr<ReadyQueue> cpu_ready_queue_;
 
+  // Whether CPU worker threads help the owning thread execute the CPU tasks
+  // of this GraphTask. See Note [Parallel CPU backward]
+  // Safe to read without synchronization once the GraphTask is enqueued
+  bool use_cpu_workers_ = false;
+  // Number of CPU worker threads currently executing tasks of this GraphTask
+  std::atomic<int> num_cpu_workers_{0};
+  // Set once the threads waiting on cpu_ready_queue_ were woken up after the
+  // completion of this GraphTask
+  std::atomic_bool cpu_workers_woken_{false};
+
   // Future representing the completion of the graph task. Notified when all
   // tasks are done.
   std::shared_ptr<at::ivalue::Future> future_result_;
@@ -215,7 +225,6 @@ struct NodeTask {
 
 
 struct ReadyQueue {
- private:
   // Returns true when t2 should be (weakly) BEFORE t1 in the queue.
   // Shutdown tasks are first and then empty NodeTask are next.
   struct CompareNodeTaskTime {
@@ -234,12 +243,16 @@ struct ReadyQueue {
     }
   };
 
+ private:
   // To notify threads waiting on the ReadyQueue of available tasks on the heap_
   std::condition_variable not_empty_;
   // To protect read and writes to heap_
   mutable std::mutex mutex_;
 
   std::priority_queue<NodeTask, std::vector<NodeTask>, CompareNodeTaskTime> heap_;
+  // Size of heap_, which is only written with mutex_ held but can be read
+  // without it. See Note [Next local task]
+  std::atomic<size_t> size_{0};
 
  public:
   // incrementOutstandingTasks indicates whether or not we should increment
@@ -249,6 +262,8 @@ struct ReadyQueue {
   void push(NodeTask item, bool incrementOutstandingTasks = true);
   void pushShutdownTask();
   NodeTask pop();
+  // These don't acquire the mutex, so the size might be outdated as soon as
+  // they return.
   bool empty() const;
   size_t size() const;
 };
@@ -312,6 +327,13 @@ struct TORCH_API Engine {
   // Should be called after fork to notify that worker threads are gone
   void release_workers();
 
+  // Sets the number of CPU worker threads executing the CPU tasks of a
+  // backward pass along with the thread that called it. 0, the default,
+  // executes them on the calling thread only.
+  // See Note [Parallel CPU backward]
+  void set_num_cpu_worker_threads(int num_threads);
+  int num_cpu_worker_threads() const;
+
   // Initializes a device thread for the autograd engine.
   virtual void thread_init(
       int device,
@@ -341,6 +363,10 @@ struct TORCH_API Engine {
   virtual void thread_main(const std::shared_ptr<GraphTask>& task);
   void reentrant_thread_init();
   void add_thread_pool_task(const std::weak_ptr<GraphTask>& graph_task);
+  void cpu_worker_thread_init();
+  void add_cpu_worker_tasks(
+      const std::shared_ptr<GraphTask>& graph_task,
+      int num_threads);
 
   // Ensures device_ready_queues_ are initialized only once
   std::once_flag start_device_threads_flag_;
@@ -377,6 +403,26 @@ struct TORCH_API Engine {
  // for the graphtasks_queue_ to be nonempty.
  std::shared_ptr<ThreadPoolShared> thread_pool_shared_;
 
+  struct CpuWorkerPoolShared {
+    // Data structures used by the threads helping with the CPU tasks of
+    // GraphTasks. See Note [Parallel CPU backward]
+    // Number of threads started.
+    int num_threads_ = 0;
+    // The threads will wait on work_ to be notified of GraphTasks
+    std::condition_variable work_;
+    // To protect reads and writes to graphtasks_queue_ and num_threads_
+    std::mutex mutex_;
+    // Every entry of this queue asks for one more thread to execute the CPU
+    // tasks of the GraphTask
+    std::queue<std::weak_ptr<GraphTask>> graphtasks_queue_;
+  };
+
+  // Shared for the same reason as thread_pool_shared_
+  std::shared_ptr<CpuWorkerPoolShared> cpu_worker_pool_shared_;
+
+  // Number of CPU worker threads used by a new backward pass
+  std::atomic<int> num_cpu_worker_threads_;
+
 private:
   // Number of non-reentrant threads
   std::atomic<uint32_t> non_reentrant_device_thread_count_;
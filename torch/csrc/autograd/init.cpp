@@ -9,6 +9,7 @@
 #include <torch/csrc/autograd/profiler.h>
 #include <torch/csrc/autograd/python_function.h>
 #include <torch/csrc/autograd/function.h>
+#include <torch/csrc/autograd/saved_variable_hooks.h>
 #include <torch/csrc/autograd/utils/wrap_outputs.h>
 #include <torch/csrc/autograd/utils/python_arg_parsing.h>
 #include <torch/csrc/utils/pycfunction_helpers.h>
@@ -60,7 +61,14 @@ PyObject* THPAutograd_initExtension(PyObject* _unused, PyObject *unused) {
       .value("CUDA", ActivityType::CUDA);
 
   py::class_<ProfilerConfig>(m, "ProfilerConfig")
-      .def(py::init<ProfilerState, bool, bool, bool, bool>());
+      .def(py::init<ProfilerState, bool, bool, bool, bool>())
+      .def(py::init<
+           ProfilerState,
+           bool,
+           bool,
+           bool,
+           bool,
+           std::vector<std::string>>());
 
   py::class_<LegacyEvent>(m, "ProfilerEvent")
       .def("kind", &LegacyEvent::kindStr)
@@ -82,7 +90,8 @@ PyObject* THPAutograd_initExtension(PyObject* _unused, PyObject *unused) {
       .def("scope", &LegacyEvent::scope)
       .def("correlation_id", &LegacyEvent::correlationId)
       .def("start_us", &LegacyEvent::cpuUs)
-      .def("flops", &LegacyEvent::flops);
+      .def("flops", &LegacyEvent::flops)
+      .def("perf_counters", &LegacyEvent::perfCounters);
 
   py::enum_<c10::DeviceType>(m, "DeviceType")
       .value("CPU", c10::DeviceType::CPU)
@@ -159,7 +168,12 @@ PyObject* THPAutograd_initExtension(PyObject* _unused, PyObject *unused) {
         return e.deviceType();
       })
       // correlation id of a linked event
-      .def("linked_correlation_id", &KinetoEvent::linkedCorrelationId);
+      .def("linked_correlation_id", &KinetoEvent::linkedCorrelationId)
+      // deltas of the performance counters over the event, in the order of
+      // the perf_events of the profiler config
+      .def("perf_counters", [](const KinetoEvent& e) {
+        return e.perfCounters();
+      });
 
   py::class_<ProfilerResult>(m, "ProfilerResult")
     .def("events", &ProfilerResult::events)
@@ -172,6 +186,7 @@ PyObject* THPAutograd_initExtension(PyObject* _unused, PyObject *unused) {
 #endif
 
   m.def("kineto_available", kinetoAvailable);
+  m.def("_supported_perf_events", supportedPerfEvents);
 
   m.def("_enable_profiler_legacy", enableProfilerLegacy);
   py::class_<ProfilerDisableOptions>(m, "_ProfilerDisableOptions")
@@ -181,6 +196,71 @@ PyObject* THPAutograd_initExtension(PyObject* _unused, PyObject *unused) {
       disableProfilerLegacy,
       py::arg("profiler_disable_options") = ProfilerDisableOptions());
   m.def("_profiler_enabled", profilerEnabled);
+
+  py::class_<SampledOpStats>(m, "_SampledOpStats")
+      .def_readonly("name", &SampledOpStats::name)
+      .def_readonly("shapes", &SampledOpStats::shapes)
+      .def_readonly("num_samples", &SampledOpStats::num_samples)
+      .def_readonly("estimated_calls", &SampledOpStats::estimated_calls)
+      .def_readonly("total_ns", &SampledOpStats::total_ns)
+      .def_readonly("histogram", &SampledOpStats::histogram)
+      .def("percentile_ns", &SampledOpStats::percentileNs);
+  m.def(
+      "_enable_sampling_profiler",
+      [](double sampling_prob,
+         bool record_shapes,
+         int64_t flush_interval_ms,
+         std::string output_file) {
+        SamplingProfilerConfig config;
+        config.sampling_prob = sampling_prob;
+        config.record_shapes = record_shapes;
+        config.flush_interval = std::chrono::milliseconds(flush_interval_ms);
+        config.output_file = std::move(output_file);
+        enableSamplingProfiler(std::move(config));
+      },
+      py::arg("sampling_prob") = 0.001,
+      py::arg("record_shapes") = false,
+      py::arg("flush_interval_ms") = 60000,
+      py::arg("output_file") = "");
+  m.def("_disable_sampling_profiler", disableSamplingProfiler);
+  m.def("_flush_sampling_profiler", flushSamplingProfiler);
+  m.def("_sampling_profiler_enabled", samplingProfilerEnabled);
+
+  py::class_<MemoryEvent>(m, "_MemoryEvent")
+      .def_readonly("time_ns", &MemoryEvent::time_ns)
+      .def_readonly("bytes", &MemoryEvent::bytes)
+      .def_property_readonly(
+          "device", [](const MemoryEvent& e) { return e.device.str(); })
+      .def_readonly("thread_id", &MemoryEvent::thread_id)
+      .def_readonly("allocation_id", &MemoryEvent::allocation_id)
+      .def_readonly("op_name", &MemoryEvent::op_name)
+      .def_readonly("stack", &MemoryEvent::stack)
+      .def_readonly("total_allocated", &MemoryEvent::total_allocated);
+  py::class_<MemoryPeak>(m, "_MemoryPeak")
+      .def_property_readonly(
+          "device", [](const MemoryPeak& e) { return e.device.str(); })
+      .def_readonly("time_ns", &MemoryPeak::time_ns)
+      .def_readonly("bytes", &MemoryPeak::bytes)
+      .def_readonly("bytes_per_op", &MemoryPeak::bytes_per_op);
+  py::class_<OpMemoryStats>(m, "_OpMemoryStats")
+      .def_readonly("name", &OpMemoryStats::name)
+      .def_readonly("num_allocations", &OpMemoryStats::num_allocations)
+      .def_readonly("allocated_bytes", &OpMemoryStats::allocated_bytes)
+      .def_readonly("live_bytes", &OpMemoryStats::live_bytes);
+  py::class_<MemoryProfile>(m, "_MemoryProfile")
+      .def("events", &MemoryProfile::events)
+      .def("peaks", &MemoryProfile::peaks)
+      .def("op_stats", &MemoryProfile::opStats)
+      .def("peak_report", &MemoryProfile::peakReport, py::arg("top_k") = 10)
+      .def("export_timeline", &MemoryProfile::exportTimeline);
+  m.def(
+      "_enable_memory_profiler",
+      [](bool with_stack) {
+        enableMemoryProfiler(MemoryProfilerConfig(with_stack));
+      },
+      py::arg("with_stack") = false);
+  m.def("_disable_memory_profiler", disableMemoryProfiler);
+  m.def("_memory_profiler_enabled", memoryProfilerEnabled);
   m.def("_enable_record_function", [](bool enable) {
     at::enableRecordFunction(enable);
   });
@@ -198,6 +278,56 @@ PyObject* THPAutograd_initExtension(PyObject* _unused, PyObject *unused) {
     at::clearCallbacks();
   });
 
+  using torch::autograd::CompressSavedVariableHooks;
+  using torch::autograd::FileSavedVariableHooks;
+  using torch::autograd::SavedVariableHooks;
+  using torch::autograd::SavedVariableHooksStats;
+  auto stats_to_tuple = [](const SavedVariableHooksStats& stats) {
+    return std::make_tuple(
+        stats.num_packed.load(),
+        stats.original_bytes.load(),
+        stats.packed_bytes.load());
+  };
+  py::class_<SavedVariableHooks, std::shared_ptr<SavedVariableHooks>>(
+      m, "_SavedVariableHooks");
+  py::class_<
+      CompressSavedVariableHooks,
+      SavedVariableHooks,
+      std::shared_ptr<CompressSavedVariableHooks>>(
+      m, "_CompressSavedVariableHooks")
+      .def(py::init([](const std::string& float_compression,
+                       bool pack_bool,
+                       int64_t min_numel) {
+        using FloatCompression = CompressSavedVariableHooks::FloatCompression;
+        FloatCompression compression;
+        if (float_compression == "none") {
+          compression = FloatCompression::None;
+        } else if (float_compression == "bf16") {
+          compression = FloatCompression::BFloat16;
+        } else if (float_compression == "int8") {
+          compression = FloatCompression::Int8;
+        } else {
+          TORCH_CHECK(
+              false,
+              "float_compression must be one of 'none', 'bf16' or 'int8', "
+              "got '", float_compression, "'");
+        }
+        return std::make_shared<CompressSavedVariableHooks>(
+            compression, pack_bool, min_numel);
+      }))
+      .def("stats", [stats_to_tuple](const CompressSavedVariableHooks& hooks) {
+        return stats_to_tuple(hooks.stats());
+      });
+  py::class_<
+      FileSavedVariableHooks,
+      SavedVariableHooks,
+      std::shared_ptr<FileSavedVariableHooks>>(m, "_FileSavedVariableHooks")
+      .def(py::init<std::string, int64_t>())
+      .def("stats", [stats_to_tuple](const FileSavedVariableHooks& hooks) {
+        return stats_to_tuple(hooks.stats());
+      });
+  m.def("_set_saved_variable_hooks", &SavedVariableHooks::set_current);
+
   Py_RETURN_TRUE;
 }
 
@@ -5,6 +5,7 @@
 #include <c10/core/Event.h>
 #include <c10/util/Optional.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <utility>
 #include <vector>
@@ -118,6 +119,32 @@ namespace torch { namespace autograd {
   }
 }
 
+void InputBuffer::add_deferred(size_t pos,
+                               Variable&& var,
+                               uint64_t producer_sequence_nr,
+                               const c10::optional<c10::Stream>& opt_producer_stream,
+                               const c10::optional<c10::Stream>& opt_consumer_stream) {
+  TORCH_INTERNAL_ASSERT(pos < buffer.size());
+  if (!var.defined()) {
+    return;
+  }
+  deferred.push_back({pos, std::move(var), producer_sequence_nr,
+                      opt_producer_stream, opt_consumer_stream});
+}
+
+void InputBuffer::accumulate_deferred() {
+  // Stable, so that the outputs of a single producer keep their order
+  std::stable_sort(deferred.begin(), deferred.end(),
+                   [](const DeferredInput& a, const DeferredInput& b) {
+                     return a.producer_sequence_nr > b.producer_sequence_nr;
+                   });
+  for (auto& input : deferred) {
+    add(input.pos, std::move(input.var),
+        input.opt_producer_stream, input.opt_consumer_stream);
+  }
+  deferred.clear();
+}
+
 auto InputBuffer::device() const -> at::Device {
   // Since we pick the first non-CPU tensor, this won't work with
   // mixed device-type operations (e.g., an op that is both CUDA
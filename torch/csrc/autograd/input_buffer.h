@@ -32,6 +32,18 @@ struct InputBuffer {
            const c10::optional<c10::Stream>& opt_producer_stream,
            const c10::optional<c10::Stream>& opt_consumer_stream);
 
+  // Like add(), but only records the variable. The recorded variables are
+  // accumulated by accumulate_deferred(), in decreasing order of the sequence
+  // number of the Node that produced them, so that the result doesn't depend
+  // on the order in which the producers ran.
+  void add_deferred(size_t pos,
+                    Variable&& var,
+                    uint64_t producer_sequence_nr,
+                    const c10::optional<c10::Stream>& opt_producer_stream,
+                    const c10::optional<c10::Stream>& opt_consumer_stream);
+
+  void accumulate_deferred();
+
   at::Device device() const;
 
   Variable operator[](size_t pos) { return buffer[pos]; }
@@ -40,7 +52,16 @@ struct InputBuffer {
   static std::vector<Variable> variables(InputBuffer&& g);
 
 private:
+  struct DeferredInput {
+    size_t pos;
+    Variable var;
+    uint64_t producer_sequence_nr;
+    c10::optional<c10::Stream> opt_producer_stream;
+    c10::optional<c10::Stream> opt_consumer_stream;
+  };
+
   std::vector<Variable> buffer;
+  std::vector<DeferredInput> deferred;
 };
 
 }}  // namespace torch::autograd
@@ -77,6 +77,9 @@ struct TORCH_API KinetoThreadLocalState : public ProfilerThreadLocalState {
       if (ctx->stack && !ctx->stack->empty()) {
         kineto_events_.back().stack(*ctx->stack);
       }
+      if (!ctx->perfCounters.empty()) {
+        kineto_events_.back().perfCounters(ctx->perfCounters);
+      }
       cpu_trace->activities.emplace_back(std::move(op));
     }
   }
@@ -171,6 +174,11 @@ void pushProfilingCallbacks() {
           ctx_ptr->stack = callstackStr(cs);
         }
 #endif
+        // Read last, not to count the work of the profiler in the range
+        if (!state_ptr->config().perf_events.empty()) {
+          ctx_ptr->perfCounters =
+              readPerfCounters(state_ptr->config().perf_events);
+        }
         return ctx_ptr;
       },
       [](const at::RecordFunction& fn, at::ObserverContext* ctx_ptr) {
@@ -182,6 +190,21 @@ void pushProfilingCallbacks() {
         TORCH_INTERNAL_ASSERT(kineto_ctx_ptr != nullptr);
 
         kineto_ctx_ptr->endThreadId = at::RecordFunction::currentThreadId();
+        auto& perf_counters = kineto_ctx_ptr->perfCounters;
+        if (!perf_counters.empty()) {
+          // The counters are per thread
+          auto end_perf_counters =
+              kineto_ctx_ptr->endThreadId == kineto_ctx_ptr->startThreadId
+              ? readPerfCounters(state_ptr->config().perf_events)
+              : std::vector<int64_t>();
+          if (end_perf_counters.size() == perf_counters.size()) {
+            for (size_t i = 0; i < perf_counters.size(); ++i) {
+              perf_counters[i] = end_perf_counters[i] - perf_counters[i];
+            }
+          } else {
+            perf_counters.clear();
+          }
+        }
 
         state_ptr->reportClientActivity(fn, kineto_ctx_ptr);
         libkineto::api().activityProfiler().popCorrelationId();
@@ -261,6 +284,7 @@ void enableProfiler(
 
   auto state_ptr = getProfilerTLSState();
   TORCH_CHECK(!state_ptr, "Profiler is already enabled on this thread");
+  checkPerfEvents(config.perf_events);
   auto state = std::make_shared<KinetoThreadLocalState>(config);
   c10::ThreadLocalDebugInfo::_push(c10::DebugInfoKind::PROFILER_STATE, state);
 
@@ -290,6 +314,9 @@ std::unique_ptr<ProfilerResult> disableProfiler() {
   if (state_ptr->hasCallbackHandle()) {
     at::removeCallback(state_ptr->callbackHandle());
   }
+  if (!state_ptr->config().perf_events.empty()) {
+    releasePerfCounters();
+  }
 
   state_ptr->mark("__stop_profile");
 
@@ -31,6 +31,9 @@ struct KinetoObserverContext : public at::ObserverContext {
   uint64_t fwdThreadId;
   uint8_t recFunScope;
   c10::optional<std::vector<std::string>> stack;
+  // The values of ProfilerConfig::perf_events at the start of the range, and
+  // their increase over the range once it ended on the same thread.
+  std::vector<int64_t> perfCounters;
 };
 
 struct TORCH_API KinetoEvent {
@@ -72,6 +75,12 @@ struct TORCH_API KinetoEvent {
     return *stack_;
   }
 
+  // The increase of ProfilerConfig::perf_events over the range, empty if they
+  // weren't read or the range ended on another thread.
+  const std::vector<int64_t>& perfCounters() const {
+    return perf_counters_;
+  }
+
   uint8_t scope() const {
     return scope_;
   }
@@ -111,6 +120,11 @@ struct TORCH_API KinetoEvent {
     return *this;
   }
 
+  KinetoEvent& perfCounters(const std::vector<int64_t>& perf_counters) {
+    perf_counters_ = perf_counters;
+    return *this;
+  }
+
   // Kineto fields
 
   KinetoEvent& activity(const libkineto::TraceActivity& activity);
@@ -159,6 +173,7 @@ struct TORCH_API KinetoEvent {
   uint8_t activity_type_;
   c10::optional<std::vector<std::vector<int64_t>>> shapes_;
   c10::optional<std::vector<std::string>> stack_;
+  std::vector<int64_t> perf_counters_;
 
   std::string name_;
   uint64_t device_index_ = 0;
@@ -8,11 +8,16 @@
 #include <ATen/core/op_registration/op_registration.h>
 #include <torch/library.h>
 
+#include <atomic>
+#include <cstdlib>
+#include <deque>
 #include <fstream>
+#include <limits>
 #include <list>
 #include <mutex>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <ATen/record_function.h>
@@ -21,6 +26,16 @@
 
 #include <iostream>
 
+#if defined(__x86_64__) || defined(_M_X64)
+#define TORCH_PROFILER_USE_TSC
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+#endif
+
 namespace torch { namespace autograd { namespace profiler {
 
 std::vector<FileLineFunc> prepareCallstack(const std::vector<jit::StackEntry>& cs) {
@@ -153,7 +168,194 @@ inline const CUDAStubs*& cuda_stubs() {
 }
 }
 
+// Note [Profiler time stamp counter]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Reading the time stamp counter of x86 CPUs takes a few nanoseconds, several
+// times less than clock_gettime, so that the CPU events of the profiler read
+// it instead when it is invariant, i.e. runs at a constant rate synchronized
+// across cores. It is converted to the nanoseconds of getTime(), so that the
+// events remain comparable with the ones timed otherwise, e.g. with CUDA
+// events or by remote workers.
+//
+// The conversion is calibrated against getTime() when the profiler is first
+// enabled, which takes a few milliseconds, and refined every time it is
+// enabled again: the rate is measured between the first calibration point
+// and the latest, which is the new origin of the conversion. Calibrations
+// are never freed, so that threads recording events can read the latest
+// without any lock. Setting PYTORCH_PROFILER_DISABLE_TSC=1 times events with
+// getTime() instead.
+
+namespace {
+
+#ifdef TORCH_PROFILER_USE_TSC
+
+struct TscCalibration {
+  uint64_t tsc;
+  int64_t ns;
+  double ns_per_tick;
+};
+
+std::atomic<const TscCalibration*> current_tsc_calibration{nullptr};
+
+bool isTscInvariant() {
+  uint32_t regs[4] = {0, 0, 0, 0};
+#ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, static_cast<int>(0x80000000));
+  if (static_cast<uint32_t>(info[0]) < 0x80000007) {
+    return false;
+  }
+  __cpuid(info, static_cast<int>(0x80000007));
+  regs[3] = info[3];
+#else
+  if (!__get_cpuid(0x80000007, &regs[0], &regs[1], &regs[2], &regs[3])) {
+    return false;
+  }
+#endif
+  return regs[3] & (1u << 8);
+}
+
+// Reads the time stamp counter and getTime() at about the same time.
+std::pair<uint64_t, int64_t> readTscAndTime() {
+  std::pair<uint64_t, int64_t> best;
+  int64_t best_gap = std::numeric_limits<int64_t>::max();
+  for (int i = 0; i < 5; i++) {
+    const auto before = getTime();
+    const auto tsc = __rdtsc();
+    const auto after = getTime();
+    if (after - before < best_gap) {
+      best_gap = after - before;
+      best = {tsc, before + (after - before) / 2};
+    }
+  }
+  return best;
+}
+
+// See Note [Profiler time stamp counter]
+void calibrateTsc() {
+  static std::mutex mutex;
+  static std::deque<TscCalibration> calibrations;
+  static const bool enabled = [] {
+    const char* disable = std::getenv("PYTORCH_PROFILER_DISABLE_TSC");
+    return !(disable && std::string(disable) == "1") && isTscInvariant();
+  }();
+  if (!enabled) {
+    return;
+  }
+  constexpr int64_t kMinCalibrationNs = 5000000;
+  std::lock_guard<std::mutex> guard(mutex);
+  if (calibrations.empty()) {
+    const auto origin = readTscAndTime();
+    while (getTime() - origin.second < kMinCalibrationNs) {
+    }
+    calibrations.push_back({origin.first, origin.second, 0});
+  }
+  const auto& first = calibrations.front();
+  const auto now = readTscAndTime();
+  if (now.first <= first.tsc) {
+    return;
+  }
+  calibrations.push_back({
+      now.first,
+      now.second,
+      static_cast<double>(now.second - first.ns) / (now.first - first.tsc)});
+  current_tsc_calibration.store(
+      &calibrations.back(), std::memory_order_release);
+}
+
+#else
+
+void calibrateTsc() {}
+
+#endif
+
+// The time of the CPU events, see Note [Profiler time stamp counter]
+int64_t getEventTime() {
+#ifdef TORCH_PROFILER_USE_TSC
+  const auto* calibration =
+      current_tsc_calibration.load(std::memory_order_acquire);
+  if (calibration) {
+    const auto ticks = static_cast<int64_t>(__rdtsc() - calibration->tsc);
+    return calibration->ns +
+        static_cast<int64_t>(ticks * calibration->ns_per_tick);
+  }
+#endif
+  return getTime();
+}
+
+// The event list of the current thread for the state it was last looked up
+// for, so that it is only looked up under the lock of the state once.
+struct CachedEventList {
+  uint64_t state_id = 0;
+  RangeEventList* list = nullptr;
+};
+thread_local CachedEventList cached_event_list;
+
+} // namespace
+
+RangeEventList::RangeEventList(uint64_t owner_thread_id)
+    : owner_thread_id_(owner_thread_id), tail_(new Chunk()), head_(tail_) {}
+
+RangeEventList::~RangeEventList() {
+  const auto size = size_.load(std::memory_order_acquire);
+  for (auto index = consolidated_; index < size; index++) {
+    if (index - head_begin_ == kChunkSize) {
+      auto next = head_->next.load(std::memory_order_acquire);
+      delete head_;
+      head_ = next;
+      head_begin_ += kChunkSize;
+    }
+    head_->event(index - head_begin_)->~LegacyEvent();
+  }
+  while (head_) {
+    auto next = head_->next.load(std::memory_order_acquire);
+    delete head_;
+    head_ = next;
+  }
+}
+
+void RangeEventList::appendChunk() {
+  auto chunk = new Chunk();
+  // Published by the release store of the size of the list
+  tail_->next.store(chunk, std::memory_order_relaxed);
+  tail_ = chunk;
+}
+
+std::vector<LegacyEvent> RangeEventList::consolidate() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  const auto size = size_.load(std::memory_order_acquire);
+  std::vector<LegacyEvent> result;
+  result.reserve(size - consolidated_ + foreign_events_.size());
+  for (; consolidated_ < size; consolidated_++) {
+    // A chunk is only freed once an event of the next one is recorded, after
+    // which the owner thread never accesses it again.
+    if (consolidated_ - head_begin_ == kChunkSize) {
+      auto next = head_->next.load(std::memory_order_acquire);
+      delete head_;
+      head_ = next;
+      head_begin_ += kChunkSize;
+    }
+    auto event = head_->event(consolidated_ - head_begin_);
+    result.emplace_back(std::move(*event));
+    event->~LegacyEvent();
+  }
+  result.insert(
+      result.end(),
+      std::make_move_iterator(foreign_events_.begin()),
+      std::make_move_iterator(foreign_events_.end()));
+  foreign_events_.clear();
+  return result;
+}
+
+size_t RangeEventList::size() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return size_.load(std::memory_order_acquire) - consolidated_ +
+      foreign_events_.size();
+}
+
 // Profiler state
+std::atomic<uint64_t> ProfilerThreadLocalState::next_id_{1};
+
 const ProfilerConfig& ProfilerThreadLocalState::config() const {
   return config_;
 }
@@ -241,6 +443,10 @@ void ProfilerThreadLocalState::pushRange(
       evt.setStack(callstackStr(cs));
     }
 #endif
+    // Read last, not to count the work of the profiler in the range
+    if (!config_.perf_events.empty()) {
+      evt.setPerfCounters(readPerfCounters(config_.perf_events));
+    }
     getEventList().record(std::move(evt));
   }
 }
@@ -252,6 +458,8 @@ void ProfilerThreadLocalState::popRange(const at::RecordFunction& fn, const bool
   if (config_.state == ProfilerState::NVTX) {
     cuda_stubs()->nvtxRangePop();
   } else {
+    // Read first, not to count the work of the profiler in the range
+    auto perf_counters = readPerfCounters(config_.perf_events);
     // In some cases RecordFunction (and popRange) may be
     // called on a different thread than pushRange
     // As a convention, we put the async pop on the original
@@ -263,6 +471,7 @@ void ProfilerThreadLocalState::popRange(const at::RecordFunction& fn, const bool
         record_cuda,
         fn.handle());
     evt.setNodeId(at::RecordFunction::getDefaultNodeId());
+    evt.setPerfCounters(std::move(perf_counters));
     getEventList(fn.threadId()).record(std::move(evt));
   }
 }
@@ -332,8 +541,13 @@ std::string ProfilerThreadLocalState::getNvtxStr(
 }
 
 RangeEventList& ProfilerThreadLocalState::getEventList(int64_t thread_id) {
+  const int64_t current_thread_id = at::RecordFunction::currentThreadId();
   if (thread_id < 0) {
-    thread_id = at::RecordFunction::currentThreadId();
+    thread_id = current_thread_id;
+  }
+  const bool is_current_thread = thread_id == current_thread_id;
+  if (is_current_thread && cached_event_list.state_id == id_) {
+    return *cached_event_list.list;
   }
   RangeEventList* list_ptr = nullptr;
   std::lock_guard<std::mutex> guard(state_mutex_);
@@ -341,10 +555,14 @@ RangeEventList& ProfilerThreadLocalState::getEventList(int64_t thread_id) {
   if (it != event_lists_map_.end()) {
     list_ptr = it->second.get();
   } else {
-    auto event_list = std::make_shared<RangeEventList>();
+    auto event_list = std::make_shared<RangeEventList>(thread_id);
     event_lists_map_[thread_id] = event_list;
     list_ptr = event_list.get();
   }
+  if (is_current_thread) {
+    cached_event_list.state_id = id_;
+    cached_event_list.list = list_ptr;
+  }
   return *list_ptr;
 }
 
@@ -512,6 +730,8 @@ void enableProfilerLegacy(const ProfilerConfig& new_config) {
 
   auto state_ptr = getProfilerTLSState();
   TORCH_CHECK(!state_ptr, "Profiler is already enabled on this thread");
+  checkPerfEvents(new_config.perf_events);
+  calibrateTsc();
   auto state = std::make_shared<ProfilerThreadLocalState>(new_config);
   c10::ThreadLocalDebugInfo::_push(c10::DebugInfoKind::PROFILER_STATE, state);
 
@@ -554,6 +774,9 @@ thread_event_lists disableProfilerLegacy(c10::optional<ProfilerDisableOptions> p
 
   if (cleanupTLSState) {
     at::removeCallback(state_ptr->callbackHandle());
+    if (!state_ptr->config().perf_events.empty()) {
+      releasePerfCounters();
+    }
   }
 
   if (!consolidate || state_ptr->config().state == ProfilerState::NVTX) {
@@ -576,7 +799,7 @@ void LegacyEvent::record(bool record_cuda) {
     cuda_stubs()->record(&device_, &cuda_event, &cpu_ns_);
     return;
   }
-  cpu_ns_ = getTime();
+  cpu_ns_ = getEventTime();
 }
 
 /* static */ LegacyEvent LegacyEvent::fromIValue(const at::IValue& eventIValue) {
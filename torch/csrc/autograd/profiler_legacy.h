@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <iostream>
 #include <mutex>
 #include <memory>
@@ -9,8 +10,10 @@
 #include <sstream>
 #include <forward_list>
 #include <tuple>
+#include <type_traits>
 #include <ATen/ATen.h>
 #include <torch/csrc/WindowsTorchApiMacro.h>
+#include <torch/csrc/autograd/profiler_perf.h>
 #include <torch/csrc/autograd/profiler_utils.h>
 #ifndef _WIN32
 #include <ctime>
@@ -112,7 +115,7 @@ struct TORCH_API LegacyEvent {
         kind_(kind),
         thread_id_(thread_id),
         handle_(handle),
-        shapes_(shapes),
+        shapes_(std::move(shapes)),
         node_id_(node_id) {
     record(record_cuda);
   }
@@ -137,7 +140,7 @@ struct TORCH_API LegacyEvent {
         kind_(kind),
         thread_id_(thread_id),
         handle_(handle),
-        shapes_(shapes),
+        shapes_(std::move(shapes)),
         cpu_memory_usage_(cpu_memory_usage),
         cuda_memory_usage_(cuda_memory_usage),
         device_(device),
@@ -308,6 +311,16 @@ struct TORCH_API LegacyEvent {
     flops_ = flops;
   }
 
+  // The values of ProfilerConfig::perf_events when the event was recorded,
+  // for the thread it was recorded on.
+  const std::vector<int64_t>& perfCounters() const {
+    return perf_counters_;
+  }
+
+  void setPerfCounters(std::vector<int64_t>&& perf_counters) {
+    perf_counters_ = std::move(perf_counters);
+  }
+
  private:
   // signed to allow for negative intervals, initialized for safety.
   int64_t cpu_ns_ = 0;
@@ -332,45 +345,75 @@ struct TORCH_API LegacyEvent {
   // Extra arguments for computing op flops
   std::unordered_map<std::string, c10::IValue> extra_args_;
   uint64_t flops_;
+  std::vector<int64_t> perf_counters_;
 };
 
-// a linked-list of fixed sized vectors, to avoid
-// a std::vector resize from taking a large amount of time inside
-// a profiling  event
-struct RangeEventList {
-  RangeEventList() {
-    events_.reserve(kReservedCapacity);
-  }
+// A linked-list of fixed sized chunks of events recorded by a thread, to
+// avoid a std::vector resize from taking a large amount of time inside a
+// profiling event.
+//
+// The thread owning the list appends its events without taking any lock: it
+// only publishes them with a release store of their number, that
+// consolidate() loads to move them out. Events recorded by other threads,
+// e.g. the pop of an async range ending on another thread, are appended to a
+// separate vector under a lock, and consolidated after the others.
+struct TORCH_API RangeEventList {
+  explicit RangeEventList(uint64_t owner_thread_id);
+  ~RangeEventList();
+
+  RangeEventList(const RangeEventList&) = delete;
+  RangeEventList& operator=(const RangeEventList&) = delete;
 
   template<typename... Args>
   void record(Args&&... args) {
-    std::lock_guard<std::mutex> guard(mutex_);
-    events_.emplace_back(std::forward<Args>(args)...);
+    if (at::RecordFunction::currentThreadId() != owner_thread_id_) {
+      std::lock_guard<std::mutex> guard(mutex_);
+      foreign_events_.emplace_back(std::forward<Args>(args)...);
+      return;
+    }
+    const auto size = size_.load(std::memory_order_relaxed);
+    if (size > 0 && size % kChunkSize == 0) {
+      appendChunk();
+    }
+    new (tail_->event(size % kChunkSize))
+        LegacyEvent(std::forward<Args>(args)...);
+    size_.store(size + 1, std::memory_order_release);
   }
 
-  std::vector<LegacyEvent> consolidate() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::vector<LegacyEvent> result;
-    result.insert(
-        result.begin(),
-        std::make_move_iterator(events_.begin()),
-        std::make_move_iterator(events_.end()));
-    events_.erase(events_.begin(), events_.end());
-    return result;
-  }
+  std::vector<LegacyEvent> consolidate();
 
-  size_t size() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return events_.size();
-  }
+  size_t size();
 
  private:
-  // This mutex is used to serialize access when different threads are writing
-  // to the same instance of RangeEventList.
-  std::mutex mutex_;
-  std::vector<LegacyEvent> events_;
+  static const size_t kChunkSize = 1024;
+
+  struct Chunk {
+    LegacyEvent* event(size_t index) {
+      return reinterpret_cast<LegacyEvent*>(&events[index]);
+    }
+
+    std::aligned_storage<sizeof(LegacyEvent), alignof(LegacyEvent)>::type
+        events[kChunkSize];
+    std::atomic<Chunk*> next{nullptr};
+  };
 
-  static const size_t kReservedCapacity = 1024;
+  // Only called by the owner thread.
+  void appendChunk();
+
+  const uint64_t owner_thread_id_;
+  // The number of events recorded by the owner thread so far.
+  std::atomic<size_t> size_{0};
+  // The chunk the owner thread records into, only accessed by it.
+  Chunk* tail_;
+
+  // This mutex serializes consolidate() and the records of other threads.
+  std::mutex mutex_;
+  // The first chunk not consolidated yet, and the index of its first event.
+  Chunk* head_;
+  size_t head_begin_ = 0;
+  // The number of events of the owner thread consolidated so far.
+  size_t consolidated_ = 0;
+  std::vector<LegacyEvent> foreign_events_;
 };
 
 enum class C10_API_ENUM ProfilerState {
@@ -388,18 +431,23 @@ struct TORCH_API ProfilerConfig {
       bool report_input_shapes = false,
       bool profile_memory = false,
       bool with_stack = false,
-      bool with_flops = false)
+      bool with_flops = false,
+      std::vector<std::string> perf_events = {})
       : state(state),
         report_input_shapes(report_input_shapes),
         profile_memory(profile_memory),
         with_stack(with_stack),
-        with_flops(with_flops) {}
+        with_flops(with_flops),
+        perf_events(std::move(perf_events)) {}
   ~ProfilerConfig() = default;
   ProfilerState state;
   bool report_input_shapes;
   bool profile_memory;
   bool with_stack;
   bool with_flops;
+  // The performance counters to read at the start and the end of the ranges,
+  // see profiler_perf.h.
+  std::vector<std::string> perf_events;
 
   // Returns IValues corresponding to ProfilerConfig struct, to be used for
   // serialization.
@@ -505,7 +553,9 @@ TORCH_API std::vector<std::vector<int64_t>> inputSizes(const at::RecordFunction&
 
 struct TORCH_API ProfilerThreadLocalState : public c10::MemoryReportingInfoBase {
   explicit ProfilerThreadLocalState(const ProfilerConfig& config)
-      : config_(config), remoteProfiledEvents_{c10::nullopt} {}
+      : id_(next_id_++),
+        config_(config),
+        remoteProfiledEvents_{c10::nullopt} {}
   ~ProfilerThreadLocalState() override = default;
 
   const ProfilerConfig& config() const;
@@ -553,6 +603,11 @@ struct TORCH_API ProfilerThreadLocalState : public c10::MemoryReportingInfoBase
 
   RangeEventList& getEventList(int64_t thread_id = -1);
 
+  // Identifies the state in the thread local cache of the event list of the
+  // current thread, unlike its address which may be reused by a later state.
+  const uint64_t id_;
+  static std::atomic<uint64_t> next_id_;
+
   std::mutex state_mutex_;
   std::unordered_map<uint64_t, std::shared_ptr<RangeEventList>>
       event_lists_map_;
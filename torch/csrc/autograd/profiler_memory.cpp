@@ -0,0 +1,299 @@
+#include <torch/csrc/autograd/profiler_memory.h>
+
+#include <torch/csrc/autograd/profiler_legacy.h>
+#include <torch/csrc/jit/frontend/tracer.h>
+#include <torch/csrc/jit/runtime/interpreter.h>
+
+#include <c10/util/Exception.h>
+#include <c10/util/ThreadLocalDebugInfo.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+namespace torch { namespace autograd {
+namespace profiler {
+
+namespace {
+
+std::atomic<uint64_t> next_state_id{1};
+
+MemoryProfilerState* getMemoryProfilerState() {
+  return static_cast<MemoryProfilerState*>(c10::ThreadLocalDebugInfo::get(
+      c10::DebugInfoKind::MEMORY_PROFILER_STATE));
+}
+
+using OpStack = std::vector<std::pair<at::StringView, at::RecordScope>>;
+
+// The ops running on the current thread, innermost last, to attribute the
+// allocations to. Reset when the thread first runs ops for another profiler
+// state.
+struct ThreadOpStack {
+  uint64_t state_id = 0;
+  OpStack ops;
+};
+
+thread_local ThreadOpStack op_stack;
+
+OpStack& currentOpStack(const MemoryProfilerState& state) {
+  if (op_stack.state_id != state.id()) {
+    op_stack.state_id = state.id();
+    op_stack.ops.clear();
+  }
+  return op_stack.ops;
+}
+
+// See MemoryEvent::op_name
+const char* owningOp(const OpStack& ops) {
+  for (const auto& op : ops) {
+    if (op.second == at::RecordScope::FUNCTION ||
+        op.second == at::RecordScope::BACKWARD_FUNCTION) {
+      return op.first.str();
+    }
+  }
+  return ops.empty() ? nullptr : ops.back().first.str();
+}
+
+std::unique_ptr<at::ObserverContext> onOpStart(const at::RecordFunction& fn) {
+  auto state_ptr = getMemoryProfilerState();
+  if (state_ptr) {
+    currentOpStack(*state_ptr).emplace_back(fn.name(), fn.scope());
+  }
+  return nullptr;
+}
+
+void onOpEnd(const at::RecordFunction& fn, at::ObserverContext* /* unused */) {
+  auto state_ptr = getMemoryProfilerState();
+  // The end of async ops may run on another thread than their start, whose
+  // stack they are not on.
+  if (!state_ptr || fn.threadId() != at::RecordFunction::currentThreadId()) {
+    return;
+  }
+  auto& ops = currentOpStack(*state_ptr);
+  if (!ops.empty()) {
+    ops.pop_back();
+  }
+}
+
+std::string formatBytes(int64_t bytes) {
+  static const char* kUnits[] = {"B", "KB", "MB", "GB", "TB"};
+  double value = bytes;
+  size_t unit = 0;
+  while (std::abs(value) >= 1024 && unit < 4) {
+    value /= 1024;
+    ++unit;
+  }
+  std::ostringstream ss;
+  ss << std::fixed << std::setprecision(unit == 0 ? 0 : 2) << value << " "
+     << kUnits[unit];
+  return ss.str();
+}
+
+} // namespace
+
+MemoryProfilerState::MemoryProfilerState(MemoryProfilerConfig config)
+    : config_(std::move(config)),
+      id_(next_state_id++),
+      start_ns_(getTime()) {}
+
+void MemoryProfilerState::reportMemoryUsage(
+    void* ptr,
+    int64_t alloc_size,
+    c10::Device device) {
+  MemoryEvent event;
+  event.time_ns = getTime() - start_ns_;
+  event.bytes = alloc_size;
+  event.device = device;
+  event.thread_id = at::RecordFunction::currentThreadId();
+  if (alloc_size > 0) {
+    const auto op_name = owningOp(currentOpStack(*this));
+    if (op_name) {
+      event.op_name = op_name;
+    }
+#ifndef C10_MOBILE
+    if (config_.with_stack) {
+      auto cs = prepareCallstack(jit::currentCallstack());
+      if (cs.empty()) {
+        cs = prepareCallstack(jit::tracer::pythonCallstack());
+      }
+      event.stack = callstackStr(cs);
+    }
+#endif
+  }
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto& total_allocated = total_allocated_[device];
+  if (alloc_size > 0) {
+    event.allocation_id = next_allocation_id_++;
+    live_allocations_[ptr] = events_.size();
+    total_allocated += alloc_size;
+  } else {
+    auto it = live_allocations_.find(ptr);
+    if (it != live_allocations_.end()) {
+      const auto& allocation = events_[it->second];
+      event.allocation_id = allocation.allocation_id;
+      event.op_name = allocation.op_name;
+      total_allocated += alloc_size;
+      live_allocations_.erase(it);
+    }
+  }
+  event.total_allocated = total_allocated;
+  events_.push_back(std::move(event));
+}
+
+std::vector<MemoryEvent> MemoryProfilerState::consolidate() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  live_allocations_.clear();
+  return std::move(events_);
+}
+
+std::vector<MemoryPeak> MemoryProfile::peaks() const {
+  // The index of the event at the peak of every device
+  std::map<std::string, size_t> peak_events;
+  for (size_t i = 0; i < events_.size(); ++i) {
+    const auto& event = events_[i];
+    if (event.bytes <= 0) {
+      continue;
+    }
+    auto it = peak_events.emplace(event.device.str(), i).first;
+    if (event.total_allocated > events_[it->second].total_allocated) {
+      it->second = i;
+    }
+  }
+
+  std::vector<MemoryPeak> peaks;
+  for (const auto& item : peak_events) {
+    const auto& peak_event = events_[item.second];
+    MemoryPeak peak;
+    peak.device = peak_event.device;
+    peak.time_ns = peak_event.time_ns;
+    peak.bytes = peak_event.total_allocated;
+    // Replays the events up to the peak to find the allocations live at it
+    std::unordered_map<int64_t, const MemoryEvent*> live;
+    for (size_t i = 0; i <= item.second; ++i) {
+      const auto& event = events_[i];
+      if (event.device != peak.device || event.allocation_id < 0) {
+        continue;
+      }
+      if (event.bytes > 0) {
+        live[event.allocation_id] = &event;
+      } else {
+        live.erase(event.allocation_id);
+      }
+    }
+    std::unordered_map<std::string, int64_t> bytes_per_op;
+    for (const auto& allocation : live) {
+      bytes_per_op[allocation.second->op_name] += allocation.second->bytes;
+    }
+    peak.bytes_per_op.assign(bytes_per_op.begin(), bytes_per_op.end());
+    std::sort(
+        peak.bytes_per_op.begin(),
+        peak.bytes_per_op.end(),
+        [](const std::pair<std::string, int64_t>& a,
+           const std::pair<std::string, int64_t>& b) {
+          return a.second > b.second ||
+              (a.second == b.second && a.first < b.first);
+        });
+    peaks.push_back(std::move(peak));
+  }
+  return peaks;
+}
+
+std::vector<OpMemoryStats> MemoryProfile::opStats() const {
+  std::unordered_map<std::string, OpMemoryStats> stats_per_op;
+  for (const auto& event : events_) {
+    if (event.allocation_id < 0) {
+      continue;
+    }
+    auto& stats = stats_per_op[event.op_name];
+    if (event.bytes > 0) {
+      ++stats.num_allocations;
+      stats.allocated_bytes += event.bytes;
+    }
+    stats.live_bytes += event.bytes;
+  }
+  std::vector<OpMemoryStats> op_stats;
+  op_stats.reserve(stats_per_op.size());
+  for (auto& item : stats_per_op) {
+    item.second.name = item.first;
+    op_stats.push_back(std::move(item.second));
+  }
+  std::sort(
+      op_stats.begin(),
+      op_stats.end(),
+      [](const OpMemoryStats& a, const OpMemoryStats& b) {
+        return a.allocated_bytes > b.allocated_bytes ||
+            (a.allocated_bytes == b.allocated_bytes && a.name < b.name);
+      });
+  return op_stats;
+}
+
+std::string MemoryProfile::peakReport(size_t top_k) const {
+  std::ostringstream ss;
+  for (const auto& peak : peaks()) {
+    ss << "Peak memory on " << peak.device << ": " << formatBytes(peak.bytes)
+       << " at " << std::fixed << std::setprecision(3)
+       << peak.time_ns / 1e6 << " ms\n";
+    for (size_t i = 0; i < peak.bytes_per_op.size() && i < top_k; ++i) {
+      const auto& op = peak.bytes_per_op[i];
+      ss << "  " << std::left << std::setw(40)
+         << (op.first.empty() ? "(outside of ops)" : op.first) << std::right
+         << std::setw(12) << formatBytes(op.second) << std::setw(8)
+         << std::setprecision(1) << 100.0 * op.second / peak.bytes << "%\n";
+    }
+  }
+  return ss.str();
+}
+
+void MemoryProfile::exportTimeline(const std::string& path) const {
+  std::ofstream out(path);
+  TORCH_CHECK(out, "Could not open ", path, " to export the memory timeline");
+  out << "{\"traceEvents\": [";
+  bool first = true;
+  for (const auto& event : events_) {
+    if (event.allocation_id < 0) {
+      continue;
+    }
+    out << (first ? "\n" : ",\n") << "{\"name\": \"" << event.device
+        << " memory\", \"ph\": \"C\", \"ts\": " << std::fixed
+        << std::setprecision(3) << event.time_ns / 1e3
+        << ", \"pid\": 0, \"tid\": 0, \"args\": {\"allocated\": "
+        << event.total_allocated << "}}";
+    first = false;
+  }
+  out << "\n]}\n";
+  TORCH_CHECK(out, "Failed to write the memory timeline to ", path);
+}
+
+void enableMemoryProfiler(const MemoryProfilerConfig& config) {
+  TORCH_CHECK(
+      !getMemoryProfilerState(),
+      "The memory profiler is already enabled on this thread");
+  auto state = std::make_shared<MemoryProfilerState>(config);
+  c10::ThreadLocalDebugInfo::_push(
+      c10::DebugInfoKind::MEMORY_PROFILER_STATE, state);
+  state->setCallbackHandle(at::addThreadLocalCallback(
+      at::RecordFunctionCallback(&onOpStart, &onOpEnd)));
+}
+
+MemoryProfile disableMemoryProfiler() {
+  TORCH_CHECK(
+      getMemoryProfilerState(),
+      "Can't disable the memory profiler when it's not running");
+  auto state = c10::ThreadLocalDebugInfo::_pop(
+      c10::DebugInfoKind::MEMORY_PROFILER_STATE);
+  auto state_ptr = static_cast<MemoryProfilerState*>(state.get());
+  at::removeCallback(state_ptr->callbackHandle());
+  return MemoryProfile(state_ptr->consolidate());
+}
+
+bool memoryProfilerEnabled() {
+  return getMemoryProfilerState() != nullptr;
+}
+
+} // namespace profiler
+}} // namespace torch::autograd
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <ATen/record_function.h>
+#include <c10/core/Allocator.h>
+#include <c10/core/Device.h>
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace torch { namespace autograd {
+namespace profiler {
+
+struct TORCH_API MemoryProfilerConfig {
+  explicit MemoryProfilerConfig(bool with_stack = false)
+      : with_stack(with_stack) {}
+
+  // Whether to record the TorchScript source ranges, or the Python stack
+  // when tracing, of the allocations.
+  bool with_stack;
+};
+
+// An allocation or a free reported by an allocator while the memory profiler
+// is enabled.
+struct TORCH_API MemoryEvent {
+  // Relative to the start of the profiler.
+  int64_t time_ns = 0;
+  // Negative for frees.
+  int64_t bytes = 0;
+  // The device of the allocator, e.g. the CPU allocator or the CUDA caching
+  // allocator of a device.
+  c10::Device device = c10::Device(c10::DeviceType::CPU);
+  uint64_t thread_id = 0;
+  // Identifies the allocation across its allocation and free events, or -1 for
+  // the frees of memory allocated before the profiler was enabled.
+  int64_t allocation_id = -1;
+  // The op which allocated the memory, for both the allocation and the free:
+  // the outermost op running, e.g. aten::mul rather than the aten::empty it
+  // allocates its output with, or the innermost range if no op was running,
+  // e.g. a user scope, or empty if no range was.
+  std::string op_name;
+  // See MemoryProfilerConfig::with_stack. Only set for allocations.
+  std::vector<std::string> stack;
+  // The bytes allocated on the device since the profiler was enabled and not
+  // freed yet, after this event.
+  int64_t total_allocated = 0;
+};
+
+// The memory allocated on a device at the time of its peak, and the ops which
+// allocated it.
+struct TORCH_API MemoryPeak {
+  c10::Device device = c10::Device(c10::DeviceType::CPU);
+  int64_t time_ns = 0;
+  int64_t bytes = 0;
+  // The bytes allocated by every op that are live at the peak, from the most
+  // bytes to the least.
+  std::vector<std::pair<std::string, int64_t>> bytes_per_op;
+};
+
+// The memory allocated by an op over the lifetime of the profiler.
+struct TORCH_API OpMemoryStats {
+  std::string name;
+  int64_t num_allocations = 0;
+  int64_t allocated_bytes = 0;
+  // The bytes allocated by the op and not freed when the profiler stopped.
+  int64_t live_bytes = 0;
+};
+
+// The events recorded by the memory profiler, see disableMemoryProfiler().
+class TORCH_API MemoryProfile {
+ public:
+  explicit MemoryProfile(std::vector<MemoryEvent> events)
+      : events_(std::move(events)) {}
+
+  const std::vector<MemoryEvent>& events() const {
+    return events_;
+  }
+
+  // The peak of the memory allocated on every device the profiler recorded
+  // allocations on.
+  std::vector<MemoryPeak> peaks() const;
+
+  // The memory allocated by every op, from the most bytes to the least.
+  std::vector<OpMemoryStats> opStats() const;
+
+  // A human readable report of peaks(), listing the `top_k` ops allocating
+  // the most memory live at every peak.
+  std::string peakReport(size_t top_k = 10) const;
+
+  // Writes the memory allocated on every device over time as counters of a
+  // trace in the Chrome trace format, to be viewed in chrome://tracing.
+  void exportTimeline(const std::string& path) const;
+
+ private:
+  std::vector<MemoryEvent> events_;
+};
+
+// The state of the memory profiler, thread local and propagated like the state
+// of the other profilers, see ThreadLocalDebugInfo.
+struct TORCH_API MemoryProfilerState : public c10::MemoryReportingInfoBase {
+  explicit MemoryProfilerState(MemoryProfilerConfig config);
+
+  void reportMemoryUsage(void* ptr, int64_t alloc_size, c10::Device device)
+      override;
+
+  bool memoryProfilingEnabled() const override {
+    return true;
+  }
+
+  const MemoryProfilerConfig& config() const {
+    return config_;
+  }
+
+  uint64_t id() const {
+    return id_;
+  }
+
+  void setCallbackHandle(at::CallbackHandle handle) {
+    handle_ = handle;
+  }
+
+  at::CallbackHandle callbackHandle() const {
+    return handle_;
+  }
+
+  std::vector<MemoryEvent> consolidate();
+
+ private:
+  const MemoryProfilerConfig config_;
+  const uint64_t id_;
+  const int64_t start_ns_;
+  at::CallbackHandle handle_ = 0;
+
+  std::mutex mutex_;
+  std::vector<MemoryEvent> events_;
+  // The index in events_ of the allocation of every pointer not freed yet.
+  std::unordered_map<void*, size_t> live_allocations_;
+  std::unordered_map<c10::Device, int64_t> total_allocated_;
+  int64_t next_allocation_id_ = 0;
+};
+
+// Starts recording the allocations and frees of the current thread, and of the
+// threads the profiler state propagates to, e.g. in backward. The memory
+// profiler can run alongside the other profilers.
+TORCH_API void enableMemoryProfiler(
+    const MemoryProfilerConfig& config = MemoryProfilerConfig());
+
+TORCH_API MemoryProfile disableMemoryProfiler();
+
+TORCH_API bool memoryProfilerEnabled();
+
+} // namespace profiler
+}} // namespace torch::autograd
@@ -0,0 +1,241 @@
+#include <torch/csrc/autograd/profiler_perf.h>
+
+#include <c10/util/Exception.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace torch { namespace autograd {
+namespace profiler {
+
+namespace {
+
+#ifdef __linux__
+
+struct PerfEventType {
+  const char* name;
+  uint32_t type;
+  uint64_t config;
+};
+
+constexpr uint64_t hwCacheConfig(
+    uint64_t cache,
+    uint64_t op = PERF_COUNT_HW_CACHE_OP_READ,
+    uint64_t result = PERF_COUNT_HW_CACHE_RESULT_MISS) {
+  return cache | (op << 8) | (result << 16);
+}
+
+const PerfEventType kPerfEventTypes[] = {
+    {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {"cache_references", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES},
+    {"cache_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {"branches", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS},
+    {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {"l1d_load_misses",
+     PERF_TYPE_HW_CACHE,
+     hwCacheConfig(PERF_COUNT_HW_CACHE_L1D)},
+    {"llc_load_misses",
+     PERF_TYPE_HW_CACHE,
+     hwCacheConfig(PERF_COUNT_HW_CACHE_LL)},
+    {"dtlb_load_misses",
+     PERF_TYPE_HW_CACHE,
+     hwCacheConfig(PERF_COUNT_HW_CACHE_DTLB)},
+    {"task_clock", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+    {"page_faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+    {"context_switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+};
+
+const PerfEventType* findPerfEventType(const std::string& name) {
+  for (const auto& type : kPerfEventTypes) {
+    if (name == type.name) {
+      return &type;
+    }
+  }
+  return nullptr;
+}
+
+// The counters of a thread, opened as a group with the first one as leader so
+// that they are scheduled together on the PMU and read at once.
+class PerfEventGroup {
+ public:
+  PerfEventGroup() = default;
+  PerfEventGroup(const PerfEventGroup&) = delete;
+  PerfEventGroup& operator=(const PerfEventGroup&) = delete;
+
+  ~PerfEventGroup() {
+    close();
+  }
+
+  // Opens the counters, or returns why they can't be.
+  std::string open(const std::vector<std::string>& events) {
+    close();
+    events_ = events;
+    for (const auto& event : events) {
+      const auto* type = findPerfEventType(event);
+      if (!type) {
+        close();
+        return c10::str("unknown perf event ", event);
+      }
+      perf_event_attr attr{};
+      attr.size = sizeof(attr);
+      attr.type = type->type;
+      attr.config = type->config;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+          PERF_FORMAT_TOTAL_TIME_RUNNING;
+      const int group_fd = fds_.empty() ? -1 : fds_[0];
+      // The current thread, on any CPU
+      const int fd = static_cast<int>(syscall(
+          __NR_perf_event_open, &attr, 0, -1, group_fd, PERF_FLAG_FD_CLOEXEC));
+      if (fd < 0) {
+        const auto error = errno;
+        close();
+        return c10::str(
+            "perf_event_open failed for ",
+            event,
+            ": ",
+            std::strerror(error),
+            error == EACCES || error == EPERM
+                ? " (see /proc/sys/kernel/perf_event_paranoid)"
+                : "");
+      }
+      fds_.push_back(fd);
+    }
+    buffer_.resize(3 + events.size());
+    return "";
+  }
+
+  const std::vector<std::string>& events() const {
+    return events_;
+  }
+
+  // Returns an empty vector if the counters can't be read, e.g. if the PMU
+  // has fewer counters than the group, which is then never scheduled.
+  std::vector<int64_t> read() {
+    const auto size = buffer_.size() * sizeof(uint64_t);
+    if (::read(fds_[0], buffer_.data(), size) != static_cast<ssize_t>(size)) {
+      return {};
+    }
+    // Laid out as {nr, time_enabled, time_running, values[nr]}
+    const auto time_enabled = buffer_[1];
+    const auto time_running = buffer_[2];
+    if (time_running == 0 && time_enabled > 0) {
+      return {};
+    }
+    std::vector<int64_t> values(buffer_.begin() + 3, buffer_.end());
+    if (time_running > 0 && time_running < time_enabled) {
+      const double scale = static_cast<double>(time_enabled) / time_running;
+      for (auto& value : values) {
+        value = static_cast<int64_t>(value * scale);
+      }
+    }
+    return values;
+  }
+
+  void close() {
+    // Members first, the leader last
+    for (auto it = fds_.rbegin(); it != fds_.rend(); ++it) {
+      ::close(*it);
+    }
+    fds_.clear();
+  }
+
+ private:
+  std::vector<std::string> events_;
+  std::vector<int> fds_;
+  std::vector<uint64_t> buffer_;
+};
+
+// Bumped by releasePerfCounters, so that the threads close the counters they
+// opened for a previous profiling session the next time they use them.
+std::atomic<uint64_t> perf_generation{0};
+
+struct ThreadPerfEventGroup {
+  PerfEventGroup group;
+  // Why the counters couldn't be opened, if they couldn't.
+  std::string error;
+  // The value of perf_generation the counters were opened in.
+  uint64_t generation = 0;
+};
+
+thread_local ThreadPerfEventGroup thread_perf_events;
+
+// Opens the counters of the current thread if they aren't already, and
+// returns why they can't be if they can't.
+const std::string& openThreadPerfEvents(
+    const std::vector<std::string>& events) {
+  auto& thread_group = thread_perf_events;
+  const auto generation = perf_generation.load(std::memory_order_relaxed);
+  if (thread_group.generation != generation ||
+      thread_group.group.events() != events) {
+    thread_group.error = thread_group.group.open(events);
+    thread_group.generation = generation;
+  }
+  return thread_group.error;
+}
+
+#endif // __linux__
+
+} // namespace
+
+const std::vector<std::string>& supportedPerfEvents() {
+  static const std::vector<std::string> names = [] {
+    std::vector<std::string> names;
+#ifdef __linux__
+    for (const auto& type : kPerfEventTypes) {
+      names.emplace_back(type.name);
+    }
+#endif
+    return names;
+  }();
+  return names;
+}
+
+void checkPerfEvents(const std::vector<std::string>& events) {
+  if (events.empty()) {
+    return;
+  }
+#ifdef __linux__
+  const auto& error = openThreadPerfEvents(events);
+  TORCH_CHECK(error.empty(), "Can't read the performance counters, ", error);
+  TORCH_CHECK(
+      !thread_perf_events.group.read().empty(),
+      "Can't read the performance counters, more counters may have been "
+      "requested than the CPU can count at once");
+#else
+  TORCH_CHECK(false, "Performance counters are only supported on Linux");
+#endif
+}
+
+std::vector<int64_t> readPerfCounters(const std::vector<std::string>& events) {
+#ifdef __linux__
+  if (events.empty() || !openThreadPerfEvents(events).empty()) {
+    return {};
+  }
+  return thread_perf_events.group.read();
+#else
+  return {};
+#endif
+}
+
+void releasePerfCounters() {
+#ifdef __linux__
+  perf_generation.fetch_add(1, std::memory_order_relaxed);
+  auto& thread_group = thread_perf_events;
+  thread_group.group.close();
+  thread_group.error.clear();
+#endif
+}
+
+} // namespace profiler
+}} // namespace torch::autograd
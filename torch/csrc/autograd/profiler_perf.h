@@ -0,0 +1,44 @@
+#pragma once
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace torch { namespace autograd {
+namespace profiler {
+
+// Hardware and software performance counters of the threads running ops,
+// read with Linux perf_event_open at the start and the end of the profiled
+// ranges. The counters are named after perf events:
+//   cycles, instructions, cache_references, cache_misses (last level cache),
+//   branches, branch_misses, l1d_load_misses, llc_load_misses,
+//   dtlb_load_misses, task_clock (ns), page_faults, context_switches
+// Only the user space part of the hardware events is counted, so that it is
+// allowed by the default perf_event_paranoid setting of most systems.
+
+// The names of the supported counters.
+TORCH_API const std::vector<std::string>& supportedPerfEvents();
+
+// Checks that the counters named `events` can be read on the current thread,
+// and throws an error explaining why otherwise, e.g. because they aren't
+// supported by the CPU or the kernel doesn't allow to read them.
+TORCH_API void checkPerfEvents(const std::vector<std::string>& events);
+
+// Reads the counters named `events` of the current thread, counted since they
+// were first read by the thread in the current profiling session, in the
+// order of `events`. The counters are read together in a single system call,
+// and scaled up if the kernel could only count them part of the time, e.g.
+// because other processes used the counters of the CPU. Returns an empty
+// vector if the counters can't be read.
+TORCH_API std::vector<int64_t> readPerfCounters(
+    const std::vector<std::string>& events);
+
+// Closes the counters of the current thread, and makes the other threads close
+// theirs the next time they read them, so that a profiling session that ended
+// doesn't keep the counters of the CPU busy. Called when profiling is disabled.
+TORCH_API void releasePerfCounters();
+
+} // namespace profiler
+}} // namespace torch::autograd
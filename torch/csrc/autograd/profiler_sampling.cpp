@@ -0,0 +1,458 @@
+#include <torch/csrc/autograd/profiler_sampling.h>
+
+#include <torch/csrc/autograd/profiler_legacy.h>
+
+#include <c10/util/Exception.h>
+#include <c10/util/thread_name.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace torch { namespace autograd {
+namespace profiler {
+
+// Note [Sampling profiler tables]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Every thread aggregates the ops it samples in its own table, an open
+// addressing hash table of a fixed number of slots, keyed by the name and the
+// input shapes of the ops. Only the thread owning a table adds entries to it
+// and updates their counters, so that recording a sample never locks nor runs
+// atomic read-modify-writes: counters are updated with relaxed loads and
+// stores, and entries are published to the slots with release stores.
+//
+// The flushing thread reads the tables concurrently, and keeps the counters of
+// every entry as of the previous flush to report the samples since then. The
+// counters of an entry are read one by one, so a flush racing with a sample
+// may see it in some counters and not others; the next flush makes up for it.
+//
+// Tables are owned by the session and the thread, and outlive the thread, so
+// that its last samples are flushed. A table is dropped by the session once
+// it was flushed after its thread exited.
+
+namespace {
+
+constexpr size_t kNumBuckets = SampledOpStats::kNumBuckets;
+
+size_t bucketOf(int64_t ns) {
+  size_t bucket = 0;
+  while (ns > 1 && bucket < kNumBuckets - 1) {
+    ns >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+// Adds to a counter only written by the current thread.
+inline void increment(std::atomic<int64_t>& counter, int64_t value) {
+  counter.store(
+      counter.load(std::memory_order_relaxed) + value,
+      std::memory_order_relaxed);
+}
+
+size_t hashOf(
+    const char* name,
+    const std::vector<std::vector<int64_t>>& shapes) {
+  // FNV-1a
+  constexpr uint64_t kPrime = 1099511628211ull;
+  uint64_t hash = 14695981039346656037ull;
+  for (const char* c = name; *c; ++c) {
+    hash = (hash ^ static_cast<unsigned char>(*c)) * kPrime;
+  }
+  for (const auto& shape : shapes) {
+    hash = (hash ^ shape.size()) * kPrime;
+    for (auto size : shape) {
+      hash = (hash ^ static_cast<uint64_t>(size)) * kPrime;
+    }
+  }
+  return static_cast<size_t>(hash);
+}
+
+struct OpEntry {
+  OpEntry(
+      size_t hash,
+      std::string name,
+      std::vector<std::vector<int64_t>> shapes)
+      : hash(hash), name(std::move(name)), shapes(std::move(shapes)) {
+    for (auto& count : histogram) {
+      count.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  void record(int64_t ns) {
+    increment(num_samples, 1);
+    increment(total_ns, ns);
+    increment(histogram[bucketOf(ns)], 1);
+  }
+
+  const size_t hash;
+  const std::string name;
+  const std::vector<std::vector<int64_t>> shapes;
+  std::atomic<int64_t> num_samples{0};
+  std::atomic<int64_t> total_ns{0};
+  std::array<std::atomic<int64_t>, kNumBuckets> histogram;
+
+  // Only accessed by the flushing thread, the counters as of the previous
+  // flush.
+  int64_t flushed_num_samples = 0;
+  int64_t flushed_total_ns = 0;
+  std::array<int64_t, kNumBuckets> flushed_histogram{};
+};
+
+// See Note [Sampling profiler tables]
+struct ThreadTable {
+  static constexpr size_t kNumSlots = 4096;
+
+  ThreadTable() {
+    for (auto& slot : slots) {
+      slot.store(nullptr, std::memory_order_relaxed);
+    }
+  }
+
+  ~ThreadTable() {
+    for (auto& slot : slots) {
+      delete slot.load(std::memory_order_relaxed);
+    }
+  }
+
+  ThreadTable(const ThreadTable&) = delete;
+  ThreadTable& operator=(const ThreadTable&) = delete;
+
+  // Returns the entry of the op, adding it if needed, or nullptr if the table
+  // is full. Only called by the thread owning the table.
+  OpEntry* find(const char* name, std::vector<std::vector<int64_t>>&& shapes) {
+    const auto hash = hashOf(name, shapes);
+    for (size_t probe = 0; probe < kNumSlots; ++probe) {
+      auto& slot = slots[(hash + probe) % kNumSlots];
+      auto* entry = slot.load(std::memory_order_relaxed);
+      if (!entry) {
+        entry = new OpEntry(hash, name, std::move(shapes));
+        slot.store(entry, std::memory_order_release);
+        return entry;
+      }
+      if (entry->hash == hash && entry->name == name &&
+          entry->shapes == shapes) {
+        return entry;
+      }
+    }
+    return nullptr;
+  }
+
+  std::array<std::atomic<OpEntry*>, kNumSlots> slots;
+  std::atomic<int64_t> num_dropped{0};
+  std::atomic<bool> thread_exited{false};
+
+  // Only accessed by the flushing thread.
+  int64_t flushed_num_dropped = 0;
+};
+
+struct Session {
+  Session(SamplingProfilerConfig config, uint64_t id)
+      : config(std::move(config)), id(id) {}
+
+  const SamplingProfilerConfig config;
+  const uint64_t id;
+  at::CallbackHandle callback_handle = 0;
+
+  std::mutex tables_mutex;
+  std::vector<std::shared_ptr<ThreadTable>> tables;
+
+  // Serializes flushes, and so the accesses to the counters as of the
+  // previous flush.
+  std::mutex flush_mutex;
+
+  std::thread flush_thread;
+  std::mutex stop_mutex;
+  std::condition_variable stop_cv;
+  bool stopping = false;
+};
+
+// Read by the threads running ops with std::atomic_load, and replaced with
+// std::atomic_store under session_mutex. The samples in flight keep their
+// session alive, so that it can be disabled while ops run.
+std::shared_ptr<Session> current_session;
+std::mutex session_mutex;
+uint64_t next_session_id = 1;
+
+// The table of the current thread in the session it was created for.
+struct ThreadTableHolder {
+  ~ThreadTableHolder() {
+    if (table) {
+      table->thread_exited.store(true, std::memory_order_release);
+    }
+  }
+
+  uint64_t session_id = 0;
+  std::shared_ptr<ThreadTable> table;
+};
+
+thread_local ThreadTableHolder thread_table;
+
+ThreadTable& currentThreadTable(Session& session) {
+  if (thread_table.session_id != session.id) {
+    thread_table.table = std::make_shared<ThreadTable>();
+    thread_table.session_id = session.id;
+    std::lock_guard<std::mutex> guard(session.tables_mutex);
+    session.tables.push_back(thread_table.table);
+  }
+  return *thread_table.table;
+}
+
+struct SampleContext : public at::ObserverContext {
+  // The session the sample started in, null if it was disabled meanwhile.
+  std::shared_ptr<Session> session;
+  std::vector<std::vector<int64_t>> shapes;
+  int64_t start_ns = 0;
+};
+
+std::unique_ptr<at::ObserverContext> onSampleStart(
+    const at::RecordFunction& fn) {
+  auto ctx = std::make_unique<SampleContext>();
+  ctx->session = std::atomic_load(&current_session);
+  if (ctx->session && ctx->session->config.record_shapes) {
+    ctx->shapes = inputSizes(fn);
+  }
+  ctx->start_ns = getTime();
+  return ctx;
+}
+
+void onSampleEnd(const at::RecordFunction& fn, at::ObserverContext* ctx_ptr) {
+  const auto end_ns = getTime();
+  auto* ctx = static_cast<SampleContext*>(ctx_ptr);
+  if (!ctx->session) {
+    return;
+  }
+  // The end of async ops may run on another thread than their start, and is
+  // recorded in the table of the thread it runs on.
+  auto& table = currentThreadTable(*ctx->session);
+  auto* entry = table.find(fn.name().str(), std::move(ctx->shapes));
+  if (entry) {
+    entry->record(end_ns - ctx->start_ns);
+  } else {
+    increment(table.num_dropped, 1);
+  }
+}
+
+std::string escapeJson(const std::string& str) {
+  std::string escaped;
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+      escaped += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      escaped += ' ';
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+void writeStats(
+    const std::string& filename,
+    const std::vector<SampledOpStats>& stats) {
+  std::ofstream out(filename, std::ios::app);
+  if (!out) {
+    TORCH_WARN("Could not open ", filename, " to write the sampling profile");
+    return;
+  }
+  const auto timestamp_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count();
+  for (const auto& op : stats) {
+    out << "{\"timestamp_us\": " << timestamp_us << ", \"name\": \""
+        << escapeJson(op.name) << "\", \"shapes\": [";
+    for (size_t i = 0; i < op.shapes.size(); ++i) {
+      out << (i == 0 ? "[" : ", [");
+      for (size_t j = 0; j < op.shapes[i].size(); ++j) {
+        out << (j == 0 ? "" : ", ") << op.shapes[i][j];
+      }
+      out << "]";
+    }
+    out << "], \"num_samples\": " << op.num_samples
+        << ", \"estimated_calls\": " << op.estimated_calls
+        << ", \"total_ns\": " << op.total_ns
+        << ", \"p50_ns\": " << op.percentileNs(0.5)
+        << ", \"p99_ns\": " << op.percentileNs(0.99) << ", \"histogram\": [";
+    for (size_t i = 0; i < kNumBuckets; ++i) {
+      out << (i == 0 ? "" : ", ") << op.histogram[i];
+    }
+    out << "]}\n";
+  }
+}
+
+std::vector<SampledOpStats> flush(Session& session) {
+  std::lock_guard<std::mutex> flush_guard(session.flush_mutex);
+  std::vector<std::shared_ptr<ThreadTable>> tables;
+  std::vector<std::shared_ptr<ThreadTable>> exited_tables;
+  {
+    std::lock_guard<std::mutex> guard(session.tables_mutex);
+    tables = session.tables;
+  }
+  using Key = std::pair<std::string, std::vector<std::vector<int64_t>>>;
+  std::map<Key, SampledOpStats> merged;
+  int64_t num_dropped = 0;
+  for (const auto& table : tables) {
+    // Checked before reading the table, so that it is read in full if the
+    // thread exited.
+    if (table->thread_exited.load(std::memory_order_acquire)) {
+      exited_tables.push_back(table);
+    }
+    const auto table_num_dropped =
+        table->num_dropped.load(std::memory_order_relaxed);
+    num_dropped += table_num_dropped - table->flushed_num_dropped;
+    table->flushed_num_dropped = table_num_dropped;
+    for (auto& slot : table->slots) {
+      auto* entry = slot.load(std::memory_order_acquire);
+      if (!entry) {
+        continue;
+      }
+      const auto num_samples =
+          entry->num_samples.load(std::memory_order_relaxed);
+      if (num_samples == entry->flushed_num_samples) {
+        continue;
+      }
+      auto& op = merged[Key(entry->name, entry->shapes)];
+      op.num_samples += num_samples - entry->flushed_num_samples;
+      entry->flushed_num_samples = num_samples;
+      const auto total_ns = entry->total_ns.load(std::memory_order_relaxed);
+      op.total_ns += total_ns - entry->flushed_total_ns;
+      entry->flushed_total_ns = total_ns;
+      for (size_t i = 0; i < kNumBuckets; ++i) {
+        const auto count = entry->histogram[i].load(std::memory_order_relaxed);
+        op.histogram[i] += count - entry->flushed_histogram[i];
+        entry->flushed_histogram[i] = count;
+      }
+    }
+  }
+  if (!exited_tables.empty()) {
+    std::lock_guard<std::mutex> guard(session.tables_mutex);
+    for (const auto& table : exited_tables) {
+      session.tables.erase(
+          std::find(session.tables.begin(), session.tables.end(), table));
+    }
+  }
+  if (num_dropped > 0) {
+    TORCH_WARN_ONCE(
+        "The sampling profiler dropped samples of ops past the first ",
+        ThreadTable::kNumSlots,
+        " ops and input shapes sampled by a thread");
+  }
+
+  std::vector<SampledOpStats> stats;
+  stats.reserve(merged.size());
+  for (auto& item : merged) {
+    auto& op = item.second;
+    op.name = item.first.first;
+    op.shapes = item.first.second;
+    op.estimated_calls = op.num_samples / session.config.sampling_prob;
+    stats.push_back(std::move(op));
+  }
+  if (!session.config.output_file.empty()) {
+    writeStats(session.config.output_file, stats);
+  }
+  if (session.config.callback) {
+    session.config.callback(stats);
+  }
+  return stats;
+}
+
+void flushLoop(Session& session) {
+  c10::setThreadName("pt_sampling");
+  std::unique_lock<std::mutex> lock(session.stop_mutex);
+  while (!session.stop_cv.wait_for(
+      lock, session.config.flush_interval, [&session] {
+        return session.stopping;
+      })) {
+    lock.unlock();
+    try {
+      flush(session);
+    } catch (const std::exception& e) {
+      TORCH_WARN("Failed to flush the sampling profiler: ", e.what());
+    }
+    lock.lock();
+  }
+}
+
+} // namespace
+
+int64_t SampledOpStats::percentileNs(double fraction) const {
+  TORCH_CHECK(
+      fraction >= 0 && fraction <= 1,
+      "Expected a fraction between 0 and 1, got ",
+      fraction);
+  int64_t count = 0;
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    count += histogram[i];
+    if (count > 0 && count >= fraction * num_samples) {
+      return int64_t(1) << (i + 1);
+    }
+  }
+  return 0;
+}
+
+void enableSamplingProfiler(SamplingProfilerConfig config) {
+  std::lock_guard<std::mutex> guard(session_mutex);
+  TORCH_CHECK(
+      !std::atomic_load(&current_session),
+      "The sampling profiler is already enabled");
+  TORCH_CHECK(
+      config.sampling_prob > 0 && config.sampling_prob <= 1,
+      "Expected a sampling probability in (0, 1], got ",
+      config.sampling_prob);
+  TORCH_CHECK(
+      config.flush_interval.count() >= 0,
+      "The flush interval can't be negative");
+  auto session =
+      std::make_shared<Session>(std::move(config), next_session_id++);
+  session->callback_handle = at::addGlobalCallback(
+      at::RecordFunctionCallback(&onSampleStart, &onSampleEnd)
+          .needsInputs(session->config.record_shapes)
+          .samplingProb(session->config.sampling_prob)
+          .scopes(session->config.scopes));
+  if (session->config.flush_interval.count() > 0) {
+    auto* session_ptr = session.get();
+    session->flush_thread = std::thread([session_ptr] {
+      flushLoop(*session_ptr);
+    });
+  }
+  std::atomic_store(&current_session, std::move(session));
+}
+
+void disableSamplingProfiler() {
+  std::lock_guard<std::mutex> guard(session_mutex);
+  auto session = std::atomic_exchange(
+      &current_session, std::shared_ptr<Session>());
+  TORCH_CHECK(session, "The sampling profiler is not enabled");
+  at::removeCallback(session->callback_handle);
+  if (session->flush_thread.joinable()) {
+    {
+      std::lock_guard<std::mutex> guard(session->stop_mutex);
+      session->stopping = true;
+    }
+    session->stop_cv.notify_one();
+    session->flush_thread.join();
+  }
+  flush(*session);
+}
+
+bool samplingProfilerEnabled() {
+  return std::atomic_load(&current_session) != nullptr;
+}
+
+std::vector<SampledOpStats> flushSamplingProfiler() {
+  auto session = std::atomic_load(&current_session);
+  TORCH_CHECK(session, "The sampling profiler is not enabled");
+  return flush(*session);
+}
+
+} // namespace profiler
+}} // namespace torch::autograd
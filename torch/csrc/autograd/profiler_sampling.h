@@ -0,0 +1,85 @@
+#pragma once
+
+#include <ATen/record_function.h>
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace torch { namespace autograd {
+namespace profiler {
+
+// The latency of the samples of an op, with the given input shapes if they are
+// recorded, aggregated since the previous flush of the sampling profiler.
+struct TORCH_API SampledOpStats {
+  // Latencies are bucketed by powers of two of nanoseconds: bucket i counts
+  // the samples taking [2^i, 2^(i + 1)) ns, the first one those taking less
+  // than 2 ns and the last one those taking more than about 9 minutes.
+  static constexpr size_t kNumBuckets = 40;
+
+  std::string name;
+  // Empty unless SamplingProfilerConfig::record_shapes is set.
+  std::vector<std::vector<int64_t>> shapes;
+  int64_t num_samples = 0;
+  // num_samples scaled by the inverse of the sampling probability.
+  double estimated_calls = 0;
+  int64_t total_ns = 0;
+  std::array<int64_t, kNumBuckets> histogram{};
+
+  // Estimates the latency, in ns, below which `fraction` of the samples are,
+  // from the upper bound of the bucket it falls in.
+  int64_t percentileNs(double fraction) const;
+};
+
+using SamplingProfilerCallback =
+    std::function<void(const std::vector<SampledOpStats>&)>;
+
+struct TORCH_API SamplingProfilerConfig {
+  // The probability with which every op is sampled. Probabilities of at most
+  // 0.001 are sampled on a fast path, so that ops not sampled cost next to
+  // nothing.
+  double sampling_prob = 0.001;
+  // Whether to aggregate samples per input shapes as well as per op name.
+  // Recording shapes copies the inputs of the sampled ops.
+  bool record_shapes = false;
+  // The scopes to sample, all of them if empty.
+  std::unordered_set<at::RecordScope, std::hash<at::RecordScope>> scopes;
+  // How often the aggregates are flushed by a background thread, or zero to
+  // only flush them on calls to flushSamplingProfiler().
+  std::chrono::milliseconds flush_interval{60000};
+  // A file to which the aggregates of every flush are appended as JSON lines,
+  // if not empty.
+  std::string output_file;
+  // A callback called with the aggregates of every flush, if set. It is called
+  // from the flushing thread, and must not enable or disable the profiler.
+  SamplingProfilerCallback callback;
+};
+
+// Starts sampling the ops run by every thread, for as long as the process
+// runs or until disableSamplingProfiler(). Each thread aggregates its samples
+// in its own table, without locking, and the tables are merged when they are
+// flushed, so that the profiler can be kept enabled in production.
+//
+// The sampling profiler uses a global RecordFunction callback, and can be
+// enabled, flushed and disabled while other threads run ops. The samples of
+// ops still running when it is disabled are dropped. It runs alongside the
+// other profilers.
+TORCH_API void enableSamplingProfiler(SamplingProfilerConfig config);
+
+// Flushes the samples aggregated so far and stops sampling.
+TORCH_API void disableSamplingProfiler();
+
+TORCH_API bool samplingProfilerEnabled();
+
+// Merges the samples aggregated by every thread since the previous flush,
+// passes them to the output file and the callback of the config, and returns
+// them.
+TORCH_API std::vector<SampledOpStats> flushSamplingProfiler();
+
+} // namespace profiler
+}} // namespace torch::autograd
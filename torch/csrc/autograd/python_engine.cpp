@@ -294,6 +294,24 @@ PyObject* THPEngine_is_checkpoint_valid(PyObject *self, PyObject *noargs) {
   END_HANDLE_TH_ERRORS
 }
 
+PyObject* THPEngine_set_num_cpu_worker_threads(PyObject *self, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (!THPUtils_checkLong(arg)) {
+    throw TypeError("num_threads must be an int (got %s)", Py_TYPE(arg)->tp_name);
+  }
+  auto& engine = python::PythonEngine::get_python_engine();
+  engine.set_num_cpu_worker_threads(THPUtils_unpackLong(arg));
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+PyObject* THPEngine_num_cpu_worker_threads(PyObject *self, PyObject *noargs) {
+  HANDLE_TH_ERRORS
+  auto& engine = python::PythonEngine::get_python_engine();
+  return THPUtils_packInt64(engine.num_cpu_worker_threads());
+  END_HANDLE_TH_ERRORS
+}
+
 PyObject *THPEngine_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
 {
   return type->tp_alloc(type, 0);
@@ -305,6 +323,8 @@ static struct PyMethodDef THPEngine_methods[] = {
     METH_VARARGS | METH_KEYWORDS, nullptr},
   {(char*)"queue_callback", THPEngine_queue_callback, METH_O, nullptr},
   {(char*)"is_checkpoint_valid", THPEngine_is_checkpoint_valid, METH_NOARGS, nullptr},
+  {(char*)"set_num_cpu_worker_threads", THPEngine_set_num_cpu_worker_threads, METH_O, nullptr},
+  {(char*)"num_cpu_worker_threads", THPEngine_num_cpu_worker_threads, METH_NOARGS, nullptr},
   {nullptr}
 };
 
@@ -24,6 +24,15 @@ SavedVariable::SavedVariable(const Variable& variable, bool is_output, bool is_i
     // These copies are all shared_ptr copies, so slightly more expensive.
     // Do them here instead of in the init list in case data is undefined.
     data_ = variable.tensor_data();
+    // Leaves requiring grad, e.g. parameters, are kept alive by the user, so
+    // that packing them would only take more memory.
+    const auto& hooks = SavedVariableHooks::get_current();
+    if (hooks && !(variable.is_leaf() && requires_grad_)) {
+      packed_ = hooks->pack(data_);
+      if (packed_) {
+        data_.reset();
+      }
+    }
     // TODO(albanD) This needs to be updated when moving to multiple levels
     const auto& fw_grad = variable.fw_grad(/* level */ 0);
     if (fw_grad.defined()) {
@@ -46,7 +55,7 @@ SavedVariable::SavedVariable(const c10::optional<Variable>& variable, bool is_ou
   : SavedVariable(variable.has_value() ? *variable : Variable(), is_output, is_inplace_view) {}
 
 Variable SavedVariable::unpack(std::shared_ptr<Node> saved_for) const {
-  if (!data_.defined()) {
+  if (!data_.defined() && !packed_) {
     if (!was_default_constructed_) {
       throw std::runtime_error(ERR_BACKWARD_TWICE);
     }
@@ -63,11 +72,13 @@ Variable SavedVariable::unpack(std::shared_ptr<Node> saved_for) const {
     grad_fn = std::move(saved_for);
   }
 
+  const auto data = packed_ ? packed_->unpack() : data_;
+
   if (saved_version_ != version_counter_.current_version()) {
     std::stringstream message;
     message << "one of the variables needed for gradient computation has been "
-        "modified by an inplace operation: [" << data_.toString() << " "
-        << data_.sizes() << "]";
+        "modified by an inplace operation: [" << data.toString() << " "
+        << data.sizes() << "]";
     if (grad_fn) {
         message << ", which is output " << output_nr_
             << " of " << grad_fn->name() << ",";
@@ -92,9 +103,9 @@ Variable SavedVariable::unpack(std::shared_ptr<Node> saved_for) const {
   // in-place functions on unpacked variables.
   Variable var;
   if (grad_fn) {
-    var = make_variable(data_, Edge(std::move(grad_fn), output_nr_));
+    var = make_variable(data, Edge(std::move(grad_fn), output_nr_));
   } else {
-    var = make_variable(data_, requires_grad_);
+    var = make_variable(data, requires_grad_);
   }
   impl::set_version_counter(var, saved_version_);
 
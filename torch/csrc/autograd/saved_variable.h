@@ -2,6 +2,7 @@
 
 #include <torch/csrc/WindowsTorchApiMacro.h>
 #include <torch/csrc/autograd/forward_grad.h>
+#include <torch/csrc/autograd/saved_variable_hooks.h>
 
 #include <ATen/ATen.h>
 
@@ -17,6 +18,8 @@ TORCH_API extern const char* ERR_BACKWARD_TWICE;
 
 /// A snapshot of a variable at a certain version. A `SavedVariable` stores
 /// enough information to reconstruct a variable from a certain point in time.
+/// Its data is packed by the `SavedVariableHooks` in use when it is created,
+/// if any.
 class TORCH_API SavedVariable {
  public:
   SavedVariable() = default;
@@ -37,6 +40,7 @@ class TORCH_API SavedVariable {
   Variable unpack(std::shared_ptr<Node> saved_for = nullptr) const;
 
   void reset_data() {
+    packed_.reset();
     return data_.reset();
   }
 
@@ -46,6 +50,9 @@ class TORCH_API SavedVariable {
 
  private:
   at::Tensor data_;
+  // The packed form of the data, in which case data_ is undefined. See
+  // SavedVariableHooks.
+  std::unique_ptr<PackedVariable> packed_;
 
   // This field is used to store the forward AD gradients associated with
   // the saved Tensor. Note that this shared_ptr must never be shared with
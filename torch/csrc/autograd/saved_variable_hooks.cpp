@@ -0,0 +1,233 @@
+#include <torch/csrc/autograd/saved_variable_hooks.h>
+
+#include <ATen/core/grad_mode.h>
+#include <TH/THAllocator.h>
+#include <c10/util/Exception.h>
+#include <c10/util/StringUtil.h>
+
+#include <limits>
+#include <utility>
+
+#ifndef _WIN32
+#include <unistd.h>
+#else
+#include <process.h>
+#endif
+
+namespace torch { namespace autograd {
+
+namespace {
+
+thread_local std::shared_ptr<SavedVariableHooks> current_hooks;
+
+int64_t nbytes(const at::Tensor& tensor) {
+  return tensor.numel() * tensor.element_size();
+}
+
+// A floating point tensor converted to another floating point type.
+struct CastPackedVariable : public PackedVariable {
+  CastPackedVariable(at::Tensor data, at::ScalarType scalar_type)
+      : data_(std::move(data)), scalar_type_(scalar_type) {}
+
+  at::Tensor unpack() const override {
+    return data_.to(scalar_type_);
+  }
+
+  const at::Tensor data_;
+  const at::ScalarType scalar_type_;
+};
+
+// A floating point tensor quantized to 8 bits over the range of its values.
+struct QuantizedPackedVariable : public PackedVariable {
+  QuantizedPackedVariable(
+      at::Tensor data,
+      at::Tensor min,
+      at::Tensor scale,
+      at::ScalarType scalar_type)
+      : data_(std::move(data)),
+        min_(std::move(min)),
+        scale_(std::move(scale)),
+        scalar_type_(scalar_type) {}
+
+  at::Tensor unpack() const override {
+    return data_.to(scalar_type_).mul_(scale_).add_(min_);
+  }
+
+  const at::Tensor data_;
+  const at::Tensor min_;
+  const at::Tensor scale_;
+  const at::ScalarType scalar_type_;
+};
+
+// The weight of each of the 8 booleans packed in a byte.
+at::Tensor bit_weights(const at::Device& device) {
+  static const uint8_t kBitWeights[] = {1, 2, 4, 8, 16, 32, 64, 128};
+  return at::tensor(
+      at::ArrayRef<uint8_t>(kBitWeights),
+      at::TensorOptions().dtype(at::kByte).device(device));
+}
+
+// A boolean tensor packed to a bit per element.
+struct BitPackedVariable : public PackedVariable {
+  BitPackedVariable(at::Tensor data, at::IntArrayRef sizes, int64_t numel)
+      : data_(std::move(data)), sizes_(sizes.vec()), numel_(numel) {}
+
+  at::Tensor unpack() const override {
+    return data_.unsqueeze(1)
+        .bitwise_and(bit_weights(data_.device()))
+        .ne(0)
+        .view({-1})
+        .narrow(0, 0, numel_)
+        .view(sizes_);
+  }
+
+  const at::Tensor data_;
+  const std::vector<int64_t> sizes_;
+  const int64_t numel_;
+};
+
+// A tensor whose data lives in a file mapped in memory.
+struct MappedPackedVariable : public PackedVariable {
+  explicit MappedPackedVariable(at::Tensor data) : data_(std::move(data)) {}
+
+  at::Tensor unpack() const override {
+    return data_;
+  }
+
+  const at::Tensor data_;
+};
+
+int current_process_id() {
+#ifndef _WIN32
+  return getpid();
+#else
+  return _getpid();
+#endif
+}
+
+} // namespace
+
+const std::shared_ptr<SavedVariableHooks>& SavedVariableHooks::get_current() {
+  return current_hooks;
+}
+
+std::shared_ptr<SavedVariableHooks> SavedVariableHooks::set_current(
+    std::shared_ptr<SavedVariableHooks> hooks) {
+  std::swap(current_hooks, hooks);
+  return hooks;
+}
+
+SavedVariableHooksGuard::SavedVariableHooksGuard(
+    std::shared_ptr<SavedVariableHooks> hooks)
+    : prev_hooks_(SavedVariableHooks::set_current(std::move(hooks))) {}
+
+SavedVariableHooksGuard::~SavedVariableHooksGuard() {
+  SavedVariableHooks::set_current(std::move(prev_hooks_));
+}
+
+void SavedVariableHooksStats::record(
+    const at::Tensor& original,
+    const at::Tensor& packed) {
+  ++num_packed;
+  original_bytes += nbytes(original);
+  packed_bytes += nbytes(packed);
+}
+
+CompressSavedVariableHooks::CompressSavedVariableHooks(
+    FloatCompression float_compression,
+    bool pack_bool,
+    int64_t min_numel)
+    : float_compression_(float_compression),
+      pack_bool_(pack_bool),
+      min_numel_(min_numel) {}
+
+std::unique_ptr<PackedVariable> CompressSavedVariableHooks::pack(
+    const at::Tensor& data) {
+  // Empty tensors have nothing to pack, and no range to quantize over.
+  if (data.numel() == 0 || data.numel() < min_numel_ ||
+      data.layout() != at::kStrided || !data.is_contiguous()) {
+    return nullptr;
+  }
+  at::NoGradGuard no_grad;
+  const auto scalar_type = data.scalar_type();
+  if (scalar_type == at::kBool && pack_bool_) {
+    const auto numel = data.numel();
+    auto bits =
+        at::zeros({(numel + 7) / 8 * 8}, data.options().dtype(at::kByte));
+    bits.narrow(0, 0, numel).copy_(data.view({-1}));
+    auto packed = bits.view({-1, 8})
+                      .mul_(bit_weights(data.device()))
+                      .sum(1, /* keepdim */ false, at::kByte);
+    stats_.record(data, packed);
+    return std::make_unique<BitPackedVariable>(
+        std::move(packed), data.sizes(), numel);
+  }
+  if (scalar_type != at::kFloat && scalar_type != at::kDouble) {
+    return nullptr;
+  }
+  switch (float_compression_) {
+    case FloatCompression::None:
+      return nullptr;
+    case FloatCompression::BFloat16: {
+      auto packed = data.to(at::kBFloat16);
+      stats_.record(data, packed);
+      return std::make_unique<CastPackedVariable>(
+          std::move(packed), scalar_type);
+    }
+    case FloatCompression::Int8: {
+      auto min = data.min();
+      auto scale = ((data.max() - min) / 255)
+                       .clamp_min_(std::numeric_limits<float>::min());
+      auto packed = (data - min).div_(scale).round_().to(at::kByte);
+      stats_.record(data, packed);
+      return std::make_unique<QuantizedPackedVariable>(
+          std::move(packed), std::move(min), std::move(scale), scalar_type);
+    }
+  }
+  return nullptr;
+}
+
+FileSavedVariableHooks::FileSavedVariableHooks(
+    std::string directory,
+    int64_t min_bytes)
+    : directory_(std::move(directory)), min_bytes_(min_bytes) {
+  TORCH_CHECK(!directory_.empty(), "The directory can't be empty");
+  TORCH_CHECK(min_bytes_ > 0, "min_bytes must be positive");
+}
+
+std::unique_ptr<PackedVariable> FileSavedVariableHooks::pack(
+    const at::Tensor& data) {
+  // Quantized tensors can't be viewed over a new storage with set_.
+  if (!data.device().is_cpu() || data.layout() != at::kStrided ||
+      data.is_quantized() || !data.is_contiguous() ||
+      nbytes(data) < min_bytes_) {
+    return nullptr;
+  }
+  at::NoGradGuard no_grad;
+  const auto filename = c10::str(
+      directory_,
+      "/torch_saved_variable_",
+      current_process_id(),
+      "_",
+      next_file_id_++);
+  // The file is removed as soon as it is mapped, and its space released when
+  // the mapping goes away with the storage.
+  at::Storage storage(
+      c10::Storage::use_byte_size_t(),
+      nbytes(data),
+      THMapAllocator::makeDataPtr(
+          filename.c_str(),
+          TH_ALLOCATOR_MAPPED_SHARED | TH_ALLOCATOR_MAPPED_EXCLUSIVE |
+              TH_ALLOCATOR_MAPPED_UNLINK,
+          nbytes(data),
+          nullptr),
+      /* allocator */ nullptr,
+      /* resizable */ false);
+  auto mapped = at::empty({0}, data.options())
+                    .set_(storage, 0, data.sizes(), data.strides());
+  mapped.copy_(data);
+  stats_.record(data, mapped);
+  return std::make_unique<MappedPackedVariable>(std::move(mapped));
+}
+
+}} // namespace torch::autograd
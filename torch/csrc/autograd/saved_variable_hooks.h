@@ -0,0 +1,129 @@
+#pragma once
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+#include <ATen/ATen.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace torch { namespace autograd {
+
+/// The packed form of the data of a saved variable, e.g. a compressed copy of
+/// it, from which the data is reconstructed when the variable is unpacked in
+/// backward.
+struct TORCH_API PackedVariable {
+  virtual ~PackedVariable() = default;
+  virtual at::Tensor unpack() const = 0;
+};
+
+/// Hooks packing the data of the variables saved for backward, to reduce the
+/// memory they use until backward. The hooks in use are set per thread and
+/// per scope with `SavedVariableHooksGuard`, and apply to the variables saved
+/// by the operations executed in that scope, besides leaves requiring grad
+/// such as parameters.
+///
+/// Packing doesn't have to be lossless, the gradients computed from lossy
+/// packed variables are only approximations. The data of saved variables is
+/// only released if nothing else refers to it, e.g. the inputs of an operation
+/// still referred to by the user or by the next operation take as much memory
+/// as before until these references are gone.
+struct TORCH_API SavedVariableHooks {
+  virtual ~SavedVariableHooks() = default;
+
+  /// Returns the packed form of `data`, or nullptr to save it as is.
+  virtual std::unique_ptr<PackedVariable> pack(const at::Tensor& data) = 0;
+
+  /// Returns the hooks in use by the current thread, if any.
+  static const std::shared_ptr<SavedVariableHooks>& get_current();
+
+  /// Sets the hooks in use by the current thread and returns the previous
+  /// ones. Prefer `SavedVariableHooksGuard` in C++.
+  static std::shared_ptr<SavedVariableHooks> set_current(
+      std::shared_ptr<SavedVariableHooks> hooks);
+};
+
+/// A RAII guard setting the hooks in use by the current thread for its
+/// lifetime. Passing nullptr disables hooks set by an enclosing guard.
+///
+/// Example:
+/// @code
+/// auto hooks = std::make_shared<CompressSavedVariableHooks>();
+/// {
+///   torch::autograd::SavedVariableHooksGuard guard(hooks);
+///   loss = model->forward(input).sum();
+/// }
+/// loss.backward();
+/// @endcode
+class TORCH_API SavedVariableHooksGuard {
+ public:
+  explicit SavedVariableHooksGuard(std::shared_ptr<SavedVariableHooks> hooks);
+  ~SavedVariableHooksGuard();
+
+ private:
+  std::shared_ptr<SavedVariableHooks> prev_hooks_;
+};
+
+/// Counts the bytes of the data of the variables packed by hooks, before and
+/// after packing.
+struct TORCH_API SavedVariableHooksStats {
+  std::atomic<int64_t> num_packed{0};
+  std::atomic<int64_t> original_bytes{0};
+  std::atomic<int64_t> packed_bytes{0};
+
+  void record(const at::Tensor& original, const at::Tensor& packed);
+};
+
+/// Compresses the saved floating point and boolean tensors of at least
+/// `min_numel` elements. Floating point tensors are converted to bfloat16, or
+/// quantized to 8 bits over the range of their values, and boolean tensors,
+/// e.g. masks, are packed to a bit per element. Only contiguous tensors are
+/// compressed.
+struct TORCH_API CompressSavedVariableHooks : public SavedVariableHooks {
+  enum class FloatCompression { None, BFloat16, Int8 };
+
+  explicit CompressSavedVariableHooks(
+      FloatCompression float_compression = FloatCompression::BFloat16,
+      bool pack_bool = true,
+      int64_t min_numel = 1024);
+
+  std::unique_ptr<PackedVariable> pack(const at::Tensor& data) override;
+
+  const SavedVariableHooksStats& stats() const {
+    return stats_;
+  }
+
+ private:
+  const FloatCompression float_compression_;
+  const bool pack_bool_;
+  const int64_t min_numel_;
+  SavedVariableHooksStats stats_;
+};
+
+/// Moves the saved CPU tensors of at least `min_bytes` bytes to files mapped
+/// in memory, created in `directory`, so that the OS can write them back and
+/// release their memory until backward reads them back. The files are removed
+/// right away, and their space is released once the saved variables are.
+/// Only contiguous tensors are moved. The bytes counted by stats() are the
+/// bytes moved to files, which keep the same size.
+struct TORCH_API FileSavedVariableHooks : public SavedVariableHooks {
+  explicit FileSavedVariableHooks(
+      std::string directory,
+      int64_t min_bytes = 1024 * 1024);
+
+  std::unique_ptr<PackedVariable> pack(const at::Tensor& data) override;
+
+  const SavedVariableHooksStats& stats() const {
+    return stats_;
+  }
+
+ private:
+  const std::string directory_;
+  const int64_t min_bytes_;
+  std::atomic<uint64_t> next_file_id_{0};
+  SavedVariableHooksStats stats_;
+};
+
+}} // namespace torch::autograd
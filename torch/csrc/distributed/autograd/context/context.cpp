@@ -65,6 +65,15 @@ DistAutogradContext::recvFunctions() const {
   return recvAutogradFunctions_;
 }
 
+DistAutogradContext::GradsShard& DistAutogradContext::getGradsShard(
+    const torch::autograd::Variable& variable) {
+  // Tensors are keyed by identity, so hash the address of their TensorImpl.
+  // Drop the low bits, which are the same for all of them due to alignment.
+  auto key = reinterpret_cast<uintptr_t>(variable.unsafeGetTensorImpl()) >> 6;
+  // kNumGradShards has to be a power of 2 for this modulo trick to work.
+  return accumulatedGrads_[key & (kNumGradShards - 1)];
+}
+
 void DistAutogradContext::accumulateGrad(
     const torch::autograd::Variable& variable,
     const torch::Tensor& grad,
@@ -72,10 +81,11 @@ void DistAutogradContext::accumulateGrad(
   TORCH_INTERNAL_ASSERT(grad.defined());
   TORCH_INTERNAL_ASSERT(variable.requires_grad());
 
-  std::lock_guard<std::mutex> guard(lock_);
-  auto it = accumulatedGrads_.find(variable);
+  auto& shard = getGradsShard(variable);
+  std::lock_guard<std::mutex> guard(shard.lock);
+  auto it = shard.grads.find(variable);
   at::Tensor old_grad;
-  if (it != accumulatedGrads_.end()) {
+  if (it != shard.grads.end()) {
     // Accumulate multiple grads on the same variable.
     old_grad = it->value();
   }
@@ -96,8 +106,8 @@ void DistAutogradContext::accumulateGrad(
       // AccumulateGrad::callHooks, since it is a const ref, and that incurs a
       // refcount bump for the new_grad.
       num_expected_refs + 1,
-      [this, &variable](at::Tensor&& grad_update) {
-        accumulatedGrads_.insert(variable, std::move(grad_update));
+      [&shard, &variable](at::Tensor&& grad_update) {
+        shard.grads.insert(variable, std::move(grad_update));
       });
 }
 
@@ -213,26 +223,33 @@ std::shared_ptr<SendRpcBackward> DistAutogradContext::retrieveSendFunction(
 
 const c10::Dict<torch::Tensor, torch::Tensor> DistAutogradContext::
     getGradients() const {
-  std::lock_guard<std::mutex> guard(lock_);
-  return accumulatedGrads_;
+  c10::Dict<torch::Tensor, torch::Tensor> grads;
+  for (const auto& shard : accumulatedGrads_) {
+    std::lock_guard<std::mutex> guard(shard.lock);
+    for (const auto& entry : shard.grads) {
+      grads.insert(entry.key(), entry.value());
+    }
+  }
+  return grads;
 }
 
 void DistAutogradContext::runGradCallbackForVariable(
     const torch::autograd::Variable& variable,
     GradCallback&& cb) {
+  auto& shard = getGradsShard(variable);
   torch::Tensor grad;
   {
-    std::lock_guard<std::mutex> guard(lock_);
-    auto it = accumulatedGrads_.find(variable);
+    std::lock_guard<std::mutex> guard(shard.lock);
+    auto it = shard.grads.find(variable);
     TORCH_INTERNAL_ASSERT(
-        it != accumulatedGrads_.end(),
+        it != shard.grads.end(),
         "The grad for the variable should exist in dist_autograd context.");
     grad = it->value();
   }
   if (cb(grad)) {
-    std::lock_guard<std::mutex> guard(lock_);
+    std::lock_guard<std::mutex> guard(shard.lock);
     // Needs to update the grad in the map.
-    accumulatedGrads_.insert_or_assign(variable, std::move(grad));
+    shard.grads.insert_or_assign(variable, std::move(grad));
   }
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <functional>
 
@@ -123,10 +124,33 @@ class TORCH_API DistAutogradContext {
   std::unordered_map<int64_t, std::shared_ptr<RecvRpcBackward>>
       recvAutogradFunctions_;
 
-  // Gradients accumulated in this context so far. The key is the variable on
-  // which the gradient needs to be accumulated and the value is the gradient
-  // that needs to be accumulated on that variable..
-  c10::Dict<torch::Tensor, torch::Tensor> accumulatedGrads_;
+  // Number of shards for the accumulated gradients. Has to be a power of 2.
+  static constexpr size_t kNumGradShards = 16;
+
+  // Use cache line size for alignment.
+  static constexpr int kCacheLineSize = 64;
+
+  // Structure holding one shard of the accumulated gradients with its
+  // associated lock. Gradients for different variables are accumulated under
+  // different locks, so that concurrent backward passes hitting the same
+  // context (e.g. many trainers sending gradients to one parameter server)
+  // mostly don't serialize on each other. Align to cache line size to avoid
+  // contention between adjacent entries.
+  struct alignas(kCacheLineSize) GradsShard {
+    // Lock for this shard.
+    mutable std::mutex lock;
+
+    // Gradients accumulated in this shard so far. The key is the variable on
+    // which the gradient needs to be accumulated and the value is the gradient
+    // that needs to be accumulated on that variable.
+    c10::Dict<torch::Tensor, torch::Tensor> grads;
+  };
+
+  // Retrieve the shard holding the gradient of the given variable.
+  GradsShard& getGradsShard(const torch::autograd::Variable& variable);
+
+  // Gradients accumulated in this context so far, sharded by variable.
+  std::array<GradsShard, kNumGradShards> accumulatedGrads_;
 
   // The autograd GraphTask for the backward pass on this node for this context.
   std::shared_ptr<torch::autograd::GraphTask> graphTask_;
@@ -136,7 +160,8 @@ class TORCH_API DistAutogradContext {
   // successfully only if all these futures are done and are successful.
   std::vector<std::shared_ptr<rpc::JitFuture>> outStandingRpcs_;
 
-  // Lock to protect concurrent modification of the context.
+  // Lock to protect concurrent modification of the context, except for the
+  // accumulated gradients which are guarded by the lock of their shard.
   mutable std::mutex lock_;
 };
 
@@ -106,8 +106,7 @@ void DistEngine::globalCpuThread(
 }
 
 DistEngine::DistEngine()
-    : initializedContextIds_(),
-      engine_(Engine::get_default_engine()),
+    : engine_(Engine::get_default_engine()),
       global_cpu_ready_queue_(std::make_shared<ReadyQueue>()),
       global_cpu_thread_(
           &DistEngine::globalCpuThread,
@@ -142,6 +141,12 @@ DistEngine& DistEngine::getInstance() {
   return *engine;
 }
 
+DistEngine::ContextIdsShard& DistEngine::getContextIdsShard(
+    int64_t contextId) {
+  // kNumContextIdsShards has to be a power of 2 for this modulo trick to work.
+  return initializedContextIds_[contextId & (kNumContextIdsShards - 1)];
+}
+
 void DistEngine::validateRootsAndRetrieveEdges(
     const variable_list& roots,
     edge_list& rootEdges,
@@ -425,9 +430,10 @@ std::shared_ptr<c10::ivalue::Future> DistEngine::executeSendFunctionAsync(
     const ContextPtr& autogradContext,
     const std::shared_ptr<Node>& sendFunction,
     bool retainGraph) {
-  std::unique_lock<std::mutex> lock(initializedContextIdsLock_);
-  if (initializedContextIds_.find(autogradContext->contextId()) ==
-      initializedContextIds_.end()) {
+  auto& shard = getContextIdsShard(autogradContext->contextId());
+  std::unique_lock<std::mutex> lock(shard.lock);
+  if (shard.contextIds.find(autogradContext->contextId()) ==
+      shard.contextIds.end()) {
     edge_list outputEdges;
     // Pass in a dummy graphRoot since all send functions are the roots.
     auto dummyRoot = std::make_shared<GraphRoot>(edge_list(), variable_list());
@@ -435,7 +441,7 @@ std::shared_ptr<c10::ivalue::Future> DistEngine::executeSendFunctionAsync(
         autogradContext, {}, {}, dummyRoot, outputEdges, retainGraph);
 
     // Mark the autograd context id as initialized and unlock.
-    initializedContextIds_.insert(autogradContext->contextId());
+    shard.contextIds.insert(autogradContext->contextId());
     lock.unlock();
 
     // Enqueue the current send function.
@@ -525,17 +531,18 @@ void DistEngine::execute(
   // Compute dependencies locally, starting from all roots and all 'send'
   // functions.
   {
-    std::lock_guard<std::mutex> guard(initializedContextIdsLock_);
+    auto& shard = getContextIdsShard(autogradContext->contextId());
+    std::lock_guard<std::mutex> guard(shard.lock);
     // Context should not have been initialized already.
     TORCH_INTERNAL_ASSERT(
-        initializedContextIds_.find(autogradContext->contextId()) ==
-        initializedContextIds_.end());
+        shard.contextIds.find(autogradContext->contextId()) ==
+        shard.contextIds.end());
 
     computeDependencies(
         autogradContext, rootEdges, grads, graphRoot, outputEdges, retainGraph);
 
     // Mark the autograd context id as initialized.
-    initializedContextIds_.insert(autogradContext->contextId());
+    shard.contextIds.insert(autogradContext->contextId());
   }
 
   BackwardPassCleanupGuard guard(autogradContext);
@@ -570,13 +577,18 @@ void DistEngine::cleanupBackwardPass(const ContextPtr& autogradContext) {
 
   // Clear the context id once we're done with the autograd engine
   // processing.
-  std::lock_guard<std::mutex> guard(initializedContextIdsLock_);
-  initializedContextIds_.erase(autogradContext->contextId());
+  auto& shard = getContextIdsShard(autogradContext->contextId());
+  std::lock_guard<std::mutex> guard(shard.lock);
+  shard.contextIds.erase(autogradContext->contextId());
 }
 
 size_t DistEngine::numBackwardPasses() const {
-  std::lock_guard<std::mutex> guard(initializedContextIdsLock_);
-  return initializedContextIds_.size();
+  size_t numBackwardPasses = 0;
+  for (const auto& shard : initializedContextIds_) {
+    std::lock_guard<std::mutex> guard(shard.lock);
+    numBackwardPasses += shard.contextIds.size();
+  }
+  return numBackwardPasses;
 }
 
 std::unordered_map<std::string, int> DistEngine::getDebugInfo() const {
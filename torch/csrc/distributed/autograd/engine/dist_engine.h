@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <mutex>
 #include <unordered_set>
 
@@ -138,11 +139,32 @@ class TORCH_API DistEngine {
   void globalCpuThread(
       const std::shared_ptr<torch::autograd::ReadyQueue>& ready_queue);
 
-  // Set of autograd context_ids, which we have already initialized for
-  // distributed autograd on this node (e.g.: already computed dependencies)
-  std::unordered_set<int64_t> initializedContextIds_;
+  // Number of shards for the set of initialized context ids. Has to be a power
+  // of 2.
+  static constexpr size_t kNumContextIdsShards = 32;
 
-  mutable std::mutex initializedContextIdsLock_;
+  // Use cache line size for alignment.
+  static constexpr int kCacheLineSize = 64;
+
+  // Structure holding one shard of the set of autograd context_ids, which we
+  // have already initialized for distributed autograd on this node (e.g.:
+  // already computed dependencies), with its associated lock. Computing the
+  // dependencies of a context happens under the lock of its shard, so that
+  // gradients received for other contexts are processed concurrently. Align
+  // to cache line size to avoid contention between adjacent entries.
+  struct alignas(kCacheLineSize) ContextIdsShard {
+    // Lock for this shard.
+    mutable std::mutex lock;
+
+    // Set of initialized context ids for this shard.
+    std::unordered_set<int64_t> contextIds;
+  };
+
+  // Retrieve the shard for given context_id.
+  ContextIdsShard& getContextIdsShard(int64_t contextId);
+
+  // Sharded set of initialized autograd context_ids.
+  std::array<ContextIdsShard, kNumContextIdsShards> initializedContextIds_;
 
   // Reference to local autograd engine.
   torch::autograd::Engine& engine_;
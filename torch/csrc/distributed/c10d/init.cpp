@@ -6,6 +6,7 @@
 #ifndef _WIN32
 #include <c10d/HashStore.hpp>
 #include <c10d/ProcessGroupRoundRobin.hpp>
+#include <c10d/ProcessGroupShm.hpp>
 #endif
 #include <c10d/ProcessGroup.hpp>
 
@@ -246,9 +247,71 @@ PyObject* c10d_init(PyObject* _unused, PyObject* noargs) {
           py::call_guard<py::gil_scoped_release>());
 
   py::enum_<::c10d::BuiltinCommHookType>(module, "BuiltinCommHookType", R"(
-An enum-like class for built-in communication hooks: ``ALLREDUCE`` and ``FP16_COMPRESS``.)")
+An enum-like class for built-in communication hooks: ``ALLREDUCE``, ``FP16_COMPRESS``,
+``INT8_ROWWISE_QUANTIZE``, ``TOPK_SPARSIFY`` and ``POWER_SGD``.)")
       .value("ALLREDUCE", ::c10d::BuiltinCommHookType::ALLREDUCE)
-      .value("FP16_COMPRESS", ::c10d::BuiltinCommHookType::FP16_COMPRESS);
+      .value("FP16_COMPRESS", ::c10d::BuiltinCommHookType::FP16_COMPRESS)
+      .value(
+          "INT8_ROWWISE_QUANTIZE",
+          ::c10d::BuiltinCommHookType::INT8_ROWWISE_QUANTIZE)
+      .value("TOPK_SPARSIFY", ::c10d::BuiltinCommHookType::TOPK_SPARSIFY)
+      .value("POWER_SGD", ::c10d::BuiltinCommHookType::POWER_SGD);
+
+  py::class_<::c10d::Int8RowwiseQuantizeOptions>(
+      module, "Int8RowwiseQuantizeOptions", R"(
+Options of the built-in ``INT8_ROWWISE_QUANTIZE`` communication hook.)")
+      .def(py::init<>())
+      .def_readwrite("row_size", &::c10d::Int8RowwiseQuantizeOptions::rowSize)
+      .def_readwrite(
+          "use_error_feedback",
+          &::c10d::Int8RowwiseQuantizeOptions::useErrorFeedback);
+
+  py::class_<::c10d::TopKSparsifyOptions>(
+      module, "TopKSparsifyOptions", R"(
+Options of the built-in ``TOPK_SPARSIFY`` communication hook.)")
+      .def(py::init<>())
+      .def_readwrite("ratio", &::c10d::TopKSparsifyOptions::ratio)
+      .def_readwrite(
+          "use_error_feedback",
+          &::c10d::TopKSparsifyOptions::useErrorFeedback);
+
+  py::class_<::c10d::PowerSGDOptions>(module, "PowerSGDOptions", R"(
+Options of the built-in ``POWER_SGD`` communication hook.)")
+      .def(py::init<>())
+      .def_readwrite(
+          "matrix_approximation_rank",
+          &::c10d::PowerSGDOptions::matrixApproximationRank)
+      .def_readwrite(
+          "start_powerSGD_iter", &::c10d::PowerSGDOptions::startPowerSGDIter)
+      .def_readwrite(
+          "use_error_feedback", &::c10d::PowerSGDOptions::useErrorFeedback)
+      .def_readwrite("warm_start", &::c10d::PowerSGDOptions::warmStart)
+      .def_readwrite("random_seed", &::c10d::PowerSGDOptions::randomSeed);
+
+  module
+      .def(
+          "_register_builtin_comm_hook",
+          [](::c10d::Reducer& reducer,
+             const ::c10d::Int8RowwiseQuantizeOptions& options) {
+            reducer.register_builtin_comm_hook(options);
+          },
+          py::arg("reducer"),
+          py::arg("options"))
+      .def(
+          "_register_builtin_comm_hook",
+          [](::c10d::Reducer& reducer,
+             const ::c10d::TopKSparsifyOptions& options) {
+            reducer.register_builtin_comm_hook(options);
+          },
+          py::arg("reducer"),
+          py::arg("options"))
+      .def(
+          "_register_builtin_comm_hook",
+          [](::c10d::Reducer& reducer, const ::c10d::PowerSGDOptions& options) {
+            reducer.register_builtin_comm_hook(options);
+          },
+          py::arg("reducer"),
+          py::arg("options"));
 
   shared_ptr_class_<::c10d::Reducer>(module, "Reducer")
       .def(
@@ -298,6 +361,11 @@ An enum-like class for built-in communication hooks: ``ALLREDUCE`` and ``FP16_CO
           "_set_forward_pass_work_handle",
           &::c10d::Reducer::set_forward_pass_work_handle,
           py::call_guard<py::gil_scoped_release>())
+      .def(
+          "_set_bucket_chunk_bytes",
+          &::c10d::Reducer::set_bucket_chunk_bytes,
+          py::arg("chunk_bytes"),
+          py::call_guard<py::gil_scoped_release>())
       .def(
           "_get_local_used_maps",
           &::c10d::Reducer::get_local_used_maps_on_device);
@@ -586,6 +654,72 @@ Example::
     >>> store = dist.TCPStore("127.0.0.1", 0, 1, True, timedelta(seconds=30))
     >>> # This will throw an exception after 10 seconds
     >>> store.wait(["bad_key"], timedelta(seconds=10))
+)")
+          // Convert from std::string to std::vector<uint8>.
+          .def(
+              "multi_set",
+              [](::c10d::Store& store,
+                 const std::vector<std::string>& keys,
+                 const std::vector<std::string>& values) {
+                std::vector<std::vector<uint8_t>> values_;
+                values_.reserve(values.size());
+                for (const auto& value : values) {
+                  values_.emplace_back(value.begin(), value.end());
+                }
+                store.multiSet(keys, values_);
+              },
+              py::call_guard<py::gil_scoped_release>(),
+              R"(
+Inserts several key-value pairs into the store, like calling
+:meth:`~torch.distributed.store.set` for each of them. The
+:class:`~torch.distributed.TCPStore` sends all of them in a single request.
+
+Arguments:
+    keys (list): The keys to be added to the store.
+    values (list): The values associated with ``keys``.
+
+Example::
+    >>> import torch.distributed as dist
+    >>> from datetime import timedelta
+    >>> store = dist.TCPStore("127.0.0.1", 0, 1, True, timedelta(seconds=30))
+    >>> store.multi_set(["first_key", "second_key"], ["po", "tato"])
+    >>> # Should return [b"po", b"tato"]
+    >>> store.multi_get(["first_key", "second_key"])
+)")
+          // Convert from std::vector<uint8_t> to py::bytes.
+          .def(
+              "multi_get",
+              [](::c10d::Store& store, const std::vector<std::string>& keys) {
+                auto values = [&]() {
+                  py::gil_scoped_release guard;
+                  return store.multiGet(keys);
+                }();
+                py::list result;
+                for (auto& value : values) {
+                  result.append(py::bytes(
+                      reinterpret_cast<char*>(value.data()), value.size()));
+                }
+                return result;
+              },
+              R"(
+Retrieves the values associated with ``keys``, waiting for all of them to be
+set like :meth:`~torch.distributed.store.get`. The
+:class:`~torch.distributed.TCPStore` fetches all of them in a single request.
+
+Arguments:
+    keys (list): The keys whose values to return.
+
+Returns:
+    List of the values associated with ``keys``.
+)")
+          .def(
+              "_wait_counter",
+              &::c10d::Store::waitCounter,
+              py::call_guard<py::gil_scoped_release>(),
+              R"(
+Waits for the counter ``key``, as incremented by
+:meth:`~torch.distributed.store.add`, to reach at least ``target``, and throws
+an exception if it does not by the supplied ``timeout``.
 )");
 
   intrusive_ptr_class_<::c10d::FileStore>(
@@ -945,6 +1079,36 @@ Arguments:
               &::c10d::ProcessGroup::recvAnysource,
               py::call_guard<py::gil_scoped_release>())
 
+          .def(
+              "batch_isend_irecv",
+              [](::c10d::ProcessGroup& pg,
+                 const std::vector<at::Tensor>& sendTensors,
+                 const std::vector<int>& dstRanks,
+                 const std::vector<at::Tensor>& recvTensors,
+                 const std::vector<int>& srcRanks,
+                 int tag) {
+                TORCH_CHECK(
+                    sendTensors.size() == dstRanks.size() &&
+                        recvTensors.size() == srcRanks.size(),
+                    "Expected one rank per tensor");
+                std::vector<::c10d::P2POp> ops;
+                for (size_t i = 0; i < sendTensors.size(); i++) {
+                  ops.push_back(
+                      {::c10d::P2POp::Type::SEND, sendTensors[i], dstRanks[i]});
+                }
+                for (size_t i = 0; i < recvTensors.size(); i++) {
+                  ops.push_back(
+                      {::c10d::P2POp::Type::RECV, recvTensors[i], srcRanks[i]});
+                }
+                return pg.batch_isend_irecv(ops, tag);
+              },
+              py::arg("send_tensors"),
+              py::arg("dst_ranks"),
+              py::arg("recv_tensors"),
+              py::arg("src_ranks"),
+              py::arg("tag") = 0,
+              py::call_guard<py::gil_scoped_release>())
+
           .def(
               "barrier",
               &::c10d::ProcessGroup::barrier,
@@ -978,7 +1142,14 @@ Arguments:
       .def(py::init<>())
       .def_readwrite("devices", &::c10d::ProcessGroupGloo::Options::devices)
       .def_readwrite("timeout", &::c10d::ProcessGroupGloo::Options::timeout)
-      .def_readwrite("threads", &::c10d::ProcessGroupGloo::Options::threads);
+      .def_readwrite("threads", &::c10d::ProcessGroupGloo::Options::threads)
+      .def_readwrite(
+          "hierarchical_allreduce",
+          &::c10d::ProcessGroupGloo::Options::hierarchicalAllreduce)
+      .def_readwrite("host_id", &::c10d::ProcessGroupGloo::Options::hostId)
+      .def_readwrite(
+          "sharded_sparse_allreduce",
+          &::c10d::ProcessGroupGloo::Options::shardedSparseAllreduce);
 
   processGroupGloo.def_static(
       "create_device",
@@ -1038,6 +1209,42 @@ Arguments:
           py::call_guard<py::gil_scoped_release>());
 #endif
 
+#ifndef _WIN32
+  auto processGroupShm = intrusive_ptr_class_<::c10d::ProcessGroupShm>(
+      module, "ProcessGroupShm", processGroup);
+
+  shared_ptr_class_<::c10d::ProcessGroupShm::Options>(
+      processGroupShm, "Options")
+      .def(py::init<>())
+      .def_readwrite("timeout", &::c10d::ProcessGroupShm::Options::timeout)
+      .def_readwrite(
+          "buffer_size", &::c10d::ProcessGroupShm::Options::bufferSize);
+
+  processGroupShm
+      .def(
+          py::init<
+              const c10::intrusive_ptr<::c10d::Store>&,
+              int,
+              int,
+              ::c10d::ProcessGroupShm::Options>(),
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          py::init([](const c10::intrusive_ptr<::c10d::Store>& store,
+                      int rank,
+                      int size,
+                      std::chrono::milliseconds timeout) {
+            ::c10d::ProcessGroupShm::Options options;
+            options.timeout = timeout;
+            return c10::make_intrusive<::c10d::ProcessGroupShm>(
+                store, rank, size, options);
+          }),
+          py::arg("store"),
+          py::arg("rank"),
+          py::arg("size"),
+          py::arg("timeout") = std::chrono::milliseconds(30 * 1000), // NOLINT
+          py::call_guard<py::gil_scoped_release>());
+#endif
+
 #ifdef USE_C10D_NCCL
   auto processGroupNCCL =
       intrusive_ptr_class_<::c10d::ProcessGroupNCCL>(
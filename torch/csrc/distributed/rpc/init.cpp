@@ -607,6 +607,25 @@ PyObject* rpc_init(PyObject* _unused, PyObject* noargs) {
           "device_maps",
           &TensorPipeRpcBackendOptions::deviceMaps,
           R"(The device map locations.)")
+      .def_readwrite(
+          "batch_window_us",
+          &TensorPipeRpcBackendOptions::batchWindowUs,
+          R"(
+              The time window, in microseconds, during which small requests to
+              the same destination are coalesced into a single message. Zero
+              (the default) disables batching.
+          )")
+      .def_readwrite(
+          "batch_max_message_bytes",
+          &TensorPipeRpcBackendOptions::batchMaxMessageBytes,
+          R"(
+              The largest size, in bytes, of the payload and tensor storages of
+              a request for it to be batched.
+          )")
+      .def_readwrite(
+          "batch_max_messages",
+          &TensorPipeRpcBackendOptions::batchMaxMessages,
+          R"(The number of requests after which a batch is sent right away.)")
       .def("set_device_map", &TensorPipeRpcBackendOptions::setDeviceMap);
 
   module.attr("_DEFAULT_NUM_WORKER_THREADS") =
@@ -85,6 +85,10 @@ enum MessageType {
   RREF_BACKWARD_REQ = 23 | MessageTypeFlags::REQUEST_TYPE,
   RREF_BACKWARD_RESP = 24 | MessageTypeFlags::RESPONSE_TYPE,
 
+  // Several requests coalesced by the TensorPipe agent. Unpacked by the agent
+  // of the callee, so it never reaches the request callback.
+  BATCHED_REQ = 25 | MessageTypeFlags::REQUEST_TYPE,
+
   // Other internal message types
   EXCEPTION = 55 | MessageTypeFlags::RESPONSE_TYPE,
   UNKNOWN = 60
@@ -2,6 +2,7 @@
 
 #ifdef USE_TENSORPIPE
 
+#include <cstring>
 #include <limits>
 
 #include <fmt/format.h>
@@ -38,6 +39,10 @@ const std::string kNumIdleThreads = "agent.num_idle_threads";
 const std::string kClientActiveCalls = "agent.client_active_calls";
 const std::string kServerActiveCalls = "agent.server_active_calls";
 const std::string kServerActiveAsyncCalls = "agent.server_active_async_calls";
+const std::string kBatchingPrefix = "agent.batching.";
+const std::string kBatchQueueDepth = ".queue_depth";
+const std::string kBatchNumBatches = ".num_batches";
+const std::string kBatchAverageSize = ".average_batch_size";
 
 std::vector<c10::DeviceIndex> getDevicesForTensors(
     const std::vector<torch::Tensor>& tensors,
@@ -75,6 +80,100 @@ std::vector<c10::DeviceIndex> getDevicesForTensors(
   return deviceIndices;
 }
 
+// A BATCHED_REQ message holds the number of requests, followed by a header for
+// each of them and by all their payloads, one after the other. Its tensors are
+// the tensors of all the requests, in order, so that TensorPipe reads them
+// straight into the tensors handed to the requests when unpacking the batch.
+struct BatchedRequestHeader {
+  MessageType type;
+  int64_t id;
+  uint64_t payloadSize;
+  uint64_t numTensors;
+};
+
+size_t requestSizeInBytes(const Message& message) {
+  size_t size = message.payload().size();
+  for (const auto& tensor : message.tensors()) {
+    size += tensor.storage().nbytes();
+  }
+  return size;
+}
+
+Message batchRequests(std::vector<Message>&& requests) {
+  const uint64_t numRequests = requests.size();
+  size_t size = sizeof(numRequests) + numRequests * sizeof(BatchedRequestHeader);
+  size_t numTensors = 0;
+  for (const auto& request : requests) {
+    size += request.payload().size();
+    numTensors += request.tensors().size();
+  }
+
+  std::vector<char> payload(size);
+  std::vector<torch::Tensor> tensors;
+  tensors.reserve(numTensors);
+  char* header = payload.data();
+  char* data = header + sizeof(numRequests) +
+      numRequests * sizeof(BatchedRequestHeader);
+  std::memcpy(header, &numRequests, sizeof(numRequests));
+  header += sizeof(numRequests);
+  for (auto& request : requests) {
+    const BatchedRequestHeader requestHeader{
+        request.type(),
+        request.id(),
+        request.payload().size(),
+        request.tensors().size()};
+    std::memcpy(header, &requestHeader, sizeof(requestHeader));
+    header += sizeof(requestHeader);
+    std::memcpy(data, request.payload().data(), request.payload().size());
+    data += request.payload().size();
+    for (auto& tensor : request.tensors()) {
+      tensors.push_back(std::move(tensor));
+    }
+  }
+  const auto id = requests.front().id();
+  return Message(
+      std::move(payload), std::move(tensors), MessageType::BATCHED_REQ, id);
+}
+
+std::vector<Message> unbatchRequests(Message&& batch) {
+  const auto& payload = batch.payload();
+  auto& tensors = batch.tensors();
+  uint64_t numRequests = 0;
+  TORCH_INTERNAL_ASSERT(
+      payload.size() >= sizeof(numRequests), "Malformed batch of requests");
+  std::memcpy(&numRequests, payload.data(), sizeof(numRequests));
+  const char* header = payload.data() + sizeof(numRequests);
+  const char* data = header + numRequests * sizeof(BatchedRequestHeader);
+  const char* end = payload.data() + payload.size();
+  TORCH_INTERNAL_ASSERT(data <= end, "Malformed batch of requests");
+
+  std::vector<Message> requests;
+  requests.reserve(numRequests);
+  size_t tensorIdx = 0;
+  for (uint64_t i = 0; i < numRequests; ++i) {
+    BatchedRequestHeader requestHeader;
+    std::memcpy(&requestHeader, header, sizeof(requestHeader));
+    header += sizeof(requestHeader);
+    TORCH_INTERNAL_ASSERT(
+        requestHeader.payloadSize <= static_cast<uint64_t>(end - data) &&
+            requestHeader.numTensors <= tensors.size() - tensorIdx,
+        "Malformed batch of requests");
+    std::vector<char> requestPayload(data, data + requestHeader.payloadSize);
+    data += requestHeader.payloadSize;
+    std::vector<torch::Tensor> requestTensors(
+        std::make_move_iterator(tensors.begin() + tensorIdx),
+        std::make_move_iterator(
+            tensors.begin() + tensorIdx + requestHeader.numTensors));
+    tensorIdx += requestHeader.numTensors;
+    requests.emplace_back(
+        std::move(requestPayload),
+        std::move(requestTensors),
+        requestHeader.type,
+        requestHeader.id);
+  }
+  return requests;
+}
+
 } // namespace
 
 // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
@@ -470,6 +569,15 @@ TensorPipeAgent::TensorPipeAgent(
       nameToAddressStore_("addrs", store),
       worldSize_(worldSize),
       processGroup_(std::move(processGroup)) {
+  TORCH_CHECK(
+      opts_.batchWindowUs >= 0,
+      "batch_window_us must be non-negative, got ",
+      opts_.batchWindowUs);
+  TORCH_CHECK(
+      opts_.batchMaxMessages > 0,
+      "batch_max_messages must be positive, got ",
+      opts_.batchMaxMessages);
+
   collectNames();
 
   // Initialize the time-series metrics tracking map
@@ -579,6 +687,10 @@ void TensorPipeAgent::startImpl() {
   // Start the Timeout Thread
   timeoutThread_ = std::thread(&TensorPipeAgent::pollTimeoutRpcs, this);
 
+  if (opts_.batchWindowUs > 0) {
+    batchThread_ = std::thread(&TensorPipeAgent::flushBatchesLoop, this);
+  }
+
   listener_->accept([this](
                         const tensorpipe::Error& error,
                         std::shared_ptr<tensorpipe::Pipe> pipe) {
@@ -778,59 +890,71 @@ void TensorPipeAgent::respond(std::shared_ptr<tensorpipe::Pipe>& pipe) {
         // Arm for next read
         respond(pipe);
 
-        uint64_t messageId = requestMessage.id();
-        increaseCallCount(serverActiveCalls_);
-
-        VLOG(1) << "RPC agent for " << workerInfo_.name_
-                << " received request #" << messageId << " from "
-                << pipe->getRemoteName();
-
-        // Defer user RPC UDF run to thread pool
-        threadPool_.run([this,
-                         pipe,
-                         messageId,
-                         requestMessage{std::move(requestMessage)},
-                         ctx{std::move(ctx)}]() mutable {
-          // create guards again as this function runs on a different thread
-          MultiStreamGuard guard(ctx);
-          VLOG(1) << "RPC agent for " << workerInfo_.name_
-                  << " is running request #" << messageId << " from "
-                  << pipe->getRemoteName() << " in thread pool";
-
-          std::shared_ptr<JitFuture> futureResponseMessage;
-          try {
-            futureResponseMessage = cb_->operator()(requestMessage);
-          } catch (const std::exception& /* unused */) {
-            futureResponseMessage =
-                std::make_shared<JitFuture>(at::AnyClassType::get());
-            futureResponseMessage->setError(std::current_exception());
+        if (requestMessage.type() == MessageType::BATCHED_REQ) {
+          for (auto& request : unbatchRequests(std::move(requestMessage))) {
+            handleRequest(pipe, std::move(request), ctx);
           }
+        } else {
+          handleRequest(pipe, std::move(requestMessage), std::move(ctx));
+        }
+      });
+}
 
-          // Shortcut if immediately done
-          if (futureResponseMessage->completed()) {
-            decreaseCallCount(serverActiveCalls_);
-            sendCompletedResponseMessage(
-                pipe, futureResponseMessage, messageId, std::move(ctx));
-          } else {
-            // Not complete yet
-            increaseCallCount(serverActiveAsyncCalls_);
-            futureResponseMessage->addCallback([this,
-                                                pipe,
-                                                futureResponseMessage,
-                                                messageId,
-                                                ctx{std::move(ctx)}]() mutable {
-              decreaseCallCount(serverActiveCalls_);
-              decreaseCallCount(serverActiveAsyncCalls_);
-              sendCompletedResponseMessage(
-                  pipe, futureResponseMessage, messageId, std::move(ctx));
-            });
-          }
+void TensorPipeAgent::handleRequest(
+    std::shared_ptr<tensorpipe::Pipe>& pipe,
+    Message&& requestMessage,
+    std::shared_ptr<LazyStreamContext> ctx) {
+  uint64_t messageId = requestMessage.id();
+  increaseCallCount(serverActiveCalls_);
+
+  VLOG(1) << "RPC agent for " << workerInfo_.name_ << " received request #"
+          << messageId << " from " << pipe->getRemoteName();
+
+  // Defer user RPC UDF run to thread pool
+  threadPool_.run([this,
+                   pipe,
+                   messageId,
+                   requestMessage{std::move(requestMessage)},
+                   ctx{std::move(ctx)}]() mutable {
+    // create guards again as this function runs on a different thread
+    MultiStreamGuard guard(ctx);
+    VLOG(1) << "RPC agent for " << workerInfo_.name_
+            << " is running request #" << messageId << " from "
+            << pipe->getRemoteName() << " in thread pool";
 
-          VLOG(1) << "RPC agent for " << workerInfo_.name_
-                  << " done running request #" << messageId << " from "
-                  << pipe->getRemoteName() << " in thread pool";
-        });
+    std::shared_ptr<JitFuture> futureResponseMessage;
+    try {
+      futureResponseMessage = cb_->operator()(requestMessage);
+    } catch (const std::exception& /* unused */) {
+      futureResponseMessage =
+          std::make_shared<JitFuture>(at::AnyClassType::get());
+      futureResponseMessage->setError(std::current_exception());
+    }
+
+    // Shortcut if immediately done
+    if (futureResponseMessage->completed()) {
+      decreaseCallCount(serverActiveCalls_);
+      sendCompletedResponseMessage(
+          pipe, futureResponseMessage, messageId, std::move(ctx));
+    } else {
+      // Not complete yet
+      increaseCallCount(serverActiveAsyncCalls_);
+      futureResponseMessage->addCallback([this,
+                                          pipe,
+                                          futureResponseMessage,
+                                          messageId,
+                                          ctx{std::move(ctx)}]() mutable {
+        decreaseCallCount(serverActiveCalls_);
+        decreaseCallCount(serverActiveAsyncCalls_);
+        sendCompletedResponseMessage(
+            pipe, futureResponseMessage, messageId, std::move(ctx));
       });
+    }
+
+    VLOG(1) << "RPC agent for " << workerInfo_.name_
+            << " done running request #" << messageId << " from "
+            << pipe->getRemoteName() << " in thread pool";
+  });
 }
 
 std::shared_ptr<JitFuture> TensorPipeAgent::send(
@@ -854,6 +978,22 @@ std::shared_ptr<JitFuture> TensorPipeAgent::send(
 
   const auto& url = findWorkerURL(toWorkerInfo);
 
+  // Use the default RPC timeout if no timeout is specified for this send call
+  auto timeout = rpcTimeoutSeconds == kUnsetRpcTimeout
+      ? getRpcTimeout()
+      : std::chrono::milliseconds(
+            static_cast<int>(rpcTimeoutSeconds * kSecToMsConversion));
+
+  // We only add to the timeoutMap_ if the timeout is not 0. Per our
+  // documentation, a user-provided timeout of 0 indicates the RPC should never
+  // expire (infinite timeout), so there is no need to track it in the
+  // timeoutMap_.
+  steady_clock_time_point expirationTime;
+  if (timeout.count() != 0) {
+    // Compute the expiration time for this message based on the timeout
+    expirationTime = computeRpcMessageExpiryTime(timeout);
+  }
+
   std::unique_lock<std::mutex> lock(mutex_);
 
   // See if we already have a connection to this address or not
@@ -871,7 +1011,8 @@ std::shared_ptr<JitFuture> TensorPipeAgent::send(
       reverseDeviceMaps_.empty() && opts_.deviceMaps.empty());
   uint64_t messageId = nextMessageID_++;
   requestMessage.setId(messageId);
-  pendingResponseMessage[messageId] = futureResponseMessage;
+  pendingResponseMessage[messageId] =
+      std::make_pair(futureResponseMessage, expirationTime);
 
   lock.unlock();
 
@@ -894,21 +1035,7 @@ std::shared_ptr<JitFuture> TensorPipeAgent::send(
   });
 
   increaseCallCount(clientActiveCalls_);
-  // Use the default RPC timeout if no timeout is specified for this send call
-  auto timeout = rpcTimeoutSeconds == kUnsetRpcTimeout
-      ? getRpcTimeout()
-      : std::chrono::milliseconds(
-            static_cast<int>(rpcTimeoutSeconds * kSecToMsConversion));
-
-  // We only add to the timeoutMap_ if the timeout is not 0. Per our
-  // documentation, a user-provided timeout of 0 indicates the RPC should never
-  // expire (infinite timeout), so there is no need to track it in the
-  // timeoutMap_.
-  steady_clock_time_point expirationTime;
   if (timeout.count() != 0) {
-    // Compute the expiration time for this message based on the timeout
-    expirationTime = computeRpcMessageExpiryTime(timeout);
-
     // Add the Future to the right vector in the timeoutMap_
     {
       std::unique_lock<std::mutex> lock(timeoutMapMutex_);
@@ -919,6 +1046,23 @@ std::shared_ptr<JitFuture> TensorPipeAgent::send(
     timeoutThreadCV_.notify_one();
   }
 
+  // Small requests carrying only CPU tensors are batched, if enabled. Any
+  // other request is written right after the pending batch to its destination,
+  // so that requests are written in the order they were sent.
+  std::unique_lock<std::mutex> batchLock(batchMutex_, std::defer_lock);
+  if (opts_.batchWindowUs > 0) {
+    batchLock.lock();
+    if (devices.empty() && deviceMap.empty() &&
+        requestSizeInBytes(requestMessage) <= opts_.batchMaxMessageBytes) {
+      VLOG(1) << "RPC agent for " << workerInfo_.name_
+              << " is batching request #" << messageId << " to "
+              << clientPipe.pipe_->getRemoteName();
+      enqueueBatchedRequest(clientPipe, std::move(requestMessage));
+      return futureResponseMessage->jitFuture;
+    }
+    flushBatchedRequests(clientPipe);
+  }
+
   VLOG(1) << "RPC agent for " << workerInfo_.name_ << " is sending request #"
           << messageId << " to " << clientPipe.pipe_->getRemoteName();
 
@@ -929,110 +1073,194 @@ std::shared_ptr<JitFuture> TensorPipeAgent::send(
       std::move(requestMessage),
       std::move(devices),
       std::move(ctx),
-      [this, &clientPipe, messageId, expirationTime](
-          const tensorpipe::Error& error) mutable {
+      [this, &clientPipe, messageId](const tensorpipe::Error& error) mutable {
+        onRequestsWritten(clientPipe, error, {messageId});
+      },
+      deviceMap);
+
+  return futureResponseMessage->jitFuture;
+}
+
+void TensorPipeAgent::onRequestsWritten(
+    ClientPipe& clientPipe,
+    const tensorpipe::Error& error,
+    const std::vector<uint64_t>& messageIds) {
+  if (error) {
+    if (error.isOfType<tensorpipe::PipeClosedError>() &&
+        !rpcAgentRunning_.load()) {
+      // This is expected.
+    } else {
+      LOG(WARNING) << "RPC agent for " << workerInfo_.name_
+                   << " encountered error when sending outgoing request #"
+                   << messageIds.front() << " to "
+                   << clientPipe.pipe_->getRemoteName() << ": "
+                   << error.what();
+    }
+    for (const auto messageId : messageIds) {
+      auto pendingFutIt = clientPipe.pendingResponseMessage_.find(messageId);
+      if (pendingFutIt != clientPipe.pendingResponseMessage_.end()) {
+        markFutureWithError(pendingFutIt->second.first, error.what());
+      }
+    }
+    return;
+  }
+
+  for (const auto messageId : messageIds) {
+    VLOG(1) << "RPC agent for " << workerInfo_.name_ << " sent request #"
+            << messageId << " to " << clientPipe.pipe_->getRemoteName();
+
+    readResponse(clientPipe);
+  }
+}
+
+void TensorPipeAgent::readResponse(ClientPipe& clientPipe) {
+  pipeRead(
+      clientPipe.pipe_,
+      [this, &clientPipe](
+          const tensorpipe::Error& error,
+          Message&& responseMessage,
+          std::shared_ptr<LazyStreamContext> ctx) {
         if (error) {
           if (error.isOfType<tensorpipe::PipeClosedError>() &&
               !rpcAgentRunning_.load()) {
             // This is expected.
           } else {
-            LOG(WARNING) << "RPC agent for " << workerInfo_.name_
-                         << " encountered error when sending outgoing request #"
-                         << messageId << " to "
-                         << clientPipe.pipe_->getRemoteName() << ": "
-                         << error.what();
+            LOG(WARNING)
+                << "RPC agent for " << workerInfo_.name_
+                << " encountered error when reading incoming response from "
+                << clientPipe.pipe_->getRemoteName() << ": " << error.what();
           }
-          auto pendingFutIt =
-              clientPipe.pendingResponseMessage_.find(messageId);
-          if (pendingFutIt != clientPipe.pendingResponseMessage_.end()) {
-            markFutureWithError(pendingFutIt->second, error.what());
+          // We may get garbage content in responseMessage upon error.
+          // Flushing all future messages belonging to this pipe due to
+          // error state.
+          decltype(clientPipe.pendingResponseMessage_) pendingMsgs;
+          {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::swap(clientPipe.pendingResponseMessage_, pendingMsgs);
+            clientPipe.readError_ = true;
+          }
+          std::string errorMsg = error.what();
+          for (auto& p : pendingMsgs) {
+            markFutureWithError(std::move(p.second.first), errorMsg);
+
+            // Remove entry from timeoutMap_.
+            removeFromTimeoutMap(p.first, p.second.second);
           }
           return;
         }
 
-        VLOG(1) << "RPC agent for " << workerInfo_.name_ << " sent request #"
-                << messageId << " to " << clientPipe.pipe_->getRemoteName();
-
-        pipeRead(
-            clientPipe.pipe_,
-            [this, &clientPipe, expirationTime](
-                const tensorpipe::Error& error,
-                Message&& responseMessage,
-                std::shared_ptr<LazyStreamContext> ctx) {
-              if (error) {
-                if (error.isOfType<tensorpipe::PipeClosedError>() &&
-                    !rpcAgentRunning_.load()) {
-                  // This is expected.
-                } else {
-                  LOG(WARNING)
-                      << "RPC agent for " << workerInfo_.name_
-                      << " encountered error when reading incoming response from "
-                      << clientPipe.pipe_->getRemoteName() << ": "
-                      << error.what();
-                }
-                // We may get garbage content in responseMessage upon error.
-                // Flushing all future messages belonging to this pipe due to
-                // error state.
-                decltype(clientPipe.pendingResponseMessage_) pendingMsgs;
-                {
-                  std::lock_guard<std::mutex> lock(mutex_);
-                  std::swap(clientPipe.pendingResponseMessage_, pendingMsgs);
-                  clientPipe.readError_ = true;
-                }
-                std::string errorMsg = error.what();
-                for (auto& p : pendingMsgs) {
-                  markFutureWithError(std::move(p.second), errorMsg);
-                }
-
-                // Remove entry from timeoutMap_.
-                removeFromTimeoutMap(responseMessage.id(), expirationTime);
-                return;
-              }
-
-              // Identify future response message by message ID
-              uint64_t messageId = responseMessage.id();
-
-              VLOG(1) << "RPC agent for " << workerInfo_.name_
-                      << " received response #" << messageId << " from "
-                      << clientPipe.pipe_->getRemoteName();
-
-              std::shared_ptr<AtomicJitFuture> futureResponseMessage;
-              {
-                std::lock_guard<std::mutex> lock(mutex_);
-                // A read error will lead all following callbacks to be
-                // invoked with error, and shouldn't reach here.
-                TORCH_INTERNAL_ASSERT(
-                    !clientPipe.readError_, "Shouldn't in error state");
-                auto it = clientPipe.pendingResponseMessage_.find(messageId);
-                TORCH_INTERNAL_ASSERT(
-                    it != clientPipe.pendingResponseMessage_.end(),
-                    "message ID ",
-                    messageId,
-                    " is not recognized");
-                futureResponseMessage = std::move(it->second);
-                clientPipe.pendingResponseMessage_.erase(it);
-              }
-
-              // Remove entry from timeoutMap_.
-              removeFromTimeoutMap(messageId, expirationTime);
-
-              if (responseMessage.type() == MessageType::EXCEPTION) {
-                markFutureWithError(
-                    std::move(futureResponseMessage),
-                    std::string(
-                        responseMessage.payload().begin(),
-                        responseMessage.payload().end()));
-              } else {
-                markFutureAsComplete(
-                    std::move(futureResponseMessage),
-                    std::move(responseMessage),
-                    std::move(ctx));
-              }
-            });
-      },
-      deviceMap);
+        // Identify future response message by message ID
+        uint64_t messageId = responseMessage.id();
 
-  return futureResponseMessage->jitFuture;
+        VLOG(1) << "RPC agent for " << workerInfo_.name_
+                << " received response #" << messageId << " from "
+                << clientPipe.pipe_->getRemoteName();
+
+        std::shared_ptr<AtomicJitFuture> futureResponseMessage;
+        steady_clock_time_point expirationTime;
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          // A read error will lead all following callbacks to be
+          // invoked with error, and shouldn't reach here.
+          TORCH_INTERNAL_ASSERT(
+              !clientPipe.readError_, "Shouldn't in error state");
+          auto it = clientPipe.pendingResponseMessage_.find(messageId);
+          TORCH_INTERNAL_ASSERT(
+              it != clientPipe.pendingResponseMessage_.end(),
+              "message ID ",
+              messageId,
+              " is not recognized");
+          futureResponseMessage = std::move(it->second.first);
+          expirationTime = it->second.second;
+          clientPipe.pendingResponseMessage_.erase(it);
+        }
+
+        // Remove entry from timeoutMap_.
+        removeFromTimeoutMap(messageId, expirationTime);
+
+        if (responseMessage.type() == MessageType::EXCEPTION) {
+          markFutureWithError(
+              std::move(futureResponseMessage),
+              std::string(
+                  responseMessage.payload().begin(),
+                  responseMessage.payload().end()));
+        } else {
+          markFutureAsComplete(
+              std::move(futureResponseMessage),
+              std::move(responseMessage),
+              std::move(ctx));
+        }
+      });
+}
+
+void TensorPipeAgent::enqueueBatchedRequest(
+    ClientPipe& clientPipe,
+    Message&& requestMessage) {
+  if (clientPipe.pendingBatch_.empty()) {
+    clientPipe.batchDeadline_ = std::chrono::steady_clock::now() +
+        std::chrono::microseconds(opts_.batchWindowUs);
+    batchDeadlines_.emplace_back(clientPipe.batchDeadline_, &clientPipe);
+    batchCV_.notify_one();
+  }
+  clientPipe.pendingBatch_.push_back(std::move(requestMessage));
+  if (clientPipe.pendingBatch_.size() >= opts_.batchMaxMessages) {
+    flushBatchedRequests(clientPipe);
+  }
+}
+
+void TensorPipeAgent::flushBatchedRequests(ClientPipe& clientPipe) {
+  if (clientPipe.pendingBatch_.empty()) {
+    return;
+  }
+
+  std::vector<Message> requests;
+  std::swap(requests, clientPipe.pendingBatch_);
+  std::vector<uint64_t> messageIds;
+  messageIds.reserve(requests.size());
+  for (const auto& request : requests) {
+    messageIds.push_back(request.id());
+  }
+  ++clientPipe.numBatches_;
+  clientPipe.numBatchedRequests_ += requests.size();
+
+  VLOG(1) << "RPC agent for " << workerInfo_.name_ << " is sending a batch of "
+          << requests.size() << " requests to "
+          << clientPipe.pipe_->getRemoteName();
+
+  // A batch of one request is sent as is.
+  Message message = requests.size() == 1 ? std::move(requests.front())
+                                         : batchRequests(std::move(requests));
+  pipeWrite(
+      clientPipe.pipe_,
+      std::move(message),
+      /* devices */ {},
+      createLazyStreamContext(),
+      [this, &clientPipe, messageIds{std::move(messageIds)}](
+          const tensorpipe::Error& error) {
+        onRequestsWritten(clientPipe, error, messageIds);
+      });
+}
+
+void TensorPipeAgent::flushBatchesLoop() {
+  std::unique_lock<std::mutex> lock(batchMutex_);
+  while (rpcAgentRunning_.load()) {
+    if (batchDeadlines_.empty()) {
+      batchCV_.wait(lock);
+      continue;
+    }
+    const auto deadline = batchDeadlines_.front().first;
+    if (std::chrono::steady_clock::now() < deadline) {
+      batchCV_.wait_until(lock, deadline);
+      continue;
+    }
+    ClientPipe& clientPipe = *batchDeadlines_.front().second;
+    batchDeadlines_.pop_front();
+    // The batch may have been sent already, because it was full or because a
+    // request that can't be batched was sent after it.
+    if (clientPipe.batchDeadline_ == deadline) {
+      flushBatchedRequests(clientPipe);
+    }
+  }
 }
 
 void TensorPipeAgent::pollTimeoutRpcs() {
@@ -1150,6 +1378,39 @@ void TensorPipeAgent::shutdownImpl() {
   VLOG(1) << "RPC agent for " << workerInfo_.name_
           << " done waiting for timeout thread to join";
 
+  // Join the Batch Thread and fail the requests that it didn't get to send.
+  {
+    std::lock_guard<std::mutex> batchLock(batchMutex_);
+  }
+  batchCV_.notify_one();
+  if (batchThread_.joinable()) {
+    batchThread_.join();
+  }
+  {
+    std::vector<std::shared_ptr<AtomicJitFuture>> unsentFutures;
+    {
+      std::lock_guard<std::mutex> batchLock(batchMutex_);
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (auto& entry : connectedPipes_) {
+        ClientPipe& clientPipe = entry.second;
+        for (const auto& request : clientPipe.pendingBatch_) {
+          auto it = clientPipe.pendingResponseMessage_.find(request.id());
+          if (it != clientPipe.pendingResponseMessage_.end()) {
+            unsentFutures.push_back(std::move(it->second.first));
+            clientPipe.pendingResponseMessage_.erase(it);
+          }
+        }
+        clientPipe.pendingBatch_.clear();
+      }
+      batchDeadlines_.clear();
+    }
+    for (auto& future : unsentFutures) {
+      markFutureWithError(
+          std::move(future),
+          "RPC agent was shut down before the request was sent");
+    }
+  }
+
   // This will close all the pipes and listeners, invoke all callbacks with
   // errors, turn down the I/O event loops and wait for everything to terminate.
   context_->join();
@@ -1208,6 +1469,24 @@ std::unordered_map<std::string, std::string> TensorPipeAgent::getMetrics() {
     metrics[kServerActiveCalls] = c10::to_string(serverActiveCalls_);
     metrics[kServerActiveAsyncCalls] = c10::to_string(serverActiveAsyncCalls_);
   }
+  if (opts_.batchWindowUs > 0) {
+    std::lock_guard<std::mutex> batchLock(batchMutex_);
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& entry : connectedPipes_) {
+      const ClientPipe& clientPipe = entry.second;
+      const std::string prefix =
+          kBatchingPrefix + clientPipe.pipe_->getRemoteName();
+      metrics[prefix + kBatchQueueDepth] =
+          c10::to_string(clientPipe.pendingBatch_.size());
+      metrics[prefix + kBatchNumBatches] =
+          c10::to_string(clientPipe.numBatches_);
+      metrics[prefix + kBatchAverageSize] = c10::to_string(
+          clientPipe.numBatches_ == 0
+              ? 0
+              : clientPipe.numBatchedRequests_ /
+                  (float)clientPipe.numBatches_);
+    }
+  }
   if (isGILProfilingEnabled()) {
     {
       std::unique_lock<std::mutex> lock(metricsMutex_);
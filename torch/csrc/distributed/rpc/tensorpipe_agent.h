@@ -3,6 +3,7 @@
 #ifdef USE_TENSORPIPE
 
 #include <atomic>
+#include <deque>
 #include <thread>
 
 #include <c10/core/thread_pool.h>
@@ -92,6 +93,8 @@ struct CudaChannelRegistration {
 C10_DECLARE_REGISTRY(TensorPipeCudaChannelRegistry, CudaChannelRegistration);
 
 constexpr auto kDefaultNumWorkerThreads = 16;
+constexpr size_t kDefaultBatchMaxMessageBytes = 16 * 1024;
+constexpr size_t kDefaultBatchMaxMessages = 64;
 
 struct TensorPipeRpcBackendOptions : public RpcBackendOptions {
   TensorPipeRpcBackendOptions(
@@ -148,6 +151,15 @@ struct TensorPipeRpcBackendOptions : public RpcBackendOptions {
   const optional<std::vector<std::string>> transports;
   const optional<std::vector<std::string>> channels;
   std::unordered_map<std::string, tensorpipe::DeviceMap> deviceMaps;
+
+  // Small requests to the same destination that are sent within this many
+  // microseconds of each other are coalesced into a single TensorPipe message.
+  // A request is small if it only holds CPU tensors and its payload and tensor
+  // storages take at most batchMaxMessageBytes. A batch is sent as soon as it
+  // holds batchMaxMessages requests. Zero disables batching.
+  int64_t batchWindowUs{0};
+  size_t batchMaxMessageBytes{kDefaultBatchMaxMessageBytes};
+  size_t batchMaxMessages{kDefaultBatchMaxMessages};
 };
 
 // Struct to track the network source metrics
@@ -267,6 +279,13 @@ class TensorPipeAgent : public RpcAgent {
   // Respond to a call from a peer
   void respond(std::shared_ptr<tensorpipe::Pipe>& pipe);
 
+  // Runs a request received from a peer on the thread pool and sends back its
+  // response.
+  void handleRequest(
+      std::shared_ptr<tensorpipe::Pipe>& pipe,
+      Message&& requestMessage,
+      std::shared_ptr<LazyStreamContext> ctx);
+
   void sendCompletedResponseMessage(
       std::shared_ptr<tensorpipe::Pipe>& pipe,
       std::shared_ptr<JitFuture>& futureResponseMessage,
@@ -342,11 +361,43 @@ class TensorPipeAgent : public RpcAgent {
     explicit ClientPipe(std::shared_ptr<tensorpipe::Pipe> pipe) : pipe_(pipe) {}
     std::shared_ptr<tensorpipe::Pipe> pipe_;
     bool readError_{false};
-    // Map from Message Request ID's to corresponding futures.
-    std::unordered_map<uint64_t, std::shared_ptr<AtomicJitFuture>>
+    // Map from Message Request ID's to corresponding futures and to the
+    // expiration times under which they are tracked in the timeoutMap_.
+    std::unordered_map<
+        uint64_t,
+        std::pair<std::shared_ptr<AtomicJitFuture>, steady_clock_time_point>>
         pendingResponseMessage_;
+
+    // Requests waiting to be sent as a batch, the time at which the batch is
+    // due and the number of batches and requests sent so far. Guarded by
+    // batchMutex_.
+    std::vector<Message> pendingBatch_;
+    steady_clock_time_point batchDeadline_;
+    uint64_t numBatches_{0};
+    uint64_t numBatchedRequests_{0};
   };
 
+  // Arms a read for one response on the given client pipe.
+  void readResponse(ClientPipe& clientPipe);
+
+  // Callback of the write of the requests with the given IDs. Arms a read for
+  // the response of each of them, or fails them all if the write failed.
+  void onRequestsWritten(
+      ClientPipe& clientPipe,
+      const tensorpipe::Error& error,
+      const std::vector<uint64_t>& messageIds);
+
+  // Appends a request to the batch of the client pipe, and sends the batch if
+  // it is full. Must be called with batchMutex_ held.
+  void enqueueBatchedRequest(ClientPipe& clientPipe, Message&& requestMessage);
+
+  // Sends all the requests in the batch of the client pipe, if any. Must be
+  // called with batchMutex_ held.
+  void flushBatchedRequests(ClientPipe& clientPipe);
+
+  // Function run by the batchThread_ to send batches once they are due.
+  void flushBatchesLoop();
+
   const TensorPipeRpcBackendOptions opts_;
   std::unordered_map<std::string, tensorpipe::DeviceMap> reverseDeviceMaps_;
 
@@ -438,6 +489,16 @@ class TensorPipeAgent : public RpcAgent {
   // Mutex to guard timeSeriesMetrics_
   std::mutex metricsMutex_;
 
+  // Thread that sends the batches of small requests when they are due, a cv
+  // to signal it and the deadlines of the batches, in the order they are due.
+  // When both batchMutex_ and mutex_ are needed, batchMutex_ must be acquired
+  // first. batchMutex_ is also held while writing a batch so that requests
+  // to the same destination are written in the order they were sent.
+  std::thread batchThread_;
+  std::mutex batchMutex_;
+  std::condition_variable batchCV_;
+  std::deque<std::pair<steady_clock_time_point, ClientPipe*>> batchDeadlines_;
+
   // Map to Track Network Data
   NetworkDataDict networkData_;
   // Mutex to guard networkData_
@@ -1,11 +1,17 @@
 #include <torch/csrc/jit/mobile/function.h>
 
+#include <ATen/core/dispatch/Dispatcher.h>
 #include <caffe2/serialize/inline_container.h>
 #include <torch/csrc/jit/mobile/interpreter.h>
 #include <torch/csrc/jit/runtime/instruction.h>
 #include <torch/csrc/jit/runtime/operator.h>
 #include <torch/custom_class_detail.h>
 
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
 namespace torch {
 namespace jit {
 
@@ -35,29 +41,159 @@ void Function::append_instruction(OpCode op, int X, int N) {
   code_->instructions_.emplace_back(op, X, N);
 }
 
-bool Function::append_operator(
-    const std::string& name,
-    const std::string& overload_name,
-    int64_t model_version) {
-  // Keep the original opname in code_
-  code_->op_names_.emplace_back(name, overload_name);
-  auto opname = code_->op_names_.back();
-
-  auto opname_c10 = opname;
-  std::function<void(Stack&)> fn;
-
-  auto jit_op = findOperatorFor(opname);
-  if (jit_op) {
-    fn = [jit_op](Stack& stack) { jit_op->getOperation()(&stack); };
-  } else {
-    auto op = c10::Dispatcher::singleton().findSchema(opname_c10);
-    if (op.has_value()) {
-      fn = [op](Stack& stack) { op->callBoxed(&stack); };
-    } else {
-      return false;
+void Function::reserve_instructions(size_t size) {
+  code_->instructions_.reserve(size);
+}
+
+namespace {
+using OperatorFunction = std::function<void(Stack&)>;
+
+struct ResolvedOperator {
+  OperatorFunction fn;
+  // Number of arguments taken from the stack, nullopt if variadic.
+  c10::optional<int> num_inputs;
+};
+
+c10::optional<int> numInputs(const c10::FunctionSchema& schema) {
+  if (schema.is_vararg()) {
+    return c10::nullopt;
+  }
+  return schema.arguments().size();
+}
+
+struct CachedOperator {
+  ResolvedOperator op;
+  // The JIT operator `op` was resolved from, empty if it was resolved from
+  // the dispatcher.
+  std::weak_ptr<Operator> jit_op;
+  bool from_jit = false;
+
+  // Whether the operator was deregistered from the JIT registry. Operators
+  // of the dispatcher are evicted from the cache when deregistered instead.
+  bool expired() const {
+    return from_jit && jit_op.expired();
+  }
+};
+
+c10::optional<CachedOperator> resolveOperator(
+    const c10::OperatorName& opname) {
+  if (auto jit_op = findOperatorFor(opname)) {
+    // Fetch the Operation once here rather than on every call.
+    auto operation = jit_op->getOperation();
+    return CachedOperator{
+        ResolvedOperator{[operation](Stack& stack) { operation(&stack); },
+                         numInputs(jit_op->schema())},
+        jit_op,
+        true};
+  }
+  auto op = c10::Dispatcher::singleton().findSchema(opname);
+  if (op.has_value()) {
+    return CachedOperator{
+        ResolvedOperator{[op](Stack& stack) { op->callBoxed(&stack); },
+                         numInputs(op->schema())}};
+  }
+  return c10::nullopt;
+}
+
+// Operators resolved by name are interned for the lifetime of the process.
+// Loading many models mostly resolves the same few hundred operators, so
+// after the first model each lookup is a single hash map probe instead of
+// a walk through the JIT operator registry and the dispatcher. Operators
+// that cannot be found are not cached, as they may be registered later
+// (e.g. by loading a library of custom ops).
+//
+// Operators deregistered from the dispatcher (e.g. when a library is
+// unloaded) are evicted by a registration listener, so that their handles
+// are never handed out again. The JIT operators registered for them are
+// deregistered at the same time.
+class OperatorCache {
+ public:
+  static OperatorCache& get() {
+    static OperatorCache cache;
+    return cache;
+  }
+
+  // Returns the resolved operators in the order of `names`. Entries for
+  // operators that cannot be found are nullopt.
+  std::vector<c10::optional<ResolvedOperator>> resolve(
+      const std::vector<c10::OperatorName>& names) {
+    std::vector<c10::optional<ResolvedOperator>> result(names.size());
+    std::vector<size_t> misses;
+    uint64_t generation = 0;
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      generation = generation_;
+      for (size_t i = 0; i < names.size(); ++i) {
+        auto it = resolved_.find(names[i]);
+        if (it != resolved_.end() && !it->second.expired()) {
+          result[i] = it->second.op;
+        } else {
+          misses.push_back(i);
+        }
+      }
+    }
+    if (misses.empty()) {
+      return result;
+    }
+
+    // Resolve outside of the lock: the dispatcher calls evict() with its own
+    // lock held, so holding ours while taking the dispatcher's would
+    // deadlock.
+    std::vector<std::pair<size_t, CachedOperator>> resolved;
+    for (size_t i : misses) {
+      if (auto op = resolveOperator(names[i])) {
+        result[i] = op->op;
+        resolved.emplace_back(i, std::move(*op));
+      }
+    }
+    std::lock_guard<std::mutex> guard(mutex_);
+    // An operator deregistered while being resolved may be dangling.
+    if (generation_ == generation) {
+      for (auto& op : resolved) {
+        resolved_[names[op.first]] = std::move(op.second);
+      }
     }
+    return result;
+  }
+
+  void evict(const c10::OperatorName& name) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    resolved_.erase(name);
+    ++generation_;
   }
 
+ private:
+  class Evictor final : public c10::OpRegistrationListener {
+   public:
+    explicit Evictor(OperatorCache* cache) : cache_(cache) {}
+
+    void onOperatorRegistered(const c10::OperatorHandle&) override {}
+
+    void onOperatorDeregistered(const c10::OperatorHandle& op) override {
+      cache_->evict(op.operator_name());
+    }
+
+   private:
+    OperatorCache* cache_;
+  };
+
+  OperatorCache()
+      : listener_(c10::Dispatcher::singleton().addRegistrationListener(
+            std::make_unique<Evictor>(this))) {}
+
+  std::mutex mutex_;
+  std::unordered_map<c10::OperatorName, CachedOperator> resolved_;
+  // Incremented on every eviction.
+  uint64_t generation_ = 0;
+  // Declared last so that the listener is removed before the cache is
+  // destroyed.
+  c10::RegistrationHandleRAII listener_;
+};
+
+ResolvedOperator withBackwardCompatibilityAdapter(
+    const c10::OperatorName& opname,
+    ResolvedOperator op,
+    int64_t model_version) {
   if (model_version == 0x3L &&
       model_version < caffe2::serialize::kProducedBytecodeVersion &&
       opname == c10::OperatorName("aten::_convolution", "")) {
@@ -65,14 +201,51 @@ bool Function::append_operator(
     // https://github.com/pytorch/pytorch/pull/40737. This wrapper is used to
     // handle backward compatibility, where there is no default bool value in
     // old models.
-    fn = [fn](Stack& stack) {
+    auto fn = std::move(op.fn);
+    op.fn = [fn](Stack& stack) {
       stack.push_back(true);
       fn(stack);
     };
+    // The adapter pushes the last argument itself.
+    if (op.num_inputs) {
+      *op.num_inputs -= 1;
+    }
   }
+  return op;
+}
+} // namespace
 
-  code_->operators_.emplace_back(fn);
-  return true;
+bool Function::append_operator(
+    const std::string& name,
+    const std::string& overload_name,
+    int64_t model_version) {
+  return append_operators({c10::OperatorName(name, overload_name)},
+                          model_version)
+      .empty();
+}
+
+std::vector<c10::OperatorName> Function::append_operators(
+    std::vector<c10::OperatorName> names,
+    int64_t model_version) {
+  auto fns = OperatorCache::get().resolve(names);
+  std::vector<c10::OperatorName> unsupported;
+  code_->op_names_.reserve(code_->op_names_.size() + names.size());
+  code_->operators_.reserve(code_->operators_.size() + names.size());
+  code_->operator_input_sizes_.reserve(
+      code_->operator_input_sizes_.size() + names.size());
+  for (size_t i = 0; i < names.size(); ++i) {
+    if (!fns[i]) {
+      unsupported.push_back(std::move(names[i]));
+      continue;
+    }
+    auto op = withBackwardCompatibilityAdapter(
+        names[i], std::move(*fns[i]), model_version);
+    code_->operators_.emplace_back(std::move(op.fn));
+    code_->operator_input_sizes_.emplace_back(op.num_inputs);
+    // Keep the original opname in code_
+    code_->op_names_.emplace_back(std::move(names[i]));
+  }
+  return unsupported;
 }
 
 void Function::set_module_debug_info_list_size(size_t size) {
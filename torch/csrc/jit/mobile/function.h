@@ -1,6 +1,6 @@
 #pragma once
 #include <ATen/core/ivalue.h>
-//#include <aten/src/Aten/core/operator_name.h>
+#include <ATen/core/operator_name.h>
 #include <vector>
 
 namespace torch {
@@ -19,10 +19,17 @@ class Function {
   const std::string& name() const;
   const c10::QualifiedName& qualname() const;
   void append_instruction(OpCode op, int X, int N);
+  void reserve_instructions(size_t size);
   bool append_operator(
       const std::string& name,
       const std::string& overload_name,
       int64_t model_version);
+  // Resolves all of `names` in one batch and appends them to the operator
+  // table. Returns the names of the operators that could not be found; the
+  // operator table is only complete if that list is empty.
+  std::vector<c10::OperatorName> append_operators(
+      std::vector<c10::OperatorName> names,
+      int64_t model_version);
   void set_module_debug_info_list_size(size_t size);
   void set_module_info(const std::string& module_info, size_t pc);
   void append_constant(const c10::IValue& constant);
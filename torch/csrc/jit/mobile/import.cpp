@@ -173,13 +173,14 @@ void parseMethods(
     }
 
     function->set_module_debug_info_list_size(ins_list.size());
+    function->reserve_instructions(ins_list.size());
     for (size_t i = 0; i < ins_list.size(); ++i) {
-      auto ins_item = ins_list[i].toTuple()->elements();
+      const auto& ins_item = ins_list[i].toTuple()->elements();
       TORCH_CHECK(
           ins_item.size() == 3,
           "There should be three parts in an instruction. The function name is ",
           function_name);
-      OpCode op_code = parseOpCode(ins_item[0].toString()->string().c_str());
+      OpCode op_code = parseOpCode(ins_item[0].toStringRef().c_str());
       int X = ins_item[1].toInt();
       int N = ins_item[2].toInt();
       function->append_instruction(op_code, X, N);
@@ -191,22 +192,24 @@ void parseMethods(
       }
     }
 
-    std::unordered_set<std::string> unsupported_op_names;
     // ops_list is the list of operator names that were read in from
-    // bytecode.plk for the method that is currently being processed.
+    // bytecode.plk for the method that is currently being processed. They are
+    // all resolved in one batch.
+    std::vector<c10::OperatorName> op_names;
+    op_names.reserve(ops_list.size());
     for (const auto& op : ops_list) {
-      auto op_item = op.toTuple()->elements();
+      const auto& op_item = op.toTuple()->elements();
       TORCH_CHECK(
           op_item.size() == 2,
           "There should be two parts in an operator name.");
-      auto op_found = function->append_operator(
-          op_item[0].toString()->string(),
-          op_item[1].toString()->string(),
-          model_version);
-      if (!op_found) {
-        unsupported_op_names.emplace(operator_str(
-            op_item[0].toString()->string(), op_item[1].toString()->string()));
-      }
+      op_names.emplace_back(
+          op_item[0].toStringRef(), op_item[1].toStringRef());
+    }
+    std::unordered_set<std::string> unsupported_op_names;
+    for (const auto& op_name :
+         function->append_operators(std::move(op_names), model_version)) {
+      unsupported_op_names.emplace(
+          operator_str(op_name.name, op_name.overload_name));
     }
     if (!unsupported_op_names.empty()) {
       print_unsupported_ops_and_throw(unsupported_op_names);
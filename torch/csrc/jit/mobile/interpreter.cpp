@@ -21,7 +21,51 @@ InterpreterState::InterpreterState(std::shared_ptr<Code> code)
 
 using namespace at;
 
+namespace {
+// Checks a MemoryPlanner out of the plan for the duration of a run. If the
+// run fails, the planner is abandoned rather than returned to the plan.
+class PlannerGuard {
+ public:
+  explicit PlannerGuard(MemoryPlan* plan) : plan_(plan) {
+    if (plan_) {
+      planner_ = plan_->acquirePlanner();
+      planner_->allocate();
+    }
+  }
+  ~PlannerGuard() {
+    if (!plan_) {
+      return;
+    }
+    if (succeeded_) {
+      planner_->deallocate();
+      plan_->releasePlanner(std::move(planner_));
+    } else {
+      planner_->abandon();
+    }
+  }
+  MemoryPlanner* get() const {
+    return planner_.get();
+  }
+  void succeeded() {
+    succeeded_ = true;
+  }
+
+ private:
+  MemoryPlan* plan_;
+  std::unique_ptr<MemoryPlanner> planner_;
+  bool succeeded_ = false;
+};
+} // namespace
+
 bool InterpreterState::run(Stack& stack) {
+  MemoryPlan* plan = nullptr;
+  if (FLAGS_torch_jit_mobile_memory_planning) {
+    std::call_once(code_->memory_plan_once_, [this] {
+      code_->memory_plan_ = MemoryPlan::build(*code_);
+    });
+    plan = code_->memory_plan_.get();
+  }
+  PlannerGuard planner(plan);
   size_t pc = 0;
   while (true) {
     Instruction inst = code_->instructions_[pc];
@@ -55,7 +99,13 @@ bool InterpreterState::run(Stack& stack) {
         if (!prev_value) {
           enableRecordFunction(false);
         }
-        code_->operators_[inst.X](stack);
+        int managed = plan ? plan->managedIndex(pc) : -1;
+        if (managed >= 0) {
+          planner.get()->runOperator(
+              managed, code_->operators_[inst.X], stack);
+        } else {
+          code_->operators_[inst.X](stack);
+        }
         ++pc;
       } break;
       case OPN: {
@@ -147,6 +197,7 @@ bool InterpreterState::run(Stack& stack) {
         }
       } break;
       case RET:
+        planner.succeeded();
         return false;
       case LIST_CONSTRUCT: {
         const auto& type = code_->types_[inst.X]->expectRef<at::ListType>();
@@ -1,7 +1,9 @@
 #pragma once
 #include <ATen/core/ivalue.h>
 #include <ATen/core/operator_name.h>
+#include <torch/csrc/jit/mobile/memory_planner.h>
 #include <torch/csrc/jit/runtime/instruction.h>
+#include <mutex>
 #include <vector>
 
 namespace torch {
@@ -12,9 +14,16 @@ struct Code {
   std::vector<Instruction> instructions_;
   std::vector<c10::OperatorName> op_names_;
   std::vector<std::function<void(Stack&)>> operators_;
+  // Number of arguments each operator takes from the stack, or nullopt if
+  // it is variadic.
+  std::vector<c10::optional<int>> operator_input_sizes_;
   std::vector<c10::IValue> constants_;
   std::vector<c10::TypePtr> types_;
   size_t register_size_; // Aggregated output size.
+  // Built on the first run if FLAGS_torch_jit_mobile_memory_planning is set,
+  // nullptr if there is nothing to plan.
+  std::once_flag memory_plan_once_;
+  std::unique_ptr<MemoryPlan> memory_plan_;
 };
 
 struct InterpreterState {
@@ -0,0 +1,586 @@
+#include <torch/csrc/jit/mobile/memory_planner.h>
+
+#include <ATen/core/jit_type.h>
+#include <c10/core/CPUAllocator.h>
+#include <torch/csrc/jit/mobile/interpreter.h>
+#include <torch/csrc/jit/runtime/instruction.h>
+#include <torch/csrc/jit/runtime/operator.h>
+
+#include <algorithm>
+#include <cstring>
+
+C10_DEFINE_bool(
+    torch_jit_mobile_memory_planning,
+    false,
+    "If enabled, the lite interpreter plans the memory of intermediate "
+    "tensors produced by ops with out variants into one arena per run.");
+
+namespace torch {
+namespace jit {
+namespace mobile {
+
+namespace {
+
+// Indices of the managed candidates a value may alias, sorted.
+using Aliases = std::vector<int>;
+
+void mergeInto(Aliases& into, const Aliases& from) {
+  if (from.empty()) {
+    return;
+  }
+  Aliases merged;
+  merged.reserve(into.size() + from.size());
+  std::set_union(
+      into.begin(),
+      into.end(),
+      from.begin(),
+      from.end(),
+      std::back_inserter(merged));
+  into = std::move(merged);
+}
+
+// Types that cannot contain a tensor.
+bool isPrimitive(const c10::TypePtr& type) {
+  switch (type->kind()) {
+    case c10::TypeKind::IntType:
+    case c10::TypeKind::FloatType:
+    case c10::TypeKind::BoolType:
+    case c10::TypeKind::StringType:
+    case c10::TypeKind::NoneType:
+    case c10::TypeKind::NumberType:
+    case c10::TypeKind::DeviceObjType:
+      return true;
+    default:
+      return false;
+  }
+}
+
+c10::optional<c10::FunctionSchema> findSchemaFor(
+    const c10::OperatorName& opname) {
+  if (auto jit_op = findOperatorFor(opname)) {
+    return jit_op->schema();
+  }
+  if (auto op = c10::Dispatcher::singleton().findSchema(opname)) {
+    return op->schema();
+  }
+  return c10::nullopt;
+}
+
+// Finds the out variant of an aten operator: an overload that takes the
+// same arguments followed by a single `Tensor(a!) out` argument and returns
+// it, e.g. aten::add.out for aten::add.Tensor or aten::sum.IntList_out for
+// aten::sum.dim_IntList.
+c10::optional<c10::OperatorHandle> findOutVariant(
+    const c10::OperatorName& opname,
+    const c10::FunctionSchema& schema) {
+  if (schema.is_vararg() || schema.is_varret() ||
+      schema.returns().size() != 1 ||
+      schema.returns()[0].type()->kind() != c10::TypeKind::TensorType ||
+      schema.returns()[0].alias_info()) {
+    return c10::nullopt;
+  }
+  for (const auto& arg : schema.arguments()) {
+    if (arg.alias_info()) {
+      return c10::nullopt;
+    }
+  }
+  std::vector<std::string> candidates = {"out"};
+  if (!opname.overload_name.empty()) {
+    candidates.insert(candidates.begin(), opname.overload_name + "_out");
+  }
+  for (const auto& overload : candidates) {
+    auto handle = c10::Dispatcher::singleton().findSchema(
+        c10::OperatorName(opname.name, overload));
+    if (!handle) {
+      continue;
+    }
+    const auto& out_schema = handle->schema();
+    const auto& args = schema.arguments();
+    const auto& out_args = out_schema.arguments();
+    if (out_args.size() != args.size() + 1 ||
+        out_schema.returns().size() != 1) {
+      continue;
+    }
+    bool matches = true;
+    for (size_t i = 0; i < args.size() && matches; ++i) {
+      matches = args[i].name() == out_args[i].name() &&
+          *args[i].type() == *out_args[i].type();
+    }
+    const auto& out_arg = out_args.back();
+    if (matches && out_arg.type()->kind() == c10::TypeKind::TensorType &&
+        out_arg.alias_info() && out_arg.alias_info()->isWrite()) {
+      return handle;
+    }
+  }
+  return c10::nullopt;
+}
+
+// Describes everything about an operator's inputs that the dtype of its
+// result can depend on. If it has not changed since a managed tensor was
+// produced by the functional operator, the out variant writing into that
+// tensor computes the same result. Returns false if the inputs should not
+// be used with an out variant at all.
+bool computeSignature(
+    const Stack& stack,
+    size_t num_inputs,
+    std::vector<int64_t>& signature) {
+  signature.clear();
+  auto describe = [&](const c10::IValue& v) {
+    if (v.isTensor()) {
+      const auto& t = v.toTensor();
+      if (!t.defined()) {
+        signature.push_back(-1);
+        return true;
+      }
+      if (!t.device().is_cpu() || t.layout() != c10::kStrided ||
+          t.requires_grad()) {
+        return false;
+      }
+      signature.push_back(
+          (static_cast<int64_t>(t.scalar_type()) << 3) |
+          (static_cast<int64_t>(t.dim() == 0) << 2) |
+          (static_cast<int64_t>(t.unsafeGetTensorImpl()->is_wrapped_number())
+           << 1) |
+          static_cast<int64_t>(t.is_contiguous()));
+      return true;
+    }
+    if (v.isTensorList()) {
+      signature.push_back(-2);
+      for (const at::Tensor& t : v.toTensorList()) {
+        if (!t.device().is_cpu() || t.layout() != c10::kStrided ||
+            t.requires_grad()) {
+          return false;
+        }
+        signature.push_back(
+            (static_cast<int64_t>(t.scalar_type()) << 1) |
+            static_cast<int64_t>(t.is_contiguous()));
+      }
+      signature.push_back(-2);
+      return true;
+    }
+    // Floating point scalars take part in type promotion through their kind
+    // only. Integers may also be a dtype argument, so their value matters.
+    if (v.isInt()) {
+      signature.push_back(-3);
+      signature.push_back(v.toInt());
+      return true;
+    }
+    if (v.isBool()) {
+      signature.push_back(v.toBool() ? -4 : -5);
+      return true;
+    }
+    signature.push_back(v.isDouble() ? -6 : v.isNone() ? -7 : -8);
+    return true;
+  };
+  for (auto it = stack.end() - num_inputs; it != stack.end(); ++it) {
+    if (!describe(*it)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Don't change the size if it is already aligned, otherwise increase the size
+// to make it aligned.
+size_t computeAlignedSize(size_t nbytes) {
+  return (nbytes + c10::gAlignment - 1) & (~(c10::gAlignment - 1));
+}
+
+} // namespace
+
+std::unique_ptr<MemoryPlan> MemoryPlan::build(const Code& code) {
+  struct Candidate {
+    size_t def;
+    size_t last_use;
+    size_t num_inputs;
+    c10::OperatorHandle out_variant;
+    bool escapes;
+  };
+  std::vector<Candidate> candidates;
+  const size_t end = code.instructions_.size();
+
+  // Resolve what the planner needs to know about each operator once.
+  struct OperatorInfo {
+    c10::optional<size_t> num_inputs;
+    size_t num_outputs = 0;
+    // whether outputs may alias inputs
+    bool outputs_alias = true;
+    // inputs that are stored into the wildcard alias set
+    std::vector<size_t> escaping_inputs;
+    c10::optional<c10::OperatorHandle> out_variant;
+  };
+  std::vector<OperatorInfo> operators(code.op_names_.size());
+  for (size_t i = 0; i < code.op_names_.size(); ++i) {
+    const auto& opname = code.op_names_[i];
+    auto schema = findSchemaFor(opname);
+    if (!schema || schema->is_vararg() || schema->is_varret() ||
+        i >= code.operator_input_sizes_.size() ||
+        !code.operator_input_sizes_[i]) {
+      // Arity unknown, the stack cannot be simulated.
+      continue;
+    }
+    auto& info = operators[i];
+    info.num_outputs = schema->returns().size();
+    const auto& args = schema->arguments();
+    for (size_t a = 0; a < args.size(); ++a) {
+      const auto& alias_info = args[a].alias_info();
+      if (!alias_info) {
+        continue;
+      }
+      if (alias_info->isWrite() &&
+          args[a].type()->kind() != c10::TypeKind::TensorType) {
+        // Mutates a container, which would add aliases to a value that is
+        // not on the stack anymore.
+        return nullptr;
+      }
+      if (alias_info->isWildcardAfter() ||
+          !alias_info->containedTypes().empty()) {
+        info.escaping_inputs.push_back(a);
+      }
+    }
+    bool is_prim = opname.name.rfind("prim::", 0) == 0;
+    info.outputs_alias = is_prim;
+    for (const auto& ret : schema->returns()) {
+      if (ret.alias_info() ||
+          (ret.type()->kind() != c10::TypeKind::TensorType &&
+           !isPrimitive(ret.type()))) {
+        info.outputs_alias = true;
+      }
+    }
+    // The backward compatibility adapters push defaults themselves, so only
+    // operators whose stack arity matches the schema are candidates.
+    size_t num_inputs = *code.operator_input_sizes_[i];
+    if (!is_prim && num_inputs == args.size()) {
+      info.out_variant = findOutVariant(opname, *schema);
+    }
+    info.num_inputs = num_inputs;
+  }
+
+  // The inputs of the function are on the stack when it starts, and its
+  // first instruction stores them into the first registers. They are never
+  // managed, so they alias nothing.
+  size_t num_inputs = 0;
+  if (end > 0 && code.instructions_[0].X == 1) {
+    if (code.instructions_[0].op == STORE) {
+      num_inputs = 1;
+    } else if (code.instructions_[0].op == STOREN) {
+      num_inputs = code.instructions_[0].N;
+    }
+  }
+  std::vector<Aliases> stack(num_inputs);
+  std::vector<Aliases> registers(code.register_size_ + 1);
+  // `register_size_` registers are addressed from the end, see
+  // InterpreterState::reg().
+  auto reg = [&](size_t r) -> Aliases& {
+    TORCH_INTERNAL_ASSERT(r >= 1 && r <= code.register_size_);
+    return registers[code.register_size_ + 1 - r];
+  };
+  auto touch = [&](const Aliases& value, size_t pc) {
+    for (int c : value) {
+      candidates[c].last_use = std::max(candidates[c].last_use, pc);
+    }
+  };
+  auto escape = [&](const Aliases& value) {
+    for (int c : value) {
+      candidates[c].escapes = true;
+    }
+  };
+  auto pop = [&](size_t pc) {
+    TORCH_INTERNAL_ASSERT(!stack.empty());
+    Aliases value = std::move(stack.back());
+    stack.pop_back();
+    touch(value, pc);
+    return value;
+  };
+  // Pops n values and returns the union of their aliases.
+  auto popN = [&](size_t n, size_t pc) {
+    TORCH_INTERNAL_ASSERT(stack.size() >= n);
+    Aliases merged;
+    for (size_t i = stack.size() - n; i < stack.size(); ++i) {
+      touch(stack[i], pc);
+      mergeInto(merged, stack[i]);
+    }
+    stack.resize(stack.size() - n);
+    return merged;
+  };
+
+  std::vector<int> pc_to_candidate(end, -1);
+  for (size_t pc = 0; pc < end; ++pc) {
+    const Instruction& inst = code.instructions_[pc];
+    switch (inst.op) {
+      case OP: {
+        const auto& info = operators[inst.X];
+        if (!info.num_inputs || stack.size() < *info.num_inputs) {
+          return nullptr;
+        }
+        size_t first = stack.size() - *info.num_inputs;
+        for (size_t a : info.escaping_inputs) {
+          if (first + a < stack.size()) {
+            escape(stack[first + a]);
+          }
+        }
+        Aliases inputs = popN(*info.num_inputs, pc);
+        if (info.out_variant) {
+          pc_to_candidate[pc] = candidates.size();
+          stack.push_back({static_cast<int>(candidates.size())});
+          candidates.push_back(Candidate{
+              pc, pc, *info.num_inputs, *info.out_variant, false});
+          break;
+        }
+        for (size_t i = 0; i < info.num_outputs; ++i) {
+          stack.push_back(info.outputs_alias ? inputs : Aliases());
+        }
+      } break;
+      case LOAD:
+        touch(reg(inst.X), pc);
+        stack.push_back(reg(inst.X));
+        break;
+      case MOVE:
+        touch(reg(inst.X), pc);
+        stack.push_back(std::move(reg(inst.X)));
+        reg(inst.X).clear();
+        break;
+      case STORE:
+        touch(reg(inst.X), pc);
+        reg(inst.X) = pop(pc);
+        break;
+      case STOREN:
+        for (size_t i = inst.N; i > 0; --i) {
+          touch(reg(inst.X + i - 1), pc);
+          reg(inst.X + i - 1) = pop(pc);
+        }
+        break;
+      case DROP:
+        pop(pc);
+        break;
+      case DROPR:
+        touch(reg(inst.X), pc);
+        reg(inst.X).clear();
+        break;
+      case LOADC:
+        stack.emplace_back();
+        break;
+      case GET_ATTR:
+        stack.push_back(pop(pc));
+        break;
+      case SET_ATTR:
+        escape(pop(pc));
+        escape(pop(pc));
+        break;
+      case LIST_CONSTRUCT:
+      case DICT_CONSTRUCT:
+      case NAMED_TUPLE_CONSTRUCT:
+        stack.push_back(popN(inst.N, pc));
+        break;
+      case TUPLE_CONSTRUCT:
+        stack.push_back(popN(inst.X, pc));
+        break;
+      case TUPLE_SLICE:
+        stack.push_back(pop(pc));
+        break;
+      case LIST_UNPACK: {
+        Aliases list = pop(pc);
+        for (int i = 0; i < inst.X; ++i) {
+          stack.push_back(list);
+        }
+      } break;
+      case WARN:
+        popN(2, pc);
+        break;
+      case RET:
+        for (const auto& value : stack) {
+          escape(value);
+        }
+        // Whatever is still held in a register lives until the end.
+        for (const auto& value : registers) {
+          touch(value, end);
+        }
+        pc = end;
+        break;
+      default:
+        // Control flow, method calls and variadic ops are not planned.
+        return nullptr;
+    }
+  }
+
+  std::unique_ptr<MemoryPlan> plan(new MemoryPlan());
+  plan->pc_to_managed_.assign(end, -1);
+  for (size_t pc = 0; pc < end; ++pc) {
+    int c = pc_to_candidate[pc];
+    if (c < 0 || candidates[c].escapes) {
+      continue;
+    }
+    plan->pc_to_managed_[pc] = plan->managed_.size();
+    plan->managed_.push_back(Managed{candidates[c].def,
+                                     candidates[c].last_use,
+                                     candidates[c].num_inputs,
+                                     candidates[c].out_variant});
+  }
+  if (plan->managed_.empty()) {
+    return nullptr;
+  }
+  return plan;
+}
+
+std::unique_ptr<MemoryPlanner> MemoryPlan::acquirePlanner() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (!planners_.empty()) {
+      auto planner = std::move(planners_.back());
+      planners_.pop_back();
+      return planner;
+    }
+  }
+  return std::make_unique<MemoryPlanner>(*this);
+}
+
+void MemoryPlan::releasePlanner(std::unique_ptr<MemoryPlanner> planner) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  planners_.push_back(std::move(planner));
+}
+
+MemoryPlanner::MemoryPlanner(const MemoryPlan& plan)
+    : plan_(plan), tensors_(plan.managed().size()) {}
+
+void MemoryPlanner::allocate() {
+  if (arena_bytes_ == 0) {
+    return;
+  }
+  arena_ = c10::GetCPUAllocator()->allocate(arena_bytes_);
+  uint8_t* start = static_cast<uint8_t*>(arena_.get());
+  for (auto& managed : tensors_) {
+    if (!managed.tensor.defined() || managed.size == 0) {
+      continue;
+    }
+    if (managed.tensor.use_count() != 1 ||
+        managed.tensor.storage().use_count() != 1) {
+      // Someone else kept a reference after all, stop managing it.
+      managed.tensor.reset();
+      continue;
+    }
+    TORCH_INTERNAL_ASSERT_DEBUG_ONLY(
+        managed.offset + managed.size <= arena_bytes_);
+    void* src = static_cast<void*>(start + managed.offset);
+    auto* impl = managed.tensor.storage().unsafeGetStorageImpl();
+    impl->set_data_ptr(at::DataPtr(src, src, nullptr, impl->device()));
+    impl->set_nbytes(managed.size);
+  }
+}
+
+void MemoryPlanner::deallocate() {
+  // Free the memory of the managed tensors but keep the TensorImpl and
+  // StorageImpl around for the next run.
+  for (auto& managed : tensors_) {
+    if (!managed.tensor.defined()) {
+      continue;
+    }
+    auto* impl = managed.tensor.storage().unsafeGetStorageImpl();
+    size_t size = computeAlignedSize(impl->nbytes());
+    if (size > managed.size) {
+      managed.size = size;
+      needs_replan_ = true;
+    }
+    impl->reset();
+  }
+  arena_ = {};
+  if (needs_replan_) {
+    assignOffsets();
+    needs_replan_ = false;
+  }
+}
+
+void MemoryPlanner::abandon() {
+  // The managed tensors may still be referenced by the failed run, e.g. from
+  // its stack, so they keep their data, copied out of the arena.
+  const auto* start = static_cast<const uint8_t*>(arena_.get());
+  for (auto& managed : tensors_) {
+    if (!managed.tensor.defined()) {
+      continue;
+    }
+    auto* impl = managed.tensor.storage().unsafeGetStorageImpl();
+    const auto* data = static_cast<const uint8_t*>(impl->data());
+    if (start && data >= start && data < start + arena_bytes_) {
+      auto copy = c10::GetCPUAllocator()->allocate(impl->nbytes());
+      std::memcpy(copy.get(), data, impl->nbytes());
+      impl->set_data_ptr(std::move(copy));
+    }
+    managed.tensor.reset();
+  }
+  arena_ = {};
+}
+
+void MemoryPlanner::runOperator(
+    size_t idx,
+    const std::function<void(Stack&)>& fn,
+    Stack& stack) {
+  const auto& info = plan_.managed()[idx];
+  auto& managed = tensors_[idx];
+  bool usable =
+      computeSignature(stack, info.num_inputs, scratch_signature_);
+  if (usable && managed.tensor.defined() &&
+      scratch_signature_ == managed.signature) {
+    managed.tensor.unsafeGetTensorImpl()->set_sizes_contiguous({0});
+    stack.emplace_back(managed.tensor);
+    info.out_variant.callBoxed(&stack);
+    return;
+  }
+  fn(stack);
+  if (!usable || stack.empty() || !stack.back().isTensor()) {
+    return;
+  }
+  // Keep the result of the functional op; from the next run on it is
+  // produced by the out variant.
+  const auto& t = stack.back().toTensor();
+  if (t.defined() && t.device().is_cpu() && t.layout() == c10::kStrided &&
+      !t.requires_grad() && t.is_contiguous() && t.storage_offset() == 0 &&
+      t.use_count() == 1 && t.storage().use_count() == 1) {
+    managed.tensor = t;
+    managed.signature = scratch_signature_;
+  }
+}
+
+// Assigns each managed tensor the lowest offset that does not overlap any
+// larger tensor that is live at the same time.
+void MemoryPlanner::assignOffsets() {
+  const auto& managed = plan_.managed();
+  std::vector<size_t> order;
+  for (size_t i = 0; i < tensors_.size(); ++i) {
+    if (tensors_[i].size > 0) {
+      order.push_back(i);
+    }
+  }
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return tensors_[a].size != tensors_[b].size
+        ? tensors_[a].size > tensors_[b].size
+        : managed[a].def < managed[b].def;
+  });
+
+  arena_bytes_ = 0;
+  std::vector<size_t> placed;
+  std::vector<std::pair<size_t, size_t>> taken;
+  for (size_t i : order) {
+    taken.clear();
+    for (size_t j : placed) {
+      if (managed[i].def <= managed[j].last_use &&
+          managed[j].def <= managed[i].last_use) {
+        taken.emplace_back(
+            tensors_[j].offset, tensors_[j].offset + tensors_[j].size);
+      }
+    }
+    std::sort(taken.begin(), taken.end());
+    size_t offset = 0;
+    for (const auto& range : taken) {
+      if (offset + tensors_[i].size <= range.first) {
+        break;
+      }
+      offset = std::max(offset, range.second);
+    }
+    tensors_[i].offset = offset;
+    arena_bytes_ = std::max(arena_bytes_, offset + tensors_[i].size);
+    placed.push_back(i);
+  }
+}
+
+} // namespace mobile
+} // namespace jit
+} // namespace torch
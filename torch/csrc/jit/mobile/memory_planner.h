@@ -0,0 +1,135 @@
+#pragma once
+#include <ATen/core/dispatch/Dispatcher.h>
+#include <ATen/core/ivalue.h>
+#include <c10/util/Flags.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+C10_DECLARE_bool(torch_jit_mobile_memory_planning);
+
+namespace torch {
+namespace jit {
+namespace mobile {
+using Stack = std::vector<c10::IValue>;
+struct Code;
+class MemoryPlanner;
+
+/**
+ * Activation memory planning for the lite interpreter.
+ *
+ * A MemoryPlan is the static part of the plan for one mobile::Code. It is
+ * built once from the bytecode by simulating the stack and registers of a
+ * straight-line function and tracking which values may alias the tensor
+ * produced by each OP instruction (using the alias annotations of the
+ * operator schemas). An OP is managed if
+ *   - its operator returns a single fresh Tensor and has an out variant
+ *     (e.g. aten::add.Tensor and aten::add.out), and
+ *   - nothing that may alias its result escapes the function, i.e. is
+ *     returned, stored into an object attribute or passed to a method call.
+ * For each managed OP the plan records the range of instructions over which
+ * its result, or anything aliasing it, is live.
+ *
+ * The dynamic part lives in MemoryPlanner, which works like Static Runtime's
+ * MemoryPlanner: the first run calls the functional operators and keeps the
+ * tensors they return. At the end of each run the storage of those tensors
+ * is released and their size recorded. Every later run allocates a single
+ * arena, points the kept tensors at non-overlapping (in time) offsets of it
+ * and calls the out variants, so a steady-state run does one allocation for
+ * all managed activations, and the arena is usually much smaller than the
+ * sum of the activations. No profiling run or fixed shapes are needed: if a
+ * tensor grows, the out variant reallocates it and the arena is re-planned
+ * at the end of the run.
+ *
+ * Functions with control flow or ops of unknown arity are not planned.
+ */
+class TORCH_API MemoryPlan {
+ public:
+  // Returns nullptr if `code` has nothing that can be planned.
+  static std::unique_ptr<MemoryPlan> build(const Code& code);
+
+  struct Managed {
+    // pc of the OP producing the tensor
+    size_t def;
+    // last pc at which the tensor, or a value aliasing it, is live
+    size_t last_use;
+    // number of arguments the functional operator takes from the stack
+    size_t num_inputs;
+    c10::OperatorHandle out_variant;
+  };
+
+  // Index into managed() of the tensor produced by the instruction at `pc`,
+  // or -1 if it is not managed.
+  int managedIndex(size_t pc) const {
+    return pc < pc_to_managed_.size() ? pc_to_managed_[pc] : -1;
+  }
+
+  const std::vector<Managed>& managed() const {
+    return managed_;
+  }
+
+  // Planners keep state between runs, so each concurrent run of the same
+  // Code checks one out of this pool.
+  std::unique_ptr<MemoryPlanner> acquirePlanner();
+  void releasePlanner(std::unique_ptr<MemoryPlanner> planner);
+
+ private:
+  MemoryPlan() = default;
+
+  std::vector<int> pc_to_managed_;
+  std::vector<Managed> managed_;
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<MemoryPlanner>> planners_;
+};
+
+class TORCH_API MemoryPlanner {
+ public:
+  explicit MemoryPlanner(const MemoryPlan& plan);
+
+  // Allocates the arena and points the managed tensors into it. Called at
+  // the start of a run.
+  void allocate();
+  // Records the size of the managed tensors, releases their storage and the
+  // arena. Called at the end of a successful run.
+  void deallocate();
+  // Stops managing the tensors without freeing their storage, and releases
+  // the arena. Called instead of deallocate() if a run fails; the planner
+  // must not be used afterwards.
+  void abandon();
+
+  // Runs the operator of the managed OP with index `idx` on `stack`, writing
+  // into the managed tensor if possible.
+  void runOperator(
+      size_t idx,
+      const std::function<void(Stack&)>& fn,
+      Stack& stack);
+
+  size_t arena_bytes() const {
+    return arena_bytes_;
+  }
+
+ private:
+  struct ManagedTensor {
+    at::Tensor tensor;
+    // Describes the inputs the tensor was produced from, see
+    // computeSignature().
+    std::vector<int64_t> signature;
+    size_t size = 0;
+    size_t offset = 0;
+  };
+
+  void assignOffsets();
+
+  const MemoryPlan& plan_;
+  std::vector<ManagedTensor> tensors_;
+  std::vector<int64_t> scratch_signature_;
+  size_t arena_bytes_ = 0;
+  bool needs_replan_ = false;
+  at::DataPtr arena_;
+};
+
+} // namespace mobile
+} // namespace jit
+} // namespace torch
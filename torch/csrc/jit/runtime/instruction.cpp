@@ -1,6 +1,8 @@
 #include <torch/csrc/jit/runtime/instruction.h>
 #include <cstring>
 #include <iostream>
+#include <string>
+#include <unordered_map>
 
 namespace torch {
 namespace jit {
@@ -61,12 +63,21 @@ static constexpr char* strOpCode[] = {
 };
 
 OpCode parseOpCode(const char* str) {
-  const int n = sizeof(strOpCode) / sizeof(strOpCode[0]);
-  for (int i = 0; i < n; ++i) {
-    if (strcmp(strOpCode[i], str) == 0)
-      return (OpCode)i;
+  // called for every instruction of every method when loading a mobile
+  // module, so avoid a linear scan over all opcode names
+  static const std::unordered_map<std::string, OpCode> opcodes = [] {
+    std::unordered_map<std::string, OpCode> result;
+    const int n = sizeof(strOpCode) / sizeof(strOpCode[0]);
+    for (int i = 0; i < n; ++i) {
+      result.emplace(strOpCode[i], (OpCode)i);
+    }
+    return result;
+  }();
+  auto it = opcodes.find(str);
+  if (it == opcodes.end()) {
+    return OP;
   }
-  return OP;
+  return it->second;
 }
 
 bool isOpSupportedInMobile(OpCode op) {
@@ -86,5 +97,20 @@ bool isOpSupportedInMobile(OpCode op) {
   return false;
 }
 
+OpCode unfusedOpCode(OpCode op) {
+  switch (op) {
+    case OP_STORE:
+      return OP;
+    case LOAD_OP_STORE:
+      return LOAD;
+    case MOVE_OP_STORE:
+      return MOVE;
+    case LOADC_OP_STORE:
+      return LOADC;
+    default:
+      return op;
+  }
+}
+
 } // namespace jit
 } // namespace torch
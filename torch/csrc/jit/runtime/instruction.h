@@ -54,7 +54,11 @@ namespace jit {
   _(FORK, "CN") /* launch a thread to run code entry x with N inputs  */       \
   _(WARN, "I") /* emit a warning with line information */                      \
   _(ENTER, "EN") /* enter scope of a contextmanager */                         \
-  _(EXIT, "EX") /* exit the last entered contextmanager */
+  _(EXIT, "EX") /* exit the last entered contextmanager */                     \
+  _(OP_STORE, "O") /* OP X, then the STORE that follows it */                  \
+  _(LOAD_OP_STORE, "R") /* LOAD X, then the OP and STORE that follow it */     \
+  _(MOVE_OP_STORE, "R") /* MOVE X, then the OP and STORE that follow it */     \
+  _(LOADC_OP_STORE, "C") /* LOADC X, then the OP and STORE that follow it */
 
 enum OpCode : uint8_t {
 #define DEFINE_OP(op, _) op,
@@ -74,5 +78,11 @@ struct Instruction {
 
 bool isOpSupportedInMobile(OpCode op);
 
+// Superinstructions are fused in place: they replace the first instruction
+// of the sequence they stand for and keep its operands, while the remaining
+// instructions of the sequence stay where they were. This returns the opcode
+// of that first instruction, i.e. undoes the fusion of a single slot.
+OpCode unfusedOpCode(OpCode op);
+
 } // namespace jit
 } // namespace torch
@@ -41,6 +41,13 @@ using torch::distributed::autograd::DistAutogradContainer;
 #include <utility>
 #include <vector>
 
+C10_DEFINE_bool(
+    torch_jit_enable_superinstructions,
+    true,
+    "If this flag is set to true, common instruction sequences emitted by the "
+    "TorchScript interpreter (e.g. LOAD, OP, STORE) are fused into single "
+    "superinstructions that are dispatched once.");
+
 namespace torch {
 namespace jit {
 
@@ -513,6 +520,9 @@ struct CodeImpl {
     // we deferred the emission of bailout blocks so they appear at the end
     // emit them now and patch up the jumps
     insertBailoutBlocks();
+    if (FLAGS_torch_jit_enable_superinstructions) {
+      fuseSuperinstructions();
+    }
   }
 
   const std::vector<c10::IValue>& constant_table() const {
@@ -575,6 +585,30 @@ struct CodeImpl {
     }
   }
 
+  // Rewrites the first instruction of every LOAD/MOVE/LOADC, OP, STORE and
+  // OP, STORE sequence into the matching superinstruction. The rest of the
+  // sequence is left untouched, so the instruction count, jump offsets and
+  // instructions_source_ stay valid and a jump into the middle of a fused
+  // sequence simply runs the unfused instructions.
+  void fuseSuperinstructions() {
+    for (size_t i = 0; i + 1 < instructions_.size(); ++i) {
+      Instruction& inst = instructions_[i];
+      OpCode next = instructions_[i + 1].op;
+      if (inst.op == OP && next == STORE) {
+        inst.op = OP_STORE;
+      } else if (
+          (inst.op == LOAD || inst.op == MOVE || inst.op == LOADC) &&
+          next == OP && i + 2 < instructions_.size() &&
+          instructions_[i + 2].op == STORE) {
+        inst.op = inst.op == LOAD
+            ? LOAD_OP_STORE
+            : (inst.op == MOVE ? MOVE_OP_STORE : LOADC_OP_STORE);
+        // the OP is already covered, don't fuse it into an OP_STORE as well
+        ++i;
+      }
+    }
+  }
+
   void createBailoutBlock(size_t jf_index) {
     bailout_blocks_.emplace_back(BailoutBlock{jf_index});
     auto& bailout_instructions = bailout_blocks_.back().instructions;
@@ -1019,11 +1053,18 @@ struct CodeImpl {
 
   void dump(std::ostream& out, size_t i) const {
     out << i << " " << instructions_[i];
-    if (instructions_[i].op == OP || instructions_[i].op == CALL ||
-        instructions_[i].op == OPN) {
-      out << " # " << *instructions_source_[i];
-    } else {
-      out << "\n";
+    switch (instructions_[i].op) {
+      case OP:
+      case CALL:
+      case OPN:
+      case OP_STORE:
+      case LOAD_OP_STORE:
+      case MOVE_OP_STORE:
+      case LOADC_OP_STORE:
+        out << " # " << *instructions_source_[i];
+        break;
+      default:
+        out << "\n";
     }
   }
 
@@ -1035,6 +1076,26 @@ struct CodeImpl {
   }
 };
 
+#if defined(__GNUC__) || defined(__clang__)
+#define JIT_USE_COMPUTED_GOTO
+#endif
+// Instructions that do not leave the current frame dispatch straight to the
+// handler of the next instruction. With computed gotos every handler ends in
+// its own indirect jump through dispatch_table, which is much easier on the
+// branch predictor than going back through a single switch.
+#ifdef JIT_USE_COMPUTED_GOTO
+#define INST(NAME) \
+  NAME:            \
+  label_##NAME
+#define INST_DISPATCH goto* dispatch_table[inst.op]
+#else
+#define INST(NAME) NAME
+#define INST_DISPATCH break
+#endif
+#define INST_NEXT      \
+  inst = instFetch(1); \
+  INST_DISPATCH
+
 // InterpreterState state that and used to compute a Code
 struct InterpreterStateImpl : c10::intrusive_ptr_target {
   InterpreterStateImpl(const Code& code, TaskLauncher taskLauncher)
@@ -1183,20 +1244,34 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
     if (frames.back().pc == 0 && stack_start_ == 0) {
       checkAndStartRecordFunction(frames.back(), stack);
     }
+#ifdef JIT_USE_COMPUTED_GOTO
+    static void* dispatch_table[] = {
+#define DISPATCH_TABLE_ENTRY(op, _) &&label_##op,
+        FORALL_OPCODES(DISPATCH_TABLE_ENTRY)
+#undef DISPATCH_TABLE_ENTRY
+    };
+#endif
     try {
       while (true) {
         Frame& frame = frames.back();
+        // advances the pc of the current frame by `offset` and returns the
+        // instruction found there. Instructions that replace the current
+        // frame (calls and returns) must `break` back to the top of the loop
+        // so that `frame` is re-read.
+        auto instFetch = [&](int32_t offset) {
+          return frame.function->instructions_[frame.pc += offset];
+        };
         // std::cout << "RUNNING ";
         // frames.back().function->dump(std::cout, frame.pc);
-        Instruction inst = frame.function->instructions_[frame.pc];
+        Instruction inst = instFetch(0);
         switch (inst.op) {
-          case ENTER: {
+          case INST(ENTER): {
             auto obj = peek(stack, 0, 1);
             TORCH_INTERNAL_ASSERT(obj.isObject());
             entered_objects.push_back(obj);
-            ++frame.pc;
-          } break;
-          case EXIT: {
+          }
+            INST_NEXT;
+          case INST(EXIT): {
             auto obj = entered_objects.back().toObject();
             auto& f = obj->type()->getMethod("__exit__");
             push(stack, obj);
@@ -1206,64 +1281,55 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             push(stack, IValue());
             runGraphFunction(stack, &f);
           } break;
-          case OP:
+          case INST(OP):
             frame.function->operator_table_[inst.X](&stack);
-            ++frame.pc;
-            break;
-          case OPN:
+            INST_NEXT;
+          case INST(OPN):
             stack.push_back(inst.N);
             frame.function->operator_table_[inst.X](&stack);
-            ++frame.pc;
-            break;
-          case LOAD:
+            INST_NEXT;
+          case INST(LOAD):
             stack.emplace_back(reg(inst.X));
-            ++frame.pc;
-            break;
-          case MOVE:
+            INST_NEXT;
+          case INST(MOVE):
             stack.emplace_back(std::move(reg(inst.X)));
-            ++frame.pc;
-            break;
-          case STORE:
+            INST_NEXT;
+          case INST(STORE):
             reg(inst.X) = pop(stack);
-            ++frame.pc;
-            break;
-          case STOREN:
+            INST_NEXT;
+          case INST(STOREN):
             for (size_t i = inst.N; i > 0; --i) {
               reg(inst.X + i - 1) = pop(stack);
             }
-            ++frame.pc;
-            break;
-          case DROP:
+            INST_NEXT;
+          case INST(DROP):
             pop(stack);
-            ++frame.pc;
-            break;
-          case DROPR:
+            INST_NEXT;
+          case INST(DROPR):
             reg(inst.X) = IValue();
-            ++frame.pc;
-            break;
-          case LOADC:
+            INST_NEXT;
+          case INST(LOADC):
             stack.emplace_back(frame.function->constant_table_[inst.X]);
-            ++frame.pc;
-            break;
-          case GET_ATTR: {
+            INST_NEXT;
+          case INST(GET_ATTR): {
             auto userObj = pop(stack).toObject();
             auto value = userObj->getSlot(inst.X);
             push(stack, std::move(value));
-            ++frame.pc;
-          } break;
-          case SET_ATTR: {
+          }
+            INST_NEXT;
+          case INST(SET_ATTR): {
             auto v = pop(stack);
             auto userObj = pop(stack).toObject();
             userObj->setSlot(inst.X, std::move(v));
-            ++frame.pc;
-          } break;
-          case JF:
-            frame.pc += (pop(stack).toBool()) ? 1 : inst.X;
-            break;
-          case JMP:
-            frame.pc += inst.X;
-            break;
-          case LOOP: {
+          }
+            INST_NEXT;
+          case INST(JF):
+            inst = instFetch((pop(stack).toBool()) ? 1 : inst.X);
+            INST_DISPATCH;
+          case INST(JMP):
+            inst = instFetch(inst.X);
+            INST_DISPATCH;
+          case INST(LOOP): {
             // stack: iteration_count, max_iter, cond, loop_carried_deps...
             auto fr = stack.end() - (inst.N + 1);
             int64_t trip_count = fr[0].toInt();
@@ -1272,17 +1338,18 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             if (trip_count < max_trip_count && cond) {
               fr[2] = trip_count;
               fr[0] = trip_count + 1;
-              ++frame.pc;
+              inst = instFetch(1);
             } else {
               size_t n_loop_carried = inst.N - 2;
               for (size_t i = 0; i < n_loop_carried; ++i) {
                 fr[i] = std::move(fr[i + 3]);
               }
               drop(stack, 3); // iteration_count, max_iter, cond
-              frame.pc += inst.X;
+              inst = instFetch(inst.X);
             }
-          } break;
-          case CALL: {
+          }
+            INST_DISPATCH;
+          case INST(CALL): {
             Function* fn = frame.function->function_table_[inst.X];
             if (!fn->isGraphFunction()) {
               runBuiltinFunction(stack, fn);
@@ -1290,7 +1357,7 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
               runGraphFunction(stack, fn);
             }
           } break;
-          case INTERFACE_CALL: {
+          case INST(INTERFACE_CALL): {
             // note the hash table lookup to find the function
             // this can be more optimized if necessary, caching parts
             // of the hashing computation or storing the offset when
@@ -1315,7 +1382,7 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
               runGraphFunction(stack, &function);
             }
           } break;
-          case RET:
+          case INST(RET):
             if (frames.size() > 1) {
               leaveFrame();
               break;
@@ -1332,7 +1399,7 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             // destroy the last frame and call RecordFunction's end callbacks
             leaveFrame();
             return false;
-          case WAIT: {
+          case INST(WAIT): {
             auto future = stack.back().toFuture();
             if (!future->completed()) {
               getOrCreateFuture();
@@ -1387,9 +1454,9 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             }
             stack.pop_back();
             stack.emplace_back(future->value());
-            ++frame.pc;
-          } break;
-          case PROFILE_OP: {
+          }
+            INST_NEXT;
+          case INST(PROFILE_OP): {
             auto& frame_id_ref = frame.id;
             if (!frame_id_ref.has_value()) {
               frame_id_ref = Frame::num_frames++;
@@ -1397,19 +1464,17 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             auto callback = frame.function->profile_function_table_[inst.X];
             push(stack, c10::IValue{static_cast<int64_t>(*frame_id_ref)});
             callback(stack);
-            ++frame.pc;
-            break;
           }
-          case FAIL_GUARD: {
+            INST_NEXT;
+          case INST(FAIL_GUARD): {
             // patch FAIL_GUARD back to GUARD
             GRAPH_DEBUG(
                 "Bailout ", inst.X, " triggered via bailout_requests_!");
             frame.function->instructions_[frame.pc].op = GUARD;
             push(stack, false);
-            ++frame.pc;
-            break;
           }
-          case TYPECHECK: {
+            INST_NEXT;
+          case INST(TYPECHECK): {
             int num_inputs = inst.N, i = 0;
             TORCH_INTERNAL_ASSERT(stack.size() >= num_inputs && num_inputs > 0);
             // Check every input's shape against profiled (expected) shape.
@@ -1426,10 +1491,9 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             if (i == num_inputs) {
               push(stack, true);
             }
-            ++frame.pc;
-            break;
           }
-          case GUARD: {
+            INST_NEXT;
+          case INST(GUARD): {
             if (!stack.back().isTensor()) {
               // stack.back() is an Uninitialized IValue and this is a guard
               // on a block output. Uninitialized IValues are never used
@@ -1447,9 +1511,9 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
                 push(stack, expected_type->matchTensor(t));
               }
             }
-            ++frame.pc;
-          } break;
-          case TAIL_CALL: {
+          }
+            INST_NEXT;
+          case INST(TAIL_CALL): {
             GRAPH_DEBUG("running TAIL_CALL for ", inst.X);
             frame.function->function_table_[inst.X]->ensure_defined();
             size_t remaining_bailout_depth =
@@ -1473,49 +1537,49 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             enterFrame(code, base_pointer);
             checkAndStartRecordFunction(frames.back(), stack);
           } break;
-          case LIST_UNPACK: {
+          case INST(LIST_UNPACK): {
             listUnpack(stack, inst.X);
-            ++frame.pc;
-          } break;
-          case TUPLE_CONSTRUCT: {
+          }
+            INST_NEXT;
+          case INST(TUPLE_CONSTRUCT): {
             tupleConstruct(stack, inst.X);
-            ++frame.pc;
-          } break;
-          case TUPLE_SLICE: {
+          }
+            INST_NEXT;
+          case INST(TUPLE_SLICE): {
             tupleSlice(stack, inst.X, inst.X + inst.N);
-            ++frame.pc;
-          } break;
-          case NAMED_TUPLE_CONSTRUCT: {
+          }
+            INST_NEXT;
+          case INST(NAMED_TUPLE_CONSTRUCT): {
             auto type =
                 frame.function->type_table_[inst.X]->expect<TupleType>();
             namedTupleConstruct(stack, type, inst.N);
-            ++frame.pc;
-          } break;
-          case LIST_CONSTRUCT: {
+          }
+            INST_NEXT;
+          case INST(LIST_CONSTRUCT): {
             const auto& type =
                 frame.function->type_table_[inst.X]->expectRef<ListType>();
             listConstruct(stack, type, inst.N);
-            ++frame.pc;
-          } break;
-          case DICT_CONSTRUCT: {
+          }
+            INST_NEXT;
+          case INST(DICT_CONSTRUCT): {
             auto type = frame.function->type_table_[inst.X]->expect<DictType>();
             dictConstruct(stack, type, inst.N);
-            ++frame.pc;
-          } break;
-          case CREATE_OBJECT: {
+          }
+            INST_NEXT;
+          case INST(CREATE_OBJECT): {
             auto type =
                 frame.function->type_table_[inst.X]->expect<ClassType>();
             createObject(stack, type);
-            ++frame.pc;
-          } break;
-          case ISINSTANCE: {
+          }
+            INST_NEXT;
+          case INST(ISINSTANCE): {
             at::ArrayRef<TypePtr> types(
                 &(frame.function->type_table_[inst.X]),
                 &(frame.function->type_table_[inst.X + inst.N]));
             isinstance(stack, types);
-            ++frame.pc;
-          } break;
-          case FORK: {
+          }
+            INST_NEXT;
+          case INST(FORK): {
             // Move inputs to a separate stack
             Function* forked_fn = frame.function->function_table_[inst.X];
             InterpreterState forked_interpreter(
@@ -1530,9 +1594,9 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             drop(stack, inst.N);
             push(stack, forked_interpreter.getFuture());
             taskLauncher_(std::move(continuation));
-            ++frame.pc;
-          } break;
-          case WARN: {
+          }
+            INST_NEXT;
+          case INST(WARN): {
             // Keeps track of which WARN instruction has been executed before,
             // we only want to execute each WARN once to match default Python
             // warning behavior.
@@ -1563,8 +1627,39 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
                 TORCH_WARN(msg);
               }
             }
-            ++frame.pc;
-          } break;
+          }
+            INST_NEXT;
+          // Superinstructions. Each one occupies the slot of the first
+          // instruction of the sequence it was fused from; the remaining
+          // instructions of the sequence are left in place and are read for
+          // their operands, so the pc always refers to the instruction
+          // currently being executed (e.g. for error reporting).
+          case INST(OP_STORE):
+            frame.function->operator_table_[inst.X](&stack);
+            inst = instFetch(1);
+            reg(inst.X) = pop(stack);
+            INST_NEXT;
+          case INST(LOAD_OP_STORE):
+            stack.emplace_back(reg(inst.X));
+            inst = instFetch(1);
+            frame.function->operator_table_[inst.X](&stack);
+            inst = instFetch(1);
+            reg(inst.X) = pop(stack);
+            INST_NEXT;
+          case INST(MOVE_OP_STORE):
+            stack.emplace_back(std::move(reg(inst.X)));
+            inst = instFetch(1);
+            frame.function->operator_table_[inst.X](&stack);
+            inst = instFetch(1);
+            reg(inst.X) = pop(stack);
+            INST_NEXT;
+          case INST(LOADC_OP_STORE):
+            stack.emplace_back(frame.function->constant_table_[inst.X]);
+            inst = instFetch(1);
+            frame.function->operator_table_[inst.X](&stack);
+            inst = instFetch(1);
+            reg(inst.X) = pop(stack);
+            INST_NEXT;
         }
       }
     } catch (std::exception& e) {
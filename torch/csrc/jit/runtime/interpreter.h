@@ -10,6 +10,7 @@
 #include <torch/csrc/jit/frontend/source_range.h>
 
 C10_DECLARE_bool(torch_jit_disable_warning_prints);
+C10_DECLARE_bool(torch_jit_enable_superinstructions);
 
 namespace at {
 class Tensor;
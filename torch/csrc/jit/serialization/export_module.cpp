@@ -116,6 +116,11 @@ std::pair<IValue, c10::optional<IValue>> getFunctionTuple(
 
   torch::jit::Code code(graph, func.name());
   auto instructions_copy = code.instructions();
+  // the lite interpreter has no superinstructions; the instructions they
+  // were fused from are all still in place, so just restore the first one
+  for (Instruction& ins : instructions_copy) {
+    ins.op = unfusedOpCode(ins.op);
+  }
 
   // operator names
   std::vector<c10::OperatorName> opnames;
@@ -13,6 +13,7 @@
 #include <torch/csrc/jit/serialization/import_source.h>
 #include <torch/csrc/jit/serialization/pickle.h>
 #include <torch/csrc/jit/serialization/source_range_serialization.h>
+#include <torch/csrc/jit/serialization/storage_cache.h>
 #include <torch/csrc/jit/serialization/unpickler.h>
 
 #include <caffe2/serialize/file_adapter.h>
@@ -85,7 +86,14 @@ IValue readArchiveAndTensors(
   std::string archive_name_plus_slash = archive_name + "/";
   auto read_record = [&](const std::string& name) {
     std::string ss = archive_name_plus_slash + name;
-    return std::get<0>(stream_reader.getRecord(ss));
+    at::DataPtr data;
+    size_t size;
+    std::tie(data, size) = stream_reader.getRecord(ss);
+    if (ShareLoadedStoragesGuard::is_enabled()) {
+      return LoadedStorageCache::global().deduplicate(
+          stream_reader.getRecordCRC32(ss), std::move(data), size);
+    }
+    return data;
   };
 
   Unpickler unpickler(
@@ -239,6 +247,25 @@ graph(%x, %packed_params, %stride, %padding, %dilation, %groups, %r_scale, %r_ze
   }
 }
 
+// Tensors that may be written to get a private copy of data shared with
+// other loaded modules, see LoadedStorageCache.
+void unshareMutableTensors(const Module& module) {
+  for (const Module& m : module.modules()) {
+    const bool training = m.is_training();
+    for (const auto& attr : m.named_attributes(/*recurse=*/false)) {
+      if (!attr.value.isTensor()) {
+        continue;
+      }
+      const auto& tensor = attr.value.toTensor();
+      if (tensor.defined() && tensor.has_storage() &&
+          (training || tensor.requires_grad())) {
+        LoadedStorageCache::unshare(
+            *tensor.storage().unsafeGetStorageImpl());
+      }
+    }
+  }
+}
+
 Module ScriptModuleDeserializer::deserialize(
     c10::optional<at::Device> device,
     ExtraFilesMap& extra_files) {
@@ -267,6 +294,9 @@ Module ScriptModuleDeserializer::deserialize(
     constants_table_.push_back(constant.toIValue());
   }
   auto m = Module(readArchive("data").toObject());
+  if (ShareLoadedStoragesGuard::is_enabled()) {
+    unshareMutableTensors(m);
+  }
   rewriteQuantizedConvForBC(m);
   return m;
 }
@@ -0,0 +1,126 @@
+#include <torch/csrc/jit/serialization/storage_cache.h>
+
+#include <c10/core/CPUAllocator.h>
+
+#include <cstring>
+#include <vector>
+
+namespace torch {
+namespace jit {
+
+namespace {
+thread_local bool share_loaded_storages = false;
+
+uint64_t cacheKey(uint32_t crc32, size_t nbytes) {
+  return (static_cast<uint64_t>(crc32) << 32) ^ static_cast<uint64_t>(nbytes);
+}
+} // namespace
+
+LoadedStorageCache& LoadedStorageCache::global() {
+  static LoadedStorageCache cache;
+  return cache;
+}
+
+namespace {
+template <typename Buffer>
+void deleteSharedBuffer(void* ctx) {
+  delete static_cast<std::shared_ptr<Buffer>*>(ctx);
+}
+} // namespace
+
+at::DataPtr LoadedStorageCache::share(const std::shared_ptr<Buffer>& buffer) {
+  void* ptr = buffer->data.get();
+  return at::DataPtr(
+      ptr,
+      new std::shared_ptr<Buffer>(buffer),
+      &deleteSharedBuffer<Buffer>,
+      at::Device(at::DeviceType::CPU));
+}
+
+bool LoadedStorageCache::unshare(c10::StorageImpl& storage) {
+  if (storage.data_ptr().get_deleter() != &deleteSharedBuffer<Buffer>) {
+    return false;
+  }
+  const auto nbytes = storage.nbytes();
+  auto copy = c10::GetCPUAllocator()->allocate(nbytes);
+  if (nbytes > 0) {
+    std::memcpy(copy.get(), storage.data(), nbytes);
+  }
+  storage.set_data_ptr(std::move(copy));
+  return true;
+}
+
+at::DataPtr LoadedStorageCache::deduplicate(
+    uint32_t crc32,
+    at::DataPtr data,
+    size_t nbytes) {
+  TORCH_INTERNAL_ASSERT(data.device().is_cpu());
+  uint64_t key = cacheKey(crc32, nbytes);
+  // The candidates are compared outside of the lock, since records may be
+  // large. The lock is only taken again to publish a new buffer, so two
+  // threads loading the same record at once may both publish it, which only
+  // costs some sharing.
+  std::vector<std::shared_ptr<Buffer>> candidates;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto range = buffers_.equal_range(key);
+    for (auto it = range.first; it != range.second;) {
+      auto buffer = it->second.lock();
+      if (!buffer) {
+        it = buffers_.erase(it);
+        continue;
+      }
+      if (buffer->nbytes == nbytes) {
+        candidates.push_back(std::move(buffer));
+      }
+      ++it;
+    }
+  }
+  for (const auto& buffer : candidates) {
+    if (nbytes == 0 ||
+        std::memcmp(buffer->data.get(), data.get(), nbytes) == 0) {
+      return share(buffer);
+    }
+  }
+
+  auto buffer = std::make_shared<Buffer>(Buffer{std::move(data), nbytes});
+  std::lock_guard<std::mutex> guard(mutex_);
+  buffers_.emplace(key, buffer);
+  if (buffers_.size() >= sweep_threshold_) {
+    sweepExpired();
+    sweep_threshold_ = std::max<size_t>(1024, 2 * buffers_.size());
+  }
+  return share(buffer);
+}
+
+size_t LoadedStorageCache::size() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  sweepExpired();
+  return buffers_.size();
+}
+
+void LoadedStorageCache::sweepExpired() {
+  for (auto it = buffers_.begin(); it != buffers_.end();) {
+    if (it->second.expired()) {
+      it = buffers_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+ShareLoadedStoragesGuard::ShareLoadedStoragesGuard(bool enabled)
+    : prev_(share_loaded_storages) {
+  share_loaded_storages = enabled;
+}
+
+ShareLoadedStoragesGuard::~ShareLoadedStoragesGuard() {
+  share_loaded_storages = prev_;
+}
+
+bool ShareLoadedStoragesGuard::is_enabled() {
+  return share_loaded_storages;
+}
+
+} // namespace jit
+} // namespace torch
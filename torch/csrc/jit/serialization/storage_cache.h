@@ -0,0 +1,81 @@
+#pragma once
+
+#include <c10/core/Allocator.h>
+#include <c10/core/StorageImpl.h>
+#include <c10/macros/Export.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace torch {
+namespace jit {
+
+/**
+ * Content-addressed cache of the data of tensors read by torch::jit::load.
+ *
+ * Serving processes often load several versions or variants of the same
+ * model, whose parameters are mostly identical. While sharing is enabled
+ * (see ShareLoadedStoragesGuard), every tensor record read from an archive
+ * is looked up here by the CRC-32 the zip file already stores for it and its
+ * size. A candidate is only used after comparing its bytes with the record,
+ * so CRC collisions are harmless. On a hit the freshly read record is freed
+ * and the tensor is backed by the existing memory instead.
+ *
+ * The cache only holds weak references; memory is released once the last
+ * tensor using it is gone.
+ *
+ * Shared memory must only be read. torch::jit::load gives the tensors that
+ * may be written to, i.e. those requiring grad or of modules in training
+ * mode, a private copy of their data (see unshare()), so only the tensors
+ * of modules loaded for inference, e.g. frozen ones, stay shared.
+ */
+class TORCH_API LoadedStorageCache {
+ public:
+  static LoadedStorageCache& global();
+
+  // Returns a DataPtr to memory holding the same `nbytes` bytes as `data`,
+  // which is either memory already in the cache or `data` itself, which is
+  // then added to the cache.
+  at::DataPtr deduplicate(uint32_t crc32, at::DataPtr data, size_t nbytes);
+
+  // Gives `storage` a private copy of its data if it is shared through the
+  // cache. Returns whether it was.
+  static bool unshare(c10::StorageImpl& storage);
+
+  // Number of distinct live buffers in the cache.
+  size_t size();
+
+ private:
+  struct Buffer {
+    at::DataPtr data;
+    size_t nbytes;
+  };
+
+  static at::DataPtr share(const std::shared_ptr<Buffer>& buffer);
+  void sweepExpired();
+
+  std::mutex mutex_;
+  std::unordered_multimap<uint64_t, std::weak_ptr<Buffer>> buffers_;
+  size_t sweep_threshold_ = 1024;
+};
+
+// While an instance is alive, tensors loaded with torch::jit::load on the
+// current thread share memory with identical tensors loaded in the same mode
+// earlier, unless they require grad or belong to a module in training mode.
+// Shared tensors must be treated as read-only: modifying one in place would
+// modify the others.
+class TORCH_API ShareLoadedStoragesGuard {
+ public:
+  explicit ShareLoadedStoragesGuard(bool enabled = true);
+  ~ShareLoadedStoragesGuard();
+
+  static bool is_enabled();
+
+ private:
+  bool prev_;
+};
+
+} // namespace jit
+} // namespace torch
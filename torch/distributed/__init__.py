@@ -27,6 +27,9 @@ if is_available():
         ProcessGroup,
         Reducer,
         BuiltinCommHookType,
+        Int8RowwiseQuantizeOptions,
+        TopKSparsifyOptions,
+        PowerSGDOptions,
         _DEFAULT_FIRST_BUCKET_BYTES,
         _GradBucket,
         _register_comm_hook,
@@ -3,7 +3,6 @@ import logging
 import pickle
 import torch
 import warnings
-import time
 from torch._six import string_classes
 from datetime import timedelta
 from typing import Dict, Optional, Tuple, Union
@@ -49,6 +48,11 @@ try:
 except ImportError:
     _GLOO_AVAILABLE = False
 
+try:
+    from torch._C._distributed_c10d import ProcessGroupShm
+except ImportError:
+    ProcessGroupShm = None
+
 # Some reduce ops are not supported by complex numbers and will result in an error.
 # We currently provide complex support to the distributed API by viewing
 # complex tensors as real (torch.view_as_real), meaning that calling
@@ -125,6 +129,11 @@ class Backend(object):
 _backend: str = Backend.UNDEFINED
 dist_backend = Backend
 
+# The shared memory backend only works among processes on the same host and
+# is registered like a third party backend.
+if ProcessGroupShm is not None:
+    Backend.register_backend("shm", ProcessGroupShm)
+
 
 class _reduce_op(object):
     r"""
@@ -186,33 +195,19 @@ def _store_based_barrier(rank, store, timeout):
     store.add(store_key, 1)
     logging.info('Added key: {} to store for rank: {}'.format(store_key, rank))
 
-    # Now wait for all workers to check in with the store.
+    # Now wait for all workers to check in with the store. Stores that support
+    # it notify us once the counter is reached, the others fall back to
+    # polling it with 'add' instead of 'get', since for some store
+    # implementations 'add' doesn't work well with 'get'.
     world_size = get_world_size()
-    # Use 'add' instead of 'get' since for some store implementations 'add'
-    # doesn't work well with 'get'. Ideally the store implementations should
-    # be fixed, but for backward compatiblity reasons it is risky to change
-    # the store implementations. Once, we completely migrate away from these
-    # legacy stores, we can use 'get' here instead.
-    worker_count = store.add(store_key, 0)
-    start = time.time()
-    log_time = time.time()
-    while worker_count != world_size:
-        time.sleep(0.01)
+    try:
+        store._wait_counter(store_key, world_size, timeout)
+    except RuntimeError:
         worker_count = store.add(store_key, 0)
-
-        # Print status periodically to keep track.
-        if timedelta(seconds=(time.time() - log_time)) > timedelta(seconds=10):
-            logging.info(
-                "Waiting in store based barrier to initialize process group for "
-                "rank: {}, key: {} (world_size={}, worker_count={}, timeout={})".format(
-                    rank, store_key, world_size, worker_count, timeout))
-            log_time = time.time()
-
-        if timedelta(seconds=(time.time() - start)) > timeout:
-            raise RuntimeError(
-                "Timed out initializing process group in store based barrier on "
-                "rank: {}, for key: {} (world_size={}, worker_count={}, timeout={})".format(
-                    rank, store_key, world_size, worker_count, timeout))
+        raise RuntimeError(
+            "Timed out initializing process group in store based barrier on "
+            "rank: {}, for key: {} (world_size={}, worker_count={}, timeout={})".format(
+                rank, store_key, world_size, worker_count, timeout))
 
 def _rank_not_in_group(group: ProcessGroup):
     """
@@ -896,7 +891,26 @@ def _batch_p2p_manager(backend):
             ProcessGroupNCCL._group_end()
 
 
-def batch_isend_irecv(p2p_op_list):
+def _batch_isend_irecv_coalesced(p2p_op_list, group, tag):
+    if group is None or group is GroupMember.WORLD:
+        pg = _get_default_group()
+        peers = [p2p_op.peer for p2p_op in p2p_op_list]
+    else:
+        pg = group
+        peers = [_get_group_rank(group, p2p_op.peer) for p2p_op in p2p_op_list]
+    send_tensors, dst_ranks, recv_tensors, src_ranks = [], [], [], []
+    for p2p_op, peer in zip(p2p_op_list, peers):
+        if p2p_op.op is isend:
+            send_tensors.append(p2p_op.tensor)
+            dst_ranks.append(peer)
+        else:
+            recv_tensors.append(p2p_op.tensor)
+            src_ranks.append(peer)
+    return pg.batch_isend_irecv(
+        send_tensors, dst_ranks, recv_tensors, src_ranks, tag)
+
+
+def batch_isend_irecv(p2p_op_list, coalesce=False):
     """
     Send or Receive a batch of tensors asynchronously and return a list of requests.
 
@@ -908,10 +922,18 @@ def batch_isend_irecv(p2p_op_list):
             ``torch.distributed.P2POp``). The order of the isend/irecv in the list
             matters and it needs to match with corresponding isend/irecv on the
             remote end.
+        coalesce (bool, optional): Gloo only. Whether to coalesce the tensors
+            sent to and received from each peer into a single message. All ops
+            must then use the same group and tag, and every peer must call this
+            function with ``coalesce=True`` and the same tensor sizes for this
+            rank, since the messages are not compatible with
+            :func:`isend`/:func:`irecv` or uncoalesced batches. Default is
+            ``False``.
 
     Returns:
         A list of distributed request objects returned by calling the corresponding
-        op in the op_list.
+        op in the op_list, or a single request for the whole batch if
+        ``coalesce`` is ``True``.
 
     Examples:
         >>> send_tensor = torch.arange(2) + 2 * rank
@@ -928,9 +950,23 @@ def batch_isend_irecv(p2p_op_list):
     .. note:: Note that when this API is used with the NCCL PG backend, users must set
         the current GPU device with `torch.cuda.set_device`, otherwise it will
         lead to unexpected hang issues.
+
     """
     _check_p2p_op_list(p2p_op_list)
     backend = get_backend(p2p_op_list[0].group)
+    if coalesce:
+        if backend != Backend.GLOO:
+            raise RuntimeError(
+                "batch_isend_irecv only supports coalesce=True with the Gloo backend")
+        group = p2p_op_list[0].group
+        tag = p2p_op_list[0].tag
+        if not all(p2p_op.group is group and p2p_op.tag == tag for p2p_op in p2p_op_list):
+            raise RuntimeError(
+                "batch_isend_irecv with coalesce=True requires all ops to use the same group and tag")
+        if _rank_not_in_group(group):
+            return []
+        return [_batch_isend_irecv_coalesced(p2p_op_list, group, tag)]
+
     reqs = []
     with _batch_p2p_manager(backend):
         for p2p_op in p2p_op_list:
@@ -60,4 +60,22 @@ void PrefixStore::wait(
   store_->wait(joinedKeys, timeout);
 }
 
+void PrefixStore::multiSet(
+    const std::vector<std::string>& keys,
+    const std::vector<std::vector<uint8_t>>& values) {
+  store_->multiSet(joinKeys(keys), values);
+}
+
+std::vector<std::vector<uint8_t>> PrefixStore::multiGet(
+    const std::vector<std::string>& keys) {
+  return store_->multiGet(joinKeys(keys));
+}
+
+void PrefixStore::waitCounter(
+    const std::string& key,
+    int64_t target,
+    const std::chrono::milliseconds& timeout) {
+  store_->waitCounter(joinKey(key), target, timeout);
+}
+
 } // namespace c10d
@@ -31,6 +31,18 @@ class PrefixStore : public Store {
       const std::vector<std::string>& keys,
       const std::chrono::milliseconds& timeout) override;
 
+  void multiSet(
+      const std::vector<std::string>& keys,
+      const std::vector<std::vector<uint8_t>>& values) override;
+
+  std::vector<std::vector<uint8_t>> multiGet(
+      const std::vector<std::string>& keys) override;
+
+  void waitCounter(
+      const std::string& key,
+      int64_t target,
+      const std::chrono::milliseconds& timeout) override;
+
  protected:
   std::string prefix_;
   c10::intrusive_ptr<Store> store_;
@@ -1,6 +1,8 @@
 #include <c10d/ProcessGroup.hpp>
 #include <ATen/ThreadLocalState.h>
 
+#include <algorithm>
+
 
 #include <c10/util/Logging.h>
 
@@ -162,6 +164,77 @@ ProcessGroup::ProcessGroup(int rank, int size) : rank_(rank), size_(size) {
 
 ProcessGroup::~ProcessGroup() {}
 
+namespace {
+
+// Work of the ops of a batch_isend_irecv call that were started separately.
+class BatchWork : public ProcessGroup::Work {
+ public:
+  explicit BatchWork(std::vector<c10::intrusive_ptr<ProcessGroup::Work>> works)
+      : works_(std::move(works)) {}
+
+  bool isCompleted() override {
+    return std::all_of(works_.begin(), works_.end(), [](auto& work) {
+      return work->isCompleted();
+    });
+  }
+
+  bool isSuccess() const override {
+    return std::all_of(works_.begin(), works_.end(), [](const auto& work) {
+      return work->isSuccess();
+    });
+  }
+
+  std::exception_ptr exception() const override {
+    for (const auto& work : works_) {
+      if (!work->isSuccess()) {
+        return work->exception();
+      }
+    }
+    return nullptr;
+  }
+
+  bool wait(std::chrono::milliseconds timeout) override {
+    bool completed = true;
+    std::exception_ptr exception{nullptr};
+    try {
+      for (auto& work : works_) {
+        completed &= work->wait(timeout);
+      }
+    } catch (...) {
+      exception = std::current_exception();
+    }
+    finishAndThrow(exception);
+    return completed;
+  }
+
+  void abort() override {
+    for (auto& work : works_) {
+      work->abort();
+    }
+  }
+
+ private:
+  const std::vector<c10::intrusive_ptr<ProcessGroup::Work>> works_;
+};
+
+} // namespace
+
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroup::batch_isend_irecv(
+    std::vector<P2POp>& ops,
+    int tag) {
+  std::vector<c10::intrusive_ptr<ProcessGroup::Work>> works;
+  works.reserve(ops.size());
+  for (auto& op : ops) {
+    std::vector<at::Tensor> tensors = {op.tensor};
+    if (op.type == P2POp::Type::SEND) {
+      works.push_back(send(tensors, op.peer, tag));
+    } else {
+      works.push_back(recv(tensors, op.peer, tag));
+    }
+  }
+  return c10::make_intrusive<BatchWork>(std::move(works));
+}
+
 // This is introduced so that implementors of ProcessGroup would not need to
 // have this implmentation.
 c10::intrusive_ptr<ProcessGroup::Work> ProcessGroup::allgather_coalesced(
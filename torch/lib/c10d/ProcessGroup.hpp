@@ -48,6 +48,16 @@ std::string opTypeToString(OpType opType);
 // Whether or not an OP is an p2p op (SEND, RECV, RECVANYSOURCE)
 bool isP2POp(OpType opType);
 
+// A send to or a recv from `peer`, as part of a batch passed to
+// ProcessGroup::batch_isend_irecv.
+struct P2POp {
+  enum class Type : std::uint8_t { SEND, RECV };
+
+  Type type;
+  at::Tensor tensor;
+  int peer;
+};
+
 // ProcessGroup is a base class that captures collective and point to
 // point communication in a fixed set of processes.
 //
@@ -259,6 +269,16 @@ class ProcessGroup : public torch::CustomClassHolder {
       std::vector<at::Tensor>& tensors,
       int tag) = 0;
 
+  // Starts all sends and recvs in `ops` and returns a single work that
+  // completes once all of them have. Implementations may coalesce the ops
+  // with the same peer and type into a single message, so the peers must
+  // issue matching batches, with the tensors of every peer in the same order
+  // and of the same sizes. The default implementation calls send and recv
+  // for every op.
+  virtual c10::intrusive_ptr<ProcessGroup::Work> batch_isend_irecv(
+      std::vector<P2POp>& ops,
+      int tag);
+
   virtual c10::intrusive_ptr<ProcessGroup::Work> barrier(
       const BarrierOptions& opts = BarrierOptions()) = 0;
 
@@ -13,6 +13,10 @@
 #endif
 #include <sys/types.h>
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <system_error>
 #include <type_traits>
 
 #include <gloo/allgather.h>
@@ -442,8 +446,66 @@ void ProcessGroupGloo::RecvWork::abort() {
   buffer_->abortWaitRecv();
 }
 
+ProcessGroupGloo::BatchSendRecvWork::BatchSendRecvWork(
+    std::vector<Message> messages)
+    : messages_(std::move(messages)) {}
+
+void ProcessGroupGloo::BatchSendRecvWork::complete() {
+  std::exception_ptr exception{nullptr};
+  try {
+    bool completed = true;
+    for (auto& message : messages_) {
+      auto buffer = message.buffer();
+      if (message.send) {
+        completed &= buffer->waitSend();
+      } else {
+        int srcRank;
+        completed &= buffer->waitRecv(&srcRank);
+      }
+    }
+    if (!completed) {
+      throw std::runtime_error("batch_isend_irecv was aborted");
+    }
+    for (auto& message : messages_) {
+      if (!message.staging) {
+        continue;
+      }
+      if (!message.send) {
+        const auto data =
+            static_cast<uint8_t*>(message.staging->tensor.data_ptr());
+        size_t offset = 0;
+        for (auto& tensor : message.tensors) {
+          const size_t nbytes = tensor.numel() * tensor.element_size();
+          if (nbytes > 0) {
+            std::memcpy(tensor.data_ptr(), data + offset, nbytes);
+          }
+          offset += nbytes;
+        }
+      }
+      message.staging->inUse = false;
+    }
+  } catch (...) {
+    // The buffers of a failed transfer are not reused.
+    exception = std::current_exception();
+  }
+  finish(exception);
+}
+
+void ProcessGroupGloo::BatchSendRecvWork::abort() {
+  for (auto& message : messages_) {
+    if (message.send) {
+      message.buffer()->abortWaitSend();
+    } else {
+      message.buffer()->abortWaitRecv();
+    }
+  }
+}
+
 ProcessGroupGloo::Options::Options()
-    : timeout(std::chrono::milliseconds(10 * 1000)), threads(2) {}
+    : timeout(std::chrono::milliseconds(10 * 1000)),
+      threads(2),
+      hierarchicalAllreduce(false),
+      shardedSparseAllreduce(false) {}
 
 namespace {
 
@@ -568,6 +630,9 @@ ProcessGroupGloo::ProcessGroupGloo(
     Options options)
     : ProcessGroup(rank, size),
       store_(new GlooStore(store)),
+      hierarchical_(false),
+      shardedSparseAllreduce_(options.shardedSparseAllreduce),
+      p2pStop_(false),
       stop_(false),
       collectiveCounter_(0) {
   auto& devices = options.devices;
@@ -596,6 +661,10 @@ ProcessGroupGloo::ProcessGroupGloo(
     contexts_.push_back(std::move(context));
   }
 
+  if (options.hierarchicalAllreduce) {
+    connectHierarchy(options);
+  }
+
   // Every worker thread stores the AsyncWork object it's currently
   // working on in the workInProgress_ vector. It must have size equal
   // to the number of workers such that they can simply index into it
@@ -624,6 +693,93 @@ ProcessGroupGloo::~ProcessGroupGloo() {
   for (auto& thread : threads_) {
     thread.join();
   }
+
+  // The p2p completion thread completes the pending work first.
+  {
+    std::lock_guard<std::mutex> p2pLock(p2pWorkMutex_);
+    p2pStop_ = true;
+  }
+  p2pWorkCV_.notify_one();
+  if (p2pThread_.joinable()) {
+    p2pThread_.join();
+  }
+}
+
+void ProcessGroupGloo::runP2PLoop() {
+  std::unique_lock<std::mutex> lock(p2pWorkMutex_);
+  while (true) {
+    p2pWorkCV_.wait(
+        lock, [&] { return p2pStop_ || !p2pWorkQueue_.empty(); });
+    if (p2pWorkQueue_.empty()) {
+      return;
+    }
+    auto work = std::move(p2pWorkQueue_.front());
+    p2pWorkQueue_.pop_front();
+    lock.unlock();
+    work->complete();
+    lock.lock();
+  }
+}
+
+void ProcessGroupGloo::connectHierarchy(const Options& options) {
+  auto hostId = options.hostId;
+  if (hostId.empty()) {
+    std::array<char, 256> hostname{};
+    if (gethostname(hostname.data(), hostname.size() - 1) != 0) {
+      throw std::system_error(errno, std::system_category());
+    }
+    hostId = hostname.data();
+  }
+
+  auto store = ::gloo::rendezvous::PrefixStore("hierarchy", *store_);
+  store.set(
+      std::to_string(rank_), std::vector<char>(hostId.begin(), hostId.end()));
+
+  // Hosts are numbered in the order of their lowest rank, which is the
+  // leader of the host.
+  std::vector<std::string> hosts;
+  std::vector<int> localRanks;
+  for (int rank = 0; rank < size_; rank++) {
+    const auto value = store.get(std::to_string(rank));
+    const std::string host(value.begin(), value.end());
+    if (std::find(hosts.begin(), hosts.end(), host) == hosts.end()) {
+      hosts.push_back(host);
+    }
+    if (host == hostId) {
+      localRanks.push_back(rank);
+    }
+  }
+  if (hosts.size() == 1 || hosts.size() == static_cast<size_t>(size_)) {
+    // Nothing to gain over the flat algorithm.
+    return;
+  }
+
+  const auto hostIndex =
+      std::find(hosts.begin(), hosts.end(), hostId) - hosts.begin();
+  const auto localRank =
+      std::find(localRanks.begin(), localRanks.end(), rank_) -
+      localRanks.begin();
+  for (size_t i = 0; i < options.devices.size(); i++) {
+    if (localRanks.size() > 1) {
+      auto context = std::make_shared<::gloo::rendezvous::Context>(
+          localRank, localRanks.size());
+      auto localStore = ::gloo::rendezvous::PrefixStore(
+          c10::str("hierarchy/local/", hostIndex, "/", i), *store_);
+      context->setTimeout(options.timeout);
+      context->connectFullMesh(localStore, options.devices[i]);
+      localContexts_.push_back(std::move(context));
+    }
+    if (localRank == 0) {
+      auto context = std::make_shared<::gloo::rendezvous::Context>(
+          hostIndex, hosts.size());
+      auto leaderStore = ::gloo::rendezvous::PrefixStore(
+          c10::str("hierarchy/leader/", i), *store_);
+      context->setTimeout(options.timeout);
+      context->connectFullMesh(leaderStore, options.devices[i]);
+      leaderContexts_.push_back(std::move(context));
+    }
+  }
+  hierarchical_ = true;
 }
 
 uint32_t ProcessGroupGloo::nextTag() {
@@ -658,6 +814,52 @@ void ProcessGroupGloo::runLoop(int workerIndex) {
   }
 }
 
+c10::intrusive_ptr<c10::ivalue::Future> ProcessGroupGloo::AsyncWork::
+    getFuture() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (!future_) {
+    future_ = c10::make_intrusive<c10::ivalue::Future>(
+        c10::ListType::create(c10::TensorType::get()));
+    if (futureFinalized_) {
+      auto eptr = exception_;
+      lock.unlock();
+      completeFuture(future_, eptr);
+    }
+  }
+  return future_;
+}
+
+void ProcessGroupGloo::AsyncWork::finishFuture(std::exception_ptr eptr) {
+  c10::intrusive_ptr<c10::ivalue::Future> future;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    futureFinalized_ = true;
+    future = future_;
+  }
+  if (future) {
+    completeFuture(future, eptr);
+  }
+}
+
+void ProcessGroupGloo::AsyncWork::completeFuture(
+    const c10::intrusive_ptr<c10::ivalue::Future>& future,
+    std::exception_ptr eptr) {
+  if (eptr) {
+    future->setError(eptr);
+    return;
+  }
+  std::vector<at::Tensor> outputs;
+  if (hasResult()) {
+    try {
+      outputs = result();
+    } catch (...) {
+      future->setError(std::current_exception());
+      return;
+    }
+  }
+  future->markCompleted(c10::IValue(std::move(outputs)));
+}
+
 void ProcessGroupGloo::enqueue(c10::intrusive_ptr<AsyncWork> work) {
   std::unique_lock<std::mutex> lock(workMutex_);
   workQueue_.push_back(std::move(work));
@@ -861,6 +1063,83 @@ class AsyncAllreduceWork : public ProcessGroupGloo::AsyncWork {
   }
 
 
+  bool hasResult() const override {
+    return true;
+  }
+
+  std::vector<at::Tensor> result() override {
+    TORCH_CHECK(
+        isCompleted(),
+        "Work needs to be completed before calling result(). "
+        "Should call wait() before result().");
+    return outputs_;
+  }
+
+ protected:
+  std::vector<at::Tensor> outputs_;
+};
+
+// Allreduce in three steps: reduce to the lowest rank on every host,
+// allreduce among those ranks and broadcast back on every host. Every step
+// uses the same tag, on different contexts.
+class AsyncHierarchicalAllreduceWork : public ProcessGroupGloo::AsyncWork {
+ public:
+  AsyncHierarchicalAllreduceWork(
+      const std::shared_ptr<gloo::Context>& localContext,
+      const std::shared_ptr<gloo::Context>& leaderContext,
+      std::vector<at::Tensor>& inputs,
+      ReduceOp reduceOp,
+      uint32_t tag)
+      : ProcessGroupGloo::AsyncWork("gloo:all_reduce"),
+        localContext(localContext),
+        leaderContext(leaderContext),
+        inputs(inputs),
+        reduceOp(reduceOp),
+        tag(tag) {}
+
+  // Null if this rank is alone on its host.
+  std::shared_ptr<gloo::Context> localContext;
+  // Null if this rank is not the leader of its host.
+  std::shared_ptr<gloo::Context> leaderContext;
+  std::vector<at::Tensor> inputs;
+  const ReduceOp reduceOp;
+  const uint32_t tag;
+
+  void run() override {
+    auto& tensor = inputs[0];
+    const auto& scalarType = tensor.scalar_type();
+    ReduceFunc fn;
+    GENERATE_ALL_TYPES(scalarType, getFunction, fn, reduceOp);
+
+    if (localContext) {
+      gloo::ReduceOptions opts(localContext);
+      opts.setRoot(0);
+      opts.setTag(tag);
+      opts.setReduceFunction(fn);
+      GENERATE_ALL_TYPES(scalarType, setOutput, opts, tensor);
+      gloo::reduce(opts);
+    }
+    if (leaderContext) {
+      gloo::AllreduceOptions opts(leaderContext);
+      opts.setTag(tag);
+      opts.setReduceFunction(fn);
+      GENERATE_ALL_TYPES(scalarType, setOutputs, opts, inputs);
+      gloo::allreduce(opts);
+    }
+    if (localContext) {
+      gloo::BroadcastOptions opts(localContext);
+      opts.setRoot(0);
+      opts.setTag(tag);
+      GENERATE_ALL_TYPES(scalarType, setOutput, opts, tensor);
+      gloo::broadcast(opts);
+    }
+    outputs_ = inputs;
+  }
+
+  bool hasResult() const override {
+    return true;
+  }
+
   std::vector<at::Tensor> result() override {
     TORCH_CHECK(
         isCompleted(),
@@ -870,6 +1149,11 @@ class AsyncAllreduceWork : public ProcessGroupGloo::AsyncWork {
   }
 
  protected:
+  template <typename T>
+  void getFunction(ReduceFunc& fn, const ReduceOp op) {
+    fn = toFunction<T>(op);
+  }
+
   std::vector<at::Tensor> outputs_;
 };
 
@@ -910,13 +1194,15 @@ class AsyncSparseAllreduceWork : public ProcessGroupGloo::AsyncWork {
   AsyncSparseAllreduceWork(
       const std::shared_ptr<gloo::Context>& context,
       std::vector<at::Tensor>& inputs,
-      uint32_t tag)
-      : context(context), inputs(inputs), tag(tag) {}
+      uint32_t tag,
+      bool sharded = false)
+      : context(context), inputs(inputs), tag(tag), sharded(sharded) {}
 
   std::shared_ptr<gloo::Context> context;
   std::vector<at::Tensor> inputs;
   std::vector<at::Tensor> outputs;
   const uint32_t tag;
+  const bool sharded;
 
   // We share dimensionality about the sparse tensors before collecting
   // their contents. We assume here that the maximum number of sparse
@@ -1013,6 +1299,10 @@ class AsyncSparseAllreduceWork : public ProcessGroupGloo::AsyncWork {
     // Need to coalesce before we can access indices and values.
     input = input.coalesce();
 
+    if (sharded && input.sparse_dim() > 0) {
+      return allreduceSharded(input);
+    }
+
     // Gather metadata information from all ranks.
     auto metadata = allgather_metadata(input);
 
@@ -1061,11 +1351,156 @@ class AsyncSparseAllreduceWork : public ProcessGroupGloo::AsyncWork {
     }
   }
 
+  bool hasResult() const override {
+    return true;
+  }
+
   std::vector<at::Tensor> result() override {
     return outputs;
   }
 
  private:
+  // Sharded sparse allreduce (see Options::shardedSparseAllreduce). Rank r
+  // owns the rows [r * rows / size, (r + 1) * rows / size) of the first
+  // sparse dimension. The input is coalesced, so the entries of every shard
+  // are contiguous and sorted, and the reduced shards concatenated in rank
+  // order form a coalesced tensor.
+  at::Tensor allreduceSharded(const at::Tensor& input) {
+    const auto size = context->size;
+    const auto rows = input.size(0);
+    const auto nnz = input._nnz();
+
+    // Transposed, so that the indices of every entry are contiguous.
+    auto indices = input.indices().t().contiguous();
+    auto values = input.values().contiguous();
+
+    // Count the entries owned by every rank.
+    std::vector<int64_t> sendCounts(size);
+    {
+      const auto sparseDim = indices.size(1);
+      const auto indicesPtr = indices.data_ptr<int64_t>();
+      int64_t begin = 0;
+      for (auto i = 0; i < size; i++) {
+        const auto shardEnd = (i + 1) * rows / size;
+        auto end = begin;
+        while (end < nnz && indicesPtr[end * sparseDim] < shardEnd) {
+          end++;
+        }
+        sendCounts[i] = end - begin;
+        begin = end;
+      }
+    }
+
+    // Exchange the number of entries every rank sends to every other rank.
+    std::vector<int64_t> recvCounts(size);
+    {
+      gloo::AlltoallOptions opts(context);
+      opts.setInput(sendCounts.data(), size);
+      opts.setOutput(recvCounts.data(), size);
+      opts.setTag(tag);
+      gloo::alltoall(opts);
+    }
+
+    // Send the entries to their owners and reduce the shard of this rank.
+    auto shardIndices = alltoallEntries(indices, sendCounts, recvCounts);
+    auto shardValues = alltoallEntries(values, sendCounts, recvCounts);
+    auto shard = at::sparse_coo_tensor(
+                     shardIndices.t(),
+                     shardValues,
+                     input.sizes(),
+                     input.options())
+                     .coalesce();
+
+    // Gather the number of entries of every reduced shard.
+    std::vector<int64_t> shardCounts(size, 0);
+    shardCounts[context->rank] = shard._nnz();
+    {
+      gloo::AllgatherOptions opts(context);
+      opts.setOutput(shardCounts.data(), size);
+      opts.setTag(tag);
+      gloo::allgather(opts);
+    }
+
+    auto outputIndices =
+        allgatherEntries(shard.indices().t().contiguous(), shardCounts);
+    auto outputValues =
+        allgatherEntries(shard.values().contiguous(), shardCounts);
+    auto output = at::_sparse_coo_tensor_unsafe(
+        outputIndices.t(), outputValues, input.sizes(), input.options());
+    output._coalesced_(true);
+    return output;
+  }
+
+  // Returns the number of elements of every slice of `tensor` along its
+  // first dimension.
+  static int64_t entryNumel(const at::Tensor& tensor) {
+    int64_t numel = 1;
+    for (auto dim : tensor.sizes().slice(1)) {
+      numel *= dim;
+    }
+    return numel;
+  }
+
+  // Returns an uninitialized tensor of `count` entries shaped like the
+  // entries of `tensor`.
+  static at::Tensor emptyEntries(const at::Tensor& tensor, int64_t count) {
+    std::vector<int64_t> shape = {count};
+    const auto entryShape = tensor.sizes().slice(1);
+    shape.insert(shape.end(), entryShape.begin(), entryShape.end());
+    return at::empty(shape, tensor.options());
+  }
+
+  // Sends sendCounts[i] entries (slices along the first dimension) of the
+  // contiguous `tensor` to rank i and returns the entries received from all
+  // ranks, in rank order.
+  at::Tensor alltoallEntries(
+      at::Tensor& tensor,
+      const std::vector<int64_t>& sendCounts,
+      const std::vector<int64_t>& recvCounts) {
+    const auto numel = entryNumel(tensor);
+    std::vector<int64_t> sendNumel(context->size);
+    std::vector<int64_t> recvNumel(context->size);
+    int64_t recvTotal = 0;
+    for (auto i = 0; i < context->size; i++) {
+      sendNumel[i] = sendCounts[i] * numel;
+      recvNumel[i] = recvCounts[i] * numel;
+      recvTotal += recvCounts[i];
+    }
+    auto output = emptyEntries(tensor, recvTotal);
+
+    gloo::AlltoallvOptions opts(context);
+    opts.setTag(tag);
+    GENERATE_ALL_TYPES(tensor.scalar_type(), setInput, opts, tensor, sendNumel);
+    GENERATE_ALL_TYPES(
+        tensor.scalar_type(), setOutput, opts, output, recvNumel);
+    gloo::alltoallv(opts);
+    return output;
+  }
+
+  // Gathers counts[i] entries (slices along the first dimension) from every
+  // rank i and concatenates them in rank order. `tensor` is contiguous and
+  // holds the entries of this rank.
+  at::Tensor allgatherEntries(
+      at::Tensor tensor,
+      const std::vector<int64_t>& counts) {
+    const auto numel = entryNumel(tensor);
+    std::vector<size_t> recvNumel(context->size);
+    int64_t total = 0;
+    for (auto i = 0; i < context->size; i++) {
+      recvNumel[i] = counts[i] * numel;
+      total += counts[i];
+    }
+    auto output = emptyEntries(tensor, total);
+
+    gloo::AllgathervOptions opts(context);
+    opts.setTag(tag);
+    GENERATE_ALL_TYPES(tensor.scalar_type(), setInput, opts, tensor);
+    GENERATE_ALL_TYPES(
+        tensor.scalar_type(), setOutput, opts, output, recvNumel);
+    gloo::allgatherv(opts);
+    return output;
+  }
+
   std::vector<SparseTensorMetadata> allgather_metadata(
       const at::Tensor& tensor) {
     auto buffer =
@@ -1334,12 +1769,21 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupGloo::allreduce(
   auto tag = nextTag();
   auto context = getContext(tag);
   if (device.type() == at::kCPU) {
-    if (layout == c10::kStrided) {
+    if (layout == c10::kStrided && hierarchical_ && inputs.size() == 1) {
+      auto localContext = localContexts_.empty()
+          ? nullptr
+          : localContexts_[tag % localContexts_.size()];
+      auto leaderContext = leaderContexts_.empty()
+          ? nullptr
+          : leaderContexts_[tag % leaderContexts_.size()];
+      work = c10::make_intrusive<AsyncHierarchicalAllreduceWork>(
+          localContext, leaderContext, inputs, opts.reduceOp, tag);
+    } else if (layout == c10::kStrided) {
       work = c10::make_intrusive<AsyncAllreduceWork>(
           std::move(context), inputs, opts.reduceOp, tag);
     } else if (layout == c10::kSparse) {
       work = c10::make_intrusive<AsyncSparseAllreduceWork>(
-          std::move(context), inputs, tag);
+          std::move(context), inputs, tag, shardedSparseAllreduce_);
     } else {
       invalidArgument("unsupported layout");
     }
@@ -2577,6 +3021,122 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupGloo::recvAnysource(
   return c10::make_intrusive<RecvWork>(tensor, std::move(buf));
 }
 
+std::shared_ptr<ProcessGroupGloo::P2PBuffer> ProcessGroupGloo::getP2PBuffer(
+    int peer,
+    bool send,
+    int tag,
+    size_t nbytes) {
+  std::lock_guard<std::mutex> lock(p2pBuffersMutex_);
+  auto& cached = p2pBuffers_[std::make_tuple(peer, send, tag)];
+  // Buffers are only marked as in use with the lock held, so one that is not
+  // in use stays available.
+  if (cached && !cached->inUse &&
+      static_cast<size_t>(cached->tensor.numel()) >= nbytes) {
+    cached->inUse = true;
+    return cached;
+  }
+
+  // Replaces the cached buffer. If it is still in use, its work keeps it
+  // alive until it is done.
+  auto buffer = std::make_shared<P2PBuffer>();
+  buffer->tensor = at::empty({static_cast<int64_t>(nbytes)}, at::kByte);
+  buffer->buffer = getContext(tag)->createUnboundBuffer(
+      buffer->tensor.data_ptr(), nbytes);
+  cached = buffer;
+  return buffer;
+}
+
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupGloo::batch_isend_irecv(
+    std::vector<P2POp>& ops,
+    int tag) {
+  static auto invalidArgument = [](const std::string& msg) {
+    throw std::invalid_argument(
+        "ProcessGroupGloo::batch_isend_irecv: " + msg);
+  };
+
+  auto utag = checkTag(tag);
+
+  // Group the tensors by peer and direction, keeping their order.
+  std::vector<BatchSendRecvWork::Message> messages;
+  std::map<std::pair<int, bool>, size_t> messageIndex;
+  for (auto& op : ops) {
+    if (op.peer < 0 || op.peer >= size_) {
+      invalidArgument("invalid peer rank: " + std::to_string(op.peer));
+    }
+    if (!op.tensor.device().is_cpu()) {
+      invalidArgument("only CPU tensors are supported");
+    }
+    if (op.tensor.is_sparse()) {
+      invalidArgument("only dense tensors are supported");
+    }
+    if (!op.tensor.is_contiguous()) {
+      invalidArgument("tensors have to be contiguous");
+    }
+    const bool send = op.type == P2POp::Type::SEND;
+    auto it = messageIndex.emplace(
+        std::make_pair(op.peer, send), messages.size());
+    if (it.second) {
+      messages.emplace_back();
+      messages.back().send = send;
+      messages.back().peer = op.peer;
+    }
+    messages[it.first->second].tensors.push_back(op.tensor);
+  }
+
+  auto context = getContext(tag);
+  std::vector<BatchSendRecvWork::Message> started;
+  for (auto& message : messages) {
+    size_t nbytes = 0;
+    for (const auto& tensor : message.tensors) {
+      nbytes += tensor.numel() * tensor.element_size();
+    }
+    // The peer skips the message as well.
+    if (nbytes == 0) {
+      continue;
+    }
+
+    if (message.tensors.size() == 1) {
+      message.direct = context->createUnboundBuffer(
+          message.tensors[0].data_ptr(), nbytes);
+    } else {
+      message.staging =
+          getP2PBuffer(message.peer, message.send, tag, nbytes);
+      if (message.send) {
+        const auto data =
+            static_cast<uint8_t*>(message.staging->tensor.data_ptr());
+        size_t offset = 0;
+        for (const auto& tensor : message.tensors) {
+          const size_t size = tensor.numel() * tensor.element_size();
+          if (size > 0) {
+            std::memcpy(data + offset, tensor.data_ptr(), size);
+          }
+          offset += size;
+        }
+      }
+    }
+
+    if (message.send) {
+      message.buffer()->send(message.peer, utag, 0, nbytes);
+    } else {
+      message.buffer()->recv(message.peer, utag, 0, nbytes);
+    }
+    started.push_back(std::move(message));
+  }
+
+  // The work captures the tensors to prevent them being deallocated and
+  // the unbound buffers to synchronize on completion.
+  auto work = c10::make_intrusive<BatchSendRecvWork>(std::move(started));
+  {
+    std::lock_guard<std::mutex> lock(p2pWorkMutex_);
+    if (!p2pThread_.joinable()) {
+      p2pThread_ = std::thread(&ProcessGroupGloo::runP2PLoop, this);
+    }
+    p2pWorkQueue_.push_back(work);
+  }
+  p2pWorkCV_.notify_one();
+  return work;
+}
+
 namespace {
 
 class AsyncBarrierWork : public ProcessGroupGloo::AsyncWork {
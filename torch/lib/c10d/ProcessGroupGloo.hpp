@@ -1,9 +1,12 @@
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
 #include <deque>
+#include <map>
 #include <mutex>
 #include <thread>
+#include <tuple>
 #include <unordered_map>
 #include <vector>
 
@@ -80,12 +83,35 @@ class ProcessGroupGloo : public ProcessGroup {
         eptr = std::current_exception();
       }
       work->finish(eptr);
+      work->finishFuture(eptr);
     }
 
     virtual void run() = 0;
 
+    // Returns a Future that is completed with the result() of this work, or
+    // an empty list if it has none, once the work completes. The Future is
+    // set to the error of the work if it fails.
+    c10::intrusive_ptr<c10::ivalue::Future> getFuture() override;
+
    protected:
     friend class ProcessGroupGloo;
+
+    // Whether result() is implemented, i.e. the Future of the work completes
+    // with it.
+    virtual bool hasResult() const {
+      return false;
+    }
+
+   private:
+    void finishFuture(std::exception_ptr eptr);
+    void completeFuture(
+        const c10::intrusive_ptr<c10::ivalue::Future>& future,
+        std::exception_ptr eptr);
+
+    // Only created on request, so works whose future is never used do not
+    // pay for it. Guarded by mutex_.
+    c10::intrusive_ptr<c10::ivalue::Future> future_;
+    bool futureFinalized_ = false;
   };
 
   // For send and recv operations there is no need to pass them to the
@@ -127,12 +153,73 @@ class ProcessGroupGloo : public ProcessGroup {
     int srcRank_;
   };
 
+  // Registered buffer that the tensors of a batch_isend_irecv sent to or
+  // received from a peer are coalesced into. It is kept across calls, so
+  // that the transport only registers it once, and reused by the next call
+  // with the same peer, direction and tag once the work using it is done.
+  struct P2PBuffer {
+    at::Tensor tensor;
+    std::unique_ptr<::gloo::transport::UnboundBuffer> buffer;
+    std::atomic<bool> inUse{true};
+  };
+
+  // Work of a batch_isend_irecv call, with one message per peer and
+  // direction. It is completed by the p2p completion thread of the process
+  // group, which copies the tensors received through a coalesced buffer out
+  // of it and releases the buffers, whether or not the work is waited for.
+  class BatchSendRecvWork : public ProcessGroup::Work {
+   public:
+    struct Message {
+      bool send;
+      int peer;
+      std::vector<at::Tensor> tensors;
+      // Set when the tensors are coalesced, otherwise `direct` wraps the
+      // single tensor.
+      std::shared_ptr<P2PBuffer> staging;
+      std::unique_ptr<::gloo::transport::UnboundBuffer> direct;
+
+      ::gloo::transport::UnboundBuffer* buffer() const {
+        return staging ? staging->buffer.get() : direct.get();
+      }
+    };
+
+    explicit BatchSendRecvWork(std::vector<Message> messages);
+
+    void abort() override;
+
+    // Waits for all messages and completes the work.
+    void complete();
+
+   protected:
+    std::vector<Message> messages_;
+  };
+
   struct Options {
     explicit Options();
 
     std::vector<std::shared_ptr<::gloo::transport::Device>> devices;
     std::chrono::milliseconds timeout;
     int threads;
+
+    // If set, allreduce of a single dense CPU tensor first reduces among the
+    // ranks on the same host, then allreduces among one leader rank per host
+    // and finally broadcasts the result on every host. Only the leaders send
+    // data across hosts, which cuts inter-host traffic by the number of
+    // ranks per host. Hosts are identified through the store when the process
+    // group is created.
+    bool hierarchicalAllreduce;
+
+    // Identifies the host of this rank for hierarchical allreduce. Defaults
+    // to the hostname if empty.
+    std::string hostId;
+
+    // If set, allreduce of sparse CPU tensors partitions the rows of the
+    // first sparse dimension into one contiguous shard per rank. Every rank
+    // sends the rows of its locally coalesced input to their owners with
+    // alltoall, the owners reduce their shard, and the reduced shards are
+    // allgathered. The shards are disjoint and sorted, so the result is
+    // coalesced without coalescing the inputs of all ranks on every rank.
+    bool shardedSparseAllreduce;
   };
 
   const std::string getBackendName() const override {
@@ -233,6 +320,14 @@ class ProcessGroupGloo : public ProcessGroup {
       std::vector<at::Tensor>& tensors,
       int tag) override;
 
+  // Sends all tensors for a peer as a single message, and receives all
+  // tensors from a peer as a single message, through registered buffers
+  // that are reused across calls. A peer with a single tensor is sent to or
+  // received from without a copy.
+  c10::intrusive_ptr<ProcessGroup::Work> batch_isend_irecv(
+      std::vector<P2POp>& ops,
+      int tag) override;
+
   c10::intrusive_ptr<ProcessGroup::Work> barrier(
       const BarrierOptions& opts = BarrierOptions()) override;
 
@@ -243,6 +338,46 @@ class ProcessGroupGloo : public ProcessGroup {
   // In order to use more than one device (or allow for parallelism on
   // a single device), you need multiple contexts.
   std::vector<std::shared_ptr<::gloo::Context>> contexts_;
+
+  // Contexts used by hierarchical allreduce, one per device like contexts_.
+  // localContexts_ connect the ranks on this host and are empty if this rank
+  // is alone on its host. leaderContexts_ connect the lowest rank of every
+  // host and are only created on those ranks.
+  bool hierarchical_;
+  std::vector<std::shared_ptr<::gloo::Context>> localContexts_;
+  std::vector<std::shared_ptr<::gloo::Context>> leaderContexts_;
+
+  // Groups the ranks by host and connects the contexts above.
+  void connectHierarchy(const Options& options);
+
+  // See Options::shardedSparseAllreduce.
+  bool shardedSparseAllreduce_;
+
+  // Returns a P2PBuffer of at least `nbytes` for the peer, direction and tag,
+  // reusing the cached one if it is large enough and no longer in use.
+  std::shared_ptr<P2PBuffer> getP2PBuffer(
+      int peer,
+      bool send,
+      int tag,
+      size_t nbytes);
+
+  // Buffers of batch_isend_irecv, keyed by peer, direction and tag.
+  std::map<std::tuple<int, bool, int>, std::shared_ptr<P2PBuffer>>
+      p2pBuffers_;
+  std::mutex p2pBuffersMutex_;
+
+  // Entrypoint for the p2p completion thread. It completes the work of
+  // batch_isend_irecv calls in order. It only waits for transfers that are
+  // already started, so it never holds up other operations.
+  void runP2PLoop();
+
+  // Started on the first batch_isend_irecv call.
+  std::thread p2pThread_;
+  bool p2pStop_;
+  std::deque<c10::intrusive_ptr<BatchSendRecvWork>> p2pWorkQueue_;
+  std::mutex p2pWorkMutex_;
+  std::condition_variable p2pWorkCV_;
+
   std::vector<std::thread> threads_;
   bool stop_;
 
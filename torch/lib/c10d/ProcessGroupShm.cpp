@@ -0,0 +1,769 @@
+#include <c10d/ProcessGroupShm.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#include <atomic>
+#include <climits>
+#include <random>
+
+#include <TH/THAllocator.h>
+#include <c10/util/StringUtil.h>
+
+namespace c10d {
+
+namespace {
+
+// Alignment of the buffers in the segment.
+constexpr size_t kAlignment = 64;
+// Number of times a rank polls the barrier before sleeping on the futex.
+constexpr int kSpinCount = 4096;
+// Longest a rank sleeps before checking for a timeout.
+constexpr auto kFutexTimeout = std::chrono::milliseconds(100);
+
+static_assert(
+    sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) &&
+        ATOMIC_INT_LOCK_FREE == 2,
+    "ProcessGroupShm requires lock-free 32-bit atomics");
+
+void futexWait(std::atomic<uint32_t>* word, uint32_t value) {
+#ifdef __linux__
+  // Not FUTEX_PRIVATE_FLAG, since the word is shared between processes.
+  struct timespec timeout;
+  timeout.tv_sec = 0;
+  timeout.tv_nsec =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(kFutexTimeout)
+          .count();
+  syscall(
+      SYS_futex,
+      reinterpret_cast<uint32_t*>(word),
+      FUTEX_WAIT,
+      value,
+      &timeout,
+      nullptr,
+      0);
+#else
+  std::this_thread::yield();
+#endif
+}
+
+void futexWakeAll(std::atomic<uint32_t>* word) {
+#ifdef __linux__
+  syscall(
+      SYS_futex,
+      reinterpret_cast<uint32_t*>(word),
+      FUTEX_WAKE,
+      INT_MAX,
+      nullptr,
+      nullptr,
+      0);
+#endif
+}
+
+// Returns a tensor aliasing `numel` elements of type `dtype` at `ptr`.
+at::Tensor alias(uint8_t* ptr, int64_t numel, at::ScalarType dtype) {
+  return at::from_blob(ptr, {numel}, at::TensorOptions().dtype(dtype));
+}
+
+void reduceInto(at::Tensor& acc, const at::Tensor& other, ReduceOp op) {
+  switch (op) {
+    case ReduceOp::SUM:
+      acc.add_(other);
+      break;
+    case ReduceOp::PRODUCT:
+      acc.mul_(other);
+      break;
+    case ReduceOp::MIN:
+      at::minimum_out(acc, acc, other);
+      break;
+    case ReduceOp::MAX:
+      at::maximum_out(acc, acc, other);
+      break;
+    case ReduceOp::BAND:
+      acc.bitwise_and_(other);
+      break;
+    case ReduceOp::BOR:
+      acc.bitwise_or_(other);
+      break;
+    case ReduceOp::BXOR:
+      acc.bitwise_xor_(other);
+      break;
+    default:
+      TORCH_CHECK(false, "ProcessGroupShm: unsupported reduction operation");
+  }
+}
+
+// Range of the part of `n` elements that `rank` of `size` is responsible for.
+std::pair<int64_t, int64_t> partition(int64_t n, int rank, int size) {
+  return {n * rank / size, n * (rank + 1) / size};
+}
+
+void checkContiguous(
+    std::function<void(const std::string&)> fn,
+    const at::ArrayRef<at::Tensor> tensors) {
+  for (const auto& tensor : tensors) {
+    if (!tensor.is_contiguous()) {
+      fn("only supports contiguous output tensors");
+    }
+  }
+}
+
+} // namespace
+
+struct ProcessGroupShm::Control {
+  // Number of ranks that have arrived at the current barrier.
+  alignas(kAlignment) std::atomic<uint32_t> arrived;
+  // Incremented by the last rank to arrive at a barrier. Ranks wait for it to
+  // change, on a futex.
+  alignas(kAlignment) std::atomic<uint32_t> generation;
+};
+
+ProcessGroupShm::WorkShm::WorkShm(std::vector<at::Tensor> outputs)
+    : outputs_(std::move(outputs)),
+      future_(c10::make_intrusive<c10::ivalue::Future>(
+          c10::ListType::create(c10::TensorType::get()))) {}
+
+std::vector<at::Tensor> ProcessGroupShm::WorkShm::result() {
+  TORCH_CHECK(
+      isCompleted(),
+      "Work needs to be completed before calling result(). "
+      "Should call wait() before result().");
+  return outputs_;
+}
+
+c10::intrusive_ptr<c10::ivalue::Future> ProcessGroupShm::WorkShm::
+    getFuture() {
+  return future_;
+}
+
+ProcessGroupShm::Options::Options()
+    : timeout(std::chrono::milliseconds(30 * 1000)),
+      bufferSize(4 * 1024 * 1024) {}
+
+ProcessGroupShm::ProcessGroupShm(
+    const c10::intrusive_ptr<Store>& store,
+    int rank,
+    int size,
+    Options options)
+    : ProcessGroup(rank, size), options_(options), stop_(false) {
+  TORCH_CHECK(
+      options_.bufferSize % kAlignment == 0 &&
+          options_.bufferSize >= kAlignment * size_,
+      "ProcessGroupShm: bufferSize must be a multiple of ",
+      kAlignment,
+      " bytes and at least ",
+      kAlignment,
+      " bytes per rank");
+  const size_t segmentSize = sizeof(Control) + size_ * options_.bufferSize;
+
+  std::string name;
+  int fd;
+  if (rank_ == 0) {
+    std::random_device rd;
+    name = c10::str("/torch_c10d_shm_", getpid(), "_", rd());
+    SYSCHECK(
+        fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600),
+        fd != -1);
+    store->set("shm/name", std::vector<uint8_t>(name.begin(), name.end()));
+  } else {
+    const auto value = store->get("shm/name");
+    name = std::string(value.begin(), value.end());
+    SYSCHECK(fd = shm_open(name.c_str(), O_RDWR, 0600), fd != -1);
+  }
+
+  // The map allocator sizes the segment (which zero-fills it) and closes fd.
+  segment_ = THMapAllocator::makeDataPtr(
+      WITH_FD,
+      name.c_str(),
+      fd,
+      TH_ALLOCATOR_MAPPED_SHAREDMEM | TH_ALLOCATOR_MAPPED_FROMFD,
+      segmentSize,
+      nullptr);
+  control_ = static_cast<Control*>(segment_.get());
+
+  // Once every rank has mapped the segment its name is not needed anymore.
+  // Removing it right away means the memory is released when the last
+  // process exits, however it exits.
+  store->set(c10::str("shm/mapped/", rank_), std::vector<uint8_t>{1});
+  if (rank_ == 0) {
+    std::vector<std::string> keys;
+    for (int i = 0; i < size_; i++) {
+      keys.push_back(c10::str("shm/mapped/", i));
+    }
+    store->wait(keys);
+    shm_unlink(name.c_str());
+  }
+
+  workerThread_ = std::thread(&ProcessGroupShm::runLoop, this);
+}
+
+ProcessGroupShm::~ProcessGroupShm() {
+  std::unique_lock<std::mutex> lock(pgMutex_);
+  queueConsumeCV_.wait(lock, [&] { return queue_.empty(); });
+
+  // Queue is empty, signal stop
+  stop_ = true;
+
+  // Release lock to allow threads to terminate
+  lock.unlock();
+  queueProduceCV_.notify_all();
+
+  // Join the single worker thread
+  workerThread_.join();
+}
+
+void ProcessGroupShm::runLoop() {
+  std::unique_lock<std::mutex> lock(pgMutex_);
+
+  while (!stop_) {
+    if (queue_.empty()) {
+      queueProduceCV_.wait(lock);
+      continue;
+    }
+
+    auto workTuple = std::move(queue_.front());
+
+    queue_.pop_front();
+
+    auto& fn = std::get<0>(workTuple);
+    auto& work = std::get<1>(workTuple);
+
+    lock.unlock();
+    queueConsumeCV_.notify_one();
+
+    try {
+      fn();
+      work->finish();
+      work->future_->markCompleted(c10::IValue(work->outputs_));
+    } catch (...) {
+      work->finish(std::current_exception());
+      work->future_->setError(std::current_exception());
+    }
+
+    lock.lock();
+  }
+}
+
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupShm::enqueue(
+    std::function<void()> fn,
+    std::vector<at::Tensor> outputs) {
+  auto work = c10::make_intrusive<WorkShm>(std::move(outputs));
+  std::unique_lock<std::mutex> lock(pgMutex_);
+  queue_.push_back(std::make_tuple(std::move(fn), work));
+  lock.unlock();
+  queueProduceCV_.notify_one();
+  return work;
+}
+
+void ProcessGroupShm::sync() {
+  auto& arrived = control_->arrived;
+  auto& generation = control_->generation;
+  // The generation cannot change before this rank arrives.
+  const auto current = generation.load(std::memory_order_acquire);
+  if (arrived.fetch_add(1, std::memory_order_acq_rel) + 1 ==
+      static_cast<uint32_t>(size_)) {
+    arrived.store(0, std::memory_order_relaxed);
+    generation.fetch_add(1, std::memory_order_release);
+    futexWakeAll(&generation);
+    return;
+  }
+
+  for (int i = 0; i < kSpinCount; i++) {
+    if (generation.load(std::memory_order_acquire) != current) {
+      return;
+    }
+  }
+  const auto deadline = std::chrono::steady_clock::now() + options_.timeout;
+  while (generation.load(std::memory_order_acquire) == current) {
+    TORCH_CHECK(
+        std::chrono::steady_clock::now() < deadline,
+        "ProcessGroupShm: timed out after ",
+        options_.timeout.count(),
+        " ms waiting for the other ranks");
+    futexWait(&generation, current);
+  }
+}
+
+uint8_t* ProcessGroupShm::buffer(int rank) const {
+  return static_cast<uint8_t*>(segment_.get()) + sizeof(Control) +
+      rank * options_.bufferSize;
+}
+
+void ProcessGroupShm::runAllreduce(at::Tensor& tensor, ReduceOp op, int root) {
+  const auto dtype = tensor.scalar_type();
+  const int64_t numel = tensor.numel();
+  const int64_t chunkSize = options_.bufferSize / tensor.element_size();
+  auto data = tensor.view(-1);
+  for (int64_t offset = 0; offset < numel; offset += chunkSize) {
+    const auto n = std::min(chunkSize, numel - offset);
+    auto chunk = data.narrow(0, offset, n);
+    alias(buffer(rank_), n, dtype).copy_(chunk);
+    sync();
+
+    // Every rank reduces its part of the chunk across all buffers, in place
+    // in the buffer of rank 0. The input is left untouched, so that only the
+    // root of a reduce sees its input overwritten.
+    int64_t begin, end;
+    std::tie(begin, end) = partition(n, rank_, size_);
+    if (end > begin) {
+      auto result = alias(buffer(0), n, dtype).narrow(0, begin, end - begin);
+      for (int r = 1; r < size_; r++) {
+        reduceInto(
+            result,
+            alias(buffer(r), n, dtype).narrow(0, begin, end - begin),
+            op);
+      }
+    }
+    sync();
+
+    if (root < 0 || root == rank_) {
+      chunk.copy_(alias(buffer(0), n, dtype));
+    }
+    sync();
+  }
+}
+
+void ProcessGroupShm::runBroadcast(at::Tensor& tensor, int root) {
+  const auto dtype = tensor.scalar_type();
+  const int64_t numel = tensor.numel();
+  const int64_t chunkSize = options_.bufferSize / tensor.element_size();
+  auto data = tensor.view(-1);
+  for (int64_t offset = 0; offset < numel; offset += chunkSize) {
+    const auto n = std::min(chunkSize, numel - offset);
+    auto chunk = data.narrow(0, offset, n);
+    if (rank_ == root) {
+      alias(buffer(root), n, dtype).copy_(chunk);
+    }
+    sync();
+    if (rank_ != root) {
+      chunk.copy_(alias(buffer(root), n, dtype));
+    }
+    sync();
+  }
+}
+
+void ProcessGroupShm::runAllgather(
+    std::vector<at::Tensor>& outputs,
+    const at::Tensor& input) {
+  const auto dtype = input.scalar_type();
+  const int64_t numel = input.numel();
+  const int64_t chunkSize = options_.bufferSize / input.element_size();
+  auto data = input.view(-1);
+  for (int64_t offset = 0; offset < numel; offset += chunkSize) {
+    const auto n = std::min(chunkSize, numel - offset);
+    alias(buffer(rank_), n, dtype).copy_(data.narrow(0, offset, n));
+    sync();
+    // Empty on the ranks that are not the root of a gather.
+    for (size_t r = 0; r < outputs.size(); r++) {
+      outputs[r].view(-1).narrow(0, offset, n).copy_(
+          alias(buffer(r), n, dtype));
+    }
+    sync();
+  }
+}
+
+void ProcessGroupShm::runReduceScatter(
+    at::Tensor& output,
+    const std::vector<at::Tensor>& inputs,
+    ReduceOp op) {
+  const auto dtype = output.scalar_type();
+  const int64_t numel = output.numel();
+  // The buffer of every rank holds a block for each rank.
+  const int64_t chunkSize =
+      options_.bufferSize / size_ / kAlignment * kAlignment /
+      output.element_size();
+  auto data = output.view(-1);
+  const auto blockBytes = chunkSize * output.element_size();
+  for (int64_t offset = 0; offset < numel; offset += chunkSize) {
+    const auto n = std::min(chunkSize, numel - offset);
+    for (int r = 0; r < size_; r++) {
+      alias(buffer(rank_) + r * blockBytes, n, dtype)
+          .copy_(inputs[r].view(-1).narrow(0, offset, n));
+    }
+    sync();
+    auto acc = data.narrow(0, offset, n);
+    acc.copy_(alias(buffer(0) + rank_ * blockBytes, n, dtype));
+    for (int r = 1; r < size_; r++) {
+      reduceInto(acc, alias(buffer(r) + rank_ * blockBytes, n, dtype), op);
+    }
+    sync();
+  }
+}
+
+void ProcessGroupShm::runScatter(
+    at::Tensor& output,
+    const std::vector<at::Tensor>& inputs,
+    int root) {
+  const auto dtype = output.scalar_type();
+  const int64_t numel = output.numel();
+  // The buffer of the root holds a block for each rank.
+  const int64_t chunkSize =
+      options_.bufferSize / size_ / kAlignment * kAlignment /
+      output.element_size();
+  const auto blockBytes = chunkSize * output.element_size();
+  auto data = output.view(-1);
+  for (int64_t offset = 0; offset < numel; offset += chunkSize) {
+    const auto n = std::min(chunkSize, numel - offset);
+    if (rank_ == root) {
+      for (int r = 0; r < size_; r++) {
+        alias(buffer(root) + r * blockBytes, n, dtype)
+            .copy_(inputs[r].view(-1).narrow(0, offset, n));
+      }
+    }
+    sync();
+    data.narrow(0, offset, n)
+        .copy_(alias(buffer(root) + rank_ * blockBytes, n, dtype));
+    sync();
+  }
+}
+
+void ProcessGroupShm::runAlltoall(
+    std::vector<at::Tensor>& outputs,
+    const std::vector<at::Tensor>& inputs) {
+  const auto dtype = inputs[0].scalar_type();
+  const int64_t numel = inputs[0].numel();
+  const int64_t chunkSize =
+      options_.bufferSize / size_ / kAlignment * kAlignment /
+      inputs[0].element_size();
+  const auto blockBytes = chunkSize * inputs[0].element_size();
+  for (int64_t offset = 0; offset < numel; offset += chunkSize) {
+    const auto n = std::min(chunkSize, numel - offset);
+    for (int r = 0; r < size_; r++) {
+      alias(buffer(rank_) + r * blockBytes, n, dtype)
+          .copy_(inputs[r].view(-1).narrow(0, offset, n));
+    }
+    sync();
+    for (int r = 0; r < size_; r++) {
+      outputs[r].view(-1).narrow(0, offset, n).copy_(
+          alias(buffer(r) + rank_ * blockBytes, n, dtype));
+    }
+    sync();
+  }
+}
+
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupShm::broadcast(
+    std::vector<at::Tensor>& tensors,
+    const BroadcastOptions& opts) {
+  static auto invalidArgument = [](const std::string& msg) {
+    throw std::invalid_argument("ProcessGroupShm::broadcast: " + msg);
+  };
+  assertRootRank(invalidArgument, opts.rootRank, size_);
+  assertSingleElement(invalidArgument, tensors);
+  assertDense(invalidArgument, tensors);
+  assertCPU(invalidArgument, tensors);
+
+  auto tensor = tensors[0];
+  const auto root = opts.rootRank;
+  auto fn = [this, tensor, root]() {
+    auto data = tensor.contiguous();
+    runBroadcast(data, root);
+    if (!data.is_same(tensor)) {
+      tensor.copy_(data);
+    }
+  };
+  return enqueue(std::move(fn), tensors);
+}
+
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupShm::allreduce(
+    std::vector<at::Tensor>& tensors,
+    const AllreduceOptions& opts) {
+  static auto invalidArgument = [](const std::string& msg) {
+    throw std::invalid_argument("ProcessGroupShm::allreduce: " + msg);
+  };
+  assertSingleElement(invalidArgument, tensors);
+  assertDense(invalidArgument, tensors);
+  assertCPU(invalidArgument, tensors);
+
+  auto tensor = tensors[0];
+  const auto op = opts.reduceOp;
+  auto fn = [this, tensor, op]() {
+    auto data = tensor.contiguous();
+    runAllreduce(data, op, /*root=*/-1);
+    if (!data.is_same(tensor)) {
+      tensor.copy_(data);
+    }
+  };
+  return enqueue(std::move(fn), tensors);
+}
+
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupShm::allreduce_coalesced(
+    std::vector<at::Tensor>& tensors,
+    const AllreduceCoalescedOptions& opts) {
+  throw std::runtime_error(
+      "allreduce_coalesced is currently not supported with shm");
+}
+
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupShm::reduce(
+    std::vector<at::Tensor>& tensors,
+    const ReduceOptions& opts) {
+  static auto invalidArgument = [](const std::string& msg) {
+    throw std::invalid_argument("ProcessGroupShm::reduce: " + msg);
+  };
+  assertRootRank(invalidArgument, opts.rootRank, size_);
+  assertSingleElement(invalidArgument, tensors);
+  assertDense(invalidArgument, tensors);
+  assertCPU(invalidArgument, tensors);
+
+  auto tensor = tensors[0];
+  const auto op = opts.reduceOp;
+  const auto root = opts.rootRank;
+  auto fn = [this, tensor, op, root]() {
+    auto data = tensor.contiguous();
+    runAllreduce(data, op, root);
+    // The inputs of the other ranks are left unmodified.
+    if (rank_ == root && !data.is_same(tensor)) {
+      tensor.copy_(data);
+    }
+  };
+  return enqueue(std::move(fn), tensors);
+}
+
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupShm::allgather(
+    std::vector<std::vector<at::Tensor>>& outputs,
+    std::vector<at::Tensor>& inputs,
+    const AllgatherOptions& opts) {
+  static auto invalidArgument = [](const std::string& msg) {
+    throw std::invalid_argument("ProcessGroupShm::allgather: " + msg);
+  };
+  assertSingleElementInput(invalidArgument, inputs);
+  assertDense(invalidArgument, inputs);
+  assertCPU(invalidArgument, inputs);
+  if (outputs.size() != 1 || outputs[0].size() != static_cast<size_t>(size_)) {
+    invalidArgument("requires a single output list with one tensor per rank");
+  }
+  assertTypeAndSizesMatch(
+      invalidArgument, outputs[0], inputs[0].options(), inputs[0].sizes());
+  checkContiguous(invalidArgument, outputs[0]);
+
+  auto input = inputs[0];
+  auto outputList = outputs[0];
+  auto fn = [this, input, outputList]() mutable {
+    runAllgather(outputList, input.contiguous());
+  };
+  return enqueue(std::move(fn), outputList);
+}
+
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupShm::allgather_base(
+    at::Tensor& outputBuffer,
+    at::Tensor& inputBuffer,
+    const AllgatherOptions& opts) {
+  static auto invalidArgument = [](const std::string& msg) {
+    throw std::invalid_argument("ProcessGroupShm::allgather_base: " + msg);
+  };
+  if (outputBuffer.numel() != inputBuffer.numel() * size_ ||
+      outputBuffer.scalar_type() != inputBuffer.scalar_type()) {
+    invalidArgument(
+        "output must have the type of the input and world size times its "
+        "number of elements");
+  }
+  std::vector<at::Tensor> inputs = {inputBuffer};
+  std::vector<at::Tensor> outputs = {outputBuffer};
+  assertDense(invalidArgument, inputs);
+  assertCPU(invalidArgument, inputs);
+  checkContiguous(invalidArgument, outputs);
+
+  auto input = inputBuffer;
+  auto outputList = outputBuffer.view(-1).chunk(size_);
+  auto fn = [this, input, outputList]() mutable {
+    runAllgather(outputList, input.contiguous());
+  };
+  return enqueue(std::move(fn), outputs);
+}
+
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupShm::gather(
+    std::vector<std::vector<at::Tensor>>& outputs,
+    std::vector<at::Tensor>& inputs,
+    const GatherOptions& opts) {
+  static auto invalidArgument = [](const std::string& msg) {
+    throw std::invalid_argument("ProcessGroupShm::gather: " + msg);
+  };
+  assertRootRank(invalidArgument, opts.rootRank, size_);
+  assertSingleElementInput(invalidArgument, inputs);
+  assertDense(invalidArgument, inputs);
+  assertCPU(invalidArgument, inputs);
+
+  std::vector<at::Tensor> outputList;
+  if (rank_ == opts.rootRank) {
+    if (outputs.size() != 1 ||
+        outputs[0].size() != static_cast<size_t>(size_)) {
+      invalidArgument("requires a single output list with one tensor per rank");
+    }
+    assertTypeAndSizesMatch(
+        invalidArgument, outputs[0], inputs[0].options(), inputs[0].sizes());
+    checkContiguous(invalidArgument, outputs[0]);
+    outputList = outputs[0];
+  } else if (outputs.size() != 0) {
+    invalidArgument("requires empty output on non-root");
+  }
+
+  // Same as allgather, except that only the root copies the results out.
+  auto input = inputs[0];
+  auto fn = [this, input, outputList]() mutable {
+    runAllgather(outputList, input.contiguous());
+  };
+  return enqueue(std::move(fn), outputList);
+}
+
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupShm::scatter(
+    std::vector<at::Tensor>& outputs,
+    std::vector<std::vector<at::Tensor>>& inputs,
+    const ScatterOptions& opts) {
+  static auto invalidArgument = [](const std::string& msg) {
+    throw std::invalid_argument("ProcessGroupShm::scatter: " + msg);
+  };
+  assertRootRank(invalidArgument, opts.rootRank, size_);
+  assertSingleElementOutput(invalidArgument, outputs);
+  assertDense(invalidArgument, outputs);
+  assertCPU(invalidArgument, outputs);
+
+  std::vector<at::Tensor> inputList;
+  if (rank_ == opts.rootRank) {
+    if (inputs.size() != 1 || inputs[0].size() != static_cast<size_t>(size_)) {
+      invalidArgument("requires a single input list with one tensor per rank");
+    }
+    assertTypeAndSizesMatch(
+        invalidArgument, inputs[0], outputs[0].options(), outputs[0].sizes());
+    inputList = inputs[0];
+  } else if (inputs.size() != 0) {
+    invalidArgument("requires empty input on non-root");
+  }
+
+  auto output = outputs[0];
+  auto contiguousInputs = fmap(inputList, [](const at::Tensor& t) {
+    return t.contiguous();
+  });
+  const auto root = opts.rootRank;
+  auto fn = [this, output, contiguousInputs, root]() {
+    auto data = output.contiguous();
+    runScatter(data, contiguousInputs, root);
+    if (!data.is_same(output)) {
+      output.copy_(data);
+    }
+  };
+  return enqueue(std::move(fn), outputs);
+}
+
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupShm::reduce_scatter(
+    std::vector<at::Tensor>& outputs,
+    std::vector<std::vector<at::Tensor>>& inputs,
+    const ReduceScatterOptions& opts) {
+  static auto invalidArgument = [](const std::string& msg) {
+    throw std::invalid_argument("ProcessGroupShm::reduce_scatter: " + msg);
+  };
+  assertSingleElementOutput(invalidArgument, outputs);
+  assertDense(invalidArgument, outputs);
+  assertCPU(invalidArgument, outputs);
+  if (inputs.size() != 1 || inputs[0].size() != static_cast<size_t>(size_)) {
+    invalidArgument("requires a single input list with one tensor per rank");
+  }
+  assertTypeAndSizesMatch(
+      invalidArgument, inputs[0], outputs[0].options(), outputs[0].sizes());
+
+  auto output = outputs[0];
+  auto inputList = fmap(inputs[0], [](const at::Tensor& t) {
+    return t.contiguous();
+  });
+  const auto op = opts.reduceOp;
+  auto fn = [this, output, inputList, op]() {
+    auto data = output.contiguous();
+    runReduceScatter(data, inputList, op);
+    if (!data.is_same(output)) {
+      output.copy_(data);
+    }
+  };
+  return enqueue(std::move(fn), outputs);
+}
+
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupShm::alltoall_base(
+    at::Tensor& outputTensor,
+    at::Tensor& inputTensor,
+    std::vector<int64_t>& outputSplitSizes,
+    std::vector<int64_t>& inputSplitSizes,
+    const AllToAllOptions& opts) {
+  static auto invalidArgument = [](const std::string& msg) {
+    throw std::invalid_argument("ProcessGroupShm::alltoall_base: " + msg);
+  };
+  TORCH_CHECK(
+      outputSplitSizes.empty() && inputSplitSizes.empty(),
+      "ProcessGroupShm::alltoall_base only supports equal splits");
+  checkSplitSizes(inputSplitSizes, inputTensor, size_);
+  checkSplitSizes(outputSplitSizes, outputTensor, size_);
+  std::vector<at::Tensor> outputs = {outputTensor};
+  assertDense(invalidArgument, outputs);
+  assertCPU(invalidArgument, outputs);
+  checkContiguous(invalidArgument, outputs);
+  assertTypeAndSizesMatch(
+      invalidArgument, outputs, inputTensor.options(), inputTensor.sizes());
+
+  auto outputList = outputTensor.chunk(size_);
+  auto inputList = inputTensor.contiguous().chunk(size_);
+  auto fn = [this, outputList, inputList]() mutable {
+    runAlltoall(outputList, inputList);
+  };
+  return enqueue(std::move(fn), outputs);
+}
+
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupShm::alltoall(
+    std::vector<at::Tensor>& outputTensors,
+    std::vector<at::Tensor>& inputTensors,
+    const AllToAllOptions& opts) {
+  static auto invalidArgument = [](const std::string& msg) {
+    throw std::invalid_argument("ProcessGroupShm::alltoall: " + msg);
+  };
+  if (outputTensors.size() != static_cast<size_t>(size_) ||
+      inputTensors.size() != static_cast<size_t>(size_)) {
+    invalidArgument("requires one input and one output tensor per rank");
+  }
+  assertDense(invalidArgument, inputTensors);
+  assertCPU(invalidArgument, inputTensors);
+  assertTypeAndSizesMatch(invalidArgument, inputTensors);
+  assertTypeAndSizesMatch(
+      invalidArgument,
+      outputTensors,
+      inputTensors[0].options(),
+      inputTensors[0].sizes());
+  checkContiguous(invalidArgument, outputTensors);
+
+  auto outputList = outputTensors;
+  auto inputList = fmap(inputTensors, [](const at::Tensor& t) {
+    return t.contiguous();
+  });
+  auto fn = [this, outputList, inputList]() mutable {
+    runAlltoall(outputList, inputList);
+  };
+  return enqueue(std::move(fn), outputTensors);
+}
+
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupShm::send(
+    std::vector<at::Tensor>& tensors,
+    int dstRank,
+    int tag) {
+  throw std::runtime_error("ProcessGroupShm does not support send");
+}
+
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupShm::recv(
+    std::vector<at::Tensor>& tensors,
+    int srcRank,
+    int tag) {
+  throw std::runtime_error("ProcessGroupShm does not support recv");
+}
+
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupShm::recvAnysource(
+    std::vector<at::Tensor>& tensors,
+    int tag) {
+  throw std::runtime_error("ProcessGroupShm does not support recv");
+}
+
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupShm::barrier(
+    const BarrierOptions& opts) {
+  // Collectives run in order on the worker thread, so this also waits for
+  // all prior work.
+  return enqueue([this]() { sync(); }, {});
+}
+
+} // namespace c10d
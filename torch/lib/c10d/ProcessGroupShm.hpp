@@ -0,0 +1,201 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <c10d/ProcessGroup.hpp>
+#include <c10d/Store.hpp>
+#include <c10d/Types.hpp>
+#include <c10d/Utils.hpp>
+
+namespace c10d {
+
+constexpr const char* SHM_BACKEND_NAME = "shm";
+
+// ProcessGroupShm implements collectives among processes on the same host
+// through a POSIX shared memory segment that all processes map, so tensors
+// are moved with plain memory copies instead of going through sockets.
+//
+// The segment holds a small control block and one buffer of
+// Options::bufferSize bytes per rank. It is created by rank 0, whose name is
+// exchanged through the store, and is unlinked as soon as every rank has
+// mapped it, so the memory is released when the last process exits, even if
+// it crashes. Ranks synchronize with a barrier on atomics in the segment,
+// which spins briefly and then sleeps on a futex.
+//
+// Tensors larger than the buffers are processed in chunks. Allreduce and
+// reduce_scatter split the reduction of every chunk among all ranks, which
+// reduce their part across the buffers of all ranks.
+//
+// Like ProcessGroupMPI, all collectives run in order on a single worker
+// thread, only support a single CPU tensor per call and are expected to be
+// called in the same order across processes. Point-to-point operations are
+// not supported.
+class ProcessGroupShm : public ProcessGroup {
+ public:
+  class WorkShm : public ProcessGroup::Work {
+   public:
+    explicit WorkShm(std::vector<at::Tensor> outputs);
+
+    std::vector<at::Tensor> result() override;
+
+    c10::intrusive_ptr<c10::ivalue::Future> getFuture() override;
+
+   protected:
+    friend class ProcessGroupShm;
+
+    const std::vector<at::Tensor> outputs_;
+    c10::intrusive_ptr<c10::ivalue::Future> future_;
+  };
+
+  struct Options {
+    explicit Options();
+
+    std::chrono::milliseconds timeout;
+
+    // Size of the buffer of every rank in the shared memory segment.
+    size_t bufferSize;
+  };
+
+  explicit ProcessGroupShm(
+      const c10::intrusive_ptr<Store>& store,
+      int rank,
+      int size,
+      Options options = Options());
+
+  virtual ~ProcessGroupShm();
+
+  const std::string getBackendName() const override {
+    return std::string(SHM_BACKEND_NAME);
+  }
+
+  c10::intrusive_ptr<ProcessGroup::Work> broadcast(
+      std::vector<at::Tensor>& tensors,
+      const BroadcastOptions& opts = BroadcastOptions()) override;
+
+  c10::intrusive_ptr<ProcessGroup::Work> allreduce(
+      std::vector<at::Tensor>& tensors,
+      const AllreduceOptions& opts = AllreduceOptions()) override;
+
+  c10::intrusive_ptr<ProcessGroup::Work> allreduce_coalesced(
+      std::vector<at::Tensor>& tensors,
+      const AllreduceCoalescedOptions& opts =
+          AllreduceCoalescedOptions()) override;
+
+  c10::intrusive_ptr<ProcessGroup::Work> reduce(
+      std::vector<at::Tensor>& tensors,
+      const ReduceOptions& opts = ReduceOptions()) override;
+
+  c10::intrusive_ptr<ProcessGroup::Work> allgather(
+      std::vector<std::vector<at::Tensor>>& outputs,
+      std::vector<at::Tensor>& inputs,
+      const AllgatherOptions& opts = AllgatherOptions()) override;
+
+  c10::intrusive_ptr<ProcessGroup::Work> allgather_base(
+      at::Tensor& outputBuffer,
+      at::Tensor& inputBuffer,
+      const AllgatherOptions& opts = AllgatherOptions()) override;
+
+  c10::intrusive_ptr<ProcessGroup::Work> gather(
+      std::vector<std::vector<at::Tensor>>& outputs,
+      std::vector<at::Tensor>& inputs,
+      const GatherOptions& opts = GatherOptions()) override;
+
+  c10::intrusive_ptr<ProcessGroup::Work> scatter(
+      std::vector<at::Tensor>& outputs,
+      std::vector<std::vector<at::Tensor>>& inputs,
+      const ScatterOptions& opts = ScatterOptions()) override;
+
+  c10::intrusive_ptr<ProcessGroup::Work> reduce_scatter(
+      std::vector<at::Tensor>& outputs,
+      std::vector<std::vector<at::Tensor>>& inputs,
+      const ReduceScatterOptions& opts = ReduceScatterOptions()) override;
+
+  c10::intrusive_ptr<ProcessGroup::Work> alltoall_base(
+      at::Tensor& outputTensor,
+      at::Tensor& inputTensor,
+      std::vector<int64_t>& outputSplitSizes,
+      std::vector<int64_t>& inputSplitSizes,
+      const AllToAllOptions& opts = AllToAllOptions()) override;
+
+  c10::intrusive_ptr<ProcessGroup::Work> alltoall(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<at::Tensor>& inputTensors,
+      const AllToAllOptions& opts = AllToAllOptions()) override;
+
+  c10::intrusive_ptr<ProcessGroup::Work> send(
+      std::vector<at::Tensor>& tensors,
+      int dstRank,
+      int tag) override;
+
+  c10::intrusive_ptr<ProcessGroup::Work> recv(
+      std::vector<at::Tensor>& tensors,
+      int srcRank,
+      int tag) override;
+
+  c10::intrusive_ptr<ProcessGroup::Work> recvAnysource(
+      std::vector<at::Tensor>& tensors,
+      int tag) override;
+
+  c10::intrusive_ptr<ProcessGroup::Work> barrier(
+      const BarrierOptions& opts = BarrierOptions()) override;
+
+ protected:
+  // Layout of the start of the shared memory segment.
+  struct Control;
+
+  using WorkType =
+      std::tuple<std::function<void()>, c10::intrusive_ptr<WorkShm>>;
+
+  // Worker thread loop
+  void runLoop();
+
+  // Queues `fn` to run on the worker thread. The returned work holds
+  // `outputs` as its result.
+  c10::intrusive_ptr<ProcessGroup::Work> enqueue(
+      std::function<void()> fn,
+      std::vector<at::Tensor> outputs);
+
+  // Blocks until all ranks have called it. Only called on the worker thread.
+  void sync();
+
+  // Start of the buffer of `rank` in the segment.
+  uint8_t* buffer(int rank) const;
+
+  // Bodies of the collectives, run on the worker thread. The tensors are
+  // contiguous.
+  void runAllreduce(at::Tensor& tensor, ReduceOp op, int root);
+  void runBroadcast(at::Tensor& tensor, int root);
+  void runAllgather(std::vector<at::Tensor>& outputs, const at::Tensor& input);
+  void runScatter(
+      at::Tensor& output,
+      const std::vector<at::Tensor>& inputs,
+      int root);
+  void runReduceScatter(
+      at::Tensor& output,
+      const std::vector<at::Tensor>& inputs,
+      ReduceOp op);
+  void runAlltoall(
+      std::vector<at::Tensor>& outputs,
+      const std::vector<at::Tensor>& inputs);
+
+  const Options options_;
+  at::DataPtr segment_;
+  Control* control_;
+
+  bool stop_;
+  std::mutex pgMutex_;
+  std::thread workerThread_;
+  std::deque<WorkType> queue_;
+  std::condition_variable queueProduceCV_;
+  std::condition_variable queueConsumeCV_;
+};
+
+} // namespace c10d
@@ -0,0 +1,161 @@
+#include <c10d/ShardedOptimizer.hpp>
+
+#include <algorithm>
+
+#include <ATen/core/grad_mode.h>
+
+namespace c10d {
+
+ShardedOptimizer::ShardedOptimizer(
+    std::vector<at::Tensor> parameters,
+    c10::intrusive_ptr<ProcessGroup> processGroup,
+    OptimizerFactory optimizerFactory,
+    int64_t bucketBytes)
+    : torch::optim::Optimizer(
+          std::vector<torch::optim::OptimizerParamGroup>(),
+          nullptr),
+      parameters_(std::move(parameters)),
+      processGroup_(std::move(processGroup)) {
+  TORCH_CHECK(!parameters_.empty(), "ShardedOptimizer requires parameters");
+  TORCH_CHECK(bucketBytes > 0, "bucketBytes must be positive");
+  const auto options = parameters_[0].options();
+  for (const auto& parameter : parameters_) {
+    TORCH_CHECK(
+        parameter.dtype() == options.dtype() &&
+            parameter.device() == options.device(),
+        "ShardedOptimizer requires all parameters to have the same dtype and "
+        "device");
+  }
+
+  // Assign every parameter to the rank owning the fewest bytes so far.
+  const auto rank = processGroup_->getRank();
+  const auto size = processGroup_->getSize();
+  std::vector<int64_t> load(size, 0);
+  owners_.reserve(parameters_.size());
+  for (const auto& parameter : parameters_) {
+    const auto owner = std::min_element(load.begin(), load.end());
+    *owner += parameter.numel();
+    owners_.push_back(owner - load.begin());
+  }
+
+  const int64_t bucketNumel =
+      std::max<int64_t>(bucketBytes / parameters_[0].element_size(), 1);
+  buckets_.resize(size);
+  for (size_t i = 0; i < parameters_.size(); i++) {
+    auto& buckets = buckets_[owners_[i]];
+    const auto numel = parameters_[i].numel();
+    if (buckets.empty() || buckets.back().numel + numel > bucketNumel) {
+      buckets.emplace_back();
+    }
+    buckets.back().indices.push_back(i);
+    buckets.back().numel += numel;
+  }
+
+  std::vector<at::Tensor> localParameters;
+  for (size_t i = 0; i < parameters_.size(); i++) {
+    if (owners_[i] == rank) {
+      localParameters.push_back(parameters_[i]);
+    }
+  }
+  localOptimizer_ = optimizerFactory(std::move(localParameters));
+  TORCH_CHECK(localOptimizer_, "The optimizer factory returned no optimizer");
+  TORCH_CHECK(
+      localOptimizer_->param_groups().size() == 1,
+      "ShardedOptimizer requires the optimizer factory to build an optimizer "
+      "with a single parameter group");
+
+  defaults_ = localOptimizer_->defaults().clone();
+  add_param_group(torch::optim::OptimizerParamGroup(
+      parameters_, localOptimizer_->param_groups()[0].options().clone()));
+}
+
+at::Tensor ShardedOptimizer::step(LossClosure closure) {
+  // The options of our param group are the ones to step with, e.g. after the
+  // learning rate was changed through param_groups().
+  localOptimizer_->param_groups()[0].set_options(
+      param_groups_[0].options().clone());
+  auto loss = localOptimizer_->step(std::move(closure));
+  syncParameters();
+  return loss;
+}
+
+void ShardedOptimizer::save(torch::serialize::OutputArchive& archive) const {
+  localOptimizer_->save(archive);
+}
+
+void ShardedOptimizer::load(torch::serialize::InputArchive& archive) {
+  localOptimizer_->load(archive);
+  param_groups_[0].set_options(
+      localOptimizer_->param_groups()[0].options().clone());
+}
+
+int ShardedOptimizer::ownerRank(size_t index) const {
+  TORCH_CHECK(index < owners_.size(), "Invalid parameter index: ", index);
+  return owners_[index];
+}
+
+torch::optim::Optimizer& ShardedOptimizer::localOptimizer() {
+  return *localOptimizer_;
+}
+
+void ShardedOptimizer::syncParameters() {
+  at::NoGradGuard noGrad;
+  const auto rank = processGroup_->getRank();
+  const auto size = processGroup_->getSize();
+  const auto options = parameters_[0].options();
+
+  size_t numRounds = 0;
+  for (const auto& buckets : buckets_) {
+    numRounds = std::max(numRounds, buckets.size());
+  }
+
+  // Launch the allgathers of all buckets before waiting for any of them. The
+  // buckets of a round are padded to the size of the largest of them.
+  std::vector<std::vector<std::vector<at::Tensor>>> outputs(numRounds);
+  std::vector<c10::intrusive_ptr<ProcessGroup::Work>> work(numRounds);
+  for (size_t round = 0; round < numRounds; round++) {
+    int64_t numel = 0;
+    for (const auto& buckets : buckets_) {
+      if (round < buckets.size()) {
+        numel = std::max(numel, buckets[round].numel);
+      }
+    }
+
+    std::vector<at::Tensor> inputs = {at::empty({numel}, options)};
+    if (round < buckets_[rank].size()) {
+      int64_t offset = 0;
+      for (const auto index : buckets_[rank][round].indices) {
+        const auto& parameter = parameters_[index];
+        inputs[0]
+            .narrow(0, offset, parameter.numel())
+            .copy_(parameter.reshape({-1}));
+        offset += parameter.numel();
+      }
+    }
+
+    outputs[round].resize(1);
+    for (auto r = 0; r < size; r++) {
+      outputs[round][0].push_back(at::empty({numel}, options));
+    }
+    work[round] = processGroup_->allgather(outputs[round], inputs);
+  }
+
+  for (size_t round = 0; round < numRounds; round++) {
+    work[round]->wait();
+    for (auto r = 0; r < size; r++) {
+      if (r == rank || round >= buckets_[r].size()) {
+        continue;
+      }
+      const auto& flat = outputs[round][0][r];
+      int64_t offset = 0;
+      for (const auto index : buckets_[r][round].indices) {
+        auto& parameter = parameters_[index];
+        parameter.copy_(
+            flat.narrow(0, offset, parameter.numel()).view(parameter.sizes()));
+        offset += parameter.numel();
+      }
+    }
+  }
+}
+
+} // namespace c10d
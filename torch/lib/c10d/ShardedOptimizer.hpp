@@ -0,0 +1,85 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <c10d/ProcessGroup.hpp>
+#include <torch/optim/optimizer.h>
+
+namespace c10d {
+
+// ShardedOptimizer partitions the state of an optimizer across the ranks of a
+// process group, in the spirit of stage 1 of ZeRO. Every parameter is owned by
+// a single rank, picked so that all ranks own about as many bytes. Each rank
+// wraps an optimizer built by the given factory for its own parameters only,
+// so the optimizer state (e.g. the moments of Adam) held by every rank scales
+// as 1 / world_size.
+//
+// All ranks are expected to hold the same parameters, in the same order, and
+// to have computed the same gradients (e.g. through DistributedDataParallel).
+// step() steps the parameters owned by this rank, and then allgathers the
+// updated parameters of all ranks. The parameters of every rank are packed
+// into buckets of up to bucketBytes bytes, which are allgathered concurrently.
+// All parameters must have the same dtype and device.
+//
+// Optimizers that evaluate the closure more than once in a step, like LBFGS,
+// can't be sharded, as the parameters of other ranks are only updated at the
+// end of the step. save() and load() save and load the state of this rank
+// only.
+//
+// The factory must build an optimizer with a single param group. Its options
+// are those of the single param group of the ShardedOptimizer, which holds
+// all parameters: changing them through param_groups(), e.g. to decay the
+// learning rate, applies to the next step. They are copied to the local
+// optimizer on every step, so changes made through localOptimizer() are
+// overwritten.
+class ShardedOptimizer : public torch::optim::Optimizer {
+ public:
+  using OptimizerFactory = std::function<std::unique_ptr<
+      torch::optim::Optimizer>(std::vector<at::Tensor> parameters)>;
+
+  static constexpr int64_t kDefaultBucketBytes = 25 * 1024 * 1024;
+
+  explicit ShardedOptimizer(
+      std::vector<at::Tensor> parameters,
+      c10::intrusive_ptr<ProcessGroup> processGroup,
+      OptimizerFactory optimizerFactory,
+      int64_t bucketBytes = kDefaultBucketBytes);
+
+  at::Tensor step(LossClosure closure = nullptr) override;
+
+  void save(torch::serialize::OutputArchive& archive) const override;
+
+  void load(torch::serialize::InputArchive& archive) override;
+
+  // Returns the rank owning the parameter at the given index.
+  int ownerRank(size_t index) const;
+
+  // Returns the optimizer of the parameters owned by this rank.
+  torch::optim::Optimizer& localOptimizer();
+
+ protected:
+  // Consecutive parameters owned by a rank, which are allgathered together.
+  struct Bucket {
+    std::vector<size_t> indices;
+    int64_t numel = 0;
+  };
+
+  // Allgathers the parameters of all ranks.
+  void syncParameters();
+
+  const std::vector<at::Tensor> parameters_;
+  const c10::intrusive_ptr<ProcessGroup> processGroup_;
+
+  // Owner rank of every parameter.
+  std::vector<int> owners_;
+
+  // Buckets of the parameters owned by every rank. The i-th buckets of all
+  // ranks are allgathered together.
+  std::vector<std::vector<Bucket>> buckets_;
+
+  std::unique_ptr<torch::optim::Optimizer> localOptimizer_;
+};
+
+} // namespace c10d
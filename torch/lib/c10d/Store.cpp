@@ -1,5 +1,7 @@
 #include <c10d/Store.hpp>
 
+#include <thread>
+
 namespace c10d {
 
 constexpr std::chrono::milliseconds Store::kDefaultTimeout;
@@ -13,4 +15,42 @@ void Store::setTimeout(const std::chrono::milliseconds& timeout) {
   timeout_ = timeout;
 }
 
+void Store::multiSet(
+    const std::vector<std::string>& keys,
+    const std::vector<std::vector<uint8_t>>& values) {
+  if (keys.size() != values.size()) {
+    throw std::invalid_argument(
+        "multiSet expects the same number of keys and values");
+  }
+  for (size_t i = 0; i < keys.size(); i++) {
+    set(keys[i], values[i]);
+  }
+}
+
+std::vector<std::vector<uint8_t>> Store::multiGet(
+    const std::vector<std::string>& keys) {
+  std::vector<std::vector<uint8_t>> values;
+  values.reserve(keys.size());
+  for (const auto& key : keys) {
+    values.push_back(get(key));
+  }
+  return values;
+}
+
+void Store::waitCounter(
+    const std::string& key,
+    int64_t target,
+    const std::chrono::milliseconds& timeout) {
+  const auto start = std::chrono::steady_clock::now();
+  while (add(key, 0) < target) {
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+    if (timeout != kNoTimeout && elapsed > timeout) {
+      throw std::runtime_error("Timeout waiting for counter: " + key);
+    }
+    /* sleep override */
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+}
+
 } // namespace c10d
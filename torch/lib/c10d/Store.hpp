@@ -44,6 +44,27 @@ class Store : public torch::CustomClassHolder {
       const std::vector<std::string>& keys,
       const std::chrono::milliseconds& timeout) = 0;
 
+  // Sets several keys at once. The default implementation calls `set` for
+  // every key; stores that can batch the keys into a single request
+  // override it.
+  virtual void multiSet(
+      const std::vector<std::string>& keys,
+      const std::vector<std::vector<uint8_t>>& values);
+
+  // Gets several keys at once, waiting for all of them like `get`. The
+  // default implementation calls `get` for every key.
+  virtual std::vector<std::vector<uint8_t>> multiGet(
+      const std::vector<std::string>& keys);
+
+  // Blocks until the counter `key`, as maintained by `add`, is at least
+  // `target`, and throws if this does not happen within `timeout`. The
+  // default implementation polls the counter; stores that can notify waiters
+  // when the counter changes override it.
+  virtual void waitCounter(
+      const std::string& key,
+      int64_t target,
+      const std::chrono::milliseconds& timeout);
+
   void setTimeout(const std::chrono::milliseconds& timeout);
 
  protected:
@@ -8,6 +8,10 @@
 #include <unistd.h>
 #endif
 
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+
 #include <algorithm>
 #include <fcntl.h>
 #include <system_error>
@@ -16,20 +20,58 @@ namespace c10d {
 
 namespace {
 
-enum class QueryType : uint8_t { SET, GET, ADD, CHECK, WAIT, GETNUMKEYS, DELETE_KEY };
+enum class QueryType : uint8_t {
+  SET,
+  GET,
+  ADD,
+  CHECK,
+  WAIT,
+  GETNUMKEYS,
+  DELETE_KEY,
+  MULTI_SET,
+  MULTI_GET,
+  WAIT_COUNTER
+};
 
 enum class CheckResponseType : uint8_t { READY, NOT_READY };
 
 enum class WaitResponseType : uint8_t { STOP_WAITING };
 
+// Maximum number of threads serving clients by default.
+constexpr size_t kDefaultWorkerThreads = 8;
+
 } // anonymous namespace
 
 // TCPStoreDaemon class methods
 // Simply start the daemon thread
-TCPStoreDaemon::TCPStoreDaemon(int storeListenSocket)
+TCPStoreDaemon::TCPStoreDaemon(int storeListenSocket, size_t numThreads)
     : storeListenSocket_(storeListenSocket) {
   // Use control pipe to signal instance destruction to the daemon thread.
   initStopSignal();
+#ifdef __linux__
+  if (numThreads == 0) {
+    numThreads = std::min<size_t>(
+        kDefaultWorkerThreads,
+        std::max<size_t>(1, std::thread::hardware_concurrency()));
+  }
+  for (size_t i = 0; i < numThreads; i++) {
+    int epollFd;
+    SYSCHECK_ERR_RETURN_NEG1(epollFd = ::epoll_create1(EPOLL_CLOEXEC));
+    epollFds_.push_back(epollFd);
+    // Every worker watches the read end of the control pipe, which hangs up
+    // when the daemon is stopped.
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.ptr = nullptr;
+    SYSCHECK_ERR_RETURN_NEG1(
+        ::epoll_ctl(epollFd, EPOLL_CTL_ADD, controlPipeFd_[0], &event));
+  }
+  for (auto epollFd : epollFds_) {
+    workerThreads_.emplace_back(&TCPStoreDaemon::runWorker, this, epollFd);
+  }
+#else
+  (void)numThreads;
+#endif
   daemonThread_ = std::thread(&TCPStoreDaemon::run, this);
 }
 
@@ -39,17 +81,73 @@ TCPStoreDaemon::~TCPStoreDaemon() {
   // Join the thread
   join();
   // Close unclosed sockets
-  for (auto socket : sockets_) {
-    if (socket != -1) {
-      tcputil::closeSocket(socket);
+  for (auto& it : connections_) {
+    if (it.second->waiter) {
+      it.second->waiter->cancel();
     }
+    tcputil::closeSocket(it.first);
   }
+  connections_.clear();
+#ifdef __linux__
+  for (auto epollFd : epollFds_) {
+    ::close(epollFd);
+  }
+#endif
   // Now close the rest control pipe
   closeStopSignal();
 }
 
 void TCPStoreDaemon::join() {
   daemonThread_.join();
+#ifdef __linux__
+  for (auto& thread : workerThreads_) {
+    thread.join();
+  }
+#endif
+}
+
+void TCPStoreDaemon::Waiter::satisfy() {
+  if (remaining.fetch_sub(1) != 1) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  if (cancelled) {
+    return;
+  }
+  try {
+    tcputil::sendValue<WaitResponseType>(
+        socket, WaitResponseType::STOP_WAITING);
+  } catch (...) {
+    // The thread serving the connection will see the error as well and close
+    // it. This thread may be serving a different client.
+  }
+}
+
+void TCPStoreDaemon::Waiter::cancel() {
+  std::lock_guard<std::mutex> lock(mutex);
+  cancelled = true;
+}
+
+TCPStoreDaemon::Connection* TCPStoreDaemon::addConnection(int socket) {
+  std::lock_guard<std::mutex> lock(connectionsMutex_);
+  auto& connection = connections_[socket];
+  connection.reset(new Connection(socket));
+  return connection.get();
+}
+
+void TCPStoreDaemon::closeConnection(int socket) {
+  std::lock_guard<std::mutex> lock(connectionsMutex_);
+  auto it = connections_.find(socket);
+  if (it == connections_.end()) {
+    return;
+  }
+  // Once cancelled, a waiter that is satisfied later does not write to the
+  // socket, whose descriptor may be reused by then.
+  if (it->second->waiter) {
+    it->second->waiter->cancel();
+  }
+  tcputil::closeSocket(socket);
+  connections_.erase(it);
 }
 
 void TCPStoreDaemon::queryFds(std::vector<struct pollfd>& fds) {
@@ -63,7 +161,12 @@ void TCPStoreDaemon::queryFds(std::vector<struct pollfd>& fds) {
 
     // Now query the socket that has the event
     try {
-      query(fds[fdIdx].fd);
+      Connection* connection;
+      {
+        std::lock_guard<std::mutex> lock(connectionsMutex_);
+        connection = connections_.at(fds[fdIdx].fd).get();
+      }
+      query(*connection);
     } catch (...) {
       // There was an error when processing query. Probably an exception
       // occurred in recv/send what would indicate that socket on the other
@@ -72,30 +175,7 @@ void TCPStoreDaemon::queryFds(std::vector<struct pollfd>& fds) {
       // exception, other connections will get an exception once they try to
       // use the store. We will go ahead and close this connection whenever
       // we hit an exception here.
-      tcputil::closeSocket(fds[fdIdx].fd);
-
-      // Remove all the tracking state of the close FD
-      for (auto it = waitingSockets_.begin(); it != waitingSockets_.end();) {
-        for (auto vecIt = it->second.begin(); vecIt != it->second.end();) {
-          if (*vecIt == fds[fdIdx].fd) {
-            vecIt = it->second.erase(vecIt);
-          } else {
-            ++vecIt;
-          }
-        }
-        if (it->second.size() == 0) {
-          it = waitingSockets_.erase(it);
-        } else {
-          ++it;
-        }
-      }
-      for (auto it = keysAwaited_.begin(); it != keysAwaited_.end();) {
-        if (it->first == fds[fdIdx].fd) {
-          it = keysAwaited_.erase(it);
-        } else {
-          ++it;
-        }
-      }
+      closeConnection(fds[fdIdx].fd);
       fds.erase(fds.begin() + fdIdx);
       sockets_.erase(sockets_.begin() + fdIdx - CONNECT_SOCKET_OFFSET);
       --fdIdx;
@@ -107,12 +187,21 @@ void TCPStoreDaemon::queryFds(std::vector<struct pollfd>& fds) {
 // query communicates with the worker. The format
 // of the query is as follows:
 // type of query | size of arg1 | arg1 | size of arg2 | arg2 | ...
-// or, in the case of wait
+// or, in the case of wait, multi get and multi set
 // type of query | number of args | size of arg1 | arg1 | ...
-void TCPStoreDaemon::query(int socket) {
+void TCPStoreDaemon::query(Connection& connection) {
+  const auto socket = connection.socket;
   QueryType qt;
   tcputil::recvBytes<QueryType>(socket, &qt, 1);
 
+  // A client only sends a new query once its previous one was answered.
+  // If a wait timed out on the client side instead, make sure it does not
+  // get a late notification in place of the answer to this query.
+  if (connection.waiter) {
+    connection.waiter->cancel();
+    connection.waiter.reset();
+  }
+
   if (qt == QueryType::SET) {
     setHandler(socket);
 
@@ -126,7 +215,7 @@ void TCPStoreDaemon::query(int socket) {
     checkHandler(socket);
 
   } else if (qt == QueryType::WAIT) {
-    waitHandler(socket);
+    waitHandler(connection);
 
   } else if (qt == QueryType::GETNUMKEYS) {
     getNumKeysHandler(socket);
@@ -134,65 +223,172 @@ void TCPStoreDaemon::query(int socket) {
   } else if (qt == QueryType::DELETE_KEY) {
     deleteHandler(socket);
 
+  } else if (qt == QueryType::MULTI_SET) {
+    multiSetHandler(socket);
+
+  } else if (qt == QueryType::MULTI_GET) {
+    multiGetHandler(socket);
+
+  } else if (qt == QueryType::WAIT_COUNTER) {
+    waitCounterHandler(connection);
+
   } else {
     throw std::runtime_error("Unexpected query type");
   }
 }
 
-void TCPStoreDaemon::wakeupWaitingClients(const std::string& key) {
-  auto socketsToWait = waitingSockets_.find(key);
-  if (socketsToWait != waitingSockets_.end()) {
-    for (int socket : socketsToWait->second) {
-      if (--keysAwaited_[socket] == 0) {
-        tcputil::sendValue<WaitResponseType>(
-            socket, WaitResponseType::STOP_WAITING);
+TCPStoreDaemon::Shard& TCPStoreDaemon::shardFor(const std::string& key) {
+  return shards_[std::hash<std::string>()(key) % kNumShards];
+}
+
+void TCPStoreDaemon::setLocked(
+    Shard& shard,
+    const std::string& key,
+    std::vector<uint8_t> value,
+    std::vector<std::shared_ptr<Waiter>>& satisfied) {
+  auto& stored = shard.data[key];
+  stored = std::move(value);
+
+  // On "set" and "add", wake up all clients that have been waiting
+  auto waiters = shard.waiters.find(key);
+  if (waiters != shard.waiters.end()) {
+    satisfied.insert(
+        satisfied.end(), waiters->second.begin(), waiters->second.end());
+    shard.waiters.erase(waiters);
+  }
+
+  auto counterWaiters = shard.counterWaiters.find(key);
+  if (counterWaiters != shard.counterWaiters.end()) {
+    int64_t counter;
+    try {
+      counter = std::stoll(std::string(stored.begin(), stored.end()));
+    } catch (const std::exception&) {
+      // Not a counter (yet).
+      return;
+    }
+    auto& pending = counterWaiters->second;
+    for (auto it = pending.begin(); it != pending.end();) {
+      if (counter >= it->first) {
+        satisfied.push_back(std::move(it->second));
+        it = pending.erase(it);
+      } else {
+        ++it;
       }
     }
-    waitingSockets_.erase(socketsToWait);
+    if (pending.empty()) {
+      shard.counterWaiters.erase(counterWaiters);
+    }
   }
 }
 
 void TCPStoreDaemon::setHandler(int socket) {
   std::string key = tcputil::recvString(socket);
-  tcpStore_[key] = tcputil::recvVector<uint8_t>(socket);
-  // On "set", wake up all clients that have been waiting
-  wakeupWaitingClients(key);
+  auto value = tcputil::recvVector<uint8_t>(socket);
+  std::vector<std::shared_ptr<Waiter>> satisfied;
+  {
+    auto& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    setLocked(shard, key, std::move(value), satisfied);
+  }
+  for (auto& waiter : satisfied) {
+    waiter->satisfy();
+  }
+}
+
+void TCPStoreDaemon::multiSetHandler(int socket) {
+  SizeType nargs;
+  tcputil::recvBytes<SizeType>(socket, &nargs, 1);
+  std::vector<std::shared_ptr<Waiter>> satisfied;
+  for (size_t i = 0; i < nargs; i++) {
+    std::string key = tcputil::recvString(socket);
+    auto value = tcputil::recvVector<uint8_t>(socket);
+    auto& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    setLocked(shard, key, std::move(value), satisfied);
+  }
+  for (auto& waiter : satisfied) {
+    waiter->satisfy();
+  }
 }
 
 void TCPStoreDaemon::addHandler(int socket) {
   std::string key = tcputil::recvString(socket);
   int64_t addVal = tcputil::recvValue<int64_t>(socket);
 
-  if (tcpStore_.find(key) != tcpStore_.end()) {
-    auto buf = reinterpret_cast<const char*>(tcpStore_[key].data());
-    auto len = tcpStore_[key].size();
-    addVal += std::stoll(std::string(buf, len));
+  std::vector<std::shared_ptr<Waiter>> satisfied;
+  {
+    auto& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.data.find(key);
+    if (it != shard.data.end()) {
+      auto buf = reinterpret_cast<const char*>(it->second.data());
+      auto len = it->second.size();
+      addVal += std::stoll(std::string(buf, len));
+    }
+    auto addValStr = std::to_string(addVal);
+    setLocked(
+        shard,
+        key,
+        std::vector<uint8_t>(addValStr.begin(), addValStr.end()),
+        satisfied);
   }
-  auto addValStr = std::to_string(addVal);
-  tcpStore_[key] = std::vector<uint8_t>(addValStr.begin(), addValStr.end());
   // Now send the new value
   tcputil::sendValue<int64_t>(socket, addVal);
-  // On "add", wake up all clients that have been waiting
-  wakeupWaitingClients(key);
+  for (auto& waiter : satisfied) {
+    waiter->satisfy();
+  }
 }
 
-void TCPStoreDaemon::getHandler(int socket) const {
+void TCPStoreDaemon::getHandler(int socket) {
   std::string key = tcputil::recvString(socket);
-  auto data = tcpStore_.at(key);
+  std::vector<uint8_t> data;
+  {
+    auto& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    data = shard.data.at(key);
+  }
   tcputil::sendVector<uint8_t>(socket, data);
 }
 
-void TCPStoreDaemon::getNumKeysHandler(int socket) const {
-  tcputil::sendValue<int64_t>(socket, tcpStore_.size());
+void TCPStoreDaemon::multiGetHandler(int socket) {
+  SizeType nargs;
+  tcputil::recvBytes<SizeType>(socket, &nargs, 1);
+  std::vector<std::string> keys(nargs);
+  for (size_t i = 0; i < nargs; i++) {
+    keys[i] = tcputil::recvString(socket);
+  }
+  std::vector<std::vector<uint8_t>> values(nargs);
+  for (size_t i = 0; i < nargs; i++) {
+    auto& shard = shardFor(keys[i]);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    values[i] = shard.data.at(keys[i]);
+  }
+  for (size_t i = 0; i < nargs; i++) {
+    tcputil::sendVector<uint8_t>(socket, values[i], (i != (nargs - 1)));
+  }
+}
+
+void TCPStoreDaemon::getNumKeysHandler(int socket) {
+  int64_t numKeys = 0;
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    numKeys += shard.data.size();
+  }
+  tcputil::sendValue<int64_t>(socket, numKeys);
 }
 
 void TCPStoreDaemon::deleteHandler(int socket) {
   std::string key = tcputil::recvString(socket);
-  auto numDeleted = tcpStore_.erase(key);
+  int64_t numDeleted;
+  {
+    auto& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    numDeleted = shard.data.erase(key);
+  }
   tcputil::sendValue<int64_t>(socket, numDeleted);
 }
 
-void TCPStoreDaemon::checkHandler(int socket) const {
+void TCPStoreDaemon::checkHandler(int socket) {
   SizeType nargs;
   tcputil::recvBytes<SizeType>(socket, &nargs, 1);
   std::vector<std::string> keys(nargs);
@@ -207,27 +403,60 @@ void TCPStoreDaemon::checkHandler(int socket) const {
   }
 }
 
-void TCPStoreDaemon::waitHandler(int socket) {
+void TCPStoreDaemon::waitHandler(Connection& connection) {
+  const auto socket = connection.socket;
   SizeType nargs;
   tcputil::recvBytes<SizeType>(socket, &nargs, 1);
   std::vector<std::string> keys(nargs);
   for (size_t i = 0; i < nargs; i++) {
     keys[i] = tcputil::recvString(socket);
   }
-  if (checkKeys(keys)) {
-    tcputil::sendValue<WaitResponseType>(
-        socket, WaitResponseType::STOP_WAITING);
-  } else {
-    for (auto& key : keys) {
-      waitingSockets_[key].push_back(socket);
+  // The extra count keeps the waiter from being notified before it has been
+  // registered for all keys.
+  auto waiter = std::make_shared<Waiter>(socket, keys.size() + 1);
+  connection.waiter = waiter;
+  for (auto& key : keys) {
+    auto& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.data.count(key) > 0) {
+      waiter->remaining--;
+    } else {
+      shard.waiters[key].push_back(waiter);
+    }
+  }
+  waiter->satisfy();
+}
+
+void TCPStoreDaemon::waitCounterHandler(Connection& connection) {
+  const auto socket = connection.socket;
+  std::string key = tcputil::recvString(socket);
+  int64_t target = tcputil::recvValue<int64_t>(socket);
+  auto waiter = std::make_shared<Waiter>(socket, 1);
+  connection.waiter = waiter;
+  bool ready = false;
+  {
+    auto& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.data.find(key);
+    if (it != shard.data.end()) {
+      auto buf = reinterpret_cast<const char*>(it->second.data());
+      auto len = it->second.size();
+      ready = std::stoll(std::string(buf, len)) >= target;
     }
-    keysAwaited_[socket] = keys.size();
+    if (!ready) {
+      shard.counterWaiters[key].emplace_back(target, waiter);
+    }
+  }
+  if (ready) {
+    waiter->satisfy();
   }
 }
 
-bool TCPStoreDaemon::checkKeys(const std::vector<std::string>& keys) const {
+bool TCPStoreDaemon::checkKeys(const std::vector<std::string>& keys) {
   return std::all_of(keys.begin(), keys.end(), [this](const std::string& s) {
-    return tcpStore_.count(s) > 0;
+    auto& shard = shardFor(s);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.data.count(s) > 0;
   });
 }
 
@@ -284,6 +513,7 @@ void TCPStoreDaemon::run() {
       }
       int sockFd = std::get<0>(tcputil::accept(storeListenSocket_));
       sockets_.push_back(sockFd);
+      addConnection(sockFd);
       tcputil::addPollfd(fds, sockFd, POLLIN);
     }
     queryFds(fds);
@@ -314,6 +544,79 @@ void TCPStoreDaemon::stop() {
   }
 }
 
+#ifdef __linux__
+// On Linux, this thread only accepts connections and hands them out round
+// robin to the worker threads, which serve them with epoll.
+void TCPStoreDaemon::run() {
+  std::vector<struct pollfd> fds;
+  tcputil::addPollfd(fds, storeListenSocket_, POLLIN);
+  // Push the read end of the pipe to signal the stopping of the daemon run
+  tcputil::addPollfd(fds, controlPipeFd_[0], POLLHUP);
+
+  while (true) {
+    fds[0].revents = 0;
+    fds[1].revents = 0;
+
+    SYSCHECK_ERR_RETURN_NEG1(::poll(fds.data(), fds.size(), -1));
+
+    // The pipe receives an event which tells us to shutdown the daemon
+    if (fds[1].revents != 0) {
+      // Will be POLLUP when the pipe is closed
+      if (fds[1].revents ^ POLLHUP) {
+        throw std::system_error(
+            ECONNABORTED,
+            std::system_category(),
+            "Unexpected poll revent on the control pipe's reading fd: " +
+                std::to_string(fds[1].revents));
+      }
+      break;
+    }
+
+    // TCPStore's listening socket has an event and it should now be able to
+    // accept new connections.
+    if (fds[0].revents != 0) {
+      if (fds[0].revents ^ POLLIN) {
+        throw std::system_error(
+            ECONNABORTED,
+            std::system_category(),
+            "Unexpected poll revent on the master's listening socket: " +
+                std::to_string(fds[0].revents));
+      }
+      int sockFd = std::get<0>(tcputil::accept(storeListenSocket_));
+      struct epoll_event event = {};
+      event.events = EPOLLIN;
+      event.data.ptr = addConnection(sockFd);
+      int epollFd = epollFds_[nextWorker_++ % epollFds_.size()];
+      SYSCHECK_ERR_RETURN_NEG1(
+          ::epoll_ctl(epollFd, EPOLL_CTL_ADD, sockFd, &event));
+    }
+  }
+}
+
+void TCPStoreDaemon::runWorker(int epollFd) {
+  std::array<struct epoll_event, 64> events;
+  while (true) {
+    int numEvents;
+    SYSCHECK_ERR_RETURN_NEG1(
+        numEvents =
+            ::epoll_wait(epollFd, events.data(), events.size(), -1));
+    for (int i = 0; i < numEvents; i++) {
+      // The control pipe was closed
+      if (events[i].data.ptr == nullptr) {
+        return;
+      }
+      auto connection = static_cast<Connection*>(events[i].data.ptr);
+      try {
+        query(*connection);
+      } catch (...) {
+        // See queryFds.
+        ::epoll_ctl(epollFd, EPOLL_CTL_DEL, connection->socket, nullptr);
+        closeConnection(connection->socket);
+      }
+    }
+  }
+}
+#else
 void TCPStoreDaemon::run() {
   std::vector<struct pollfd> fds;
   tcputil::addPollfd(fds, storeListenSocket_, POLLIN);
@@ -341,6 +644,7 @@ void TCPStoreDaemon::run() {
       }
       int sockFd = std::get<0>(tcputil::accept(storeListenSocket_));
       sockets_.push_back(sockFd);
+      addConnection(sockFd);
       tcputil::addPollfd(fds, sockFd, POLLIN);
     }
 
@@ -361,6 +665,7 @@ void TCPStoreDaemon::run() {
   }
 }
 #endif
+#endif
 
 // TCPStore class methods
 TCPStore::TCPStore(
@@ -505,9 +810,67 @@ void TCPStore::wait(
   waitHelper_(regKeys, timeout);
 }
 
-void TCPStore::waitHelper_(
+void TCPStore::multiSet(
     const std::vector<std::string>& keys,
+    const std::vector<std::vector<uint8_t>>& values) {
+  if (keys.size() != values.size()) {
+    throw std::invalid_argument(
+        "multiSet expects the same number of keys and values");
+  }
+  if (keys.empty()) {
+    return;
+  }
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::MULTI_SET);
+  SizeType nkeys = keys.size();
+  tcputil::sendBytes<SizeType>(storeSocket_, &nkeys, 1, true);
+  for (size_t i = 0; i < nkeys; i++) {
+    std::string regKey = regularPrefix_ + keys[i];
+    tcputil::sendString(storeSocket_, regKey, true);
+    tcputil::sendVector<uint8_t>(storeSocket_, values[i], (i != (nkeys - 1)));
+  }
+}
+
+std::vector<std::vector<uint8_t>> TCPStore::multiGet(
+    const std::vector<std::string>& keys) {
+  if (keys.empty()) {
+    return {};
+  }
+  std::vector<std::string> regKeys;
+  regKeys.resize(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    regKeys[i] = regularPrefix_ + keys[i];
+  }
+  waitHelper_(regKeys, timeout_);
+
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::MULTI_GET);
+  SizeType nkeys = regKeys.size();
+  tcputil::sendBytes<SizeType>(storeSocket_, &nkeys, 1, true);
+  for (size_t i = 0; i < nkeys; i++) {
+    tcputil::sendString(storeSocket_, regKeys[i], (i != (nkeys - 1)));
+  }
+  std::vector<std::vector<uint8_t>> values(nkeys);
+  for (size_t i = 0; i < nkeys; i++) {
+    values[i] = tcputil::recvVector<uint8_t>(storeSocket_);
+  }
+  return values;
+}
+
+void TCPStore::waitCounter(
+    const std::string& key,
+    int64_t target,
     const std::chrono::milliseconds& timeout) {
+  std::string regKey = regularPrefix_ + key;
+  setReceiveTimeout_(timeout);
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::WAIT_COUNTER);
+  tcputil::sendString(storeSocket_, regKey, true);
+  tcputil::sendValue<int64_t>(storeSocket_, target);
+  auto waitResponse = tcputil::recvValue<WaitResponseType>(storeSocket_);
+  if (waitResponse != WaitResponseType::STOP_WAITING) {
+    throw std::runtime_error("Stop_waiting response is expected");
+  }
+}
+
+void TCPStore::setReceiveTimeout_(const std::chrono::milliseconds& timeout) {
   // Set the socket timeout if there is a wait timeout
   if (timeout != kNoTimeout) {
 #ifdef _WIN32
@@ -524,6 +887,12 @@ void TCPStore::waitHelper_(
         reinterpret_cast<char*>(&timeoutTV),
         sizeof(timeoutTV)));
   }
+}
+
+void TCPStore::waitHelper_(
+    const std::vector<std::string>& keys,
+    const std::chrono::milliseconds& timeout) {
+  setReceiveTimeout_(timeout);
   tcputil::sendValue<QueryType>(storeSocket_, QueryType::WAIT);
   SizeType nkeys = keys.size();
   tcputil::sendBytes<SizeType>(storeSocket_, &nkeys, 1, (nkeys > 0));
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <unordered_map>
 
@@ -14,40 +17,108 @@
 
 namespace c10d {
 
+// The daemon serving a TCPStore. Keys are spread over kNumShards shards,
+// each with its own lock, so that queries on different keys do not contend.
+//
+// On Linux, the daemon thread only accepts connections and hands them out
+// round robin to a pool of worker threads, each of which runs an epoll loop
+// over its connections. Elsewhere, the daemon thread polls all connections
+// and serves all queries.
+//
+// Waiting clients are not polled: a client waiting for keys, or for a counter
+// to reach a value, is registered as a waiter on the keys and notified by
+// the query that sets the last of them.
 class TCPStoreDaemon {
  public:
-  explicit TCPStoreDaemon(int storeListenSocket);
+  explicit TCPStoreDaemon(int storeListenSocket, size_t numThreads = 0);
   ~TCPStoreDaemon();
 
   void join();
 
  protected:
+  static constexpr size_t kNumShards = 64;
+
+  // A client blocked in a wait or waitCounter query. It is notified once
+  // `remaining` drops to zero.
+  struct Waiter {
+    explicit Waiter(int socket, size_t remaining)
+        : socket(socket), remaining(remaining) {}
+
+    // Decrements `remaining` and notifies the client if it drops to zero.
+    void satisfy();
+
+    // Prevents further notifications, before the socket is closed.
+    void cancel();
+
+    const int socket;
+    std::atomic<size_t> remaining;
+    std::mutex mutex;
+    bool cancelled = false;
+  };
+
+  struct Shard {
+    std::mutex mutex;
+    std::unordered_map<std::string, std::vector<uint8_t>> data;
+    // From key -> waiters for the key to be set
+    std::unordered_map<std::string, std::vector<std::shared_ptr<Waiter>>>
+        waiters;
+    // From key -> waiters for the counter to reach the given value
+    std::unordered_map<
+        std::string,
+        std::vector<std::pair<int64_t, std::shared_ptr<Waiter>>>>
+        counterWaiters;
+  };
+
+  // State of a client connection. Only accessed by the thread serving it.
+  struct Connection {
+    explicit Connection(int socket) : socket(socket) {}
+
+    const int socket;
+    // The waiter of the last wait query, if any.
+    std::shared_ptr<Waiter> waiter;
+  };
+
   void run();
   void stop();
 
   void queryFds(std::vector<struct pollfd>& fds);
-  void query(int socket);
+  void query(Connection& connection);
 
   void setHandler(int socket);
+  void multiSetHandler(int socket);
   void addHandler(int socket);
-  void getHandler(int socket) const;
-  void checkHandler(int socket) const;
-  void getNumKeysHandler(int socket) const;
+  void getHandler(int socket);
+  void multiGetHandler(int socket);
+  void checkHandler(int socket);
+  void getNumKeysHandler(int socket);
   void deleteHandler(int socket);
-  void waitHandler(int socket);
+  void waitHandler(Connection& connection);
+  void waitCounterHandler(Connection& connection);
+
+  Shard& shardFor(const std::string& key);
+  bool checkKeys(const std::vector<std::string>& keys);
+
+  // Stores the value and collects the waiters it satisfies. Must be called
+  // with the lock of the shard of `key` held.
+  void setLocked(
+      Shard& shard,
+      const std::string& key,
+      std::vector<uint8_t> value,
+      std::vector<std::shared_ptr<Waiter>>& satisfied);
 
-  bool checkKeys(const std::vector<std::string>& keys) const;
-  void wakeupWaitingClients(const std::string& key);
+  // Registers a new connection, and cancels the waiter and closes the socket
+  // of a connection.
+  Connection* addConnection(int socket);
+  void closeConnection(int socket);
 
   void initStopSignal();
   void closeStopSignal();
 
   std::thread daemonThread_;
-  std::unordered_map<std::string, std::vector<uint8_t>> tcpStore_;
-  // From key -> the list of sockets waiting on it
-  std::unordered_map<std::string, std::vector<int>> waitingSockets_;
-  // From socket -> number of keys awaited
-  std::unordered_map<int, size_t> keysAwaited_;
+  std::array<Shard, kNumShards> shards_;
+
+  std::mutex connectionsMutex_;
+  std::unordered_map<int, std::unique_ptr<Connection>> connections_;
 
   std::vector<int> sockets_;
   int storeListenSocket_;
@@ -58,6 +129,14 @@ class TCPStoreDaemon {
 #else
   std::vector<int> controlPipeFd_{-1, -1};
 #endif
+#ifdef __linux__
+  // Worker threads and their epoll instances.
+  void runWorker(int epollFd);
+
+  std::vector<std::thread> workerThreads_;
+  std::vector<int> epollFds_;
+  size_t nextWorker_ = 0;
+#endif
 };
 
 class TCPStore : public Store {
@@ -90,6 +169,18 @@ class TCPStore : public Store {
       const std::vector<std::string>& keys,
       const std::chrono::milliseconds& timeout) override;
 
+  void multiSet(
+      const std::vector<std::string>& keys,
+      const std::vector<std::vector<uint8_t>>& values) override;
+
+  std::vector<std::vector<uint8_t>> multiGet(
+      const std::vector<std::string>& keys) override;
+
+  void waitCounter(
+      const std::string& key,
+      int64_t target,
+      const std::chrono::milliseconds& timeout) override;
+
   // Waits for all workers to join.
   void waitForWorkers();
 
@@ -102,6 +193,7 @@ class TCPStore : public Store {
   void waitHelper_(
       const std::vector<std::string>& keys,
       const std::chrono::milliseconds& timeout);
+  void setReceiveTimeout_(const std::chrono::milliseconds& timeout);
 
   bool isServer_;
   int storeSocket_ = -1;
@@ -1,11 +1,143 @@
 #include <c10d/default_comm_hooks.hpp>
 
+#include <ATen/CPUGeneratorImpl.h>
 #include <c10d/comm.hpp>
 #include <c10d/ProcessGroup.hpp>
 #include <torch/torch.h>
 
+#include <cmath>
+
 namespace c10d {
 
+namespace {
+
+// Runs `callback` once `future` completes and returns a future of `type`,
+// or of the type of `future` if null, that is completed with the value of the
+// future returned by `callback`. Unlike Future::then(), this lets a hook wait
+// for several collectives without blocking a worker thread of the process
+// group. A collective issued from `callback` is issued from whichever thread
+// completes `future`, see issueInOrder().
+c10::intrusive_ptr<c10::ivalue::Future> thenAsync(
+    const c10::intrusive_ptr<c10::ivalue::Future>& future,
+    std::function<c10::intrusive_ptr<c10::ivalue::Future>()> callback,
+    c10::TypePtr type = nullptr) {
+  auto result = c10::make_intrusive<c10::ivalue::Future>(
+      type ? std::move(type) : future->elementType());
+  future->addCallback([future, result, callback = std::move(callback)]() {
+    if (future->hasError()) {
+      result->setError(future->exception_ptr());
+      return;
+    }
+    c10::intrusive_ptr<c10::ivalue::Future> next;
+    try {
+      next = callback();
+    } catch (const std::exception&) {
+      result->setError(std::current_exception());
+      return;
+    }
+    next->addCallback([next, result]() {
+      if (next->hasError()) {
+        result->setError(next->exception_ptr());
+      } else {
+        result->markCompleted(next->constValue());
+      }
+    });
+  });
+  return result;
+}
+
+// Every rank must issue its collectives in the same order, or they are matched
+// up with the wrong peers. A hook that issues a collective from the
+// continuation of another one, on whichever thread completes it, calls
+// `issue` through this function: it runs once the collectives of the previous
+// call were all issued, and must complete the future it is passed once its own
+// collectives are. `lastIssued` is the future of the previous call.
+c10::intrusive_ptr<c10::ivalue::Future> issueInOrder(
+    c10::intrusive_ptr<c10::ivalue::Future>& lastIssued,
+    std::function<c10::intrusive_ptr<c10::ivalue::Future>(
+        const c10::intrusive_ptr<c10::ivalue::Future>&)> issue) {
+  auto previous = std::move(lastIssued);
+  auto issued = c10::make_intrusive<c10::ivalue::Future>(c10::NoneType::get());
+  lastIssued = issued;
+  auto run = [issue = std::move(issue), issued]() {
+    try {
+      return issue(issued);
+    } catch (...) {
+      // Don't hold back the collectives of the next calls.
+      if (!issued->completed()) {
+        issued->markCompleted(c10::IValue());
+      }
+      throw;
+    }
+  };
+  if (!previous || previous->completed()) {
+    return run();
+  }
+  return thenAsync(
+      previous,
+      std::move(run),
+      c10::ListType::create(c10::TensorType::get()));
+}
+
+// Allgathers `input` into `outputs`, one tensor per rank.
+c10::intrusive_ptr<c10::ivalue::Future> allgatherInto(
+    ProcessGroup* processGroup,
+    const at::Tensor& input,
+    std::vector<at::Tensor>& outputs) {
+  outputs.clear();
+  for (int i = 0; i < processGroup->getSize(); ++i) {
+    outputs.push_back(at::empty_like(input));
+  }
+  std::vector<std::vector<at::Tensor>> outputLists = {outputs};
+  std::vector<at::Tensor> inputs = {input};
+  return processGroup->allgather(outputLists, inputs)->getFuture();
+}
+
+// Averages the tensor of a bucket with a plain allreduce. Used for sparse
+// buckets, which the compression hooks do not apply to.
+c10::intrusive_ptr<c10::ivalue::Future> allreduceAndAverage(
+    ProcessGroup* processGroup,
+    const at::Tensor& tensor) {
+  std::vector<at::Tensor> tensors = {tensor};
+  auto fut = processGroup->allreduce(tensors)->getFuture();
+  const auto worldSize = processGroup->getSize();
+  return fut->then(
+      [fut, tensor, worldSize]() {
+        fut->value();
+        return c10::IValue(tensor.div_(worldSize));
+      },
+      fut->elementType());
+}
+
+// Returns the local error of `bucket` for error feedback, zero-initialized
+// if the bucket is new or was rebuilt with a different size.
+at::Tensor& errorFor(
+    std::unordered_map<size_t, at::Tensor>& errors,
+    const GradBucket& bucket) {
+  const auto& tensor = bucket.getTensors()[0];
+  auto& error = errors[bucket.getIndex()];
+  if (!error.defined() || error.numel() != tensor.numel()) {
+    error = at::zeros_like(tensor);
+  }
+  return error;
+}
+
+// Applies the Gram-Schmidt procedure to the columns of `matrix` in place.
+void orthogonalize(at::Tensor& matrix, double epsilon = 1e-8) {
+  const auto numCols = matrix.size(1);
+  for (int64_t i = 0; i < numCols; ++i) {
+    auto col = matrix.narrow(1, i, 1);
+    // The epsilon avoids dividing by zero for vanishing gradients.
+    col.div_(col.norm() + epsilon);
+    if (i + 1 < numCols) {
+      auto rest = matrix.narrow(1, i + 1, numCols - i - 1);
+      rest.sub_((col * rest).sum(0) * col);
+    }
+  }
+}
+
+} // namespace
+
 c10::intrusive_ptr<c10::ivalue::Future> AllReduceCommHook::runHook(
     GradBucket& bucket) {
   auto allreduce_work = state_->allreduce(bucket.getTensorsRef());
@@ -38,4 +170,328 @@ c10::intrusive_ptr<c10::ivalue::Future> FP16CompressCommHook::runHook(
       decompress_and_div_by_process_group_size, fut->elementType());
 }
 
+c10::intrusive_ptr<c10::ivalue::Future> Int8RowwiseQuantizeCommHook::runHook(
+    GradBucket& bucket) {
+  auto tensor = bucket.getTensorsRef()[0];
+  if (tensor.is_sparse()) {
+    return allreduceAndAverage(state_, bucket.getTensorsRef()[0]);
+  }
+  const int64_t numel = tensor.numel();
+  const int64_t rowSize = options_.rowSize;
+  const int64_t rows = (numel + rowSize - 1) / rowSize;
+  const auto worldSize = state_->getSize();
+
+  if (options_.useErrorFeedback) {
+    tensor.add_(errorFor(errors_, bucket));
+  }
+  auto matrix = at::zeros({rows, rowSize}, tensor.options().dtype(at::kFloat));
+  matrix.view({-1}).narrow(0, 0, numel).copy_(tensor);
+
+  // Quantize each row to [0, 255] between its min and max.
+  auto lo = std::get<0>(matrix.min(/*dim=*/1, /*keepdim=*/true));
+  auto hi = std::get<0>(matrix.max(/*dim=*/1, /*keepdim=*/true));
+  auto scale = (hi - lo).div_(255).clamp_min_(1e-12);
+  auto quantized =
+      (matrix - lo).div_(scale).round_().clamp_(0, 255).to(at::kByte);
+  auto params = at::cat({lo, scale}, /*dim=*/1);
+
+  if (options_.useErrorFeedback) {
+    auto dequantized = quantized.to(at::kFloat).mul_(scale).add_(lo);
+    errors_[bucket.getIndex()].copy_(
+        (matrix - dequantized).view({-1}).narrow(0, 0, numel));
+  }
+
+  auto allParams = std::make_shared<std::vector<at::Tensor>>();
+  auto allQuantized = std::make_shared<std::vector<at::Tensor>>();
+  auto paramsFut = allgatherInto(state_, params, *allParams);
+  auto quantizedFut = allgatherInto(state_, quantized, *allQuantized);
+
+  auto gathered = thenAsync(paramsFut, [paramsFut, quantizedFut]() {
+    paramsFut->value();
+    return quantizedFut;
+  });
+  auto dequantizeAndAverage = [gathered,
+                               allParams,
+                               allQuantized,
+                               tensor,
+                               numel,
+                               worldSize]() mutable {
+    gathered->value();
+    auto sum = at::zeros_like((*allQuantized)[0], at::kFloat);
+    for (size_t r = 0; r < allQuantized->size(); ++r) {
+      const auto& p = (*allParams)[r];
+      sum.add_((*allQuantized)[r]
+                   .to(at::kFloat)
+                   .mul_(p.narrow(1, 1, 1))
+                   .add_(p.narrow(1, 0, 1)));
+    }
+    tensor.copy_(sum.view({-1}).narrow(0, 0, numel).div_(worldSize));
+    return c10::IValue(tensor);
+  };
+  return gathered->then(dequantizeAndAverage, gathered->elementType());
+}
+
+c10::intrusive_ptr<c10::ivalue::Future> TopKSparsifyCommHook::runHook(
+    GradBucket& bucket) {
+  auto tensor = bucket.getTensorsRef()[0];
+  if (tensor.is_sparse()) {
+    return allreduceAndAverage(state_, bucket.getTensorsRef()[0]);
+  }
+  const int64_t numel = tensor.numel();
+  const int64_t k = std::min<int64_t>(
+      numel,
+      std::max<int64_t>(1, std::ceil(options_.ratio * numel)));
+  const auto worldSize = state_->getSize();
+  TORCH_CHECK(
+      numel <= std::numeric_limits<int32_t>::max(),
+      "TopKSparsifyCommHook does not support buckets of more than 2^31 elements");
+
+  auto flat = tensor.view({-1});
+  if (options_.useErrorFeedback) {
+    flat.add_(errorFor(errors_, bucket).view({-1}));
+  }
+  auto indices = std::get<1>(flat.abs().topk(k, /*dim=*/0, /*largest=*/true,
+                                             /*sorted=*/false));
+  auto values = flat.index_select(0, indices);
+  if (options_.useErrorFeedback) {
+    // Whatever is not sent now is sent in a later iteration.
+    auto error = errors_[bucket.getIndex()].view({-1});
+    error.copy_(flat);
+    error.index_fill_(0, indices, 0);
+  }
+
+  auto allValues = std::make_shared<std::vector<at::Tensor>>();
+  auto allIndices = std::make_shared<std::vector<at::Tensor>>();
+  auto valuesFut = allgatherInto(state_, values, *allValues);
+  auto indicesFut = allgatherInto(state_, indices.to(at::kInt), *allIndices);
+
+  auto gathered = thenAsync(valuesFut, [valuesFut, indicesFut]() {
+    valuesFut->value();
+    return indicesFut;
+  });
+  auto scatterAndAverage =
+      [gathered, allValues, allIndices, tensor, worldSize]() mutable {
+        gathered->value();
+        auto flat = tensor.view({-1});
+        flat.zero_();
+        for (size_t r = 0; r < allValues->size(); ++r) {
+          flat.index_add_(
+              0, (*allIndices)[r].to(at::kLong), (*allValues)[r]);
+        }
+        flat.div_(worldSize);
+        return c10::IValue(tensor);
+      };
+  return gathered->then(scatterAndAverage, gathered->elementType());
+}
+
+PowerSGDCommHook::PowerSGDCommHook(
+    ProcessGroup* state,
+    PowerSGDOptions options)
+    : CppCommHookInterface<ProcessGroup*>(state),
+      options_(options),
+      rng_(options.randomSeed) {
+  TORCH_CHECK(
+      options_.startPowerSGDIter >= 1,
+      "PowerSGD requires startPowerSGDIter >= 1, since buckets may be "
+      "rebuilt after the first iteration.");
+  LOG(INFO) << "PowerSGD config: matrixApproximationRank = "
+            << options_.matrixApproximationRank
+            << "; startPowerSGDIter = " << options_.startPowerSGDIter
+            << "; useErrorFeedback = " << options_.useErrorFeedback
+            << "; warmStart = " << options_.warmStart << ".";
+}
+
+c10::intrusive_ptr<c10::ivalue::Future> PowerSGDCommHook::runHook(
+    GradBucket& bucket) {
+  auto input = bucket.getTensorsRef()[0];
+  const auto bucketIndex = bucket.getIndex();
+  const auto worldSize = state_->getSize();
+  // Bucket 0 is the last bucket to be reduced in an iteration.
+  const bool compress = iter_ >= options_.startPowerSGDIter;
+  if (bucketIndex == 0) {
+    ++iter_;
+    if (iter_ == options_.startPowerSGDIter) {
+      LOG(INFO) << "Starting to apply PowerSGD after " << iter_
+                << " iterations.";
+    }
+  }
+  if (!compress || input.is_sparse()) {
+    // Still ordered after the Q allreduces of the previous buckets.
+    auto* processGroup = state_;
+    return issueInOrder(
+        lastIssued_,
+        [processGroup, input](
+            const c10::intrusive_ptr<c10::ivalue::Future>& issued) {
+          auto fut = allreduceAndAverage(processGroup, input);
+          issued->markCompleted(c10::IValue());
+          return fut;
+        });
+  }
+
+  auto& bucketState = bucketStates_[bucketIndex];
+  at::Tensor inputCopy;
+  if (options_.useErrorFeedback) {
+    if (bucketState.error.defined() &&
+        bucketState.error.numel() == input.numel()) {
+      input.add_(bucketState.error);
+    } else {
+      bucketState.error = at::zeros_like(input);
+    }
+    // Used to compute the local error once the input has been replaced by
+    // its approximation.
+    inputCopy = input.clone();
+  }
+
+  // Unflatten the input into per-parameter tensors for layer-wise
+  // compression.
+  std::vector<at::Tensor> rank1Tensors;
+  std::vector<at::Tensor> highRankTensors;
+  const auto& offsets = bucket.getOffsets();
+  const auto& lengths = bucket.getLengths();
+  const auto& sizes = bucket.getSizesVec();
+  for (size_t i = 0; i < offsets.size(); ++i) {
+    auto tensor = input.narrow(0, offsets[i], lengths[i]).view(sizes[i]);
+    if (tensor.dim() <= 1) {
+      rank1Tensors.push_back(tensor.view({-1}));
+    } else {
+      highRankTensors.push_back(tensor.view({tensor.size(0), -1}));
+    }
+  }
+  auto rank1Memory = rank1Tensors.empty() ? at::empty({0}, input.options())
+                                          : at::cat(rank1Tensors);
+
+  int64_t totalPsSize = 0;
+  int64_t totalQsSize = 0;
+  for (const auto& tensor : highRankTensors) {
+    const auto rank = std::min(
+        {tensor.size(0), tensor.size(1), options_.matrixApproximationRank});
+    totalPsSize += tensor.size(0) * rank;
+    totalQsSize += tensor.size(1) * rank;
+  }
+  bool needRandomizeQs = false;
+  if (!options_.warmStart || !bucketState.pMemory.defined() ||
+      bucketState.pMemory.numel() != totalPsSize ||
+      bucketState.qMemory.numel() != totalQsSize) {
+    needRandomizeQs = true;
+    bucketState.pMemory = at::empty({totalPsSize}, input.options());
+    bucketState.qMemory = at::empty({totalQsSize}, input.options());
+  }
+
+  std::vector<at::Tensor> ps;
+  std::vector<at::Tensor> qs;
+  int64_t pIdx = 0;
+  int64_t qIdx = 0;
+  for (const auto& tensor : highRankTensors) {
+    const auto n = tensor.size(0);
+    const auto m = tensor.size(1);
+    const auto rank = std::min({n, m, options_.matrixApproximationRank});
+    ps.push_back(bucketState.pMemory.narrow(0, pIdx, n * rank).view({n, rank}));
+    qs.push_back(bucketState.qMemory.narrow(0, qIdx, m * rank).view({m, rank}));
+    pIdx += n * rank;
+    qIdx += m * rank;
+  }
+
+  if (needRandomizeQs) {
+    // The same seed on all workers gives the same initial projection, and a
+    // new seed every time gives a different projection at each step.
+    auto generator = at::detail::createCPUGenerator(rng_());
+    for (auto& q : qs) {
+      q.copy_(at::randn(
+          q.sizes(), generator, input.options().device(at::kCPU)));
+    }
+  }
+  for (auto& q : qs) {
+    orthogonalize(q);
+  }
+  for (size_t i = 0; i < highRankTensors.size(); ++i) {
+    at::mm_out(ps[i], highRankTensors[i], qs[i]);
+  }
+
+  // Qs depend on the reduced Ps, so their allreduce is issued from the
+  // continuation of the P allreduce, in order with the collectives of the
+  // other buckets.
+  auto* processGroup = state_;
+  auto pMemory = bucketState.pMemory;
+  auto qMemory = bucketState.qMemory;
+  auto issue = [processGroup,
+                rank1Memory,
+                rank1Tensors,
+                pMemory,
+                qMemory,
+                ps,
+                qs,
+                highRankTensors,
+                worldSize](
+                   const c10::intrusive_ptr<c10::ivalue::Future>& issued) {
+    std::vector<at::Tensor> rank1Inputs = {rank1Memory};
+    auto rank1Fut = processGroup->allreduce(rank1Inputs)->getFuture();
+    // Ps are orthogonalized afterwards, so they need not be averaged.
+    std::vector<at::Tensor> pInputs = {pMemory};
+    auto psFut = processGroup->allreduce(pInputs)->getFuture();
+    psFut->addCallback([psFut, issued]() {
+      // The Q allreduce is never issued if the P allreduce failed.
+      if (psFut->hasError()) {
+        issued->markCompleted(c10::IValue());
+      }
+    });
+    auto qsFut = thenAsync(
+        psFut,
+        [processGroup, psFut, issued, qMemory, ps, qs, highRankTensors]()
+            mutable {
+          try {
+            psFut->value();
+            for (auto& p : ps) {
+              orthogonalize(p);
+            }
+            for (size_t i = 0; i < highRankTensors.size(); ++i) {
+              at::mm_out(qs[i], highRankTensors[i].t(), ps[i]);
+            }
+            std::vector<at::Tensor> qInputs = {qMemory};
+            auto fut = processGroup->allreduce(qInputs)->getFuture();
+            issued->markCompleted(c10::IValue());
+            return fut;
+          } catch (...) {
+            if (!issued->completed()) {
+              issued->markCompleted(c10::IValue());
+            }
+            throw;
+          }
+        });
+    return thenAsync(
+        rank1Fut, [rank1Fut, qsFut, rank1Memory, rank1Tensors, worldSize]() {
+          rank1Fut->value();
+          rank1Memory.div_(worldSize);
+          int64_t idx = 0;
+          for (const auto& tensor : rank1Tensors) {
+            tensor.copy_(rank1Memory.narrow(0, idx, tensor.numel()));
+            idx += tensor.numel();
+          }
+          return qsFut;
+        });
+  };
+  auto reduced = issueInOrder(lastIssued_, std::move(issue));
+  auto error = bucketState.error;
+  auto decompress = [reduced,
+                     qMemory,
+                     ps,
+                     qs,
+                     highRankTensors,
+                     input,
+                     inputCopy,
+                     error,
+                     worldSize]() mutable {
+    reduced->value();
+    qMemory.div_(worldSize);
+    for (size_t i = 0; i < highRankTensors.size(); ++i) {
+      at::mm_out(highRankTensors[i], ps[i], qs[i].t());
+    }
+    if (inputCopy.defined()) {
+      // Memorize the local error.
+      at::sub_out(error, inputCopy, input);
+    }
+    return c10::IValue(input);
+  };
+  return reduced->then(decompress, reduced->elementType());
+}
+
 } // namespace c10d
@@ -3,11 +3,17 @@
 #include <c10d/comm.hpp>
 #include <c10d/ProcessGroup.hpp>
 
+#include <random>
+#include <unordered_map>
+
 namespace c10d {
 
 enum class BuiltinCommHookType {
   ALLREDUCE = 1,
   FP16_COMPRESS = 2,
+  INT8_ROWWISE_QUANTIZE = 3,
+  TOPK_SPARSIFY = 4,
+  POWER_SGD = 5,
 };
 
 class AllReduceCommHook : public CppCommHookInterface<ProcessGroup*> {
@@ -30,4 +36,107 @@ class FP16CompressCommHook : public CppCommHookInterface<ProcessGroup*> {
   c10::intrusive_ptr<c10::ivalue::Future> runHook(GradBucket& bucket) override;
 };
 
+struct Int8RowwiseQuantizeOptions {
+  int64_t rowSize = 512;
+  bool useErrorFeedback = true;
+};
+
+// Quantizes the bucket to uint8 with a scale and an offset per row of
+// `rowSize` elements, and allgathers the quantized rows together with the
+// quantization parameters, so every worker sends about a quarter of the
+// bytes of the bucket. Each worker then dequantizes and averages the
+// contributions locally. The quantization error is fed back into the
+// gradient of the next iteration.
+//
+// Since it is based on allgather, the bytes received per worker grow with
+// the number of workers; it pays off over a plain allreduce for groups of up
+// to about 8 workers.
+class Int8RowwiseQuantizeCommHook : public CppCommHookInterface<ProcessGroup*> {
+ public:
+  explicit Int8RowwiseQuantizeCommHook(
+      ProcessGroup* state,
+      Int8RowwiseQuantizeOptions options = {})
+      : CppCommHookInterface<ProcessGroup*>(state), options_(options) {}
+
+  ~Int8RowwiseQuantizeCommHook() override {}
+
+  c10::intrusive_ptr<c10::ivalue::Future> runHook(GradBucket& bucket) override;
+
+ private:
+  const Int8RowwiseQuantizeOptions options_;
+  // Maps a bucket index to the local quantization error. Entries are only
+  // added from runHook, which is called from a single thread.
+  std::unordered_map<size_t, at::Tensor> errors_;
+};
+
+struct TopKSparsifyOptions {
+  double ratio = 0.01;
+  bool useErrorFeedback = true;
+};
+
+// Allgathers the `ratio` fraction of the bucket entries that have the
+// largest magnitude, as values and int32 indices, and averages the sparse
+// contributions of all workers. The entries that were not sent are fed back
+// into the gradient of the next iteration.
+class TopKSparsifyCommHook : public CppCommHookInterface<ProcessGroup*> {
+ public:
+  explicit TopKSparsifyCommHook(
+      ProcessGroup* state,
+      TopKSparsifyOptions options = {})
+      : CppCommHookInterface<ProcessGroup*>(state), options_(options) {}
+
+  ~TopKSparsifyCommHook() override {}
+
+  c10::intrusive_ptr<c10::ivalue::Future> runHook(GradBucket& bucket) override;
+
+ private:
+  const TopKSparsifyOptions options_;
+  std::unordered_map<size_t, at::Tensor> errors_;
+};
+
+struct PowerSGDOptions {
+  int64_t matrixApproximationRank = 1;
+  // Plain allreduce is used for this many iterations first.
+  int64_t startPowerSGDIter = 10;
+  bool useErrorFeedback = true;
+  // Reuse P and Q of the previous iteration.
+  bool warmStart = true;
+  uint64_t randomSeed = 0;
+};
+
+// C++ implementation of the layer-wise PowerSGD hook in
+// torch/distributed/algorithms/ddp_comm_hooks/powerSGD_hook.py
+// (https://arxiv.org/abs/1905.13727). Each parameter of rank > 1 is
+// approximated by a product P * Q^T of rank `matrixApproximationRank`, and
+// only P and Q are allreduced; 1-D parameters are allreduced uncompressed.
+// The allreduce of Q is issued once the allreduce of P completes, from its
+// continuation, so the hook never blocks. The collectives of every bucket are
+// issued after those of the previous one, so that all ranks issue them in the
+// same order.
+class PowerSGDCommHook : public CppCommHookInterface<ProcessGroup*> {
+ public:
+  explicit PowerSGDCommHook(
+      ProcessGroup* state,
+      PowerSGDOptions options = {});
+
+  ~PowerSGDCommHook() override {}
+
+  c10::intrusive_ptr<c10::ivalue::Future> runHook(GradBucket& bucket) override;
+
+ private:
+  struct BucketState {
+    at::Tensor error;
+    at::Tensor pMemory;
+    at::Tensor qMemory;
+  };
+
+  const PowerSGDOptions options_;
+  // Seeds the initialization of Q, in the same order on all workers.
+  std::mt19937_64 rng_;
+  int64_t iter_ = 0;
+  std::unordered_map<size_t, BucketState> bucketStates_;
+  // Completed once the collectives of the last bucket were all issued.
+  c10::intrusive_ptr<c10::ivalue::Future> lastIssued_;
+};
+
 } // namespace c10d
@@ -47,6 +47,7 @@ Reducer::Reducer(
       backward_stats_base_(0),
       has_rebuilt_bucket_(false),
       bucket_bytes_cap_(bucket_bytes_cap),
+      bucket_chunk_bytes_(0),
       divFactor_(kUnsetDivFactor),
       comm_hook_(nullptr),
       ddp_logging_data_(std::move(std::make_unique<c10::DDPLoggingData>())) {
@@ -640,11 +641,19 @@ void Reducer::mark_variable_ready(VariableIndex index) {
   // event.record();
 
   // Check if this was the final gradient for this bucket.
+  bool ready = false;
   if (--replica.pending == 0) {
     // Kick off reduction if all replicas for this bucket are ready.
-    if (--bucket.pending == 0) {
-      mark_bucket_ready(bucket_index.bucket_index);
-    }
+    ready = --bucket.pending == 0;
+  }
+  // A pipelined bucket has a single replica. Kick off reduction as soon as
+  // the chunk holding this variable is complete.
+  if (is_pipelined(bucket)) {
+    const auto chunk = bucket.variable_chunks[bucket_index.intra_bucket_index];
+    ready = --bucket.chunk_pending[chunk] == 0;
+  }
+  if (ready) {
+    mark_bucket_ready(bucket_index.bucket_index);
   }
 
   // Run finalizer function and kick off reduction for local_used_maps once the
@@ -690,9 +699,18 @@ void Reducer::mark_bucket_ready(size_t bucket_index) {
   // Keep going, until we either:
   // - have kicked off reduction for all buckets, or
   // - found a bucket that's not yet ready for reduction.
-  for (; next_bucket_ < buckets_.size() && buckets_[next_bucket_].pending == 0;
-       next_bucket_++) {
+  for (; next_bucket_ < buckets_.size(); next_bucket_++) {
     auto& bucket = buckets_[next_bucket_];
+    if (is_pipelined(bucket)) {
+      reduce_ready_chunks(bucket);
+      if (bucket.next_chunk < bucket.chunk_ends.size()) {
+        break;
+      }
+      continue;
+    }
+    if (bucket.pending != 0) {
+      break;
+    }
     std::vector<at::Tensor> tensors;
     tensors.reserve(bucket.replicas.size());
     for (const auto& replica : bucket.replicas) {
@@ -726,6 +744,74 @@ void Reducer::mark_bucket_ready(size_t bucket_index) {
   }
 }
 
+void Reducer::reduce_ready_chunks(Bucket& bucket) {
+  auto& replica = bucket.replicas[0];
+  for (; bucket.next_chunk < bucket.chunk_ends.size() &&
+       bucket.chunk_pending[bucket.next_chunk] == 0;
+       bucket.next_chunk++) {
+    const auto chunk = bucket.next_chunk;
+    const auto begin = chunk == 0 ? 0 : bucket.chunk_ends[chunk - 1];
+    const auto end = bucket.chunk_ends[chunk];
+    const auto offset = replica.offsets[begin];
+    const auto length =
+        replica.offsets[end - 1] + replica.lengths[end - 1] - offset;
+    // Gradients were already divided by divFactor_ while being copied into
+    // the bucket, so the chunk is reduced as is.
+    std::vector<at::Tensor> tensors = {
+        replica.contents.narrow(0, offset, length)};
+    bucket.chunk_work.push_back(process_group_->allreduce(tensors));
+  }
+}
+
+void Reducer::initialize_bucket_chunks(Bucket& bucket) {
+  bucket.chunk_ends.clear();
+  bucket.variable_chunks.clear();
+  bucket.chunk_pending.clear();
+  bucket.chunk_work.clear();
+  bucket.next_chunk = 0;
+  if (bucket_chunk_bytes_ <= 0 || bucket.expect_sparse_gradient ||
+      bucket.replicas.size() != 1) {
+    return;
+  }
+
+  // Chunks hold whole variables, so that a chunk is complete when all its
+  // variables have been marked ready.
+  const auto& replica = bucket.replicas[0];
+  const auto element_size = replica.contents.element_size();
+  const auto num_variables = replica.variables.size();
+  bucket.variable_chunks.reserve(num_variables);
+  int64_t chunk_bytes = 0;
+  for (size_t i = 0; i < num_variables; i++) {
+    bucket.variable_chunks.push_back(bucket.chunk_ends.size());
+    chunk_bytes += replica.lengths[i] * element_size;
+    if (chunk_bytes >= bucket_chunk_bytes_ || i + 1 == num_variables) {
+      bucket.chunk_ends.push_back(i + 1);
+      chunk_bytes = 0;
+    }
+  }
+
+  // There is nothing to pipeline in a bucket with a single chunk.
+  if (bucket.chunk_ends.size() < 2) {
+    bucket.chunk_ends.clear();
+    bucket.variable_chunks.clear();
+    return;
+  }
+  bucket.chunk_pending.resize(bucket.chunk_ends.size());
+  bucket.chunk_work.reserve(bucket.chunk_ends.size());
+}
+
+void Reducer::set_bucket_chunk_bytes(int64_t chunk_bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  TORCH_CHECK(chunk_bytes >= 0, "Bucket chunk size must be non-negative.");
+  TORCH_CHECK(
+      !expect_autograd_hooks_,
+      "`set_bucket_chunk_bytes` must NOT be called during autograd execution.");
+  bucket_chunk_bytes_ = chunk_bytes;
+  for (auto& bucket : buckets_) {
+    initialize_bucket_chunks(bucket);
+  }
+}
+
 void Reducer::initialize_buckets(
     std::vector<std::vector<size_t>> bucket_indices) {
   // If initialize_buckets is called inside DDP constructor, then
@@ -891,6 +977,8 @@ void Reducer::initialize_buckets(
     }
     bucket.variable_indices = std::move(bucket_indices[bucket_index]);
 
+    initialize_bucket_chunks(bucket);
+
     buckets_.push_back(std::move(bucket));
   }
 }
@@ -991,6 +1079,14 @@ void Reducer::prepare_for_backward(
       replica.pending = replica.variables.size();
     }
     bucket.pending = bucket.replicas.size();
+    if (!bucket.chunk_ends.empty()) {
+      for (size_t chunk = 0; chunk < bucket.chunk_ends.size(); chunk++) {
+        const auto begin = chunk == 0 ? 0 : bucket.chunk_ends[chunk - 1];
+        bucket.chunk_pending[chunk] = bucket.chunk_ends[chunk] - begin;
+      }
+      bucket.next_chunk = 0;
+      bucket.chunk_work.clear();
+    }
   }
 
   // Reset unused parameter accounting.
@@ -1078,12 +1174,14 @@ void Reducer::copy_bucket_to_grad(
 }
 
 // A bucket with one or more dense tensors needs to be unflattened.
-void Reducer::finalize_bucket_dense(Bucket& bucket) {
+void Reducer::finalize_bucket_dense(
+    Bucket& bucket,
+    size_t begin,
+    size_t end) {
   for (size_t replica_index = 0; replica_index < bucket.replicas.size();
        replica_index++) {
     auto& replica = bucket.replicas[replica_index];
-    for (size_t intra_bucket_index = 0;
-         intra_bucket_index < replica.variables.size();
+    for (size_t intra_bucket_index = begin; intra_bucket_index < end;
          intra_bucket_index++) {
       auto& variable = replica.variables[intra_bucket_index];
       const auto offset = replica.offsets[intra_bucket_index];
@@ -1195,6 +1293,21 @@ void Reducer::finalize_backward() {
 
   // Wait for asynchronous reduction to complete and unflatten contents.
   for (auto& bucket : buckets_) {
+    // Copy out the variables of every chunk of a pipelined bucket as soon as
+    // its reduction is done, while later chunks may still be in flight.
+    if (is_pipelined(bucket)) {
+      TORCH_INTERNAL_ASSERT(
+          bucket.chunk_work.size() == bucket.chunk_ends.size());
+      for (size_t chunk = 0; chunk < bucket.chunk_ends.size(); chunk++) {
+        bucket.chunk_work[chunk]->wait();
+        finalize_bucket_dense(
+            bucket,
+            chunk == 0 ? 0 : bucket.chunk_ends[chunk - 1],
+            bucket.chunk_ends[chunk]);
+      }
+      continue;
+    }
+
     // See Note [DDP Communication Hook]
     if (comm_hook_ == nullptr) {
       TORCH_INTERNAL_ASSERT(
@@ -1227,7 +1340,8 @@ void Reducer::finalize_backward() {
       // We don't need to finalize the sparse bucket since the sparse grad and
       // the bucket essentially point to the same storage. As a result, once
       // the allreduce is done, the sparse grads are automatically updated.
-      finalize_bucket_dense(bucket);
+      finalize_bucket_dense(
+          bucket, 0, bucket.replicas[0].variables.size());
     }
   }
 
@@ -1433,12 +1547,49 @@ void Reducer::register_builtin_comm_hook(
           std::make_unique<c10d::FP16CompressCommHook>(process_group_.get());
       LOG(INFO) << "Built-in communication hook FP16_COMPRESS is registered.";
       break;
+    case c10d::BuiltinCommHookType::INT8_ROWWISE_QUANTIZE:
+      comm_hook_ = std::make_unique<c10d::Int8RowwiseQuantizeCommHook>(
+          process_group_.get());
+      LOG(INFO)
+          << "Built-in communication hook INT8_ROWWISE_QUANTIZE is registered.";
+      break;
+    case c10d::BuiltinCommHookType::TOPK_SPARSIFY:
+      comm_hook_ =
+          std::make_unique<c10d::TopKSparsifyCommHook>(process_group_.get());
+      LOG(INFO) << "Built-in communication hook TOPK_SPARSIFY is registered.";
+      break;
+    case c10d::BuiltinCommHookType::POWER_SGD:
+      comm_hook_ =
+          std::make_unique<c10d::PowerSGDCommHook>(process_group_.get());
+      LOG(INFO) << "Built-in communication hook POWER_SGD is registered.";
+      break;
     default:
       TORCH_WARN_ONCE(
           "Unknown built-in DDP comm hook type is provided. No comm hook will be used.");
   }
 }
 
+void Reducer::register_builtin_comm_hook(
+    const c10d::Int8RowwiseQuantizeOptions& options) {
+  register_comm_hook(std::make_unique<c10d::Int8RowwiseQuantizeCommHook>(
+      process_group_.get(), options));
+  LOG(INFO)
+      << "Built-in communication hook INT8_ROWWISE_QUANTIZE is registered.";
+}
+
+void Reducer::register_builtin_comm_hook(
+    const c10d::TopKSparsifyOptions& options) {
+  register_comm_hook(std::make_unique<c10d::TopKSparsifyCommHook>(
+      process_group_.get(), options));
+  LOG(INFO) << "Built-in communication hook TOPK_SPARSIFY is registered.";
+}
+
+void Reducer::register_builtin_comm_hook(const c10d::PowerSGDOptions& options) {
+  register_comm_hook(std::make_unique<c10d::PowerSGDCommHook>(
+      process_group_.get(), options));
+  LOG(INFO) << "Built-in communication hook POWER_SGD is registered.";
+}
+
 void Reducer::ensure_prior_reduction_finished() {
   // Check that any prior reduction has finished.
   // The variable `require_finalize_` is true until all gradients
@@ -68,6 +68,23 @@ class Reducer {
   // Cannot combine with the call of `register_comm_hook`.
   void register_builtin_comm_hook(c10d::BuiltinCommHookType comm_hook_type);
 
+  // Same as above, for the INT8_ROWWISE_QUANTIZE, TOPK_SPARSIFY and POWER_SGD
+  // hooks with non-default options.
+  void register_builtin_comm_hook(
+      const c10d::Int8RowwiseQuantizeOptions& options);
+  void register_builtin_comm_hook(const c10d::TopKSparsifyOptions& options);
+  void register_builtin_comm_hook(const c10d::PowerSGDOptions& options);
+
+  // Enables pipelined reduction of buckets. Every bucket is split into chunks
+  // of consecutive variables holding at least `chunk_bytes` bytes, and a chunk
+  // is reduced as soon as all its gradients have been copied in, while later
+  // chunks of the same bucket are still being filled. After the backward pass,
+  // gradients are copied out chunk by chunk as their reductions complete.
+  // Passing 0 disables pipelining. Only applies to dense buckets with a single
+  // replica and without a communication hook. Must not be called during
+  // autograd execution.
+  void set_bucket_chunk_bytes(int64_t chunk_bytes);
+
   // Returns a vector of tensors in each bucket in sequential order.
   std::vector<std::vector<at::Tensor>> get_bucket_tensors() const;
 
@@ -187,7 +204,9 @@ class Reducer {
 
   void mark_bucket_ready(size_t bucket_index);
 
-  void finalize_bucket_dense(Bucket& replica);
+  // Unflattens the contents of the variables in the range [begin, end) of
+  // the bucket.
+  void finalize_bucket_dense(Bucket& bucket, size_t begin, size_t end);
 
   void finalize_backward();
 
@@ -303,8 +322,39 @@ class Reducer {
     // If this bucket should expect a single sparse gradient.
     // Implies: replicas[i].variables.size() == 1.
     bool expect_sparse_gradient = false;
+
+    // If bucket pipelining is enabled, the bucket is split into chunks of
+    // consecutive variables that are reduced independently, in order.
+    // `chunk_ends[c]` is the intra bucket index one past the last variable of
+    // chunk c and `variable_chunks[i]` is the chunk of variable i. These are
+    // empty if the bucket is not pipelined.
+    std::vector<size_t> chunk_ends;
+    std::vector<size_t> variable_chunks;
+
+    // Number of variables to be marked ready before each chunk is complete.
+    // This is reset every iteration.
+    std::vector<size_t> chunk_pending;
+
+    // Index of the next chunk to be reduced.
+    size_t next_chunk = 0;
+
+    // Work handles of the chunks that are being reduced.
+    std::vector<c10::intrusive_ptr<c10d::ProcessGroup::Work>> chunk_work;
   };
 
+  // Splits the bucket into chunks of at least `bucket_chunk_bytes_` bytes, or
+  // clears its chunks if it is not to be pipelined.
+  void initialize_bucket_chunks(Bucket& bucket);
+
+  // Returns true if the chunks of the bucket are reduced independently.
+  bool is_pipelined(const Bucket& bucket) const {
+    return !bucket.chunk_ends.empty() && comm_hook_ == nullptr;
+  }
+
+  // Kicks off reduction of the chunks of the bucket that are complete,
+  // in order, stopping at the first chunk that is not.
+  void reduce_ready_chunks(Bucket& bucket);
+
   std::vector<Bucket> buckets_;
 
   // A variable locator locates a particular variable in the bucket
@@ -340,6 +390,10 @@ class Reducer {
   std::vector<int64_t> rebuilt_param_indices_;
   const int64_t bucket_bytes_cap_;
 
+  // Minimum size of the chunks of pipelined buckets. 0 if pipelining is
+  // disabled.
+  int64_t bucket_chunk_bytes_;
+
   struct RpcContext {
     using ContextPtr = torch::distributed::autograd::ContextPtr;
     // The shared_ptr is to hold the context instance.
@@ -461,6 +461,73 @@ void testRecv(const std::string& path) {
   EXPECT_TRUE(recvCompleted);
 }
 
+void testBatchSendRecv(const std::string& path) {
+  const auto size = 3;
+  auto tests = CollectiveTest::initialize(path, size);
+  constexpr uint64_t tag = 0x1337;
+
+  // Every rank sends a float and a long tensor to every other rank, which
+  // are coalesced into one message per peer. Run several times, so that the
+  // later batches reuse the buffers of the first. The second batch is only
+  // polled and never waited for, its buffers must be released all the same.
+  for (auto iteration = 0; iteration < 3; iteration++) {
+    std::vector<std::vector<at::Tensor>> outputs(size);
+    std::vector<std::thread> threads;
+    for (auto rank = 0; rank < size; rank++) {
+      threads.push_back(std::thread([&, rank] {
+        std::vector<::c10d::P2POp> ops;
+        for (auto peer = 0; peer < size; peer++) {
+          if (peer == rank) {
+            continue;
+          }
+          auto value = rank * size + peer + iteration;
+          ops.push_back({::c10d::P2POp::Type::SEND,
+                         at::full({4, 4}, value, at::kFloat),
+                         peer});
+          ops.push_back({::c10d::P2POp::Type::SEND,
+                         at::full({7}, value, at::kLong),
+                         peer});
+          ops.push_back(
+              {::c10d::P2POp::Type::RECV, at::zeros({4, 4}, at::kFloat), peer});
+          ops.push_back(
+              {::c10d::P2POp::Type::RECV, at::zeros({7}, at::kLong), peer});
+        }
+        auto work =
+            tests[rank].getProcessGroup().batch_isend_irecv(ops, tag);
+        if (iteration == 1) {
+          while (!work->isCompleted()) {
+            std::this_thread::yield();
+          }
+          EXPECT_TRUE(work->isSuccess());
+        } else {
+          EXPECT_TRUE(work->wait());
+        }
+        for (const auto& op : ops) {
+          if (op.type == ::c10d::P2POp::Type::RECV) {
+            outputs[rank].push_back(op.tensor);
+          }
+        }
+      }));
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    for (auto rank = 0; rank < size; rank++) {
+      auto i = 0;
+      for (auto peer = 0; peer < size; peer++) {
+        if (peer == rank) {
+          continue;
+        }
+        auto value = peer * size + rank + iteration;
+        EXPECT_TRUE(
+            outputs[rank][i++].equal(at::full({4, 4}, value, at::kFloat)));
+        EXPECT_TRUE(outputs[rank][i++].equal(at::full({7}, value, at::kLong)));
+      }
+    }
+  }
+}
+
 #ifndef _WIN32
 TEST(ProcessGroupGlooTest, testSIGSTOPException) {
   // test SIGSTOP
@@ -535,6 +602,13 @@ TEST(ProcessGroupGlooTest, testRecv) {
   }
 }
 
+TEST(ProcessGroupGlooTest, testBatchSendRecv) {
+  {
+    TemporaryFile file;
+    testBatchSendRecv(file.path);
+  }
+}
+
 TEST(ProcessGroupGlooTest, testWaitDelay) {
   {
     TemporaryFile file;
@@ -0,0 +1,210 @@
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <c10d/FileStore.hpp>
+#include <c10d/ProcessGroupShm.hpp>
+#include <c10d/test/TestUtils.hpp>
+
+using namespace c10d::test;
+
+// A small buffer, so that the tensors below are processed in several chunks.
+constexpr size_t kBufferSize = 256;
+
+std::vector<c10::intrusive_ptr<::c10d::ProcessGroupShm>> initialize(
+    const std::string& path,
+    int size) {
+  std::vector<c10::intrusive_ptr<::c10d::ProcessGroupShm>> pgs(size);
+  std::vector<std::thread> threads;
+  for (auto i = 0; i < size; i++) {
+    threads.push_back(std::thread([i, size, &path, &pgs] {
+      auto store = c10::make_intrusive<::c10d::FileStore>(path, size);
+      ::c10d::ProcessGroupShm::Options options;
+      options.timeout = std::chrono::milliseconds(5000);
+      options.bufferSize = kBufferSize;
+      pgs[i] = c10::make_intrusive<::c10d::ProcessGroupShm>(
+          store, i, size, options);
+    }));
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  return pgs;
+}
+
+void waitAll(
+    const std::vector<c10::intrusive_ptr<::c10d::ProcessGroup::Work>>& work) {
+  for (const auto& w : work) {
+    w->wait();
+  }
+}
+
+TEST(ProcessGroupShmTest, testAllreduce) {
+  TemporaryFile file;
+  const auto size = 4;
+  auto pgs = initialize(file.path, size);
+
+  std::vector<std::vector<at::Tensor>> inputs(size);
+  std::vector<c10::intrusive_ptr<::c10d::ProcessGroup::Work>> work(size);
+  for (auto i = 0; i < size; i++) {
+    inputs[i] = {at::arange(1000, at::kFloat) * (i + 1)};
+    work[i] = pgs[i]->allreduce(inputs[i]);
+  }
+  waitAll(work);
+
+  const auto expected = at::arange(1000, at::kFloat) * 10;
+  for (auto i = 0; i < size; i++) {
+    EXPECT_TRUE(inputs[i][0].equal(expected));
+  }
+
+  ::c10d::AllreduceOptions opts;
+  opts.reduceOp = ::c10d::ReduceOp::MAX;
+  for (auto i = 0; i < size; i++) {
+    // Non-contiguous input
+    inputs[i] = {at::full({100, 3}, i, at::kLong).t()};
+    work[i] = pgs[i]->allreduce(inputs[i], opts);
+  }
+  waitAll(work);
+  for (auto i = 0; i < size; i++) {
+    EXPECT_TRUE(inputs[i][0].equal(at::full({3, 100}, size - 1, at::kLong)));
+  }
+}
+
+TEST(ProcessGroupShmTest, testReduce) {
+  TemporaryFile file;
+  const auto size = 3;
+  auto pgs = initialize(file.path, size);
+
+  for (auto root = 0; root < size; root++) {
+    std::vector<std::vector<at::Tensor>> inputs(size);
+    std::vector<c10::intrusive_ptr<::c10d::ProcessGroup::Work>> work(size);
+    ::c10d::ReduceOptions opts;
+    opts.rootRank = root;
+    for (auto i = 0; i < size; i++) {
+      inputs[i] = {at::arange(500, at::kFloat) * (i + 1)};
+      work[i] = pgs[i]->reduce(inputs[i], opts);
+    }
+    waitAll(work);
+    for (auto i = 0; i < size; i++) {
+      // Only the input of the root holds the result.
+      const auto expected = at::arange(500, at::kFloat) *
+          (i == root ? size * (size + 1) / 2 : i + 1);
+      EXPECT_TRUE(inputs[i][0].equal(expected));
+    }
+  }
+}
+
+TEST(ProcessGroupShmTest, testBroadcast) {
+  TemporaryFile file;
+  const auto size = 3;
+  auto pgs = initialize(file.path, size);
+
+  for (auto root = 0; root < size; root++) {
+    std::vector<std::vector<at::Tensor>> inputs(size);
+    std::vector<c10::intrusive_ptr<::c10d::ProcessGroup::Work>> work(size);
+    ::c10d::BroadcastOptions opts;
+    opts.rootRank = root;
+    for (auto i = 0; i < size; i++) {
+      inputs[i] = {at::full({500}, i, at::kDouble)};
+      work[i] = pgs[i]->broadcast(inputs[i], opts);
+    }
+    waitAll(work);
+    for (auto i = 0; i < size; i++) {
+      EXPECT_TRUE(inputs[i][0].equal(at::full({500}, root, at::kDouble)));
+    }
+  }
+}
+
+TEST(ProcessGroupShmTest, testAllgather) {
+  TemporaryFile file;
+  const auto size = 4;
+  auto pgs = initialize(file.path, size);
+
+  std::vector<std::vector<at::Tensor>> inputs(size);
+  std::vector<std::vector<std::vector<at::Tensor>>> outputs(size);
+  std::vector<c10::intrusive_ptr<::c10d::ProcessGroup::Work>> work(size);
+  for (auto i = 0; i < size; i++) {
+    inputs[i] = {at::full({300}, i, at::kInt)};
+    outputs[i] = {std::vector<at::Tensor>(size)};
+    for (auto& output : outputs[i][0]) {
+      output = at::empty({300}, at::kInt);
+    }
+    work[i] = pgs[i]->allgather(outputs[i], inputs[i]);
+  }
+  waitAll(work);
+  for (auto i = 0; i < size; i++) {
+    for (auto j = 0; j < size; j++) {
+      EXPECT_TRUE(outputs[i][0][j].equal(at::full({300}, j, at::kInt)));
+    }
+  }
+}
+
+TEST(ProcessGroupShmTest, testReduceScatter) {
+  TemporaryFile file;
+  const auto size = 4;
+  auto pgs = initialize(file.path, size);
+
+  std::vector<std::vector<at::Tensor>> outputs(size);
+  std::vector<std::vector<std::vector<at::Tensor>>> inputs(size);
+  std::vector<c10::intrusive_ptr<::c10d::ProcessGroup::Work>> work(size);
+  for (auto i = 0; i < size; i++) {
+    outputs[i] = {at::empty({200}, at::kFloat)};
+    inputs[i] = {std::vector<at::Tensor>(size)};
+    for (auto j = 0; j < size; j++) {
+      inputs[i][0][j] = at::full({200}, i * size + j, at::kFloat);
+    }
+    work[i] = pgs[i]->reduce_scatter(outputs[i], inputs[i]);
+  }
+  waitAll(work);
+  for (auto i = 0; i < size; i++) {
+    // sum over ranks r of (r * size + i)
+    const auto expected = size * (size - 1) / 2 * size + size * i;
+    EXPECT_TRUE(outputs[i][0].equal(at::full({200}, expected, at::kFloat)));
+  }
+}
+
+TEST(ProcessGroupShmTest, testAlltoall) {
+  TemporaryFile file;
+  const auto size = 4;
+  auto pgs = initialize(file.path, size);
+
+  std::vector<at::Tensor> inputs(size);
+  std::vector<at::Tensor> outputs(size);
+  std::vector<c10::intrusive_ptr<::c10d::ProcessGroup::Work>> work(size);
+  std::vector<int64_t> splits;
+  for (auto i = 0; i < size; i++) {
+    // Rank i sends (i * size + j) to rank j
+    inputs[i] = (at::arange(size, at::kLong) + i * size)
+                    .repeat_interleave(100)
+                    .view({size * 100});
+    outputs[i] = at::empty({size * 100}, at::kLong);
+    work[i] = pgs[i]->alltoall_base(outputs[i], inputs[i], splits, splits);
+  }
+  waitAll(work);
+  for (auto i = 0; i < size; i++) {
+    const auto expected =
+        (at::arange(size, at::kLong) * size + i).repeat_interleave(100);
+    EXPECT_TRUE(outputs[i].equal(expected));
+  }
+}
+
+TEST(ProcessGroupShmTest, testBarrier) {
+  TemporaryFile file;
+  const auto size = 4;
+  auto pgs = initialize(file.path, size);
+
+  std::vector<c10::intrusive_ptr<::c10d::ProcessGroup::Work>> work(size);
+  for (auto round = 0; round < 100; round++) {
+    for (auto i = 0; i < size; i++) {
+      work[i] = pgs[i]->barrier();
+    }
+    waitAll(work);
+  }
+}
+
+TEST(ProcessGroupShmTest, testBackendName) {
+  TemporaryFile file;
+  auto pgs = initialize(file.path, 2);
+  EXPECT_EQ(pgs[0]->getBackendName(), std::string(::c10d::SHM_BACKEND_NAME));
+}
@@ -0,0 +1,132 @@
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <torch/optim/adam.h>
+#include <torch/optim/sgd.h>
+
+#include <c10d/FileStore.hpp>
+#include <c10d/ProcessGroupShm.hpp>
+#include <c10d/ShardedOptimizer.hpp>
+#include <c10d/test/TestUtils.hpp>
+
+using namespace c10d::test;
+
+// Parameters of different sizes, with gradients set, identical on all ranks.
+std::vector<at::Tensor> createParameters() {
+  std::vector<at::Tensor> parameters;
+  for (auto i = 0; i < 7; i++) {
+    auto parameter = at::arange((i + 1) * 10, at::kFloat)
+                         .view({i + 1, 10})
+                         .clone()
+                         .set_requires_grad(true);
+    parameter.mutable_grad() = at::ones_like(parameter) * (i - 3);
+    parameters.push_back(parameter);
+  }
+  return parameters;
+}
+
+void testStep(int64_t bucketBytes) {
+  TemporaryFile file;
+  const auto size = 3;
+  const auto numSteps = 3;
+
+  // Reference: the same optimizer, not sharded.
+  auto expected = createParameters();
+  torch::optim::Adam reference(expected, torch::optim::AdamOptions(0.1));
+  for (auto step = 0; step < numSteps; step++) {
+    reference.step();
+  }
+
+  std::vector<std::vector<at::Tensor>> parameters(size);
+  std::vector<size_t> numLocalStates(size);
+  std::vector<std::vector<int>> owners(size);
+  std::vector<std::thread> threads;
+  for (auto rank = 0; rank < size; rank++) {
+    threads.push_back(std::thread([&, rank] {
+      auto store = c10::make_intrusive<::c10d::FileStore>(file.path, size);
+      auto pg = c10::make_intrusive<::c10d::ProcessGroupShm>(store, rank, size);
+      parameters[rank] = createParameters();
+      ::c10d::ShardedOptimizer optimizer(
+          parameters[rank],
+          pg,
+          [](std::vector<at::Tensor> parameters) {
+            return std::make_unique<torch::optim::Adam>(
+                std::move(parameters), torch::optim::AdamOptions(0.1));
+          },
+          bucketBytes);
+      for (auto step = 0; step < numSteps; step++) {
+        optimizer.step();
+      }
+      numLocalStates[rank] = optimizer.localOptimizer().state().size();
+      for (size_t i = 0; i < parameters[rank].size(); i++) {
+        owners[rank].push_back(optimizer.ownerRank(i));
+      }
+    }));
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  size_t totalLocalStates = 0;
+  for (auto rank = 0; rank < size; rank++) {
+    EXPECT_EQ(owners[rank], owners[0]);
+    totalLocalStates += numLocalStates[rank];
+    for (size_t i = 0; i < expected.size(); i++) {
+      EXPECT_TRUE(parameters[rank][i].allclose(expected[i]));
+    }
+  }
+  // Every rank only holds the state of the parameters it owns.
+  EXPECT_EQ(totalLocalStates, expected.size());
+  for (auto rank = 0; rank < size; rank++) {
+    EXPECT_GT(numLocalStates[rank], 0);
+  }
+}
+
+TEST(ShardedOptimizerTest, testStep) {
+  testStep(::c10d::ShardedOptimizer::kDefaultBucketBytes);
+}
+
+TEST(ShardedOptimizerTest, testStepSmallBuckets) {
+  // Buckets of about two rows, so that most parameters have a bucket of their
+  // own and ranks allgather different numbers of buckets.
+  testStep(80);
+}
+
+TEST(ShardedOptimizerTest, testParamGroupOptions) {
+  TemporaryFile file;
+  const auto size = 2;
+
+  std::vector<std::vector<at::Tensor>> parameters(size);
+  std::vector<std::thread> threads;
+  for (auto rank = 0; rank < size; rank++) {
+    threads.push_back(std::thread([&, rank] {
+      auto store = c10::make_intrusive<::c10d::FileStore>(file.path, size);
+      auto pg = c10::make_intrusive<::c10d::ProcessGroupShm>(store, rank, size);
+      parameters[rank] = createParameters();
+      ::c10d::ShardedOptimizer optimizer(
+          parameters[rank], pg, [](std::vector<at::Tensor> parameters) {
+            return std::make_unique<torch::optim::SGD>(
+                std::move(parameters), torch::optim::SGDOptions(0.1));
+          });
+      optimizer.step();
+      // Like a learning rate schedule, through the param groups of the
+      // wrapper.
+      auto& options = static_cast<torch::optim::SGDOptions&>(
+          optimizer.param_groups()[0].options());
+      options.lr(0.5);
+      optimizer.step();
+    }));
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto expected = createParameters();
+  for (auto rank = 0; rank < size; rank++) {
+    for (size_t i = 0; i < expected.size(); i++) {
+      EXPECT_TRUE(parameters[rank][i].allclose(
+          expected[i] - expected[i].grad() * (0.1 + 0.5)));
+    }
+  }
+}
@@ -136,3 +136,89 @@ TEST(TCPStoreTest, testHelper) {
 TEST(TCPStoreTest, testHelperPrefix) {
   testHelper("testPrefix");
 }
+
+void testMultiSetGetAndWaitCounter(const std::string& prefix = "") {
+  const auto numThreads = 16;
+
+  auto serverTCPStore = c10::make_intrusive<c10d::TCPStore>(
+      "127.0.0.1",
+      0,
+      numThreads + 1,
+      true,
+      std::chrono::seconds(30),
+      /* wait */ false);
+
+  std::vector<c10::intrusive_ptr<c10d::PrefixStore>> clientStores;
+  for (auto i = 0; i < numThreads; i++) {
+    auto clientTCPStore = c10::make_intrusive<c10d::TCPStore>(
+        "127.0.0.1",
+        serverTCPStore->getPort(),
+        numThreads + 1,
+        false,
+        std::chrono::seconds(30),
+        /* wait */ false);
+    clientStores.push_back(
+        c10::make_intrusive<c10d::PrefixStore>(prefix, clientTCPStore));
+  }
+
+  // Every round, each thread publishes two keys, checks in on a counter and
+  // reads the keys of all threads once all of them have checked in.
+  const auto numRounds = 20;
+  std::vector<std::thread> threads;
+  for (auto i = 0; i < numThreads; i++) {
+    threads.push_back(std::thread([&clientStores, i, numThreads, numRounds] {
+      auto& store = clientStores[i];
+      for (auto round = 0; round < numRounds; round++) {
+        const auto roundPrefix = "round_" + std::to_string(round) + "/";
+        const auto value = std::to_string(i * numRounds + round);
+        store->multiSet(
+            {roundPrefix + "a_" + std::to_string(i),
+             roundPrefix + "b_" + std::to_string(i)},
+            {std::vector<uint8_t>(value.begin(), value.end()),
+             std::vector<uint8_t>(value.rbegin(), value.rend())});
+        store->add(roundPrefix + "counter", 1);
+        store->waitCounter(
+            roundPrefix + "counter", numThreads, std::chrono::seconds(30));
+
+        std::vector<std::string> keys;
+        for (auto j = 0; j < numThreads; j++) {
+          keys.push_back(roundPrefix + "a_" + std::to_string(j));
+          keys.push_back(roundPrefix + "b_" + std::to_string(j));
+        }
+        auto values = store->multiGet(keys);
+        ASSERT_EQ(values.size(), keys.size());
+        for (auto j = 0; j < numThreads; j++) {
+          const auto expected = std::to_string(j * numRounds + round);
+          EXPECT_EQ(
+              std::string(values[2 * j].begin(), values[2 * j].end()),
+              expected);
+          EXPECT_EQ(
+              std::string(values[2 * j + 1].begin(), values[2 * j + 1].end()),
+              std::string(expected.rbegin(), expected.rend()));
+        }
+      }
+    }));
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // A counter that is not reached times out. Once the client has sent
+  // another query, it is not notified when the counter is reached later.
+  auto timeout = std::chrono::milliseconds(kShortStoreTimeoutMillis);
+  EXPECT_THROW(
+      clientStores[0]->waitCounter("late", 1, timeout), std::runtime_error);
+  c10d::test::set(*clientStores[0], "key", "value");
+  c10d::test::check(*clientStores[0], "key", "value");
+  EXPECT_EQ(clientStores[1]->add("late", 1), 1);
+  EXPECT_EQ(clientStores[0]->add("late", 1), 2);
+  EXPECT_TRUE(clientStores[0]->multiGet({}).empty());
+}
+
+TEST(TCPStoreTest, testMultiSetGetAndWaitCounter) {
+  testMultiSetGetAndWaitCounter();
+}
+
+TEST(TCPStoreTest, testMultiSetGetAndWaitCounterPrefix) {
+  testMultiSetGetAndWaitCounter("testPrefix");
+}
@@ -1097,7 +1097,7 @@ class DistributedDataParallel(Module):
         dist._register_comm_hook(self.reducer, state, hook)
 
     def _register_builtin_comm_hook(
-        self, comm_hook_type
+        self, comm_hook_type, options=None
     ):
         r"""
         Registers a built-in communication hook that specifies how DDP
@@ -1107,7 +1107,11 @@ class DistributedDataParallel(Module):
 
         Args:
             comm_hook_type (dist.BuiltinCommHookType): type of communication hook, such as
-            ALLREDUCE, FP16_COMPRESS, etc.
+            ALLREDUCE, FP16_COMPRESS, INT8_ROWWISE_QUANTIZE, TOPK_SPARSIFY
+            or POWER_SGD.
+            options (optional): options of the hook, a ``dist.Int8RowwiseQuantizeOptions``,
+            ``dist.TopKSparsifyOptions`` or ``dist.PowerSGDOptions`` matching
+            ``comm_hook_type``. The defaults are used if not given.
 
         .. warning ::
             DDP communication hook can only be registered once and should be registered
@@ -1127,8 +1131,58 @@ class DistributedDataParallel(Module):
 
             >>> ddp._register_builtin_comm_hook(dist.BuiltinCommHookType.FP16_COMPRESS)
 
+            PowerSGD compression of rank 2, starting after 100 iterations of
+            plain allreduce:
+
+            >>> options = dist.PowerSGDOptions()
+            >>> options.matrix_approximation_rank = 2
+            >>> options.start_powerSGD_iter = 100
+            >>> ddp._register_builtin_comm_hook(dist.BuiltinCommHookType.POWER_SGD, options)
+
+        """
+        if options is None:
+            dist._register_builtin_comm_hook(self.reducer, comm_hook_type)
+            return
+        options_types = {
+            dist.BuiltinCommHookType.INT8_ROWWISE_QUANTIZE: dist.Int8RowwiseQuantizeOptions,
+            dist.BuiltinCommHookType.TOPK_SPARSIFY: dist.TopKSparsifyOptions,
+            dist.BuiltinCommHookType.POWER_SGD: dist.PowerSGDOptions,
+        }
+        if not isinstance(options, options_types.get(comm_hook_type, ())):
+            raise ValueError(
+                "Options of type {} cannot be used with the built-in communication hook {}.".format(
+                    type(options).__name__, comm_hook_type
+                )
+            )
+        dist._register_builtin_comm_hook(self.reducer, options)
+
+    def _set_bucket_chunk_size(self, chunk_bytes):
+        r"""
+        Enables pipelined reduction of gradient buckets. Every bucket is split
+        into chunks of consecutive parameters holding at least ``chunk_bytes``
+        bytes of gradients. A chunk is allreduced as soon as all its gradients
+        are ready, while the rest of its bucket is still being filled, and its
+        gradients are copied back as soon as its allreduce completes. This
+        mostly helps CPU training, where copying gradients into and out of the
+        buckets is not overlapped with communication otherwise.
+
+        Args:
+            chunk_bytes (int): minimum size of a chunk in bytes. Pass 0 to
+                disable pipelining.
+
+        .. warning ::
+            Pipelining does not apply to buckets reduced by a communication
+            hook, buckets of sparse gradients, and single-process
+            multiple-device mode.
+
+        .. warning ::
+            This API is experimental and subject to change.
+
+        Example::
+            >>> ddp = torch.nn.parallel.DistributedDataParallel(model)
+            >>> ddp._set_bucket_chunk_size(1024 * 1024)
         """
-        dist._register_builtin_comm_hook(self.reducer, comm_hook_type)
+        self.reducer._set_bucket_chunk_bytes(chunk_bytes)
 
     def _distributed_broadcast_coalesced(
         self, tensors, buffer_size, authoritative_rank=0
@@ -735,6 +735,52 @@ class DistributedTest:
 
             self._barrier()
 
+        # GLOO Batch SEND RECV CPU with several tensors per peer, which are
+        # coalesced into one message per peer
+        @unittest.skipIf(BACKEND != "gloo", "GLOO Batch Send Recv CPU")
+        def test_batch_isend_irecv_gloo_coalesced(self):
+            self._barrier()
+            rank = dist.get_rank()
+            world_size = dist.get_world_size()
+
+            # Run twice, the second time reusing the buffers of the first.
+            for iteration in range(2):
+                p2p_op_list = []
+                expected = []
+                for peer in range(world_size):
+                    if peer == rank:
+                        continue
+                    for i, dtype in enumerate([torch.float, torch.int64, torch.uint8]):
+                        send_tensor = torch.full(
+                            (i + 1, 3), rank * 10 + i + iteration, dtype=dtype)
+                        recv_tensor = torch.zeros(i + 1, 3, dtype=dtype)
+                        p2p_op_list.append(dist.P2POp(dist.isend, send_tensor, peer))
+                        p2p_op_list.append(dist.P2POp(dist.irecv, recv_tensor, peer))
+                        expected.append((recv_tensor, peer * 10 + i + iteration))
+
+                reqs = dist.batch_isend_irecv(p2p_op_list, coalesce=True)
+                self.assertEqual(len(reqs), 1)
+                for req in reqs:
+                    req.wait()
+                for recv_tensor, value in expected:
+                    self.assertEqual(recv_tensor, torch.full_like(recv_tensor, value))
+
+            # Without coalescing, every op is sent or received on its own.
+            reqs = dist.batch_isend_irecv(p2p_op_list)
+            self.assertEqual(len(reqs), len(p2p_op_list))
+            for req in reqs:
+                req.wait()
+            for recv_tensor, value in expected:
+                self.assertEqual(recv_tensor, torch.full_like(recv_tensor, value))
+
+            with self.assertRaisesRegex(RuntimeError, "same group and tag"):
+                dist.batch_isend_irecv(
+                    [dist.P2POp(dist.isend, torch.ones(1), (rank + 1) % world_size, tag=1),
+                     dist.P2POp(dist.irecv, torch.ones(1), (rank + 1) % world_size, tag=2)],
+                    coalesce=True)
+
+            self._barrier()
+
         # NCCL Batch SEND RECV Tensor Error
         @unittest.skipIf(BACKEND != "nccl", "NCCL Batch Send Recv Only")
         @requires_nccl_version(2700, "Need NCCL 2.7+ for send/recv")
@@ -4532,6 +4532,43 @@ class TensorPipeAgentRpcTest(RpcAgentTestFixture):
         self.assertEqual(default_timeout, timeout)
         rpc.shutdown()
 
+    @dist_init(setup_rpc=False)
+    def test_tensorpipe_batching(self):
+        rpc_backend_options = rpc.TensorPipeRpcBackendOptions(
+            init_method=self.rpc_backend_options.init_method,
+            num_worker_threads=self.rpc_backend_options.num_worker_threads,
+        )
+        rpc_backend_options.batch_window_us = 1000
+        rpc_backend_options.batch_max_messages = 8
+        rpc.init_rpc(
+            name=worker_name(self.rank),
+            backend=self.rpc_backend,
+            rank=self.rank,
+            world_size=self.world_size,
+            rpc_backend_options=rpc_backend_options,
+        )
+
+        dst = worker_name((self.rank + 1) % self.world_size)
+        futs = [
+            rpc.rpc_async(dst, torch.add, args=(torch.ones(2, 2), i))
+            for i in range(20)
+        ]
+        # Too large to be batched, so it flushes the pending batch first.
+        big = torch.ones(8192)
+        futs.append(rpc.rpc_async(dst, torch.add, args=(big, 1)))
+        futs.append(rpc.rpc_async(dst, my_function, args=(1, 2, 3)))
+        for i, fut in enumerate(futs[:20]):
+            self.assertEqual(fut.wait(), torch.ones(2, 2) + i)
+        self.assertEqual(futs[20].wait(), big + 1)
+        self.assertEqual(futs[21].wait(), my_function(1, 2, 3))
+
+        info = rpc.api._get_current_rpc_agent().get_debug_info()
+        prefix = "agent.batching.{}".format(dst)
+        self.assertEqual(int(info[prefix + ".queue_depth"]), 0)
+        self.assertGreater(int(info[prefix + ".num_batches"]), 0)
+        self.assertGreaterEqual(float(info[prefix + ".average_batch_size"]), 1)
+        rpc.shutdown()
+
     # FIXME Merge this test with the corresponding one in RpcTest.
     @dist_init(setup_rpc=False)
     def test_tensorpipe_options_throw_on_timedelta_timeout(self):